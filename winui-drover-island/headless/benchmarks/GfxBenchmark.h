@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace winui_drover_island {
+namespace benchmark {
+
+// Just enough of a benchmark harness for the headless benchmarks, so they build with nothing but
+// the compiler. Each case runs a body a number of iterations per sample, and reports the median
+// of the samples per iteration, with the fastest and slowest: the median is stable from one run
+// to the next, the range tells how noisy the machine was.
+class Runner {
+ public:
+    Runner(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--quick") == 0) {
+                quick_ = true;
+            }
+        }
+    }
+
+    // --quick only checks the benchmarks still run, as ctest does: numbers are meaningless then.
+    bool quick() const { return quick_; }
+    size_t iterations(size_t full) const { return quick_ ? std::max<size_t>(full / 100, 1) : full; }
+
+    // fn(iterations) runs the measured code that many times. Units are per iteration, scaled by
+    // itemsPerIteration when one iteration processes several items.
+    template <typename Fn>
+    void run(const char* name, size_t iterations, Fn&& fn, double itemsPerIteration = 1.0, const char* unit = "item") {
+        iterations = this->iterations(iterations);
+        const int samples = quick_ ? 1 : 7;
+        std::vector<double> nsPerItem;
+        fn(std::max<size_t>(iterations / 10, 1));  // warm up
+        for (int sample = 0; sample < samples; ++sample) {
+            auto start = std::chrono::steady_clock::now();
+            fn(iterations);
+            std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            nsPerItem.push_back(elapsed.count() / (static_cast<double>(iterations) * itemsPerIteration));
+        }
+        report(name, nsPerItem, unit);
+    }
+
+    // For what run() can't time in one piece: samples measured by the caller, in nanoseconds.
+    static void report(const char* name, std::vector<double> nsPerItem, const char* unit = "item") {
+        if (nsPerItem.empty()) {
+            return;
+        }
+        std::sort(nsPerItem.begin(), nsPerItem.end());
+        std::printf("%-52s %12.2f ns/%-8s (%.2f .. %.2f)\n", name, nsPerItem[nsPerItem.size() / 2], unit,
+            nsPerItem.front(), nsPerItem.back());
+    }
+
+    // A value computed by a run that must not be optimized away.
+    template <typename T>
+    static void keep(const T& value) {
+        static volatile char sink;
+        sink = static_cast<char>(sizeof(value) + *reinterpret_cast<const volatile char*>(&value));
+    }
+
+ private:
+    bool quick_ = false;
+};
+
+}  // namespace benchmark
+}  // namespace winui_drover_island
@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxDamageRegion.h"
+#include "./GfxScene.h"
+
+using namespace winui_drover_island;
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // A diagram of small shapes over a 1920x1080 DIP view at 150%, as DroverIsland draws it.
+    const auto path = std::filesystem::temp_directory_path() / "GfxDamageRegionBenchmarks.gscn";
+    {
+        GfxSceneBuilder builder;
+        GfxScene::Style style = {};
+        style.fill[3] = 1.f;
+        style.flags = GfxScene::kFill;
+        auto fill = builder.addStyle(style);
+        for (uint32_t i = 0; i < 200 * 100; ++i) {
+            float x = static_cast<float>(i % 200) * 10.f;
+            float y = static_cast<float>(i / 200) * 11.f;
+            builder.addRect({x, y, x + 8, y + 8}, fill);
+        }
+        if (!builder.write(path)) {
+            std::printf("can't write %s\n", path.string().c_str());
+            return 1;
+        }
+    }
+    GfxScene scene;
+    if (!scene.open(path)) {
+        std::printf("can't open %s\n", path.string().c_str());
+        return 1;
+    }
+
+    const float scale = 1.5f;
+    const PixelRect surface{0, 0, static_cast<int32_t>(1920 * scale), static_cast<int32_t>(1080 * scale)};
+    auto toPixels = [&](const GfxScene::Rect& rect) {
+        return PixelRect{static_cast<int32_t>(std::floor(rect.left * scale)), static_cast<int32_t>(std::floor(rect.top * scale)),
+            static_cast<int32_t>(std::ceil(rect.right * scale)), static_cast<int32_t>(std::ceil(rect.bottom * scale))};
+    };
+    GfxDamageRegion damage;
+    scene.setChangeListener([&](const GfxScene::Rect& oldBounds, const GfxScene::Rect& newBounds) {
+        damage.add(toPixels(oldBounds).intersection(surface));
+        damage.add(toPixels(newBounds).intersection(surface));
+    });
+    std::vector<uint32_t> visible;
+    scene.nodesIntersecting({0, 0, 1920, 1080}, visible);
+
+    // Nudges a few random nodes by a couple of DIPs, as a drag or an animation does.
+    auto edit = [&](int edits) {
+        for (int k = 0; k < edits; ++k) {
+            auto node = visible[static_cast<size_t>(std::rand()) % visible.size()];
+            auto bounds = scene.node(node).bounds;
+            float dx = static_cast<float>(std::rand() % 5 - 2);
+            float dy = static_cast<float>(std::rand() % 5 - 2);
+            scene.setNodeBounds(node, {bounds.left + dx, bounds.top + dy, bounds.right + dx, bounds.bottom + dy});
+        }
+    };
+
+    // The tracking overhead: each edit and the simplification once per frame. Then how much of the
+    // surface the frame redraws, against all of it without the tracking.
+    char name[96];
+    const size_t frameCount = runner.iterations(2000);
+    for (int edits : {1, 4, 16, 64}) {
+        std::snprintf(name, sizeof(name), "edit and track, %d edits per frame", edits);
+        runner.run(
+            name, 2000,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    edit(edits);
+                    damage.clear();
+                }
+            },
+            static_cast<double>(edits), "edit");
+
+        std::vector<double> simplifyNs;
+        double redrawn = 0;
+        for (size_t frame = 0; frame < frameCount; ++frame) {
+            edit(edits);
+            auto start = std::chrono::steady_clock::now();
+            damage.simplify();
+            simplifyNs.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+            redrawn += static_cast<double>(damage.area());
+            damage.clear();
+        }
+        std::snprintf(name, sizeof(name), "simplify, %d edits per frame", edits);
+        benchmark::Runner::report(name, simplifyNs, "frame");
+        std::snprintf(name, sizeof(name), "redrawn, %d edits per frame", edits);
+        std::printf("%-52s %12.3f %% of the surface\n", name, 100 * redrawn / static_cast<double>(frameCount) / static_cast<double>(surface.area()));
+    }
+
+    scene.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <memory>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxDrawStreamHasher.h"
+#include "./GfxObjectHashCache.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+// What GfxDrawStreamHashSink feeds the hasher for a FillRectangle with a solid color brush.
+struct FillRectangle {
+    uint32_t command = 16;
+    float rect[4] = {};
+    uint32_t hasBrush = 1;
+    float color[4] = {};
+    float opacity = 1.f;
+    float transform[6] = {1, 0, 0, 1, 0, 0};
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // A frame of a few hundred primitives is what a dashboard control draws; the whole stream is
+    // hashed before deciding to skip the frame.
+    {
+        std::vector<FillRectangle> commands(256);
+        for (size_t i = 0; i < commands.size(); ++i) {
+            commands[i].rect[0] = static_cast<float>(i);
+            commands[i].rect[2] = static_cast<float>(i + 10);
+        }
+        GfxDrawStreamHasher hasher;
+        runner.run(
+            "hash a frame of 256 filled rectangles", 20000,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    hasher.reset();
+                    for (const auto& command : commands) {
+                        hasher.add(command);
+                    }
+                    benchmark::Runner::keep(hasher.hash());
+                }
+            },
+            static_cast<double>(commands.size()), "command");
+    }
+
+    // The figures of a path geometry, as streamed on a cache miss: a 4096-point polyline.
+    {
+        std::vector<float> points(2 * 4096);
+        for (size_t i = 0; i < points.size(); ++i) {
+            points[i] = static_cast<float>(i) * 0.5f;
+        }
+        GfxDrawStreamHasher hasher;
+        runner.run(
+            "hash the figures of a 4096-point path", 20000,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    hasher.reset();
+                    hasher.addArray(points.data(), points.size());
+                    benchmark::Runner::keep(hasher.hash());
+                }
+            },
+            4096.0, "point");
+    }
+
+    // On a hit, the same path costs a lookup instead: at once when it is the one found last, as
+    // when a path is drawn several times in a row, otherwise after a scan of the cache.
+    {
+        GfxObjectHashCache<std::shared_ptr<int>> cache(64);
+        std::vector<std::shared_ptr<int>> objects;
+        for (int i = 0; i < 64; ++i) {
+            objects.push_back(std::make_shared<int>(i));
+            cache.insert(objects.back(), static_cast<uint64_t>(i + 1));
+        }
+        runner.run("find a cached path, same as the last one", 10000000, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                benchmark::Runner::keep(cache.find(objects[63].get()));
+            }
+        });
+        runner.run(
+            "find 64 cached paths in turn", 200000,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    for (const auto& object : objects) {
+                        benchmark::Runner::keep(cache.find(object.get()));
+                    }
+                }
+            },
+            64.0, "lookup");
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "./GfxBenchmark.h"
+#include "./GfxHeadlessCanvas.h"
+#include "./GfxLruCache.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using Event = GfxEventTrace::Event;
+using EventKind = GfxEventTrace::EventKind;
+
+Event event(EventKind kind, float a = 0, float b = 0) {
+    Event result;
+    result.kind = kind;
+    result.values[0] = a;
+    result.values[1] = b;
+    return result;
+}
+
+// Content that costs something per pixel, standing in for what the panels draw.
+void drawPanel(uint32_t* pixels, size_t stride, const PixelRect& tileRect, const PixelRect& rect) {
+    for (int32_t y = rect.top; y < rect.bottom; ++y) {
+        auto* row = pixels + static_cast<size_t>(y - tileRect.top) * stride;
+        for (int32_t x = rect.left; x < rect.right; ++x) {
+            auto shade = static_cast<uint32_t>((x * 7 + y * 13) ^ (x * y)) & 0xff;
+            row[x - tileRect.left] = 0xff000000u | shade << 16 | (255 - shade) << 8 | ((x + y) & 0xff);
+        }
+    }
+}
+
+// A panel as the window shows it: sized, at the window DPI, drawn on the next frame.
+std::unique_ptr<GfxHeadlessCanvas> makePanel(const std::shared_ptr<GfxFrameClock>& clock) {
+    auto panel = std::make_unique<GfxHeadlessCanvas>(clock);
+    panel->setDrawFn(&drawPanel);
+    panel->applyEvent(event(EventKind::kDpiChange, 144.f));
+    panel->applyEvent(event(EventKind::kResize, 1000.f, 700.f));
+    return panel;
+}
+
+}  // namespace
+
+// What WinUIWindow::renderCanvasControl() costs per switch until the first frame of the new panel
+// is drawn: a new control every time, or the control parked when it was switched away from, under
+// the same memory cap.
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    auto clock = std::make_shared<GfxManualFrameClock>();
+    auto now = GfxFrameClock::Clock::now();
+    const uint32_t panelCount = 4;
+    const size_t parkedCapacity = 64 * 1024 * 1024;
+
+    std::unique_ptr<GfxHeadlessCanvas> current;
+    runner.run(
+        "switch to a new panel", 50,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                current = makePanel(clock);
+                clock->advance(now);
+            }
+        },
+        1.0, "switch");
+
+    GfxLruCache<uint32_t, std::unique_ptr<GfxHeadlessCanvas>> parked(parkedCapacity);
+    uint32_t currentKey = 0;
+    current = makePanel(clock);
+    clock->advance(now);
+    // The content of the panel switched to may have changed while it was parked: redrawn on the
+    // surface it kept, or not at all.
+    auto switchParked = [&](bool contentChanged) {
+        parked.updateCosts([](uint32_t, const auto& panel) { return panel->surfaceBytes(); });
+        auto bytes = current->surfaceBytes();
+        parked.insert(currentKey, std::move(current), bytes);
+        currentKey = (currentKey + 1) % panelCount;
+        if (!parked.take(currentKey, current)) {
+            current = makePanel(clock);
+        } else if (contentChanged) {
+            current->applyEvent(event(EventKind::kInvalidate));
+        }
+        clock->advance(now);
+    };
+    runner.run(
+        "switch to a parked panel, unchanged", 50,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                switchParked(false);
+            }
+        },
+        1.0, "switch");
+    runner.run(
+        "switch to a parked panel, content changed", 50,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                switchParked(true);
+            }
+        },
+        1.0, "switch");
+    benchmark::Runner::keep(current->stats().surfacesCreated);
+    return 0;
+}
@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxImageResampler.h"
+
+using namespace winui_drover_island;
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // A photo decoded for a thumbnail, which is what the decode workers spend their time on.
+    const int32_t width = runner.quick() ? 1000 : 4000;
+    const int32_t height = runner.quick() ? 750 : 3000;
+    const double megapixels = static_cast<double>(width) * height / 1e6;
+    std::vector<uint8_t> source(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<uint8_t>(i * 7 + i / 16000);
+    }
+
+    // Opaque pixels are skipped, most of these are translucent.
+    for (size_t alpha = 3; alpha < source.size(); alpha += 4) {
+        source[alpha] = static_cast<uint8_t>(alpha >> 2);
+    }
+    runner.run(
+        "premultiply", 10,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                GfxImageResampler::premultiply(source.data(), width, height, static_cast<size_t>(width) * 4);
+            }
+        },
+        megapixels, "Mpx");
+
+    GfxImageResampler resampler;
+    for (int32_t divisor : {2, 10, 37}) {
+        const int32_t fitWidth = width / divisor;
+        const int32_t fitHeight = height / divisor;
+        std::vector<uint8_t> destination(static_cast<size_t>(fitWidth) * fitHeight * 4);
+        runner.run(
+            ("downscale by " + std::to_string(divisor)).c_str(), 5,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    resampler.downscale(source.data(), width, height, static_cast<size_t>(width) * 4, destination.data(),
+                        fitWidth, fitHeight, static_cast<size_t>(fitWidth) * 4);
+                    benchmark::Runner::keep(destination[0]);
+                }
+            },
+            megapixels, "Mpx");
+    }
+    return 0;
+}
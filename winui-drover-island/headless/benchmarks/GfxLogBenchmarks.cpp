@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxLog.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+class CountingSink : public GfxLogSink {
+ public:
+    void write(const GfxLogRecord&) override { written++; }
+    std::atomic<uint64_t> written{0};
+};
+
+// A sink on a slow disk or a debugger output that takes its time.
+class SlowSink : public GfxLogSink {
+ public:
+    void write(const GfxLogRecord&) override { std::this_thread::sleep_for(std::chrono::microseconds(500)); }
+};
+
+// Distinct pointers land in distinct rate limiter slots, so each gets its own allowance.
+const char kSites[GfxLog::kRateLimitSlots] = {};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // The render path during a device loss: every draw fails at the same site, and nearly all of
+    // the records are dropped by the rate limiter.
+    {
+        GfxLog log;
+        log.start(std::make_unique<CountingSink>());
+        runner.run(
+            "log, storm on one site, 1 thread", 2000000,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    log.log(GfxLogKind::kFailed, "performImageSourceDraw", static_cast<int32_t>(0x887A0005), i);
+                }
+            },
+            1.0, "record");
+        for (int threadCount : {2, 4, 8}) {
+            char name[64];
+            std::snprintf(name, sizeof(name), "log, storm on one site, %d threads", threadCount);
+            runner.run(
+                name, 500000,
+                [&](size_t iterations) {
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < threadCount; ++t) {
+                        threads.emplace_back([&log, iterations, t]() {
+                            for (size_t i = 0; i < iterations; ++i) {
+                                log.log(GfxLogKind::kFailed, "performImageSourceDraw", static_cast<int32_t>(0x887A0005), t);
+                            }
+                        });
+                    }
+                    for (auto& thread : threads) {
+                        thread.join();
+                    }
+                },
+                threadCount, "record");
+        }
+        log.stop();
+    }
+
+    {
+        GfxLogRecord record;
+        record.site = "performImageSourceDraw";
+        record.hresult = static_cast<int32_t>(0x887A0005);
+        record.controlId = 42;
+        record.suppressed = 17;
+        char buffer[512];
+        runner.run("format a record on the drain thread", 2000000, [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                record.controlId = i;
+                benchmark::Runner::keep(GfxLogSink::format(record, buffer, sizeof(buffer)));
+            }
+        });
+    }
+
+    // A thread logging for the first time registers its ring. The drain thread writes to the sink
+    // without holding the ring list, so a slow sink doesn't hold up that registration.
+    {
+        GfxLog log;
+        log.start(std::make_unique<SlowSink>());
+        std::vector<double> samples;
+        for (size_t i = 0; i < runner.iterations(500) / 25; ++i) {
+            for (size_t site = 0; site < 64; ++site) {
+                log.log(GfxLogKind::kFailed, &kSites[site], 0);
+            }
+            // Let the drain thread pick them up and start writing.
+            std::this_thread::sleep_for(GfxLog::kDrainInterval + std::chrono::milliseconds(5));
+            std::thread([&]() {
+                auto start = std::chrono::steady_clock::now();
+                log.log(GfxLogKind::kFailed, "firstLog", 0);
+                std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+                samples.push_back(elapsed.count());
+            }).join();
+        }
+        benchmark::Runner::report("first log of a new thread, slow sink draining", samples, "thread");
+        log.stop();
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxObjectPool.h"
+
+using namespace winui_drover_island;
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // As GfxD2DContextPool leases its contexts: a take and a give around each use, from the UI
+    // thread and the threads drawing in the background. The pool keeps a context per core.
+    const size_t maxIdle = std::max(std::thread::hardware_concurrency(), 1U);
+    for (int threadCount : {1, 2, 4, 8}) {
+        GfxObjectPool<std::unique_ptr<int>> pool(maxIdle);
+        char name[64];
+        std::snprintf(name, sizeof(name), "take and give, %d threads", threadCount);
+        runner.run(
+            name, 200000,
+            [&](size_t iterations) {
+                std::vector<std::thread> threads;
+                for (int t = 0; t < threadCount; ++t) {
+                    threads.emplace_back([&pool, iterations]() {
+                        for (size_t i = 0; i < iterations; ++i) {
+                            std::unique_ptr<int> object;
+                            if (!pool.take(object)) {
+                                object = std::make_unique<int>(0);
+                            }
+                            benchmark::Runner::keep(*object);
+                            pool.give(std::move(object));
+                        }
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+            },
+            threadCount, "lease");
+        auto stats = pool.stats();
+        std::printf("%-52s %12.3f %% of the takes contended, %llu created\n", name,
+            stats.takes ? 100.0 * static_cast<double>(stats.contended) / static_cast<double>(stats.takes) : 0.0,
+            static_cast<unsigned long long>(stats.takes - stats.hits));
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxSeriesSummary.h"
+
+using namespace winui_drover_island;
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // A waveform of a few minutes, drawn in a view a couple thousand pixels wide.
+    const size_t sampleCount = runner.quick() ? 100000 : 10000000;
+    const size_t columnCount = 2000;
+    std::vector<float> samples(sampleCount);
+    for (size_t i = 0; i < sampleCount; ++i) {
+        samples[i] = std::sin(static_cast<float>(i) * 0.001f) + static_cast<float>(i * 7919 % 100) * 0.001f;
+    }
+
+    runner.run(
+        "min/max kernel", 20,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                benchmark::Runner::keep(GfxSeriesSummary::minMax(samples.data(), samples.size()).max);
+            }
+        },
+        static_cast<double>(sampleCount), "sample");
+
+    GfxSeriesSummary series;
+    runner.run(
+        "append the series at once", 3,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                series.clear();
+                series.append(samples.data(), samples.size());
+            }
+        },
+        static_cast<double>(sampleCount), "sample");
+
+    // As a meter does: a buffer of samples every 10ms at 48kHz.
+    const size_t chunkSize = 480;
+    runner.run(
+        "append the series in chunks", 3,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                series.clear();
+                for (size_t first = 0; first < sampleCount; first += chunkSize) {
+                    series.append(samples.data() + first, std::min(chunkSize, sampleCount - first));
+                }
+            }
+        },
+        static_cast<double>(sampleCount), "sample");
+
+    // The cost of a redraw showing the whole series, with the summary and without it.
+    std::vector<GfxSeriesSummary::Range> columns(columnCount);
+    const double samplesPerColumn = static_cast<double>(sampleCount) / columnCount;
+    runner.run(
+        "decimate to columns", 200,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                series.decimate(0, samplesPerColumn, columns.data(), columns.size());
+                benchmark::Runner::keep(columns[0].min);
+            }
+        },
+        static_cast<double>(columnCount), "column");
+    runner.run(
+        "reduce the samples of each column", 3,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (size_t column = 0; column < columnCount; ++column) {
+                    auto begin = column * sampleCount / columnCount;
+                    auto end = (column + 1) * sampleCount / columnCount;
+                    columns[column] = GfxSeriesSummary::minMax(samples.data() + begin, end - begin);
+                }
+                benchmark::Runner::keep(columns[0].min);
+            }
+        },
+        static_cast<double>(columnCount), "column");
+    return 0;
+}
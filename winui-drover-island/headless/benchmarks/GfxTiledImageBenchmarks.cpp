@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <filesystem>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxTiledImage.h"
+
+using namespace winui_drover_island;
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    const int32_t size = runner.quick() ? 1024 : 4096;
+    const int32_t tileSize = GfxTiledImage::kDefaultTileSize;
+    const auto path = std::filesystem::temp_directory_path() / "GfxTiledImageBenchmarks.gtim";
+
+    // Converting an image, tile by tile.
+    const double tiles = static_cast<double>(size / tileSize) * (size / tileSize);
+    runner.run(
+        "write an image tile by tile", 1,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                GfxTiledImage::write(path, size, size, tileSize, [](const PixelRect& rect, uint8_t* pixels, size_t stride) {
+                    for (int32_t y = 0; y < rect.height(); ++y) {
+                        auto* row = reinterpret_cast<uint32_t*>(pixels + stride * y);
+                        for (int32_t x = 0; x < rect.width(); ++x) {
+                            row[x] = 0xff000000u | static_cast<uint32_t>(rect.left + x) << 8 | static_cast<uint32_t>(rect.top + y);
+                        }
+                    }
+                });
+            }
+        },
+        tiles, "tile");
+
+    GfxTiledImage image;
+    if (!image.open(path)) {
+        std::printf("can't open %s\n", path.string().c_str());
+        return 1;
+    }
+
+    // What GfxRasterLayer does per frame while a 1920x1080 viewport scrolls diagonally: read ahead
+    // of the update bounds, list the tiles of the viewport and read them, as an upload would.
+    {
+        std::vector<GfxTiledImage::Tile> visibleTiles;
+        const int32_t steps = (size - 1080) / 16;
+        runner.run(
+            "scroll a viewport, read ahead and read its tiles", 20,
+            [&](size_t iterations) {
+                for (size_t i = 0; i < iterations; ++i) {
+                    PixelRect previous;
+                    for (int32_t step = 0; step < steps; ++step) {
+                        PixelRect viewport{step * 8, step * 16, step * 8 + 1920, step * 16 + 1080};
+                        image.prefetch(GfxTiledImage::readAheadRect(previous, viewport, 2 * tileSize));
+                        previous = viewport;
+                        visibleTiles.clear();
+                        image.tilesIntersecting(viewport, visibleTiles);
+                        uint32_t sum = 0;
+                        for (const auto& tile : visibleTiles) {
+                            const auto* pixels = image.tilePixels(tile);
+                            for (size_t offset = 0; offset < image.tileBytes(); offset += 4096) {
+                                sum += pixels[offset];
+                            }
+                        }
+                        benchmark::Runner::keep(sum);
+                    }
+                }
+            },
+            static_cast<double>(steps), "frame");
+    }
+
+    // Sizing the cache of the raster layer to the viewport and its read-ahead margin.
+    runner.run("count the tiles around a viewport", 1000000, [&](size_t iterations) {
+        for (size_t i = 0; i < iterations; ++i) {
+            auto offset = static_cast<int32_t>(i & 1023);
+            PixelRect cached{offset - 512, offset - 512, offset + 1920 + 512, offset + 1080 + 512};
+            benchmark::Runner::keep(image.tileCountIntersecting(cached));
+        }
+    });
+
+    image.close();
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return 0;
+}
@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "./GfxBenchmark.h"
+#include "./GfxUnits.h"
+
+using namespace winui_drover_island;
+
+int main(int argc, char** argv) {
+    benchmark::Runner runner(argc, argv);
+
+    // The conversions of an invalidation or of a draw, over rects of a 4K surface at 150%.
+    const float dpi = 144.f;
+    const size_t count = 4096;
+    std::vector<DipRect> dipRects(count);
+    std::vector<PixelRect> pixelRects(count);
+    for (size_t i = 0; i < count; ++i) {
+        float x = static_cast<float>(std::rand() % 25600) * 0.1f;
+        float y = static_cast<float>(std::rand() % 14400) * 0.1f;
+        dipRects[i] = DipRect{x, y, static_cast<float>(std::rand() % 2000) * 0.1f, static_cast<float>(std::rand() % 2000) * 0.1f};
+        pixelRects[i] = toPixelRect(dipRects[i], dpi);
+    }
+
+    runner.run(
+        "dipsToPixels, floor and ceiling edges", 2000,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (const auto& rect : dipRects) {
+                    PixelRect pixels{dipsToPixels(rect.x, dpi, DpiRounding::kFloor), dipsToPixels(rect.y, dpi, DpiRounding::kFloor),
+                        dipsToPixels(rect.x + rect.width, dpi, DpiRounding::kCeiling),
+                        dipsToPixels(rect.y + rect.height, dpi, DpiRounding::kCeiling)};
+                    benchmark::Runner::keep(pixels.right);
+                }
+            }
+        },
+        static_cast<double>(count), "rect");
+    runner.run(
+        "toPixelRect", 2000,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (const auto& rect : dipRects) {
+                    benchmark::Runner::keep(toPixelRect(rect, dpi).right);
+                }
+            }
+        },
+        static_cast<double>(count), "rect");
+    runner.run(
+        "toDipRect", 2000,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                for (const auto& rect : pixelRects) {
+                    benchmark::Runner::keep(toDipRect(rect, dpi).width);
+                }
+            }
+        },
+        static_cast<double>(count), "rect");
+
+    // What the damage tracking and the tiling do with each rect: clip it to the surface or a tile,
+    // merge it, move it to the tile origin.
+    const PixelRect surface{0, 0, 3840, 2160};
+    runner.run(
+        "clip, merge and translate a pixel rect", 2000,
+        [&](size_t iterations) {
+            for (size_t i = 0; i < iterations; ++i) {
+                PixelRect bounds;
+                for (const auto& rect : pixelRects) {
+                    auto clipped = rect.intersection(surface);
+                    bounds = bounds.unionWith(clipped.translated(-512, -512));
+                }
+                benchmark::Runner::keep(bounds.right);
+            }
+        },
+        static_cast<double>(count), "rect");
+    return 0;
+}
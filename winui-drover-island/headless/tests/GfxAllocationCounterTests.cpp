@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <memory>
+#include <vector>
+
+#include "./GfxAllocationCounter.h"
+#include "./GfxFrameClock.h"
+#include "./GfxHeadlessCanvas.h"
+#include "./GfxSmallVector.h"
+#include "./GfxTest.h"
+#include "./GfxViolationCheck.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using test::ViolationCheck;
+
+GfxEventTrace::Event event(GfxEventTrace::EventKind kind, float a = 0, float b = 0, float c = 0, float d = 0) {
+    GfxEventTrace::Event result;
+    result.kind = kind;
+    result.values[0] = a;
+    result.values[1] = b;
+    result.values[2] = c;
+    result.values[3] = d;
+    return result;
+}
+
+}  // namespace
+
+GFX_TEST(CountingIsCompiledIn) {
+    GFX_REQUIRE(GfxAllocationCounter::isEnabled());
+    auto before = GfxAllocationCounter::threadAllocationCount();
+    auto value = std::make_unique<int>(1);
+    GFX_CHECK_EQ(GfxAllocationCounter::threadAllocationCount() - before, 1u);
+}
+
+GFX_TEST(ScopeReportsAllocations) {
+    ViolationCheck check;
+    {
+        GfxNoAllocationScope scope("allocating");
+        std::vector<int> values(3);
+        GFX_CHECK_EQ(scope.allocationCount(), 1u);
+    }
+    GFX_CHECK_EQ(check.violations(), 1u);
+}
+
+GFX_TEST(DisabledScopeReportsNothing) {
+    ViolationCheck check;
+    {
+        GfxNoAllocationScope scope("cold frame", false);
+        std::vector<int> values(3);
+        GFX_CHECK_EQ(scope.allocationCount(), 0u);
+    }
+    GFX_CHECK_EQ(check.violations(), 0u);
+}
+
+GFX_TEST(SmallVectorStopsAllocatingOnceWarm) {
+    ViolationCheck check;
+    GfxSmallVector<int, 4> values;
+    for (int round = 0; round < 3; ++round) {
+        // The first round may grow the heap storage, the next ones reuse it.
+        GfxNoAllocationScope scope("GfxSmallVector", round > 0);
+        values.clear();
+        for (int i = 0; i < 10; ++i) {
+            values.push_back(i);
+        }
+        int sum = 0;
+        for (int value : values) {
+            sum += value;
+        }
+        GFX_CHECK_EQ(sum, 45);
+    }
+    GFX_CHECK_EQ(check.violations(), 0u);
+
+    GfxSmallVector<int, 4> inlineOnly;
+    GfxNoAllocationScope scope("GfxSmallVector inline");
+    inlineOnly.push_back(1);
+    inlineOnly.resizeForOverwrite(4);
+    GFX_CHECK_EQ(scope.allocationCount(), 0u);
+}
+
+// The frames of a canvas whose surfaces exist: invalidations, damage merging, tile iteration and
+// the frame clock must not touch the heap.
+void checkSteadyStateFrames(int32_t tilingThreshold) {
+    ViolationCheck check;
+    auto clock = std::make_shared<GfxManualFrameClock>();
+    GfxHeadlessCanvas canvas(clock);
+    canvas.setTilingThreshold(tilingThreshold);
+    canvas.applyEvent(event(GfxEventTrace::EventKind::kResize, 1000, 800));
+    auto now = GfxFrameClock::Clock::time_point{};
+
+    auto frame = [&](int index) {
+        for (int i = 0; i < 12; ++i) {
+            float left = static_cast<float>((index * 37 + i * 71) % 900);
+            float top = static_cast<float>((index * 53 + i * 29) % 700);
+            canvas.applyEvent(event(GfxEventTrace::EventKind::kInvalidateRect, left, top, left + 40, top + 30));
+        }
+        if (index % 10 == 0) {
+            canvas.applyEvent(event(GfxEventTrace::EventKind::kInvalidate));
+        }
+        now += std::chrono::milliseconds(16);
+        clock->advance(now);
+    };
+    // Warm frames create the surfaces and grow the buffers to their steady-state size.
+    for (int i = 0; i < 3; ++i) {
+        frame(i);
+    }
+    for (int i = 3; i < 200; ++i) {
+        GfxNoAllocationScope scope("GfxHeadlessCanvas frame");
+        frame(i);
+    }
+    GFX_CHECK_EQ(check.violations(), 0u);
+    GFX_CHECK(canvas.stats().frames.partialFrames > 0u);
+}
+
+GFX_TEST(SteadyStateFramesDoNotAllocate) {
+    checkSteadyStateFrames(0);
+}
+
+GFX_TEST(SteadyStateTiledFramesDoNotAllocate) {
+    checkSteadyStateFrames(256);
+}
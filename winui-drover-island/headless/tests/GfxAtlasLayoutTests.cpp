@@ -0,0 +1,171 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "./GfxAtlasLayout.h"
+#include "./GfxRectPacker.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(PackerPlacesRectsInsideWithoutOverlap) {
+    GfxRectPacker packer(512, 512);
+    std::vector<PixelRect> rects;
+    for (int i = 0; i < 100; ++i) {
+        auto rect = packer.allocate(20 + i % 13, 10 + i % 7);
+        GFX_REQUIRE(rect);
+        GFX_CHECK_EQ(rect->width(), 20 + i % 13);
+        GFX_CHECK_EQ(rect->height(), 10 + i % 7);
+        GFX_CHECK(PixelRect{0, 0, 512, 512}.contains(*rect));
+        rects.push_back(*rect);
+    }
+    for (size_t i = 0; i < rects.size(); ++i) {
+        for (size_t j = i + 1; j < rects.size(); ++j) {
+            GFX_CHECK(!rects[i].intersects(rects[j]));
+        }
+    }
+    GFX_CHECK_EQ(packer.allocationCount(), rects.size());
+}
+
+GFX_TEST(PackerKeepsPaddingBetweenRects) {
+    GfxRectPacker packer(64, 64, 2);
+    auto a = packer.allocate(10, 10);
+    auto b = packer.allocate(10, 10);
+    GFX_REQUIRE(a && b);
+    GFX_CHECK(b->left >= a->right + 2 || b->top >= a->bottom + 2);
+}
+
+GFX_TEST(PackerFailsWhenFull) {
+    GfxRectPacker packer(100, 100);
+    GFX_CHECK(!packer.allocate(200, 10));
+    GFX_CHECK(!packer.allocate(10, 200));
+    auto all = packer.allocate(99, 99);
+    GFX_REQUIRE(all);
+    GFX_CHECK(!packer.allocate(1, 1));
+    GFX_CHECK_EQ(packer.allocationCount(), 1u);
+}
+
+GFX_TEST(PackerReusesReleasedSpace) {
+    GfxRectPacker packer(100, 100);
+    auto all = packer.allocate(99, 99);
+    GFX_REQUIRE(all);
+    packer.release(*all);
+    GFX_CHECK_EQ(packer.allocationCount(), 0u);
+    GFX_CHECK_EQ(packer.allocatedArea(), 0);
+    GFX_CHECK(packer.allocate(99, 99));
+}
+
+GFX_TEST(PackerCoalescesReleasedSpans) {
+    // Two neighbours released on the same shelf leave room for one rect as wide as both.
+    GfxRectPacker packer(64, 16, 0);
+    auto a = packer.allocate(32, 16);
+    auto b = packer.allocate(32, 16);
+    GFX_REQUIRE(a && b);
+    GFX_CHECK(!packer.allocate(64, 16));
+    packer.release(*a);
+    packer.release(*b);
+    GFX_CHECK(packer.allocate(64, 16));
+}
+
+GFX_TEST(PackerResetFreesEverything) {
+    GfxRectPacker packer(32, 32);
+    GFX_REQUIRE(packer.allocate(31, 31));
+    packer.reset();
+    GFX_CHECK_EQ(packer.allocationCount(), 0u);
+    GFX_CHECK(packer.allocate(31, 31));
+}
+
+GFX_TEST(LayoutSlotsDoNotOverlap) {
+    GfxAtlasLayout layout(1024, 1024);
+    std::vector<GfxAtlasLayout::SlotId> slots;
+    for (int i = 0; i < 200; ++i) {
+        auto slot = layout.addSlot(40 + i % 7, 30 + i % 5);
+        GFX_REQUIRE(slot != GfxAtlasLayout::kInvalidSlot);
+        slots.push_back(slot);
+    }
+    GFX_CHECK_EQ(layout.slotCount(), slots.size());
+    for (size_t i = 0; i < slots.size(); ++i) {
+        for (size_t j = i + 1; j < slots.size(); ++j) {
+            GFX_CHECK(!layout.slotRect(slots[i]).intersects(layout.slotRect(slots[j])));
+        }
+    }
+}
+
+GFX_TEST(LayoutFailsWhenFull) {
+    GfxAtlasLayout layout(64, 64);
+    GFX_CHECK(layout.addSlot(128, 8) == GfxAtlasLayout::kInvalidSlot);
+    GFX_REQUIRE(layout.addSlot(63, 63) != GfxAtlasLayout::kInvalidSlot);
+    GFX_CHECK(layout.addSlot(8, 8) == GfxAtlasLayout::kInvalidSlot);
+    GFX_CHECK_EQ(layout.slotCount(), 1u);
+}
+
+GFX_TEST(LayoutBatchesNewSlotsInOneUpdateRect) {
+    GfxAtlasLayout layout(256, 256);
+    std::vector<GfxAtlasLayout::SlotId> slots;
+    for (int i = 0; i < 10; ++i) {
+        slots.push_back(layout.addSlot(30, 20));
+    }
+    GFX_CHECK(layout.hasDirtySlots());
+    GfxAtlasLayout::Batch batch;
+    GFX_REQUIRE(layout.takeBatch(batch));
+    GFX_CHECK_EQ(batch.slots, slots);
+    for (auto slot : slots) {
+        GFX_CHECK(batch.updateRect.contains(layout.slotRect(slot)));
+    }
+    GFX_CHECK(!layout.hasDirtySlots());
+    GFX_CHECK(!layout.takeBatch(batch));
+}
+
+GFX_TEST(LayoutBatchRedrawsCleanSlotsInsideTheUpdateRect) {
+    GfxAtlasLayout layout(256, 256);
+    std::vector<GfxAtlasLayout::SlotId> slots;
+    for (int i = 0; i < 10; ++i) {
+        slots.push_back(layout.addSlot(30, 20));
+    }
+    GfxAtlasLayout::Batch batch;
+    GFX_REQUIRE(layout.takeBatch(batch));
+
+    layout.markDirty(slots[3]);
+    GFX_REQUIRE(layout.takeBatch(batch));
+    GFX_CHECK(batch.updateRect.contains(layout.slotRect(slots[3])));
+    for (auto slot : slots) {
+        bool inBatch = std::find(batch.slots.begin(), batch.slots.end(), slot) != batch.slots.end();
+        GFX_CHECK_EQ(inBatch, layout.slotRect(slot).intersects(batch.updateRect));
+    }
+}
+
+GFX_TEST(LayoutReusesRemovedSlots) {
+    GfxAtlasLayout layout(64, 64);
+    auto slot = layout.addSlot(63, 63);
+    GFX_REQUIRE(slot != GfxAtlasLayout::kInvalidSlot);
+    layout.removeSlot(slot);
+    GFX_CHECK(layout.isEmpty());
+    GFX_CHECK(layout.slotRect(slot).isEmpty());
+    auto again = layout.addSlot(63, 63);
+    GFX_CHECK(again != GfxAtlasLayout::kInvalidSlot);
+    GFX_CHECK(again != slot);
+}
+
+GFX_TEST(LayoutMarkAllDirtyBatchesEverySlot) {
+    GfxAtlasLayout layout(256, 256);
+    for (int i = 0; i < 5; ++i) {
+        layout.addSlot(40, 40);
+    }
+    GfxAtlasLayout::Batch batch;
+    layout.takeBatch(batch);
+    layout.markAllDirty();
+    GFX_REQUIRE(layout.takeBatch(batch));
+    GFX_CHECK_EQ(batch.slots.size(), 5u);
+}
@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "./GfxBlur.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+// Premultiplied noise: no channel above its alpha.
+std::vector<uint8_t> makeNoise(int32_t width, int32_t height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        auto alpha = static_cast<uint8_t>(std::rand());
+        pixels[i + 3] = alpha;
+        for (size_t c = 0; c < 3; ++c) {
+            pixels[i + c] = alpha ? static_cast<uint8_t>(std::rand() % (alpha + 1)) : 0;
+        }
+    }
+    return pixels;
+}
+
+// The blur by definition: a horizontal then a vertical box average, rounded to nearest, with
+// transparent pixels outside the image.
+void referenceBoxBlur(std::vector<uint8_t>& pixels, int32_t width, int32_t height, int32_t radius) {
+    std::vector<uint8_t> horizontal(pixels.size());
+    const float scale = 1.f / (2 * radius + 1);
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            for (int32_t c = 0; c < 4; ++c) {
+                uint32_t sum = 0;
+                for (int32_t k = std::max(x - radius, 0); k <= std::min(x + radius, width - 1); ++k) {
+                    sum += pixels[(y * width + k) * 4 + c];
+                }
+                horizontal[(y * width + x) * 4 + c] = static_cast<uint8_t>(sum * scale + 0.5f);
+            }
+        }
+    }
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            for (int32_t c = 0; c < 4; ++c) {
+                uint32_t sum = 0;
+                for (int32_t k = std::max(y - radius, 0); k <= std::min(y + radius, height - 1); ++k) {
+                    sum += horizontal[(k * width + x) * 4 + c];
+                }
+                pixels[(y * width + x) * 4 + c] = static_cast<uint8_t>(sum * scale + 0.5f);
+            }
+        }
+    }
+}
+
+}  // namespace
+
+GFX_TEST(BoxBlurMatchesTheReference) {
+    GfxBlur blur;
+    int32_t mismatches = 0;
+    int32_t unpremultiplied = 0;
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        int32_t width = 1 + std::rand() % 40;
+        int32_t height = 1 + std::rand() % 40;
+        int32_t radius = 1 + std::rand() % 25;
+        auto pixels = makeNoise(width, height);
+        auto expected = pixels;
+        blur.boxBlur(pixels.data(), width, height, static_cast<size_t>(width) * 4, radius);
+        referenceBoxBlur(expected, width, height, radius);
+        mismatches += pixels != expected;
+        for (size_t i = 0; i < pixels.size(); i += 4) {
+            unpremultiplied += pixels[i] > pixels[i + 3] || pixels[i + 1] > pixels[i + 3] || pixels[i + 2] > pixels[i + 3];
+        }
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+    GFX_CHECK_EQ(unpremultiplied, 0);
+}
+
+GFX_TEST(BoxRadiiApproximateTheDeviation) {
+    for (float deviation : {2.f, 5.f, 10.f, 30.f}) {
+        int32_t radii[GfxBlur::kGaussianPasses];
+        GfxBlur::gaussianBoxRadii(deviation, radii);
+        // The variance of a box of width w is (w * w - 1) / 12, and the variances of the passes add up.
+        double variance = 0;
+        int32_t extent = 0;
+        for (auto radius : radii) {
+            double boxWidth = 2 * radius + 1;
+            variance += (boxWidth * boxWidth - 1) / 12;
+            extent += radius;
+        }
+        GFX_CHECK(std::abs(std::sqrt(variance) - deviation) < 0.25);
+        GFX_CHECK_EQ(GfxBlur::gaussianExtent(deviation), extent);
+    }
+    // Too small to blur anything.
+    GFX_CHECK_EQ(GfxBlur::gaussianExtent(0.f), 0);
+}
+
+GFX_TEST(GaussianBlurStaysWithinItsExtent) {
+    // An opaque square with twice the extent around it: the blur spreads over the extent, as the
+    // effect cache pads its bitmaps with, and no further.
+    const float deviation = 5.f;
+    const int32_t extent = GfxBlur::gaussianExtent(deviation);
+    const int32_t square = 20;
+    const int32_t size = square + 4 * extent;
+    std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4, 0);
+    for (int32_t y = 2 * extent; y < 2 * extent + square; ++y) {
+        std::fill_n(&pixels[(y * size + 2 * extent) * 4], square * 4, uint8_t(255));
+    }
+
+    GfxBlur blur;
+    blur.gaussianBlur(pixels.data(), size, size, static_cast<size_t>(size) * 4, deviation);
+    auto alphaAt = [&](int32_t x, int32_t y) { return pixels[(y * size + x) * 4 + 3]; };
+    const int32_t middle = size / 2;
+    GFX_CHECK(alphaAt(extent + 2, middle) > 0);
+    GFX_CHECK(alphaAt(middle, extent + 2) > 0);
+    bool outsideIsClear = true;
+    for (int32_t i = 0; i < size; ++i) {
+        outsideIsClear = outsideIsClear && alphaAt(extent - 1, i) == 0 && alphaAt(size - extent, i) == 0 &&
+                         alphaAt(i, extent - 1) == 0 && alphaAt(i, size - extent) == 0;
+    }
+    GFX_CHECK(outsideIsClear);
+    // Symmetric around the square.
+    GFX_CHECK_EQ(alphaAt(2 * extent - 3, middle), alphaAt(2 * extent + square + 2, middle));
+    GFX_CHECK_EQ(alphaAt(middle, 2 * extent - 3), alphaAt(middle, 2 * extent + square + 2));
+}
+
+GFX_TEST(TintKeepsTheCoverage) {
+    uint8_t pixels[8] = {10, 20, 30, 255, 0, 0, 64, 128};
+    const uint8_t color[4] = {0, 0, 128, 255};
+    GfxBlur::tint(pixels, 2, 1, 8, color);
+    GFX_CHECK(pixels[0] == 0 && pixels[1] == 0 && pixels[2] == 128 && pixels[3] == 255);
+    // Half covered, half the color.
+    GFX_CHECK(pixels[4] == 0 && pixels[5] == 0 && pixels[6] == 64 && pixels[7] == 128);
+}
@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "./GfxCompressedTileStore.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+constexpr int32_t kTileSize = 64;
+
+// A flat background with a band of varying pixels, like most UI content.
+std::vector<uint8_t> makeTile(int seed) {
+    std::vector<uint8_t> pixels(kTileSize * kTileSize * 4, 0xf3);
+    for (int32_t y = 20; y < 30; ++y) {
+        for (int32_t x = 0; x < kTileSize; ++x) {
+            uint8_t* pixel = &pixels[(y * kTileSize + x) * 4];
+            pixel[0] = static_cast<uint8_t>(x * 3 + seed);
+            pixel[1] = static_cast<uint8_t>(y * 5);
+            pixel[2] = static_cast<uint8_t>(seed);
+            pixel[3] = 255;
+        }
+    }
+    return pixels;
+}
+
+}  // namespace
+
+GFX_TEST(RestoredTilesMatchTheStoredPixels) {
+    GfxCompressedTileStore store;
+    auto tile = makeTile(1);
+    store.store({1, 7}, tile.data(), kTileSize, kTileSize, kTileSize * 4);
+    GFX_CHECK_EQ(store.tileCount(), 1u);
+    GFX_CHECK(store.sizeInBytes() < tile.size() / 4);
+    GFX_CHECK(store.stats().compressionRatio() > 4);
+
+    std::vector<uint8_t> pixels;
+    GFX_REQUIRE(store.restore({1, 7}, kTileSize, kTileSize, pixels));
+    GFX_CHECK(pixels == tile);
+    GFX_CHECK_EQ(store.stats().restoredTiles, 1u);
+    GFX_CHECK_EQ(store.stats().decodedBytes, uint64_t(tile.size()));
+}
+
+GFX_TEST(RestoringTakesTheTileOut) {
+    GfxCompressedTileStore store;
+    auto tile = makeTile(1);
+    store.store({1, 7}, tile.data(), kTileSize, kTileSize, kTileSize * 4);
+    std::vector<uint8_t> pixels;
+    GFX_REQUIRE(store.restore({1, 7}, kTileSize, kTileSize, pixels));
+    GFX_CHECK_EQ(store.tileCount(), 0u);
+    GFX_CHECK_EQ(store.sizeInBytes(), 0u);
+    GFX_CHECK(!store.restore({1, 7}, kTileSize, kTileSize, pixels));
+    GFX_CHECK_EQ(store.stats().missedTiles, 1u);
+}
+
+GFX_TEST(TilesOfAnotherSizeArentRestored) {
+    GfxCompressedTileStore store;
+    auto tile = makeTile(1);
+    store.store({1, 7}, tile.data(), kTileSize, kTileSize, kTileSize * 4);
+    std::vector<uint8_t> pixels;
+    GFX_CHECK(!store.restore({1, 7}, kTileSize, kTileSize / 2, pixels));
+    // The stale tile is dropped rather than kept for a size that won't come back.
+    GFX_CHECK_EQ(store.tileCount(), 0u);
+    GFX_CHECK_EQ(store.stats().missedTiles, 1u);
+}
+
+GFX_TEST(StoringAgainReplacesTheTile) {
+    GfxCompressedTileStore store;
+    auto first = makeTile(1);
+    auto second = makeTile(2);
+    store.store({1, 7}, first.data(), kTileSize, kTileSize, kTileSize * 4);
+    store.store({1, 7}, second.data(), kTileSize, kTileSize, kTileSize * 4);
+    GFX_CHECK_EQ(store.tileCount(), 1u);
+    std::vector<uint8_t> pixels;
+    GFX_REQUIRE(store.restore({1, 7}, kTileSize, kTileSize, pixels));
+    GFX_CHECK(pixels == second);
+}
+
+GFX_TEST(LeastRecentlyStoredTilesAreDroppedFirst) {
+    auto tile = makeTile(1);
+    GfxCompressedTileStore probe;
+    probe.store({1, 0}, tile.data(), kTileSize, kTileSize, kTileSize * 4);
+    const size_t tileBytes = probe.sizeInBytes();
+
+    GfxCompressedTileStore store(tileBytes * 3);
+    for (uint64_t i = 0; i < 5; ++i) {
+        store.store({1, i}, tile.data(), kTileSize, kTileSize, kTileSize * 4);
+    }
+    GFX_CHECK_EQ(store.tileCount(), 3u);
+    std::vector<uint8_t> pixels;
+    GFX_CHECK(!store.restore({1, 1}, kTileSize, kTileSize, pixels));
+    GFX_CHECK(store.restore({1, 4}, kTileSize, kTileSize, pixels));
+
+    store.setCapacity(tileBytes);
+    GFX_CHECK_EQ(store.tileCount(), 1u);
+    GFX_CHECK(store.restore({1, 3}, kTileSize, kTileSize, pixels));
+}
+
+GFX_TEST(RemoveOwnerOnlyRemovesItsTiles) {
+    GfxCompressedTileStore store;
+    auto tile = makeTile(1);
+    for (uint64_t owner = 1; owner <= 2; ++owner) {
+        for (uint64_t i = 0; i < 3; ++i) {
+            store.store({owner, i}, tile.data(), kTileSize, kTileSize, kTileSize * 4);
+        }
+    }
+    store.removeOwner(1);
+    GFX_CHECK_EQ(store.tileCount(), 3u);
+    store.remove({2, 0});
+    GFX_CHECK_EQ(store.tileCount(), 2u);
+    std::vector<uint8_t> pixels;
+    GFX_CHECK(!store.restore({1, 1}, kTileSize, kTileSize, pixels));
+    GFX_CHECK(store.restore({2, 1}, kTileSize, kTileSize, pixels));
+    store.clear();
+    GFX_CHECK_EQ(store.sizeInBytes(), 0u);
+}
+
+GFX_TEST(StrideAndEmptyTiles) {
+    GfxCompressedTileStore store;
+    auto tile = makeTile(3);
+    const size_t stride = kTileSize * 4 + 16;
+    std::vector<uint8_t> padded(stride * kTileSize, 0xaa);
+    for (int32_t y = 0; y < kTileSize; ++y) {
+        std::copy_n(&tile[y * kTileSize * 4], kTileSize * 4, &padded[y * stride]);
+    }
+    store.store({1, 0}, padded.data(), kTileSize, kTileSize, stride);
+    std::vector<uint8_t> pixels;
+    GFX_REQUIRE(store.restore({1, 0}, kTileSize, kTileSize, pixels));
+    GFX_CHECK(pixels == tile);
+
+    store.store({1, 1}, tile.data(), 0, kTileSize, kTileSize * 4);
+    GFX_CHECK_EQ(store.tileCount(), 0u);
+    GFX_CHECK_EQ(store.stats().storedTiles, 1u);
+}
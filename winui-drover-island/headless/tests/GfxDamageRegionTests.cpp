@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <cmath>
+#include <filesystem>
+#include <vector>
+
+#include "./GfxDamageRegion.h"
+#include "./GfxFrameDamage.h"
+#include "./GfxScene.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+// Removed with the test, whatever the outcome.
+class TemporaryFile {
+ public:
+    explicit TemporaryFile(const char* name) : path_(std::filesystem::temp_directory_path() / name) {}
+    ~TemporaryFile() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    const std::filesystem::path& path() const { return path_; }
+
+ private:
+    std::filesystem::path path_;
+};
+
+bool covers(const GfxDamageRegion& region, const PixelRect& rect) {
+    // Every pixel of the rect is in one of the region rects.
+    for (int32_t y = rect.top; y < rect.bottom; ++y) {
+        for (int32_t x = rect.left; x < rect.right; ++x) {
+            bool covered = false;
+            for (const auto& damaged : region.rects()) {
+                covered = covered || damaged.contains(PixelRect{x, y, x + 1, y + 1});
+            }
+            if (!covered) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+GFX_TEST(ContainedRectsAreDropped) {
+    GfxDamageRegion region;
+    region.add(PixelRect{0, 0, 100, 100});
+    region.add(PixelRect{10, 10, 20, 20});
+    GFX_CHECK_EQ(region.rects().size(), 1u);
+    // A larger rect replaces the ones it contains.
+    region.add(PixelRect{200, 200, 210, 210});
+    region.add(PixelRect{-10, -10, 300, 300});
+    GFX_REQUIRE(region.rects().size() == 1u);
+    GFX_CHECK(region.rects()[0] == (PixelRect{-10, -10, 300, 300}));
+    // Empty rects damage nothing.
+    region.clear();
+    region.add(PixelRect{});
+    region.add(PixelRect{5, 5, 5, 50});
+    GFX_CHECK(region.isEmpty());
+}
+
+GFX_TEST(SimplifyMergesOnlyWhatIsFree) {
+    GfxDamageRegion region;
+    // Two halves of a rect merge for free, distant rects stay apart.
+    region.add(PixelRect{0, 0, 50, 20});
+    region.add(PixelRect{50, 0, 100, 20});
+    region.add(PixelRect{500, 500, 510, 510});
+    region.simplify();
+    GFX_REQUIRE(region.rects().size() == 2u);
+    GFX_CHECK(region.area() == 100 * 20 + 10 * 10);
+    GFX_CHECK(region.bounds() == (PixelRect{0, 0, 510, 510}));
+    GFX_CHECK(covers(region, PixelRect{0, 0, 100, 20}));
+}
+
+GFX_TEST(SimplifyMergesTheLeastWastefulPairsPastTheMaximum) {
+    GfxDamageRegion region(2);
+    region.add(PixelRect{0, 0, 10, 10});
+    region.add(PixelRect{12, 0, 22, 10});
+    region.add(PixelRect{1000, 1000, 1010, 1010});
+    region.simplify();
+    // The close pair is merged, not the distant rect.
+    GFX_REQUIRE(region.rects().size() == 2u);
+    GFX_CHECK_EQ(region.area(), 22 * 10 + 10 * 10);
+    GFX_CHECK(covers(region, PixelRect{0, 0, 22, 10}));
+    GFX_CHECK(covers(region, PixelRect{1000, 1000, 1010, 1010}));
+}
+
+GFX_TEST(AddingStaysBounded) {
+    GfxDamageRegion region(4);
+    std::vector<PixelRect> added;
+    for (int32_t i = 0; i < 100; ++i) {
+        PixelRect rect{(i * 37) % 500, (i * 91) % 500, (i * 37) % 500 + 7, (i * 91) % 500 + 5};
+        region.add(rect);
+        added.push_back(rect);
+        GFX_CHECK(region.rects().size() <= 8u);
+    }
+    region.simplify();
+    GFX_CHECK(region.rects().size() <= 4u);
+    // Merging only grows the region, nothing added is lost.
+    bool allCovered = true;
+    for (const auto& rect : added) {
+        allCovered = allCovered && covers(region, rect);
+    }
+    GFX_CHECK(allCovered);
+}
+
+GFX_TEST(SceneEditsDamageOnlyTheEditedNodes) {
+    // What DroverIsland does: the scene reports the old and new bounds of each edit, in DIPs, and
+    // the frame draws their pixels only.
+    TemporaryFile file("GfxDamageRegionTests.gscn");
+    GfxSceneBuilder builder;
+    GfxScene::Style style = {};
+    style.fill[3] = 1.f;
+    style.flags = GfxScene::kFill;
+    auto fill = builder.addStyle(style);
+    for (uint32_t i = 0; i < 400; ++i) {
+        float x = static_cast<float>(i % 20) * 50.f;
+        float y = static_cast<float>(i / 20) * 50.f;
+        builder.addRect({x, y, x + 40, y + 40}, fill);
+    }
+    GFX_REQUIRE(builder.write(file.path()));
+    GfxScene scene;
+    GFX_REQUIRE(scene.open(file.path()));
+
+    const float scale = 1.5f;
+    const PixelRect surface{0, 0, 1500, 1500};
+    GfxFrameDamage damage;
+    auto toPixels = [&](const GfxScene::Rect& rect) {
+        return PixelRect{static_cast<int32_t>(std::floor(rect.left * scale)), static_cast<int32_t>(std::floor(rect.top * scale)),
+            static_cast<int32_t>(std::ceil(rect.right * scale)), static_cast<int32_t>(std::ceil(rect.bottom * scale))};
+    };
+    scene.setChangeListener([&](const GfxScene::Rect& oldBounds, const GfxScene::Rect& newBounds) {
+        damage.add(toPixels(oldBounds).intersection(surface));
+        damage.add(toPixels(newBounds).intersection(surface));
+    });
+    GFX_CHECK(damage.beginFrame(surface, true));
+    damage.endFrame(true);
+
+    // Two nodes nudged, one hidden.
+    GFX_REQUIRE(scene.setNodeBounds(0, {2, 2, 42, 42}));
+    GFX_REQUIRE(scene.setNodeBounds(210, {502, 502, 542, 542}));
+    GFX_REQUIRE(scene.setNodeVisible(399, false));
+    GFX_REQUIRE(!damage.beginFrame(surface, false));
+    const auto& frame = damage.frame();
+    GFX_CHECK(covers(frame, toPixels({0, 0, 42, 42})));
+    GFX_CHECK(covers(frame, toPixels({500, 500, 542, 542})));
+    GFX_CHECK(covers(frame, toPixels({950, 950, 990, 990})));
+    // A few percent of the surface rather than all of it.
+    GFX_CHECK(frame.area() * 20 < surface.area());
+    damage.endFrame(true);
+    GFX_CHECK_EQ(damage.stats().partialFrames, 1u);
+}
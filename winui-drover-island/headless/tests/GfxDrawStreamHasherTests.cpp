@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <memory>
+
+#include "./GfxDrawStreamHasher.h"
+#include "./GfxObjectHashCache.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(SameStreamSameHash) {
+    const float rect[4] = {1, 2, 3, 4};
+    GfxDrawStreamHasher a;
+    GfxDrawStreamHasher b;
+    a.add(rect);
+    b.add(rect);
+    GFX_CHECK_EQ(a.hash(), b.hash());
+
+    const float other[4] = {1, 2, 3, 5};
+    b.reset();
+    b.add(other);
+    GFX_CHECK(a.hash() != b.hash());
+}
+
+GFX_TEST(TrailingZerosChangeTheHash) {
+    const uint8_t bytes[9] = {};
+    GfxDrawStreamHasher a;
+    GfxDrawStreamHasher b;
+    a.addBytes(bytes, 8);
+    b.addBytes(bytes, 9);
+    GFX_CHECK(a.hash() != b.hash());
+    GFX_CHECK(GfxDrawStreamHasher().hash() != 0);
+}
+
+GFX_TEST(ArraysAreHashedWithTheirCount) {
+    const int values[2] = {0, 0};
+    GfxDrawStreamHasher a;
+    GfxDrawStreamHasher b;
+    a.addArray(values, 1);
+    a.addArray(values, 1);
+    b.addArray(values, 2);
+    GFX_CHECK(a.hash() != b.hash());
+}
+
+GFX_TEST(ResetMakesTheStreamDedupableAgain) {
+    GfxDrawStreamHasher hasher;
+    hasher.markNotDedupable();
+    GFX_CHECK(!hasher.isDedupable());
+    hasher.reset();
+    GFX_CHECK(hasher.isDedupable());
+}
+
+GFX_TEST(ObjectHashCacheFindsWhatWasInserted) {
+    GfxObjectHashCache<std::shared_ptr<int>> cache(4);
+    auto object = std::make_shared<int>(1);
+    GFX_CHECK_EQ(cache.find(object.get()), 0u);
+    cache.insert(object, 42);
+    GFX_CHECK_EQ(cache.find(object.get()), 42u);
+    GFX_CHECK_EQ(cache.find(nullptr), 0u);
+}
+
+GFX_TEST(ObjectHashCacheKeepsTheObjectsAlive) {
+    GfxObjectHashCache<std::shared_ptr<int>> cache(4);
+    auto object = std::make_shared<int>(1);
+    std::weak_ptr<int> weak = object;
+    const void* address = object.get();
+    cache.insert(std::move(object), 42);
+    // No other object can be created at the same address while the hash is cached.
+    GFX_CHECK(!weak.expired());
+    GFX_CHECK_EQ(cache.find(address), 42u);
+    cache.clear();
+    GFX_CHECK(weak.expired());
+    GFX_CHECK_EQ(cache.size(), 0u);
+}
+
+GFX_TEST(ObjectHashCacheReplacesTheOldestOnceFull) {
+    GfxObjectHashCache<std::shared_ptr<int>> cache(2);
+    auto first = std::make_shared<int>(1);
+    auto second = std::make_shared<int>(2);
+    auto third = std::make_shared<int>(3);
+    cache.insert(first, 1);
+    cache.insert(second, 2);
+    // Hits don't change the order of replacement.
+    GFX_CHECK_EQ(cache.find(first.get()), 1u);
+    cache.insert(third, 3);
+    GFX_CHECK_EQ(cache.size(), 2u);
+    GFX_CHECK_EQ(cache.find(first.get()), 0u);
+    GFX_CHECK_EQ(cache.find(second.get()), 2u);
+    GFX_CHECK_EQ(cache.find(third.get()), 3u);
+    GFX_CHECK_EQ(first.use_count(), 1);
+}
@@ -0,0 +1,249 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "./GfxEventReplayer.h"
+#include "./GfxEventTrace.h"
+#include "./GfxHeadlessCanvas.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using EventKind = GfxEventTrace::EventKind;
+
+// Removed with the test, whatever the outcome.
+class TemporaryFile {
+ public:
+    explicit TemporaryFile(const char* name) : path_(std::filesystem::temp_directory_path() / name) {}
+    ~TemporaryFile() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    const std::filesystem::path& path() const { return path_; }
+
+ private:
+    std::filesystem::path path_;
+};
+
+// Builds a trace of one control, source 7, with the time in milliseconds.
+class TraceBuilder {
+ public:
+    TraceBuilder& at(int64_t milliseconds, EventKind kind, float value0 = 0, float value1 = 0, float value2 = 0, float value3 = 0) {
+        GfxEventTrace::Event event;
+        event.time = std::chrono::milliseconds(milliseconds);
+        event.source = 7;
+        event.kind = kind;
+        event.values[0] = value0;
+        event.values[1] = value1;
+        event.values[2] = value2;
+        event.values[3] = value3;
+        trace_.append(event);
+        return *this;
+    }
+
+    const GfxEventTrace& trace() const { return trace_; }
+
+ private:
+    GfxEventTrace trace_;
+};
+
+// A session seen in the field: a resize storm, DPI changes, a device loss, then small updates.
+GfxEventTrace makeSession() {
+    TraceBuilder builder;
+    int64_t time = 0;
+    builder.at(time, EventKind::kPickControl, 1).at(time, EventKind::kResize, 800, 600);
+    for (int i = 0; i < 200; ++i) {
+        time += 4;
+        builder.at(time, EventKind::kResize, 800.f + i, 600.f + i / 2);
+    }
+    for (int i = 0; i < 6; ++i) {
+        time += 100;
+        builder.at(time, EventKind::kDpiChange, i % 2 ? 144.f : 96.f);
+    }
+    time += 50;
+    builder.at(time, EventKind::kDeviceLost);
+    for (int i = 0; i < 60; ++i) {
+        time += 16;
+        float x = static_cast<float>(i * 37 % 900);
+        float y = static_cast<float>(i * 53 % 600);
+        builder.at(time, EventKind::kInvalidateRect, x, y, x + 20, y + 20).at(time, EventKind::kFrame, 1500.f + i);
+    }
+    return builder.trace();
+}
+
+bool sameEvents(const GfxEventTrace& a, const GfxEventTrace& b) {
+    if (a.events().size() != b.events().size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.events().size(); ++i) {
+        const auto& x = a.events()[i];
+        const auto& y = b.events()[i];
+        if (x.time != y.time || x.source != y.source || x.kind != y.kind) {
+            return false;
+        }
+        for (size_t v = 0; v < GfxEventTrace::valueCount(x.kind); ++v) {
+            if (x.values[v] != y.values[v]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+GFX_TEST(TracesRoundTrip) {
+    auto trace = makeSession();
+    std::vector<uint8_t> data;
+    trace.encode(data);
+    GfxEventTrace decoded;
+    GFX_REQUIRE(decoded.decode(data.data(), data.size()));
+    GFX_CHECK(sameEvents(trace, decoded));
+    GFX_CHECK(decoded.duration() == trace.duration());
+    // Varints and the values of the kind only: far smaller than the events in memory.
+    GFX_CHECK(data.size() * 2 < trace.events().size() * sizeof(GfxEventTrace::Event));
+
+    TemporaryFile file("GfxEventReplayerTests.gevt");
+    GFX_REQUIRE(trace.save(file.path()));
+    GfxEventTrace loaded;
+    GFX_REQUIRE(loaded.load(file.path()));
+    GFX_CHECK(sameEvents(trace, loaded));
+}
+
+GFX_TEST(DamagedTracesDontDecode) {
+    auto trace = makeSession();
+    std::vector<uint8_t> data;
+    trace.encode(data);
+    GfxEventTrace decoded;
+    GFX_CHECK(!decoded.decode(data.data(), data.size() - 1));
+    GFX_CHECK(decoded.isEmpty());
+    GFX_CHECK(!decoded.decode(data.data(), 6));
+    auto badVersion = data;
+    badVersion[4] ^= 0x40;
+    GFX_CHECK(!decoded.decode(badVersion.data(), badVersion.size()));
+    auto badMagic = data;
+    badMagic[0] ^= 1;
+    GFX_CHECK(!decoded.decode(badMagic.data(), badMagic.size()));
+    GFX_CHECK(!decoded.load(std::filesystem::temp_directory_path() / "GfxEventReplayerTests-missing.gevt"));
+}
+
+GFX_TEST(RecorderRecordsWhileStarted) {
+    auto& recorder = GfxEventRecorder::instance();
+    recorder.record(3, EventKind::kInvalidate);
+    recorder.start();
+    GFX_CHECK(recorder.isRecording());
+    recorder.record(3, EventKind::kResize, 100, 50);
+    recorder.record(4, EventKind::kDeviceLost);
+    auto trace = recorder.stop();
+    GFX_CHECK(!recorder.isRecording());
+    recorder.record(3, EventKind::kInvalidate);
+    GFX_REQUIRE(trace.events().size() == 2u);
+    GFX_CHECK(trace.events()[0].source == 3u && trace.events()[0].kind == EventKind::kResize);
+    GFX_CHECK(trace.events()[0].values[0] == 100.f && trace.events()[0].values[1] == 50.f);
+    GFX_CHECK(trace.events()[1].time >= trace.events()[0].time);
+    // A new recording starts empty.
+    recorder.start();
+    GFX_CHECK(recorder.stop().isEmpty());
+}
+
+GFX_TEST(ReplaysAreTheSameEveryTime) {
+    auto trace = makeSession();
+    GfxHeadlessCanvas::Stats first;
+    for (int run = 0; run < 2; ++run) {
+        auto clock = std::make_shared<GfxManualFrameClock>();
+        GfxHeadlessCanvas canvas(clock);
+        canvas.setTilingThreshold(512);
+        auto result = GfxEventReplayer::replay(trace, canvas, *clock);
+        auto stats = canvas.stats();
+        // Every event but the frames is applied, the frames are what the session measured.
+        GFX_CHECK_EQ(result.events, uint64_t(trace.events().size() - 60));
+        GFX_CHECK_EQ(result.recorded.frames, 60u);
+        GFX_CHECK(result.recorded.max == std::chrono::microseconds(1559));
+        GFX_CHECK(result.replayed.frames > 0u);
+        if (run == 0) {
+            first = stats;
+            continue;
+        }
+        GFX_CHECK_EQ(stats.frames.fullFrames, first.frames.fullFrames);
+        GFX_CHECK_EQ(stats.frames.partialFrames, first.frames.partialFrames);
+        GFX_CHECK_EQ(stats.frames.redrawnPixels, first.frames.redrawnPixels);
+        GFX_CHECK_EQ(stats.surfacesCreated, first.surfacesCreated);
+    }
+    // The storm of 200 resizes over 800ms is coalesced in a frame per tick, about 50, the device
+    // loss drops the surface once, and the small updates draw only what they damaged.
+    GFX_CHECK(first.frames.fullFrames < 70u);
+    GFX_CHECK(first.surfacesCreated <= first.frames.fullFrames);
+    GFX_CHECK_EQ(first.surfacesLost, 1u);
+    GFX_CHECK(first.frames.partialFrames >= 50u);
+}
+
+GFX_TEST(CanvasFollowsTheEvents) {
+    auto clock = std::make_shared<GfxManualFrameClock>();
+    GfxHeadlessCanvas canvas(clock);
+    canvas.setTilingThreshold(256);
+    auto trace = TraceBuilder()
+                     .at(0, EventKind::kResize, 400, 300)
+                     .at(20, EventKind::kDpiChange, 192)
+                     .at(40, EventKind::kInvalidateRect, 10, 10, 20, 20)
+                     .trace();
+    GfxEventReplayer::replay(trace, canvas, *clock);
+    // At 200%, 800x600 pixels in 256 pixel tiles.
+    GFX_CHECK_EQ(canvas.widthInPixels(), 800);
+    GFX_CHECK_EQ(canvas.heightInPixels(), 600);
+    GFX_CHECK_EQ(canvas.tileCount(), 12u);
+    GFX_CHECK_EQ(canvas.surfaceBytes(), size_t(800 * 600 * 4));
+    auto stats = canvas.stats();
+    GFX_CHECK_EQ(stats.surfacesCreated, 2u);
+    GFX_CHECK_EQ(stats.frames.partialFrames, 1u);
+    GFX_CHECK_EQ(stats.frames.redrawnPixels, uint64_t(400 * 300 + 800 * 600 + 20 * 20));
+
+    // Picking no control drops the surface and draws nothing.
+    canvas.applyEvent(TraceBuilder().at(0, EventKind::kPickControl, 0).trace().events()[0]);
+    clock->advance(GfxFrameClock::Clock::time_point{} + std::chrono::seconds(1));
+    GFX_CHECK_EQ(canvas.tileCount(), 0u);
+    GFX_CHECK_EQ(canvas.stats().frames.fullFrames, stats.frames.fullFrames);
+}
+
+GFX_TEST(GroupsGiveEachSourceACanvas) {
+    auto clock = std::make_shared<GfxManualFrameClock>();
+    GfxHeadlessCanvasGroup group(clock);
+    GfxEventTrace trace;
+    for (uint64_t source : {3u, 1u, 2u}) {
+        GfxEventTrace::Event resize;
+        resize.source = source;
+        resize.kind = EventKind::kResize;
+        resize.values[0] = 100;
+        resize.values[1] = 100;
+        trace.append(resize);
+    }
+    // The window's events apply to every control.
+    GfxEventTrace::Event dpi;
+    dpi.time = std::chrono::milliseconds(50);
+    dpi.kind = EventKind::kDpiChange;
+    dpi.values[0] = 192;
+    trace.append(dpi);
+    GfxEventReplayer::replay(trace, group, *clock);
+    GFX_CHECK_EQ(group.canvasCount(), 3u);
+    GFX_CHECK_EQ(group.surfaceCount(), 3u);
+    GFX_CHECK_EQ(group.surfaceBytes(), size_t(3 * 200 * 200 * 4));
+    GFX_CHECK_EQ(group.stats().surfacesCreated, 6u);
+    GFX_CHECK_EQ(group.stats().frames.fullFrames, 6u);
+}
@@ -0,0 +1,165 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <functional>
+#include <vector>
+
+#include "./GfxFrameClock.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using Clock = GfxFrameClock::Clock;
+
+// Counts its frames; what it does in onFrame is up to the test.
+class Client : public GfxFrameClockClient {
+ public:
+    void onFrame(Clock::time_point now) override {
+        frames++;
+        lastFrame = now;
+        if (action) {
+            action();
+        }
+    }
+
+    int frames = 0;
+    Clock::time_point lastFrame{};
+    std::function<void()> action;
+};
+
+// A clock like the composition one, pausing while the window is occluded, with its ticks in the
+// hands of the test.
+class OccludableClock : public GfxFrameClock {
+ public:
+    OccludableClock() : GfxFrameClock(true) {}
+    ~OccludableClock() override { detach(); }
+
+    void advance(Clock::time_point now) { tick(now); }
+    bool isTicking() const { return ticking_; }
+
+ protected:
+    void startTicking() override { ticking_ = true; }
+    void stopTicking() override { ticking_ = false; }
+
+ private:
+    bool ticking_ = false;
+};
+
+Clock::time_point at(int frame) {
+    return Clock::time_point{} + std::chrono::milliseconds(16) * frame;
+}
+
+}  // namespace
+
+GFX_TEST(RequestsAreDeliveredOnce) {
+    GfxManualFrameClock clock;
+    Client a, b;
+    clock.requestFrame(&a);
+    clock.requestFrame(&a);
+    clock.requestFrame(&b);
+    GFX_CHECK(clock.isFramePending(&a));
+    clock.advance(at(1));
+    GFX_CHECK(a.frames == 1 && b.frames == 1);
+    GFX_CHECK(a.lastFrame == at(1));
+    GFX_CHECK(!clock.hasPendingFrames());
+    // Nothing requested, nothing delivered.
+    clock.advance(at(2));
+    GFX_CHECK_EQ(a.frames, 1);
+    GFX_CHECK_EQ(clock.frameCount(), 1u);
+    GFX_CHECK_EQ(clock.tickStats().clientFrames, 2u);
+}
+
+GFX_TEST(RequestsMadeWhileDeliveringWaitForTheNextTick) {
+    GfxManualFrameClock clock;
+    Client animating, other;
+    // An animation asks for its next frame, and for a frame of another client, from onFrame.
+    animating.action = [&]() {
+        clock.requestFrame(&animating);
+        clock.requestFrame(&other);
+    };
+    clock.requestFrame(&animating);
+    clock.advance(at(1));
+    GFX_CHECK(animating.frames == 1 && other.frames == 0);
+    GFX_CHECK(clock.isFramePending(&animating) && clock.isFramePending(&other));
+    clock.advance(at(2));
+    GFX_CHECK(animating.frames == 2 && other.frames == 1);
+    GFX_CHECK_EQ(clock.frameCount(), 2u);
+}
+
+GFX_TEST(CancelledDuringDeliveryGetsNoFrame) {
+    GfxManualFrameClock clock;
+    Client first, second, third;
+    // The first client destroys the second one, which cancels its frame on the way out.
+    first.action = [&]() { clock.cancelFrame(&second); };
+    clock.requestFrame(&first);
+    clock.requestFrame(&second);
+    clock.requestFrame(&third);
+    clock.advance(at(1));
+    GFX_CHECK(first.frames == 1 && second.frames == 0 && third.frames == 1);
+    GFX_CHECK_EQ(clock.tickStats().clientFrames, 2u);
+
+    // Cancelled before the tick.
+    clock.requestFrame(&first);
+    clock.cancelFrame(&first);
+    GFX_CHECK(!clock.hasPendingFrames());
+    clock.advance(at(2));
+    GFX_CHECK_EQ(first.frames, 1);
+}
+
+GFX_TEST(PausedClocksKeepTheirRequests) {
+    GfxManualFrameClock clock;
+    Client client;
+    clock.requestFrame(&client);
+    clock.setPaused(true);
+    clock.advance(at(1));
+    clock.advance(at(2));
+    GFX_CHECK_EQ(client.frames, 0);
+    GFX_CHECK(clock.isFramePending(&client));
+
+    clock.setPaused(false);
+    clock.advance(at(3));
+    GFX_CHECK_EQ(client.frames, 1);
+    GFX_CHECK(client.lastFrame == at(3));
+}
+
+GFX_TEST(OcclusionPausesOnlyTheClocksThatAskedFor) {
+    OccludableClock occludable;
+    GfxManualFrameClock manual;
+    Client a, b;
+    occludable.requestFrame(&a);
+    manual.requestFrame(&b);
+    GFX_CHECK(occludable.isTicking());
+
+    GfxFrameClock::setOccluded(true);
+    GFX_CHECK(occludable.isPaused() && !occludable.isTicking());
+    GFX_CHECK(!manual.isPaused());
+    occludable.advance(at(1));
+    manual.advance(at(1));
+    GFX_CHECK(a.frames == 0 && b.frames == 1);
+
+    // Created while occluded, paused from the start.
+    {
+        OccludableClock late;
+        GFX_CHECK(late.isPaused());
+    }
+
+    GfxFrameClock::setOccluded(false);
+    GFX_CHECK(occludable.isTicking());
+    occludable.advance(at(2));
+    GFX_CHECK_EQ(a.frames, 1);
+    // Nothing left to deliver, the tick source stops.
+    GFX_CHECK(!occludable.isTicking());
+}
@@ -0,0 +1,115 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxFrameDamage.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+const PixelRect kSurface{0, 0, 400, 300};
+
+// A frame that drew whatever it was asked to, successfully.
+bool drawFrame(GfxFrameDamage& damage, bool newSurface = false) {
+    bool full = damage.beginFrame(kSurface, newSurface);
+    damage.endFrame(true);
+    return full;
+}
+
+}  // namespace
+
+GFX_TEST(FirstFrameIsFull) {
+    GfxFrameDamage damage;
+    GFX_CHECK(damage.isPending());
+    damage.add(PixelRect{0, 0, 10, 10});
+    GFX_CHECK(drawFrame(damage));
+    GFX_CHECK(!damage.isPending());
+    GFX_CHECK_EQ(damage.stats().fullFrames, 1u);
+    GFX_CHECK_EQ(damage.stats().redrawnPixels, uint64_t(kSurface.area()));
+}
+
+GFX_TEST(SmallDamageDrawsOnlyItsRects) {
+    GfxFrameDamage damage;
+    drawFrame(damage);
+
+    damage.add(PixelRect{10, 10, 30, 30});
+    damage.add(PixelRect{200, 100, 220, 120});
+    GFX_REQUIRE(!damage.beginFrame(kSurface, false));
+    GFX_CHECK(damage.isPartialFrame());
+    GFX_CHECK_EQ(damage.frame().rects().size(), 2u);
+    // Damage added while the frame is drawn is for the next one.
+    damage.add(PixelRect{0, 0, 5, 5});
+    GFX_CHECK_EQ(damage.frame().rects().size(), 2u);
+    damage.endFrame(true);
+
+    GFX_CHECK(!damage.isPartialFrame());
+    GFX_CHECK(damage.isPending());
+    GFX_CHECK_EQ(damage.stats().partialFrames, 1u);
+    GFX_CHECK_EQ(damage.stats().redrawnPixels, uint64_t(kSurface.area()) + 800u);
+    GFX_CHECK_EQ(damage.stats().partialFrameSurfacePixels, uint64_t(kSurface.area()));
+}
+
+GFX_TEST(DamagePastHalfTheSurfaceDrawsAllOfIt) {
+    GfxFrameDamage damage;
+    drawFrame(damage);
+    damage.add(PixelRect{0, 0, 400, 151});
+    GFX_CHECK(drawFrame(damage));
+
+    damage.add(PixelRect{0, 0, 400, 150});
+    GFX_CHECK(!drawFrame(damage));
+}
+
+GFX_TEST(NewSurfaceAndInvalidateAllDrawAllOfIt) {
+    GfxFrameDamage damage;
+    drawFrame(damage);
+    damage.add(PixelRect{0, 0, 10, 10});
+    GFX_CHECK(drawFrame(damage, true));
+
+    damage.add(PixelRect{0, 0, 10, 10});
+    damage.invalidateAll();
+    GFX_CHECK(drawFrame(damage));
+}
+
+GFX_TEST(NoDamageDrawsAllOfIt) {
+    // A frame without damage was scheduled for another reason, like a new layer.
+    GfxFrameDamage damage;
+    drawFrame(damage);
+    GFX_CHECK(drawFrame(damage));
+}
+
+GFX_TEST(FailedFrameDrawsAllOfTheNextOne) {
+    GfxFrameDamage damage;
+    drawFrame(damage);
+    damage.add(PixelRect{0, 0, 10, 10});
+    GFX_REQUIRE(!damage.beginFrame(kSurface, false));
+    damage.endFrame(false);
+    GFX_CHECK(damage.isPending());
+    damage.add(PixelRect{0, 0, 10, 10});
+    GFX_CHECK(drawFrame(damage));
+}
+
+GFX_TEST(PendingRectsAreEmptyWhenAllIsDamaged) {
+    GfxFrameDamage damage;
+    damage.add(PixelRect{0, 0, 10, 10});
+    GFX_CHECK(damage.pendingRects().empty());
+    damage.clearPending();
+    GFX_CHECK(!damage.isPending());
+
+    damage.add(PixelRect{0, 0, 10, 10});
+    damage.add(PixelRect{5, 5, 15, 15});
+    GFX_CHECK(!damage.pendingRects().empty());
+    damage.clearPending();
+    GFX_CHECK(!damage.isPending());
+    GFX_CHECK_EQ(damage.stats().fullFrames + damage.stats().partialFrames, 0u);
+}
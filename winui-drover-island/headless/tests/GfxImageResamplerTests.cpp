@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "./GfxImageResampler.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(PremultiplyRoundsLikeTheReference) {
+    int32_t mismatches = 0;
+    for (uint32_t value = 0; value < 256; ++value) {
+        for (uint32_t alpha = 0; alpha < 256; ++alpha) {
+            uint8_t pixel[4] = {static_cast<uint8_t>(value), static_cast<uint8_t>(value), static_cast<uint8_t>(value),
+                static_cast<uint8_t>(alpha)};
+            GfxImageResampler::premultiply(pixel, 1, 1, 4);
+            auto expected = (value * alpha + 127) / 255;
+            mismatches += pixel[0] != expected || pixel[1] != expected || pixel[2] != expected || pixel[3] != alpha;
+        }
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+}
+
+GFX_TEST(PremultiplySkipsTheStride) {
+    const size_t stride = 2 * 4 + 8;
+    std::vector<uint8_t> pixels(stride * 2, 0xcc);
+    for (size_t row = 0; row < 2; ++row) {
+        for (size_t i = 0; i < 8; i += 4) {
+            uint8_t pixel[4] = {200, 100, 50, 128};
+            std::copy_n(pixel, 4, &pixels[row * stride + i]);
+        }
+    }
+    GfxImageResampler::premultiply(pixels.data(), 2, 2, stride);
+    GFX_CHECK_EQ(pixels[0], 100);
+    GFX_CHECK_EQ(pixels[stride + 5], 50);
+    GFX_CHECK_EQ(pixels[8], 0xcc);
+    GFX_CHECK_EQ(pixels[stride + 15], 0xcc);
+}
+
+GFX_TEST(FitSizeKeepsTheAspectRatio) {
+    int32_t width = 0, height = 0;
+    GfxImageResampler::fitSize(4000, 3000, 400, 0, width, height);
+    GFX_CHECK(width == 400 && height == 300);
+    GfxImageResampler::fitSize(4000, 3000, 400, 100, width, height);
+    GFX_CHECK(width == 133 && height == 100);
+    // Never upscaled, and never empty.
+    GfxImageResampler::fitSize(100, 50, 400, 400, width, height);
+    GFX_CHECK(width == 100 && height == 50);
+    GfxImageResampler::fitSize(10000, 1, 100, 0, width, height);
+    GFX_CHECK(width == 100 && height == 1);
+}
+
+GFX_TEST(DownscaleAveragesTheCoveredArea) {
+    // Two by two blocks of 0 and 255 average to their mean, whatever the channel.
+    const int32_t size = 8;
+    std::vector<uint8_t> source(size * size * 4);
+    for (int32_t y = 0; y < size; ++y) {
+        for (int32_t x = 0; x < size; ++x) {
+            std::fill_n(&source[(y * size + x) * 4], 4, static_cast<uint8_t>((x + y) % 2 ? 255 : 0));
+        }
+    }
+    std::vector<uint8_t> destination(size / 2 * size / 2 * 4);
+    GfxImageResampler resampler;
+    resampler.downscale(source.data(), size, size, size * 4, destination.data(), size / 2, size / 2, size / 2 * 4);
+    bool averaged = true;
+    for (auto value : destination) {
+        averaged = averaged && (value == 127 || value == 128);
+    }
+    GFX_CHECK(averaged);
+}
+
+GFX_TEST(DownscaleKeepsFlatImagesFlat) {
+    // A ratio that isn't an integer splits source pixels between destination pixels.
+    std::vector<uint8_t> source(7 * 5 * 4, 200);
+    std::vector<uint8_t> destination(3 * 2 * 4);
+    GfxImageResampler resampler;
+    resampler.downscale(source.data(), 7, 5, 7 * 4, destination.data(), 3, 2, 3 * 4);
+    bool flat = true;
+    for (auto value : destination) {
+        flat = flat && value == 200;
+    }
+    GFX_CHECK(flat);
+}
+
+GFX_TEST(DownscaleToTheSameSizeCopies) {
+    std::vector<uint8_t> source(8 * 8 * 4);
+    for (auto& value : source) {
+        value = static_cast<uint8_t>(std::rand());
+    }
+    std::vector<uint8_t> destination(source.size());
+    GfxImageResampler resampler;
+    resampler.downscale(source.data(), 8, 8, 8 * 4, destination.data(), 8, 8, 8 * 4);
+    GFX_CHECK(destination == source);
+
+    // The buffers of a previous, larger call don't leak into the next one.
+    std::vector<uint8_t> large(64 * 64 * 4, 10);
+    std::vector<uint8_t> small(4 * 4 * 4);
+    resampler.downscale(large.data(), 64, 64, 64 * 4, small.data(), 4, 4, 4 * 4);
+    resampler.downscale(source.data(), 8, 8, 8 * 4, destination.data(), 8, 8, 8 * 4);
+    GFX_CHECK(destination == source);
+}
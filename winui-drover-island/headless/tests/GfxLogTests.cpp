@@ -0,0 +1,146 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "./GfxLog.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+class RecordingSink : public GfxLogSink {
+ public:
+    explicit RecordingSink(std::vector<GfxLogRecord>& records) : records_(records) {}
+    void write(const GfxLogRecord& record) override { records_.push_back(record); }
+
+ private:
+    // Owned by the test, the logger deletes the sink on stop().
+    std::vector<GfxLogRecord>& records_;
+};
+
+}  // namespace
+
+GFX_TEST(RecordsReachTheSink) {
+    std::vector<GfxLogRecord> records;
+    GfxLog log;
+    log.start(std::make_unique<RecordingSink>(records));
+    log.log(GfxLogKind::kFailed, "first", 1, 10);
+    log.log(GfxLogKind::kException, "second", 2, 20);
+    log.flush();
+    GFX_REQUIRE(records.size() == 2u);
+    GFX_CHECK(std::strcmp(records[0].site, "first") == 0);
+    GFX_CHECK_EQ(records[1].kind, GfxLogKind::kException);
+    GFX_CHECK_EQ(records[1].controlId, 20u);
+    log.stop();
+    GFX_CHECK_EQ(log.stats().written, 2u);
+}
+
+GFX_TEST(RecordsLoggedBeforeStartWaitInTheRings) {
+    std::vector<GfxLogRecord> records;
+    GfxLog log;
+    log.log(GfxLogKind::kFailed, "early", 1);
+    log.start(std::make_unique<RecordingSink>(records));
+    log.stop();
+    GFX_CHECK_EQ(records.size(), 1u);
+}
+
+GFX_TEST(StormIsRateLimitedPerSite) {
+    std::vector<GfxLogRecord> records;
+    GfxLog log;
+    log.start(std::make_unique<RecordingSink>(records));
+    for (int i = 0; i < 1000; ++i) {
+        log.log(GfxLogKind::kFailed, "storm", 1);
+    }
+    log.log(GfxLogKind::kFailed, "other", 1);
+    log.stop();
+    auto stats = log.stats();
+    GFX_CHECK_EQ(stats.logged, 1001u);
+    // Unless the storm straddled two windows of the limiter.
+    GFX_CHECK(stats.droppedRateLimited >= 1000u - 2 * GfxLog::kMaxRecordsPerSitePerWindow);
+    GFX_CHECK_EQ(stats.written + stats.droppedRateLimited + stats.droppedRingFull, stats.logged);
+    GFX_CHECK(std::any_of(records.begin(), records.end(), [](const GfxLogRecord& r) {
+        return std::strcmp(r.site, "other") == 0;
+    }));
+}
+
+GFX_TEST(EveryThreadGetsItsOwnRing) {
+    std::vector<GfxLogRecord> records;
+    GfxLog log;
+    log.start(std::make_unique<RecordingSink>(records));
+    static const char kSites[4] = {};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&log, t]() { log.log(GfxLogKind::kFailed, &kSites[t], t); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    log.stop();
+    GFX_CHECK_EQ(records.size(), 4u);
+}
+
+// A thread remembers its ring per logger: a logger created after another one was destroyed must
+// not reuse the ring freed with it.
+GFX_TEST(SuccessiveLoggersOnOneThread) {
+    for (int i = 0; i < 3; ++i) {
+        std::vector<GfxLogRecord> records;
+        GfxLog log;
+        log.start(std::make_unique<RecordingSink>(records));
+        log.log(GfxLogKind::kFailed, "again", i);
+        log.stop();
+        GFX_CHECK_EQ(records.size(), 1u);
+    }
+}
+
+// More loggers than a thread remembers, used in turn: each finds the ring the thread already has.
+GFX_TEST(AlternatingLoggersReuseTheirRing) {
+    std::vector<std::unique_ptr<GfxLog>> logs;
+    for (int i = 0; i < 6; ++i) {
+        logs.push_back(std::make_unique<GfxLog>());
+    }
+    for (int round = 0; round < 100; ++round) {
+        for (auto& log : logs) {
+            log->log(GfxLogKind::kFailed, "alternating", round);
+        }
+    }
+    for (auto& log : logs) {
+        GFX_CHECK_EQ(log->ringCount(), 1u);
+    }
+}
+
+GFX_TEST(FormatMentionsSuppressedRecords) {
+    GfxLogRecord record;
+    record.site = "performImageSourceDraw";
+    record.hresult = static_cast<int32_t>(0x887A0005);
+    record.controlId = 7;
+    record.suppressed = 12;
+    char buffer[256];
+    GFX_REQUIRE(GfxLogSink::format(record, buffer, sizeof(buffer)) > 0);
+    std::string text(buffer);
+    GFX_CHECK(text.find("performImageSourceDraw") != std::string::npos);
+    GFX_CHECK(text.find("0x887A0005") != std::string::npos);
+    GFX_CHECK(text.find("12 similar messages suppressed") != std::string::npos);
+    GFX_CHECK(text.back() == '\n');
+
+    // Truncated rather than overflowing a short buffer.
+    char shortBuffer[16];
+    GfxLogSink::format(record, shortBuffer, sizeof(shortBuffer));
+    GFX_CHECK(std::strlen(shortBuffer) < sizeof(shortBuffer));
+}
@@ -0,0 +1,134 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <string>
+
+#include "./GfxLruCache.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(FindReturnsTheInsertedValue) {
+    GfxLruCache<int, std::string> cache(100);
+    GFX_CHECK(cache.find(1) == nullptr);
+    cache.insert(1, "one", 10);
+    GFX_REQUIRE(cache.find(1) != nullptr);
+    GFX_CHECK(*cache.find(1) == "one");
+    GFX_CHECK(cache.contains(1));
+    GFX_CHECK_EQ(cache.cost(), 10u);
+    GFX_CHECK_EQ(cache.size(), 1u);
+}
+
+GFX_TEST(InsertReplacesThePreviousValue) {
+    GfxLruCache<int, std::string> cache(100);
+    cache.insert(1, "one", 10);
+    cache.insert(1, "uno", 30);
+    GFX_CHECK(*cache.find(1) == "uno");
+    GFX_CHECK_EQ(cache.cost(), 30u);
+    GFX_CHECK_EQ(cache.size(), 1u);
+    GFX_CHECK_EQ(cache.evictionCount(), 0u);
+}
+
+GFX_TEST(LeastRecentlyUsedIsEvictedFirst) {
+    GfxLruCache<int, int> cache(30);
+    cache.insert(1, 1, 10);
+    cache.insert(2, 2, 10);
+    cache.insert(3, 3, 10);
+    // Finding an entry makes it the most recently used one.
+    GFX_CHECK(cache.find(1) != nullptr);
+    cache.insert(4, 4, 10);
+    GFX_CHECK(cache.contains(1));
+    GFX_CHECK(!cache.contains(2));
+    GFX_CHECK(cache.contains(3));
+    GFX_CHECK(cache.contains(4));
+    GFX_CHECK_EQ(cache.cost(), 30u);
+    GFX_CHECK_EQ(cache.evictionCount(), 1u);
+
+    // contains() doesn't touch the order.
+    GFX_CHECK(cache.contains(3));
+    cache.insert(5, 5, 10);
+    GFX_CHECK(!cache.contains(3));
+}
+
+GFX_TEST(ValuesCostingMoreThanTheCapacityArentKept) {
+    GfxLruCache<int, int> cache(30);
+    cache.insert(1, 1, 10);
+    cache.insert(2, 2, 31);
+    GFX_CHECK(!cache.contains(2));
+    GFX_CHECK(cache.contains(1));
+    // It still replaces the previous value of its key.
+    cache.insert(1, 1, 31);
+    GFX_CHECK(!cache.contains(1));
+    GFX_CHECK_EQ(cache.cost(), 0u);
+}
+
+GFX_TEST(TakeMovesTheValueOut) {
+    GfxLruCache<int, std::string> cache(100);
+    cache.insert(1, "one", 10);
+    std::string value;
+    GFX_CHECK(cache.take(1, value));
+    GFX_CHECK(value == "one");
+    GFX_CHECK(!cache.contains(1));
+    GFX_CHECK_EQ(cache.cost(), 0u);
+    GFX_CHECK(!cache.take(1, value));
+}
+
+GFX_TEST(EraseIfRemovesTheMatchingEntries) {
+    GfxLruCache<int, int> cache(100);
+    for (int i = 0; i < 6; ++i) {
+        cache.insert(i, i * 10, 5);
+    }
+    auto erased = cache.eraseIf([](int key, int) { return key % 2 == 0; });
+    GFX_CHECK_EQ(erased, 3u);
+    GFX_CHECK_EQ(cache.size(), 3u);
+    GFX_CHECK_EQ(cache.cost(), 15u);
+    GFX_CHECK(!cache.contains(2) && cache.contains(3));
+    // Erasing isn't evicting.
+    GFX_CHECK_EQ(cache.evictionCount(), 0u);
+    GFX_CHECK(cache.erase(3));
+    GFX_CHECK(!cache.erase(3));
+}
+
+GFX_TEST(LoweringTheCapacityTrims) {
+    GfxLruCache<int, int> cache(100);
+    for (int i = 0; i < 10; ++i) {
+        cache.insert(i, i, 10);
+    }
+    cache.setCapacity(35);
+    GFX_CHECK_EQ(cache.size(), 3u);
+    GFX_CHECK_EQ(cache.cost(), 30u);
+    GFX_CHECK(cache.contains(9) && cache.contains(7) && !cache.contains(6));
+    cache.clear();
+    GFX_CHECK_EQ(cache.size(), 0u);
+    GFX_CHECK_EQ(cache.cost(), 0u);
+}
+
+GFX_TEST(UpdatedCostsMakeRoom) {
+    // As the parked controls: their surfaces are released by the memory budget while cached.
+    GfxLruCache<int, int> cache(100);
+    for (int i = 0; i < 3; ++i) {
+        cache.insert(i, i, 30);
+    }
+    cache.updateCosts([](int key, int) { return key == 1 ? size_t(0) : size_t(30); });
+    GFX_CHECK_EQ(cache.cost(), 60u);
+    // Fits without evicting anything, with the costs known at insertion it would evict 0.
+    cache.insert(3, 3, 40);
+    GFX_CHECK_EQ(cache.size(), 4u);
+    GFX_CHECK_EQ(cache.evictionCount(), 0u);
+
+    // Costs that grew past the capacity evict the least recently used entries.
+    cache.updateCosts([](int, int) { return size_t(40); });
+    GFX_CHECK_EQ(cache.size(), 2u);
+    GFX_CHECK(cache.contains(3) && cache.contains(2) && !cache.contains(1));
+    GFX_CHECK_EQ(cache.cost(), 80u);
+}
@@ -0,0 +1,122 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <vector>
+
+#include "./GfxMemoryBudget.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+// Entries that remove themselves when evicted, the way the surfaces and caches do.
+struct EvictableEntries {
+    GfxMemoryBudget& budget;
+    std::vector<GfxMemoryBudget::EntryId> ids;
+    std::vector<size_t> evicted;
+
+    size_t add(size_t bytes, GfxMemorySubsystem subsystem = GfxMemorySubsystem::kSurfaces) {
+        size_t index = ids.size();
+        ids.push_back(budget.add(subsystem, bytes, [this, index]() {
+            evicted.push_back(index);
+            budget.remove(ids[index]);
+        }));
+        return index;
+    }
+};
+
+}  // namespace
+
+GFX_TEST(CountersFollowAddUpdateRemove) {
+    GfxMemoryBudget budget;
+    auto surface = budget.add(GfxMemorySubsystem::kSurfaces, 100);
+    auto pool = budget.add(GfxMemorySubsystem::kContextPool, 30);
+    budget.update(surface, 150);
+    auto counters = budget.counters();
+    GFX_CHECK_EQ(counters.totalBytes, 180u);
+    GFX_CHECK_EQ(counters.bytes[static_cast<size_t>(GfxMemorySubsystem::kSurfaces)], 150u);
+    GFX_CHECK_EQ(counters.bytes[static_cast<size_t>(GfxMemorySubsystem::kContextPool)], 30u);
+    budget.remove(surface);
+    budget.remove(pool);
+    counters = budget.counters();
+    GFX_CHECK_EQ(counters.totalBytes, 0u);
+    GFX_CHECK_EQ(counters.entries[static_cast<size_t>(GfxMemorySubsystem::kSurfaces)], 0u);
+}
+
+GFX_TEST(EnforceEvictsLeastRecentlyVisibleFirst) {
+    GfxMemoryBudget budget;
+    budget.setBudget(100);
+    EvictableEntries entries{budget, {}, {}};
+    for (int i = 0; i < 5; ++i) {
+        entries.add(40);
+    }
+    for (auto id : entries.ids) {
+        budget.setVisible(id, false);
+    }
+    budget.touch(entries.ids[0]);
+
+    GFX_CHECK_EQ(budget.enforce(), 120u);
+    GFX_CHECK_EQ(entries.evicted, (std::vector<size_t>{1, 2, 3}));
+    GFX_CHECK(budget.counters().totalBytes <= 100u);
+    GFX_CHECK_EQ(budget.enforce(), 0u);
+}
+
+GFX_TEST(EnforceNeverEvictsVisibleEntries) {
+    GfxMemoryBudget budget;
+    budget.setBudget(10);
+    EvictableEntries entries{budget, {}, {}};
+    entries.add(40);
+    entries.add(40);
+    budget.setVisible(entries.ids[1], false);
+    GFX_CHECK_EQ(budget.enforce(), 40u);
+    GFX_CHECK_EQ(entries.evicted, std::vector<size_t>{1});
+    GFX_CHECK_EQ(budget.counters().totalBytes, 40u);
+}
+
+// What the low memory notification does: every hidden evictable entry goes, even under budget.
+GFX_TEST(TrimUnderPressureEvictsEveryHiddenEntry) {
+    GfxMemoryBudget budget;
+    EvictableEntries entries{budget, {}, {}};
+    entries.add(1000);
+    entries.add(2000, GfxMemorySubsystem::kCaches);
+    entries.add(3000);
+    auto accounted = budget.add(GfxMemorySubsystem::kContextPool, 500);
+    budget.setVisible(entries.ids[0], false);
+    budget.setVisible(entries.ids[1], false);
+    budget.setVisible(accounted, false);
+
+    GFX_CHECK_EQ(budget.trim(), 3000u);
+    GFX_CHECK_EQ(entries.evicted.size(), 2u);
+    auto counters = budget.counters();
+    GFX_CHECK_EQ(counters.totalBytes, 3500u);
+    GFX_CHECK_EQ(counters.trimCount, 1u);
+    GFX_CHECK_EQ(counters.evictionCount, 2u);
+    GFX_CHECK_EQ(counters.evictedBytes, 3000u);
+
+    // A second notification while memory stays low finds nothing left to evict.
+    GFX_CHECK_EQ(budget.trim(), 0u);
+    GFX_CHECK_EQ(budget.counters().trimCount, 2u);
+}
+
+GFX_TEST(EvictedEntryIsNotEvictedTwice) {
+    GfxMemoryBudget budget;
+    std::vector<GfxMemoryBudget::EntryId> ids;
+    int evictions = 0;
+    // An owner that keeps its entry while it releases its memory asynchronously.
+    ids.push_back(budget.add(GfxMemorySubsystem::kSurfaces, 100, [&evictions]() { evictions++; }));
+    budget.setVisible(ids[0], false);
+    budget.trim();
+    budget.trim();
+    GFX_CHECK_EQ(evictions, 1);
+}
@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "./GfxObjectPool.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(IdleObjectsAreReused) {
+    GfxObjectPool<std::unique_ptr<int>> pool(2);
+    std::unique_ptr<int> object;
+    GFX_CHECK(!pool.take(object));
+    object = std::make_unique<int>(42);
+    auto* created = object.get();
+    GFX_CHECK(pool.give(std::move(object)));
+    GFX_CHECK_EQ(pool.idleCount(), 1u);
+
+    std::unique_ptr<int> reused;
+    GFX_REQUIRE(pool.take(reused));
+    GFX_CHECK(reused.get() == created);
+    auto stats = pool.stats();
+    GFX_CHECK_EQ(stats.takes, 2u);
+    GFX_CHECK_EQ(stats.hits, 1u);
+    GFX_CHECK_EQ(stats.outstanding, 1u);
+    GFX_CHECK_EQ(stats.idle, 0u);
+}
+
+GFX_TEST(ObjectsPastTheMaximumAreDropped) {
+    GfxObjectPool<std::shared_ptr<int>> pool(2);
+    auto shared = std::make_shared<int>(1);
+    // Three taken at once, none idle: all three are created.
+    for (int i = 0; i < 3; ++i) {
+        std::shared_ptr<int> object;
+        GFX_CHECK(!pool.take(object));
+    }
+    for (int i = 0; i < 3; ++i) {
+        GFX_CHECK(pool.give(std::shared_ptr<int>(shared)) == (i < 2));
+    }
+    // The idle objects, the local one; the dropped one is destroyed.
+    GFX_CHECK_EQ(shared.use_count(), 3);
+    GFX_CHECK_EQ(pool.stats().drops, 1u);
+
+    pool.clear();
+    GFX_CHECK_EQ(shared.use_count(), 1);
+    GFX_CHECK(pool.give(std::shared_ptr<int>(shared)));
+    // Closed, whatever is given back is dropped.
+    pool.close();
+    GFX_CHECK_EQ(shared.use_count(), 1);
+    GFX_CHECK(!pool.give(std::shared_ptr<int>(shared)));
+    GFX_CHECK_EQ(pool.idleCount(), 0u);
+}
+
+GFX_TEST(CancelledTakesArentOutstanding) {
+    GfxObjectPool<std::unique_ptr<int>> pool(1);
+    std::unique_ptr<int> object;
+    GFX_CHECK(!pool.take(object));
+    pool.cancelTake();
+    GFX_CHECK_EQ(pool.stats().outstanding, 0u);
+    // Never below zero.
+    pool.cancelTake();
+    GFX_CHECK_EQ(pool.stats().outstanding, 0u);
+}
+
+GFX_TEST(ThreadsShareThePool) {
+    GfxObjectPool<std::unique_ptr<int>> pool(4);
+    const int threadCount = 8;
+    const int takesPerThread = 10000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&pool]() {
+            for (int i = 0; i < takesPerThread; ++i) {
+                std::unique_ptr<int> object;
+                if (!pool.take(object)) {
+                    object = std::make_unique<int>(i);
+                }
+                pool.give(std::move(object));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto stats = pool.stats();
+    GFX_CHECK_EQ(stats.takes, uint64_t(threadCount * takesPerThread));
+    GFX_CHECK_EQ(stats.outstanding, 0u);
+    GFX_CHECK(stats.idle <= 4u);
+    // Every object created was either kept or dropped.
+    GFX_CHECK_EQ(stats.takes - stats.hits, stats.idle + stats.drops);
+}
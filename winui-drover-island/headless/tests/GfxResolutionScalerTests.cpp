@@ -0,0 +1,131 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <cstdlib>
+
+#include "./GfxResolutionScaler.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using Clock = GfxResolutionScaler::Clock;
+
+const Clock::duration kTarget = std::chrono::microseconds(16667);
+
+// Frames cost their pixels: fullCost at full resolution, times the square of the scale.
+Clock::duration costAt(float scale, double fullCost) {
+    return std::chrono::duration_cast<Clock::duration>(kTarget * (fullCost * scale * scale));
+}
+
+// Renders frames of the given full resolution cost, in fractions of the target, at whatever
+// scale the scaler picks. Returns the number of scale changes.
+int renderFrames(GfxResolutionScaler& scaler, double fullCost, int frameCount) {
+    int changes = 0;
+    for (int i = 0; i < frameCount; ++i) {
+        changes += scaler.addFrameTime(costAt(scaler.scale(), fullCost));
+    }
+    return changes;
+}
+
+}  // namespace
+
+GFX_TEST(ScaleConvergesUnderTheTarget) {
+    GfxResolutionScaler scaler;
+    // Twice the target at full resolution: the pixels have to be halved, 0.707 in each dimension,
+    // quantized down to 0.625.
+    renderFrames(scaler, 2.0, 40);
+    GFX_CHECK_EQ(scaler.scale(), 0.625f);
+    GFX_CHECK(costAt(scaler.scale(), 2.0) <= kTarget);
+    // Settled, the scale no longer changes.
+    GFX_CHECK_EQ(renderFrames(scaler, 2.0, 100), 0);
+}
+
+GFX_TEST(ScaleChangesOnlyAfterSettling) {
+    GfxResolutionScaler::Options options;
+    options.settleFrames = 6;
+    GfxResolutionScaler scaler(options);
+    for (int i = 0; i < 5; ++i) {
+        GFX_CHECK(!scaler.addFrameTime(costAt(1.f, 3.0)));
+    }
+    GFX_CHECK(scaler.addFrameTime(costAt(1.f, 3.0)));
+    // The average follows the change, so the next frames at the new scale don't look expensive.
+    GFX_CHECK(scaler.averageFrameTime() < costAt(1.f, 3.0));
+    for (int i = 0; i < 5; ++i) {
+        GFX_CHECK(!scaler.addFrameTime(costAt(scaler.scale(), 3.0)));
+    }
+}
+
+GFX_TEST(ScaleStepsBackUpWhenFramesAreCheap) {
+    GfxResolutionScaler scaler;
+    renderFrames(scaler, 3.0, 40);
+    GFX_CHECK(scaler.scale() < 1.f);
+    // The scene got simpler: a step at a time, back to full resolution.
+    float previous = scaler.scale();
+    bool stepped = true;
+    for (int i = 0; i < 40; ++i) {
+        if (scaler.addFrameTime(costAt(scaler.scale(), 0.3))) {
+            stepped = stepped && scaler.scale() == previous + scaler.options().step;
+            previous = scaler.scale();
+        }
+    }
+    GFX_CHECK(stepped);
+    GFX_CHECK_EQ(scaler.scale(), 1.f);
+
+    // Within the band around the target, neither up nor down.
+    GFX_CHECK_EQ(renderFrames(scaler, 0.9, 40), 0);
+}
+
+GFX_TEST(ScaleStaysBetweenTheMinimumAndFullResolution) {
+    GfxResolutionScaler::Options options;
+    options.minScale = 0.3f;
+    options.step = 0.25f;
+    GfxResolutionScaler scaler(options);
+    // Far too slow for any scale: clamped to the minimum, which isn't a multiple of the step.
+    renderFrames(scaler, 100.0, 40);
+    GFX_CHECK_EQ(scaler.scale(), 0.3f);
+
+    bool inRange = true;
+    for (int i = 0; i < 1000; ++i) {
+        double fullCost = static_cast<double>(std::rand() % 500) / 100.0;
+        scaler.addFrameTime(costAt(scaler.scale(), fullCost));
+        inRange = inRange && scaler.scale() >= options.minScale && scaler.scale() <= 1.f;
+    }
+    GFX_CHECK(inRange);
+
+    // Options changed on the fly clamp the current scale too.
+    options.minScale = 0.6f;
+    scaler.setOptions(options);
+    GFX_CHECK(scaler.scale() >= 0.6f);
+    scaler.reset();
+    GFX_CHECK_EQ(scaler.scale(), 1.f);
+}
+
+GFX_TEST(UnquantizedScaleFollowsTheCost) {
+    GfxResolutionScaler::Options options;
+    options.step = 0;
+    GfxResolutionScaler scaler(options);
+    renderFrames(scaler, 2.0, 40);
+    // The exact scale for the target, without steps.
+    GFX_CHECK(scaler.scale() > 0.68f && scaler.scale() < 0.72f);
+    renderFrames(scaler, 0.5, 40);
+    GFX_CHECK_EQ(scaler.scale(), 1.f);
+    bool inRange = true;
+    for (int i = 0; i < 1000; ++i) {
+        scaler.addFrameTime(costAt(scaler.scale(), static_cast<double>(std::rand() % 500) / 100.0));
+        inRange = inRange && scaler.scale() >= options.minScale && scaler.scale() <= 1.f;
+    }
+    GFX_CHECK(inRange);
+}
@@ -0,0 +1,248 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "./GfxScene.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using Rect = GfxScene::Rect;
+
+// Removed with the test, whatever the outcome.
+class TemporaryFile {
+ public:
+    explicit TemporaryFile(const char* name) : path_(std::filesystem::temp_directory_path() / name) {}
+    ~TemporaryFile() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    const std::filesystem::path& path() const { return path_; }
+
+ private:
+    std::filesystem::path path_;
+};
+
+GfxScene::Style makeStyle(uint32_t flags, float strokeWidth = 0) {
+    GfxScene::Style style = {};
+    style.fill[3] = 1.f;
+    style.stroke[3] = 1.f;
+    style.strokeWidth = strokeWidth;
+    style.fontSize = 12.f;
+    style.flags = flags;
+    return style;
+}
+
+bool sameRect(const Rect& a, const Rect& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+// A grid of rects, one every 30 DIPs, enough for the builder to split the scene in many cells.
+bool writeGrid(const std::filesystem::path& path, uint32_t side) {
+    GfxSceneBuilder builder;
+    auto style = builder.addStyle(makeStyle(GfxScene::kFill));
+    // Unused by the nodes, for the edits.
+    builder.addStyle(makeStyle(GfxScene::kFill | GfxScene::kStroke, 4.f));
+    for (uint32_t i = 0; i < side * side; ++i) {
+        float x = static_cast<float>(i % side) * 30.f;
+        float y = static_cast<float>(i / side) * 30.f;
+        builder.addRect({x, y, x + 20, y + 20}, style);
+    }
+    // A background across every cell, listed in each of them.
+    builder.addRect({0, 0, side * 30.f, side * 30.f}, style);
+    return builder.write(path);
+}
+
+std::vector<uint32_t> bruteForce(const GfxScene& scene, const Rect& rect) {
+    std::vector<uint32_t> nodes;
+    for (uint32_t i = 0; i < scene.nodeCount(); ++i) {
+        const auto& node = scene.node(i);
+        if (!(node.flags & GfxScene::kHidden) && !node.bounds.isEmpty() && node.bounds.intersects(rect)) {
+            nodes.push_back(i);
+        }
+    }
+    return nodes;
+}
+
+}  // namespace
+
+GFX_TEST(WrittenNodesReadBack) {
+    TemporaryFile file("GfxSceneTests-read.gscn");
+    GfxSceneBuilder builder;
+    auto fill = builder.addStyle(makeStyle(GfxScene::kFill));
+    auto stroke = builder.addStyle(makeStyle(GfxScene::kStroke, 4.f));
+    auto group = builder.addGroup();
+    auto rect = builder.addRect({10, 10, 50, 30}, fill, group);
+    auto ellipse = builder.addEllipse({100, 10, 140, 50}, stroke, group);
+    const GfxScene::Point points[] = {{0, 100}, {50, 150}, {100, 100}};
+    auto polyline = builder.addPolyline(points, 3, stroke);
+    auto text = builder.addText({0, 200, 100, 220}, "Drover \xc3\xaele", fill);
+    GFX_REQUIRE(builder.write(file.path()));
+
+    GfxScene scene;
+    GFX_REQUIRE(scene.open(file.path()));
+    GFX_CHECK_EQ(scene.nodeCount(), 5u);
+    GFX_CHECK(scene.node(group).kind == GfxScene::NodeKind::kGroup);
+    GFX_CHECK(scene.node(group).bounds.isEmpty());
+    GFX_CHECK_EQ(scene.node(rect).parent, group);
+    GFX_CHECK(sameRect(scene.node(rect).bounds, {10, 10, 50, 30}));
+    // The bounds include the stroke, centered on the outline.
+    GFX_CHECK(sameRect(scene.node(ellipse).bounds, {98, 8, 142, 52}));
+    GFX_CHECK_EQ(scene.node(polyline).parent, GfxScene::kNoParent);
+    GFX_CHECK(sameRect(scene.node(polyline).bounds, {-2, 98, 102, 152}));
+
+    uint32_t count = 0;
+    const auto* read = scene.points(scene.node(polyline), count);
+    GFX_REQUIRE(read != nullptr && count == 3u);
+    GFX_CHECK(read[1].x == 50 && read[1].y == 150);
+    GFX_CHECK(scene.text(scene.node(text)) == "Drover \xc3\xaele");
+    GFX_CHECK_EQ(scene.style(scene.node(ellipse).style).strokeWidth, 4.f);
+    // Unknown styles draw nothing.
+    GFX_CHECK_EQ(scene.style(1000).flags, 0u);
+    GFX_CHECK(sameRect(scene.bounds(), {-2, 8, 142, 220}));
+}
+
+GFX_TEST(NodesIntersectingMatchesBruteForce) {
+    TemporaryFile file("GfxSceneTests-grid.gscn");
+    GFX_REQUIRE(writeGrid(file.path(), 40));
+    GfxScene scene;
+    GFX_REQUIRE(scene.open(file.path()));
+
+    int32_t mismatches = 0;
+    for (const Rect& rect : {Rect{0, 0, 10, 10}, Rect{95, 95, 305, 185}, Rect{-100, -100, 5000, 5000},
+             Rect{1199, 1199, 1300, 1300}, Rect{21, 21, 29, 29}}) {
+        std::vector<uint32_t> nodes;
+        scene.nodesIntersecting(rect, nodes);
+        // In paint order, each node once however many cells it spans.
+        mismatches += nodes != bruteForce(scene, rect);
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+
+    // Appended to what the vector holds.
+    std::vector<uint32_t> nodes{12345};
+    scene.nodesIntersecting(Rect{0, 0, 10, 10}, nodes);
+    GFX_REQUIRE(nodes.size() == 3u);
+    GFX_CHECK(nodes[0] == 12345u && nodes[1] == 0u && nodes[2] == 1600u);
+    scene.nodesIntersecting(Rect{}, nodes);
+    GFX_CHECK_EQ(nodes.size(), 3u);
+}
+
+GFX_TEST(EditsReportWhatToRedraw) {
+    TemporaryFile file("GfxSceneTests-edit.gscn");
+    GFX_REQUIRE(writeGrid(file.path(), 10));
+    GfxScene scene;
+    GFX_REQUIRE(scene.open(file.path()));
+    std::vector<std::pair<Rect, Rect>> changes;
+    scene.setChangeListener([&](const Rect& oldBounds, const Rect& newBounds) { changes.emplace_back(oldBounds, newBounds); });
+
+    // Moved: found at its new place, no longer at its old one.
+    GFX_REQUIRE(scene.setNodeBounds(0, {500, 500, 520, 520}));
+    GFX_REQUIRE(changes.size() == 1u);
+    GFX_CHECK(sameRect(changes[0].first, {0, 0, 20, 20}) && sameRect(changes[0].second, {500, 500, 520, 520}));
+    std::vector<uint32_t> nodes;
+    scene.nodesIntersecting(Rect{505, 505, 510, 510}, nodes);
+    GFX_CHECK(nodes == std::vector<uint32_t>{0});
+    nodes.clear();
+    scene.nodesIntersecting(Rect{5, 5, 10, 10}, nodes);
+    GFX_CHECK(nodes == std::vector<uint32_t>{100});
+
+    // A stroked style grows the bounds by half the stroke.
+    GFX_REQUIRE(scene.setNodeStyle(1, 1));
+    GFX_CHECK(sameRect(changes[1].first, {30, 0, 50, 20}) && sameRect(changes[1].second, {28, -2, 52, 22}));
+
+    // Hidden nodes cover nothing and aren't listed.
+    GFX_REQUIRE(scene.setNodeVisible(2, false));
+    GFX_CHECK(changes.back().second.isEmpty());
+    nodes.clear();
+    scene.nodesIntersecting(Rect{65, 5, 70, 10}, nodes);
+    GFX_CHECK(nodes == std::vector<uint32_t>{100});
+    GFX_CHECK_EQ(scene.editedNodeCount(), 3u);
+
+    // Out of range nodes aren't edited.
+    GFX_CHECK(!scene.setNodeBounds(scene.nodeCount(), {0, 0, 1, 1}));
+    GFX_CHECK_EQ(changes.size(), 3u);
+
+    // Reopening drops the edits, the file wasn't modified.
+    GFX_REQUIRE(scene.open(file.path()));
+    GFX_CHECK_EQ(scene.editedNodeCount(), 0u);
+    GFX_CHECK(sameRect(scene.node(0).bounds, {0, 0, 20, 20}));
+}
+
+GFX_TEST(PolylineBoundsCantBeSet) {
+    TemporaryFile file("GfxSceneTests-polyline.gscn");
+    GfxSceneBuilder builder;
+    auto style = builder.addStyle(makeStyle(GfxScene::kStroke, 2.f));
+    const GfxScene::Point points[] = {{0, 0}, {10, 10}};
+    builder.addPolyline(points, 2, style);
+    builder.addGroup();
+    GFX_REQUIRE(builder.write(file.path()));
+    GfxScene scene;
+    GFX_REQUIRE(scene.open(file.path()));
+    GFX_CHECK(!scene.setNodeBounds(0, {0, 0, 100, 100}));
+    GFX_CHECK(!scene.setNodeStyle(1, style));
+    GFX_CHECK(scene.setNodeVisible(0, false));
+}
+
+GFX_TEST(DamagedFilesDontOpenOrDrawLess) {
+    TemporaryFile file("GfxSceneTests-damaged.gscn");
+    GfxSceneBuilder builder;
+    auto style = builder.addStyle(makeStyle(GfxScene::kStroke, 1.f));
+    const GfxScene::Point points[] = {{0, 0}, {10, 10}, {20, 0}};
+    builder.addPolyline(points, 3, style);
+    builder.addText({0, 20, 50, 40}, "text", style);
+    GFX_REQUIRE(builder.write(file.path()));
+
+    std::vector<char> bytes;
+    {
+        std::ifstream input(file.path(), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    }
+    auto rewrite = [&](const std::vector<char>& content) {
+        std::ofstream output(file.path(), std::ios::binary | std::ios::trunc);
+        output.write(content.data(), static_cast<std::streamsize>(content.size()));
+    };
+
+    GfxScene scene;
+    // A bad magic, a truncated header, truncated sections.
+    for (size_t size : {size_t(0), size_t(40), bytes.size() - 1}) {
+        rewrite(std::vector<char>(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(size)));
+        GFX_CHECK(!scene.open(file.path()));
+        GFX_CHECK(!scene.isOpen());
+    }
+    auto badMagic = bytes;
+    badMagic[0] ^= 1;
+    rewrite(badMagic);
+    GFX_CHECK(!scene.open(file.path()));
+
+    // Nodes referencing points and strings beyond their sections read as empty. The nodes follow
+    // the 112 byte header; first is at offset 12 of a node, and nodes are 40 bytes.
+    auto badReferences = bytes;
+    const uint32_t beyond = 1000;
+    std::memcpy(&badReferences[112 + 12], &beyond, sizeof(beyond));
+    std::memcpy(&badReferences[112 + 40 + 12], &beyond, sizeof(beyond));
+    rewrite(badReferences);
+    GFX_REQUIRE(scene.open(file.path()));
+    uint32_t count = 1;
+    GFX_CHECK(scene.points(scene.node(0), count) == nullptr && count == 0u);
+    GFX_CHECK(scene.text(scene.node(1)).empty());
+}
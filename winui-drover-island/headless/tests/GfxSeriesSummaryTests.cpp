@@ -0,0 +1,151 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "./GfxAllocationCounter.h"
+#include "./GfxSeriesSummary.h"
+#include "./GfxTest.h"
+#include "./GfxViolationCheck.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+using Range = GfxSeriesSummary::Range;
+
+Range referenceRange(const std::vector<float>& samples, size_t begin, size_t end) {
+    auto result = Range::empty();
+    for (size_t i = begin; i < std::min(end, samples.size()); ++i) {
+        result.min = std::min(result.min, samples[i]);
+        result.max = std::max(result.max, samples[i]);
+    }
+    return result;
+}
+
+bool sameRange(const Range& a, const Range& b) {
+    return (a.isEmpty() && b.isEmpty()) || (a.min == b.min && a.max == b.max);
+}
+
+float randomSample() {
+    return static_cast<float>(std::rand() % 20001 - 10000) / 7.f;
+}
+
+}  // namespace
+
+GFX_TEST(MinMaxMatchesTheReference) {
+    // Every length around the unrolled kernel, at every alignment.
+    std::vector<float> samples(64);
+    for (auto& sample : samples) {
+        sample = randomSample();
+    }
+    int32_t mismatches = 0;
+    for (size_t begin = 0; begin < 4; ++begin) {
+        for (size_t count = 0; begin + count <= samples.size(); ++count) {
+            auto range = GfxSeriesSummary::minMax(samples.data() + begin, count);
+            mismatches += !sameRange(range, referenceRange(samples, begin, begin + count));
+        }
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+    GFX_CHECK(GfxSeriesSummary::minMax(samples.data(), 0).isEmpty());
+}
+
+GFX_TEST(RangesMatchTheSamplesWhileAppending) {
+    GfxSeriesSummary series;
+    std::vector<float> samples;
+    int32_t mismatches = 0;
+    for (int round = 0; round < 30; ++round) {
+        // Chunks of any size, so the partial blocks and the pyramid levels fill up in every order.
+        std::vector<float> chunk(static_cast<size_t>(std::rand() % 3000));
+        for (auto& sample : chunk) {
+            sample = randomSample();
+        }
+        series.append(chunk.data(), chunk.size());
+        samples.insert(samples.end(), chunk.begin(), chunk.end());
+        for (int query = 0; query < 100; ++query) {
+            size_t begin = static_cast<size_t>(std::rand()) % (samples.size() + 1);
+            size_t end = static_cast<size_t>(std::rand()) % (samples.size() + 1);
+            if (begin > end) {
+                std::swap(begin, end);
+            }
+            mismatches += !sameRange(series.range(begin, end), referenceRange(samples, begin, end));
+        }
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+    GFX_CHECK_EQ(series.size(), samples.size());
+    GFX_CHECK(series.summaryBytes() > 0);
+    // Clamped to the series.
+    GFX_CHECK(sameRange(series.range(0, samples.size() + 100), referenceRange(samples, 0, samples.size())));
+}
+
+GFX_TEST(DecimateReducesToColumns) {
+    GfxSeriesSummary series;
+    std::vector<float> samples(10000);
+    for (auto& sample : samples) {
+        sample = randomSample();
+    }
+    series.append(samples.data(), samples.size());
+
+    std::vector<Range> columns(100);
+    series.decimate(0, 100, columns.data(), columns.size());
+    int32_t mismatches = 0;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        mismatches += !sameRange(columns[i], referenceRange(samples, i * 100, (i + 1) * 100));
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+
+    // Zoomed in past one sample per column, each column still gets the sample it starts in;
+    // the columns before and after the series are empty.
+    series.decimate(-10, 0.25, columns.data(), columns.size());
+    GFX_CHECK(columns[0].isEmpty());
+    GFX_CHECK(sameRange(columns[40], referenceRange(samples, 0, 1)));
+    GFX_CHECK(sameRange(columns[43], referenceRange(samples, 0, 1)));
+    GFX_CHECK(sameRange(columns[44], referenceRange(samples, 1, 2)));
+    series.decimate(9990, 1, columns.data(), columns.size());
+    GFX_CHECK(!columns[9].isEmpty());
+    GFX_CHECK(columns[10].isEmpty());
+}
+
+GFX_TEST(ClearStartsOver) {
+    GfxSeriesSummary series;
+    std::vector<float> samples(1000, 1.f);
+    series.append(samples.data(), samples.size());
+    series.clear();
+    GFX_CHECK_EQ(series.size(), 0u);
+    GFX_CHECK(series.range(0, 1000).isEmpty());
+    series.append(-2.f);
+    series.append(3.f);
+    auto range = series.range(0, 2);
+    GFX_CHECK(range.min == -2.f && range.max == 3.f);
+}
+
+GFX_TEST(AppendingWithinTheReservationDoesntAllocate) {
+    GFX_REQUIRE(GfxAllocationCounter::isEnabled());
+    const size_t capacity = 64 * 1024;
+    GfxSeriesSummary series;
+    series.reserve(capacity);
+    test::ViolationCheck check;
+    {
+        // Twice, since clearing must keep the memory as well.
+        GfxNoAllocationScope scope("append");
+        for (int round = 0; round < 2; ++round) {
+            for (size_t i = 0; i < capacity; ++i) {
+                series.append(static_cast<float>(i % 97));
+            }
+            series.clear();
+        }
+    }
+    GFX_CHECK_EQ(check.violations(), 0u);
+}
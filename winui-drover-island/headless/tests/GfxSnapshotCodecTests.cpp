@@ -0,0 +1,179 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "./GfxSnapshotCodec.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+// Premultiplied BGRA, tightly packed: a flat background, a gradient, and noise, so that every op
+// of the codec is used.
+std::vector<uint8_t> makeImage(int32_t width, int32_t height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    uint64_t random = 1;
+    for (int32_t y = 0; y < height; ++y) {
+        for (int32_t x = 0; x < width; ++x) {
+            uint8_t* pixel = &pixels[(static_cast<size_t>(y) * width + x) * 4];
+            if (y < height / 3) {
+                std::fill_n(pixel, 4, uint8_t(255));
+            } else if (y < 2 * height / 3) {
+                pixel[0] = static_cast<uint8_t>(x);
+                pixel[1] = static_cast<uint8_t>(x + y);
+                pixel[2] = static_cast<uint8_t>(y);
+                pixel[3] = 255;
+            } else {
+                random = random * 6364136223846793005ull + 1442695040888963407ull;
+                auto alpha = static_cast<uint8_t>(random >> 56);
+                pixel[0] = std::min(static_cast<uint8_t>(random >> 32), alpha);
+                pixel[1] = std::min(static_cast<uint8_t>(random >> 40), alpha);
+                pixel[2] = std::min(static_cast<uint8_t>(random >> 48), alpha);
+                pixel[3] = alpha;
+            }
+        }
+    }
+    return pixels;
+}
+
+}  // namespace
+
+GFX_TEST(RoundTripIsLossless) {
+    const int32_t width = 97;
+    const int32_t height = 61;
+    auto pixels = makeImage(width, height);
+    std::vector<uint8_t> encoded;
+    GfxSnapshotCodec::encode(pixels.data(), width, height, width * 4, encoded);
+    GFX_REQUIRE(!encoded.empty());
+
+    GfxSnapshotImage image;
+    GFX_REQUIRE(GfxSnapshotCodec::decode(encoded.data(), encoded.size(), image));
+    GFX_CHECK_EQ(image.width, width);
+    GFX_CHECK_EQ(image.height, height);
+    GFX_CHECK(image.pixels == pixels);
+}
+
+GFX_TEST(FlatImagesCompressToRuns) {
+    const int32_t width = 256;
+    const int32_t height = 256;
+    std::vector<uint8_t> pixels(width * height * 4, 0);
+    std::vector<uint8_t> encoded;
+    GfxSnapshotCodec::encode(pixels.data(), width, height, width * 4, encoded);
+    GFX_CHECK(encoded.size() < pixels.size() / 50);
+
+    GfxSnapshotImage image;
+    GFX_REQUIRE(GfxSnapshotCodec::decode(encoded.data(), encoded.size(), image));
+    GFX_CHECK(image.pixels == pixels);
+}
+
+GFX_TEST(StrideIsSkipped) {
+    const int32_t width = 10;
+    const int32_t height = 7;
+    const size_t stride = width * 4 + 24;
+    auto packed = makeImage(width, height);
+    std::vector<uint8_t> padded(stride * height, 0xcd);
+    for (int32_t y = 0; y < height; ++y) {
+        std::copy_n(&packed[y * width * 4], width * 4, &padded[y * stride]);
+    }
+    std::vector<uint8_t> encoded;
+    GfxSnapshotCodec::encode(padded.data(), width, height, stride, encoded);
+
+    GfxSnapshotImage image;
+    GFX_REQUIRE(GfxSnapshotCodec::decode(encoded.data(), encoded.size(), image));
+    GFX_CHECK(image.pixels == packed);
+}
+
+GFX_TEST(InvalidSizesEncodeNothing) {
+    uint8_t pixel[4] = {};
+    std::vector<uint8_t> encoded(16, 1);
+    GfxSnapshotCodec::encode(pixel, 0, 1, 4, encoded);
+    GFX_CHECK(encoded.empty());
+    GfxSnapshotCodec::encode(pixel, 1, -1, 4, encoded);
+    GFX_CHECK(encoded.empty());
+    GfxSnapshotCodec::encode(pixel, 1 << 20, 1, 4, encoded);
+    GFX_CHECK(encoded.empty());
+}
+
+GFX_TEST(TruncatedDataFails) {
+    const int32_t width = 31;
+    const int32_t height = 17;
+    auto pixels = makeImage(width, height);
+    std::vector<uint8_t> encoded;
+    GfxSnapshotCodec::encode(pixels.data(), width, height, width * 4, encoded);
+
+    for (size_t size = 0; size < encoded.size(); ++size) {
+        GfxSnapshotImage image;
+        GFX_CHECK(!GfxSnapshotCodec::decode(encoded.data(), size, image));
+        GFX_CHECK(image.pixels.empty() && image.width == 0 && image.height == 0);
+    }
+    GfxSnapshotImage image;
+    GFX_CHECK(!GfxSnapshotCodec::decode(nullptr, encoded.size(), image));
+}
+
+GFX_TEST(HeadersLargerThanTheDataAreRejected) {
+    // Opaque black is the pixel before the first one: the image is nothing but full runs, the
+    // most pixels an op can yield.
+    const int32_t width = 62;
+    const int32_t height = 4;
+    std::vector<uint8_t> pixels(width * height * 4, 0);
+    for (size_t i = 3; i < pixels.size(); i += 4) {
+        pixels[i] = 255;
+    }
+    std::vector<uint8_t> encoded;
+    GfxSnapshotCodec::encode(pixels.data(), width, height, width * 4, encoded);
+    GFX_REQUIRE(encoded.size() == 16u + height);
+    GfxSnapshotImage image;
+    GFX_CHECK(GfxSnapshotCodec::decode(encoded.data(), encoded.size(), image));
+
+    // A header claiming the largest image, with far too few ops to fill it, fails before its
+    // gigabyte of pixels is allocated.
+    const int32_t largest = 16384;
+    std::memcpy(&encoded[8], &largest, sizeof(largest));
+    std::memcpy(&encoded[12], &largest, sizeof(largest));
+    GFX_CHECK(!GfxSnapshotCodec::decode(encoded.data(), encoded.size(), image));
+    GFX_CHECK(image.pixels.empty());
+}
+
+GFX_TEST(CorruptedDataNeverOverruns) {
+    const int32_t width = 40;
+    const int32_t height = 30;
+    auto pixels = makeImage(width, height);
+    std::vector<uint8_t> encoded;
+    GfxSnapshotCodec::encode(pixels.data(), width, height, width * 4, encoded);
+
+    // A corrupted header is rejected.
+    for (size_t byte = 0; byte < 16; ++byte) {
+        auto corrupted = encoded;
+        corrupted[byte] ^= 0x80;
+        GfxSnapshotImage image;
+        GFX_CHECK(!GfxSnapshotCodec::decode(corrupted.data(), corrupted.size(), image));
+    }
+    // Corrupted ops decode to the wrong pixels or fail, always within the image. Run under a
+    // sanitizer, this catches any read or write out of bounds.
+    for (size_t step = 3; step < 40; step += 7) {
+        auto corrupted = encoded;
+        for (size_t i = 16; i < corrupted.size(); i += step) {
+            corrupted[i] ^= 0x5a;
+        }
+        GfxSnapshotImage image;
+        if (GfxSnapshotCodec::decode(corrupted.data(), corrupted.size(), image)) {
+            GFX_CHECK_EQ(image.pixels.size(), pixels.size());
+        } else {
+            GFX_CHECK(image.pixels.empty());
+        }
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <chrono>
+#include <vector>
+
+#include "./GfxStressScenario.h"
+#include "./GfxTest.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+GfxStressScenario::Options smallScenario() {
+    GfxStressScenario::Options options;
+    options.controlCount = 40;
+    options.columns = 8;
+    options.duration = std::chrono::seconds(2);
+    return options;
+}
+
+}  // namespace
+
+GFX_TEST(ScenariosDependOnlyOnTheOptions) {
+    GfxStressScenario a(smallScenario());
+    GfxStressScenario b(smallScenario());
+    GFX_REQUIRE(a.controls().size() == 40u);
+    GFX_CHECK_EQ(a.rowCount(), 5u);
+    int32_t mismatches = 0;
+    for (size_t i = 0; i < a.controls().size(); ++i) {
+        const auto& x = a.controls()[i];
+        const auto& y = b.controls()[i];
+        mismatches += x.source != i + 1 || x.kind != y.kind || x.useVirtualSurface != y.useVirtualSurface ||
+                      x.invalidationsPerSecond != y.invalidationsPerSecond;
+        mismatches += x.invalidationsPerSecond < 1.0 || x.invalidationsPerSecond > 60.0;
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+
+    auto options = smallScenario();
+    options.seed = 2;
+    GfxStressScenario other(options);
+    bool differs = false;
+    for (size_t i = 0; i < a.controls().size(); ++i) {
+        differs = differs || a.controls()[i].invalidationsPerSecond != other.controls()[i].invalidationsPerSecond;
+    }
+    GFX_CHECK(differs);
+}
+
+GFX_TEST(AdvancingInStepsMatchesAdvancingAtOnce) {
+    GfxStressScenario stepped(smallScenario());
+    GfxStressScenario whole(smallScenario());
+    std::vector<GfxStressScenario::Invalidation> steps;
+    for (int64_t time = 0; time <= 2000000; time += 16667) {
+        const auto& due = stepped.advance(std::chrono::microseconds(time));
+        steps.insert(steps.end(), due.begin(), due.end());
+    }
+    // Past the duration, whatever was left.
+    const auto& rest = stepped.advance(std::chrono::seconds(3));
+    steps.insert(steps.end(), rest.begin(), rest.end());
+    auto all = whole.advance(std::chrono::seconds(2));
+    GFX_REQUIRE(steps.size() == all.size());
+    GFX_CHECK(!all.empty());
+
+    int32_t outOfOrder = 0;
+    int32_t outsideTheControl = 0;
+    for (size_t i = 0; i < all.size(); ++i) {
+        outOfOrder += i > 0 && all[i].time < all[i - 1].time;
+        if (all[i].partial) {
+            outsideTheControl += all[i].rect[0] < 0 || all[i].rect[1] < 0 || all[i].rect[2] > 160.f || all[i].rect[3] > 120.f;
+        }
+    }
+    GFX_CHECK_EQ(outOfOrder, 0);
+    GFX_CHECK_EQ(outsideTheControl, 0);
+    GFX_CHECK(whole.advance(std::chrono::seconds(10)).empty());
+
+    // Restarting plays the same invalidations again.
+    whole.restart();
+    GFX_CHECK_EQ(whole.advance(std::chrono::seconds(2)).size(), all.size());
+}
+
+GFX_TEST(HeadlessRunsAreTheSameEveryTime) {
+    GfxStressScenario scenario(smallScenario());
+    auto trace = scenario.toTrace();
+    // A resize per control, then every invalidation.
+    GFX_CHECK_EQ(trace.events().size(), 40u + GfxStressScenario(smallScenario()).advance(std::chrono::seconds(2)).size());
+
+    auto first = scenario.runHeadless();
+    auto second = scenario.runHeadless();
+    GFX_CHECK(first.frames.replayed.frames > 0u);
+    GFX_CHECK_EQ(first.frames.replayed.frames, second.frames.replayed.frames);
+    GFX_CHECK_EQ(first.canvases.frames.redrawnPixels, second.canvases.frames.redrawnPixels);
+    GFX_CHECK(first.canvases.frames.partialFrames > 0u);
+    // Every control keeps its surface; at the default size, smaller than a tile, a virtual surface
+    // is a single surface like the others.
+    GFX_CHECK_EQ(first.surfaces, 40u);
+    GFX_CHECK_EQ(first.canvases.surfacesCreated, 40u);
+    GFX_CHECK_EQ(first.surfaceBytes, size_t(40 * 160 * 120 * 4));
+}
+
+GFX_TEST(LargeVirtualCellsAreTiled) {
+    auto options = smallScenario();
+    options.cellWidth = 600;
+    options.cellHeight = 300;
+    options.virtualSurfaceFraction = 1.f;
+    auto result = GfxStressScenario(options).runHeadless();
+    // 3x2 tiles of 256 pixels per control.
+    GFX_CHECK_EQ(result.surfaces, 40u * 6u);
+}
+
+GFX_TEST(ArgumentsSetTheOptions) {
+    GfxStressScenario::Options options;
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-controls=1000", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-columns=40", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-min-rate=0.5", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-max-rate=120", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-partial=0.25", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-virtual=1", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-duration=2.5", options));
+    GFX_CHECK(GfxStressScenario::parseArgument("--stress-seed=7", options));
+    GFX_CHECK_EQ(options.controlCount, 1000u);
+    GFX_CHECK_EQ(options.columns, 40u);
+    GFX_CHECK(options.minInvalidationsPerSecond == 0.5 && options.maxInvalidationsPerSecond == 120.0);
+    GFX_CHECK(options.partialInvalidationFraction == 0.25f && options.virtualSurfaceFraction == 1.f);
+    GFX_CHECK(options.duration == std::chrono::milliseconds(2500));
+    GFX_CHECK_EQ(options.seed, 7u);
+
+    // Other arguments and bad values leave the options alone.
+    for (const char* argument : {"--stress-controls=0", "--stress-controls=1.5", "--stress-controls=12x", "--stress-controls=",
+             "--stress-max-rate=-1", "--stress-partial=2", "--stress-duration=inf", "--stress-colour=1", "--stress-controls",
+             "--controls=5", "stress-controls=5"}) {
+        GFX_CHECK(!GfxStressScenario::parseArgument(argument, options));
+    }
+    GFX_CHECK_EQ(options.controlCount, 1000u);
+    GFX_CHECK(options.maxInvalidationsPerSecond == 120.0);
+}
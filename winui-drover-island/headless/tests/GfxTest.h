@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace winui_drover_island {
+namespace test {
+
+// The few pieces of a test framework the headless tests need, so they build with nothing but the
+// compiler. A test is a function registered with GFX_TEST; a failed check reports the expression
+// and goes on with the test, and the executable fails if any check did.
+struct TestCase {
+    const char* name;
+    std::function<void()> body;
+};
+
+std::vector<TestCase>& registry();
+void reportFailure(const char* file, int line, const char* expression);
+
+struct Registrar {
+    Registrar(const char* name, std::function<void()> body) { registry().push_back({name, std::move(body)}); }
+};
+
+}  // namespace test
+}  // namespace winui_drover_island
+
+#define GFX_TEST_CONCAT_(a, b) a##b
+#define GFX_TEST_CONCAT(a, b) GFX_TEST_CONCAT_(a, b)
+
+#define GFX_TEST(name)                                                                              \
+    static void name();                                                                             \
+    static ::winui_drover_island::test::Registrar GFX_TEST_CONCAT(name, Registrar_)(#name, name);   \
+    static void name()
+
+#define GFX_CHECK(...)                                                                              \
+    do {                                                                                            \
+        if (!(__VA_ARGS__)) {                                                                       \
+            ::winui_drover_island::test::reportFailure(__FILE__, __LINE__, #__VA_ARGS__);           \
+        }                                                                                           \
+    } while (false)
+
+// Stops the test when the rest of it would not make sense, e.g. after an allocation failed.
+#define GFX_REQUIRE(...)                                                                            \
+    do {                                                                                            \
+        if (!(__VA_ARGS__)) {                                                                       \
+            ::winui_drover_island::test::reportFailure(__FILE__, __LINE__, #__VA_ARGS__);           \
+            return;                                                                                 \
+        }                                                                                           \
+    } while (false)
+
+#define GFX_CHECK_EQ(a, b) GFX_CHECK((a) == (b))
@@ -0,0 +1,57 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxTest.h"
+
+#include <cstring>
+
+namespace winui_drover_island {
+namespace test {
+
+namespace {
+int gFailureCount = 0;
+}  // namespace
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+void reportFailure(const char* file, int line, const char* expression) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++gFailureCount;
+}
+
+}  // namespace test
+}  // namespace winui_drover_island
+
+// Runs every test, or only those whose name contains the first argument.
+int main(int argc, char** argv) {
+    using namespace winui_drover_island::test;
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int failedTests = 0;
+    int ranTests = 0;
+    for (const auto& testCase : registry()) {
+        if (filter && !std::strstr(testCase.name, filter)) {
+            continue;
+        }
+        int failuresBefore = gFailureCount;
+        testCase.body();
+        ++ranTests;
+        bool failed = gFailureCount != failuresBefore;
+        failedTests += failed ? 1 : 0;
+        std::printf("[%s] %s\n", failed ? "FAILED" : "  OK  ", testCase.name);
+    }
+    std::printf("%d of %d tests passed\n", ranTests - failedTests, ranTests);
+    return failedTests == 0 ? 0 : 1;
+}
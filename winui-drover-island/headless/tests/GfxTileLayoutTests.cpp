@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <vector>
+
+#include "./GfxTest.h"
+#include "./GfxTileLayout.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(NeedsTilingOnlyPastTheMaximumSize) {
+    GFX_CHECK(!GfxTileLayout::needsTiling(4096, 4096, 4096));
+    GFX_CHECK(GfxTileLayout::needsTiling(4097, 10, 4096));
+    GFX_CHECK(GfxTileLayout::needsTiling(10, 4097, 4096));
+}
+
+GFX_TEST(TilesCoverTheSurfaceExactlyOnce) {
+    GfxTileLayout layout(10000, 5000, 4096);
+    GFX_CHECK_EQ(layout.columns(), 3);
+    GFX_CHECK_EQ(layout.rows(), 2);
+    GFX_REQUIRE(layout.tileCount() == 6u);
+
+    int64_t area = 0;
+    for (size_t i = 0; i < layout.tileCount(); ++i) {
+        auto rect = layout.tileRect(i);
+        GFX_CHECK(rect.width() <= 4096 && rect.height() <= 4096);
+        GFX_CHECK(PixelRect{0, 0, 10000, 5000}.contains(rect));
+        for (size_t j = i + 1; j < layout.tileCount(); ++j) {
+            GFX_CHECK(!rect.intersects(layout.tileRect(j)));
+        }
+        area += rect.area();
+    }
+    GFX_CHECK_EQ(area, int64_t{10000} * 5000);
+}
+
+GFX_TEST(LastColumnAndRowAreSmaller) {
+    GfxTileLayout layout(10000, 5000, 4096);
+    GFX_CHECK(layout.tileRect(2) == (PixelRect{8192, 0, 10000, 4096}));
+    GFX_CHECK(layout.tileRect(5) == (PixelRect{8192, 4096, 10000, 5000}));
+}
+
+GFX_TEST(ForEachTileIntersectingVisitsOnlyTouchedTilesInOrder) {
+    GfxTileLayout layout(10000, 5000, 4096);
+    std::vector<size_t> visited;
+    layout.forEachTileIntersecting(PixelRect{4000, 4000, 4200, 4200}, [&](size_t index, const PixelRect& rect) {
+        GFX_CHECK(rect == layout.tileRect(index));
+        visited.push_back(index);
+    });
+    GFX_CHECK_EQ(visited, (std::vector<size_t>{0, 1, 3, 4}));
+
+    // Right and bottom edges are exclusive: a rect ending on a tile boundary stays in one tile.
+    visited.clear();
+    layout.forEachTileIntersecting(PixelRect{0, 0, 4096, 4096}, [&](size_t index, const PixelRect&) {
+        visited.push_back(index);
+    });
+    GFX_CHECK_EQ(visited, std::vector<size_t>{0});
+}
+
+GFX_TEST(ForEachTileIntersectingClipsToTheSurface) {
+    GfxTileLayout layout(5000, 5000, 4096);
+    int visits = 0;
+    layout.forEachTileIntersecting(PixelRect{6000, 6000, 7000, 7000}, [&](size_t, const PixelRect&) { visits++; });
+    GFX_CHECK_EQ(visits, 0);
+    layout.forEachTileIntersecting(PixelRect{-100, -100, 10000, 10}, [&](size_t, const PixelRect&) { visits++; });
+    GFX_CHECK_EQ(visits, 2);
+    layout.forEachTileIntersecting(PixelRect{}, [&](size_t, const PixelRect&) { visits++; });
+    GFX_CHECK_EQ(visits, 2);
+}
+
+GFX_TEST(SurfaceSmallerThanATileIsOneTile) {
+    GfxTileLayout layout(300, 200, 4096);
+    GFX_REQUIRE(layout.tileCount() == 1u);
+    GFX_CHECK(layout.tileRect(0) == (PixelRect{0, 0, 300, 200}));
+}
@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <filesystem>
+#include <vector>
+
+#include "./GfxTest.h"
+#include "./GfxTiledImage.h"
+
+using namespace winui_drover_island;
+
+namespace {
+
+// Every pixel tells where it is, so a tile read from the wrong place shows.
+uint32_t pixelAt(int32_t x, int32_t y) {
+    return 0xff000000u | (static_cast<uint32_t>(x & 0xfff) << 12) | static_cast<uint32_t>(y & 0xfff);
+}
+
+// Removed with the test, whatever the outcome.
+class TemporaryImage {
+ public:
+    TemporaryImage(const char* name, int32_t width, int32_t height, int32_t tileSize)
+        : path_(std::filesystem::temp_directory_path() / name) {
+        written_ = GfxTiledImage::write(path_, width, height, tileSize, [](const PixelRect& rect, uint8_t* pixels, size_t stride) {
+            for (int32_t y = 0; y < rect.height(); ++y) {
+                auto* row = reinterpret_cast<uint32_t*>(pixels + stride * y);
+                for (int32_t x = 0; x < rect.width(); ++x) {
+                    row[x] = pixelAt(rect.left + x, rect.top + y);
+                }
+            }
+        });
+    }
+    ~TemporaryImage() {
+        std::error_code error;
+        std::filesystem::remove(path_, error);
+    }
+
+    const std::filesystem::path& path() const { return path_; }
+    bool written() const { return written_; }
+
+ private:
+    std::filesystem::path path_;
+    bool written_ = false;
+};
+
+}  // namespace
+
+GFX_TEST(WrittenTilesReadBack) {
+    TemporaryImage file("GfxTiledImageTests-read.gtim", 300, 200, 64);
+    GFX_REQUIRE(file.written());
+    GfxTiledImage image;
+    GFX_REQUIRE(image.open(file.path()));
+    GFX_CHECK_EQ(image.width(), 300);
+    GFX_CHECK_EQ(image.height(), 200);
+    GFX_CHECK_EQ(image.columns(), 5);
+    GFX_CHECK_EQ(image.rows(), 4);
+
+    for (auto tile : {GfxTiledImage::Tile{0, 0}, GfxTiledImage::Tile{2, 1}, GfxTiledImage::Tile{4, 3}}) {
+        auto rect = image.tileRect(tile);
+        const auto* pixels = image.tilePixels(tile);
+        bool same = true;
+        for (int32_t y = 0; y < rect.height(); ++y) {
+            const auto* row = reinterpret_cast<const uint32_t*>(pixels + image.tileStride() * y);
+            for (int32_t x = 0; x < rect.width(); ++x) {
+                same = same && row[x] == pixelAt(rect.left + x, rect.top + y);
+            }
+        }
+        GFX_CHECK(same);
+    }
+}
+
+GFX_TEST(EdgeTilesAreClippedToTheImage) {
+    TemporaryImage file("GfxTiledImageTests-edge.gtim", 300, 200, 64);
+    GFX_REQUIRE(file.written());
+    GfxTiledImage image;
+    GFX_REQUIRE(image.open(file.path()));
+    auto rect = image.tileRect({4, 3});
+    GFX_CHECK(rect == (PixelRect{256, 192, 300, 200}));
+    // The padding is cleared.
+    const auto* row = reinterpret_cast<const uint32_t*>(image.tilePixels({4, 3}));
+    GFX_CHECK_EQ(row[rect.width()], 0u);
+}
+
+GFX_TEST(TilesIntersectingAreListedRowByRow) {
+    TemporaryImage file("GfxTiledImageTests-intersect.gtim", 300, 200, 64);
+    GFX_REQUIRE(file.written());
+    GfxTiledImage image;
+    GFX_REQUIRE(image.open(file.path()));
+
+    std::vector<GfxTiledImage::Tile> tiles;
+    image.tilesIntersecting(PixelRect{60, 10, 130, 70}, tiles);
+    GFX_REQUIRE(tiles.size() == 6u);
+    GFX_CHECK(tiles[0].column == 0 && tiles[0].row == 0);
+    GFX_CHECK(tiles[2].column == 2 && tiles[2].row == 0);
+    GFX_CHECK(tiles[3].column == 0 && tiles[3].row == 1);
+    GFX_CHECK_EQ(image.tileCountIntersecting(PixelRect{60, 10, 130, 70}), 6u);
+
+    // Clipped to the image, whatever the rect.
+    GFX_CHECK_EQ(image.tileCountIntersecting(PixelRect{-1000, -1000, 10000, 10000}), 20u);
+    GFX_CHECK_EQ(image.tileCountIntersecting(PixelRect{300, 0, 400, 200}), 0u);
+    GFX_CHECK_EQ(image.tileCountIntersecting(PixelRect{}), 0u);
+}
+
+GFX_TEST(ReadAheadFollowsTheMove) {
+    const PixelRect previous{100, 100, 200, 200};
+    GFX_CHECK(GfxTiledImage::readAheadRect(previous, previous.translated(10, 0), 50) == (PixelRect{110, 100, 260, 200}));
+    GFX_CHECK(GfxTiledImage::readAheadRect(previous, previous.translated(-10, 5), 50) == (PixelRect{40, 105, 190, 255}));
+    GFX_CHECK(GfxTiledImage::readAheadRect(previous, previous.translated(0, -20), 50) == (PixelRect{100, 30, 200, 180}));
+    // Nothing to read ahead without a move.
+    GFX_CHECK(GfxTiledImage::readAheadRect(previous, previous, 50).isEmpty());
+    GFX_CHECK(GfxTiledImage::readAheadRect(PixelRect{}, previous, 50).isEmpty());
+    GFX_CHECK(GfxTiledImage::readAheadRect(previous, previous.translated(10, 0), 0).isEmpty());
+}
+
+GFX_TEST(InvalidFilesDontOpen) {
+    GfxTiledImage image;
+    GFX_CHECK(!image.open(std::filesystem::temp_directory_path() / "GfxTiledImageTests-missing.gtim"));
+    GFX_CHECK(!GfxTiledImage::write(std::filesystem::temp_directory_path() / "GfxTiledImageTests-invalid.gtim", 0, 10, 64,
+        [](const PixelRect&, uint8_t*, size_t) {}));
+
+    TemporaryImage file("GfxTiledImageTests-truncated.gtim", 300, 200, 64);
+    GFX_REQUIRE(file.written());
+    auto size = std::filesystem::file_size(file.path());
+    std::filesystem::resize_file(file.path(), size - 1);
+    GFX_CHECK(!image.open(file.path()));
+    GFX_CHECK(!image.isOpen());
+}
@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#include "./GfxTest.h"
+#include "./GfxUnits.h"
+
+using namespace winui_drover_island;
+
+GFX_TEST(DipsToPixelsRounds) {
+    GFX_CHECK_EQ(dipsToPixels(10.f, 144.f, DpiRounding::kFloor), 15);
+    GFX_CHECK_EQ(dipsToPixels(10.5f, 144.f, DpiRounding::kFloor), 15);
+    GFX_CHECK_EQ(dipsToPixels(10.5f, 144.f, DpiRounding::kCeiling), 16);
+    // 15.75 pixels.
+    GFX_CHECK_EQ(dipsToPixels(10.5f, 144.f, DpiRounding::kRound), 16);
+    // Halves away from zero, negatives floor down.
+    GFX_CHECK_EQ(dipsToPixels(1.f, 144.f, DpiRounding::kRound), 2);
+    GFX_CHECK_EQ(dipsToPixels(-1.f, 144.f, DpiRounding::kRound), -2);
+    GFX_CHECK_EQ(dipsToPixels(-1.f, 144.f, DpiRounding::kFloor), -2);
+    GFX_CHECK_EQ(dipsToPixels(-1.f, 144.f, DpiRounding::kCeiling), -1);
+    GFX_CHECK_EQ(dipsToPixels(7.f, kDefaultDpi, DpiRounding::kFloor), 7);
+    GFX_CHECK(pixelsToDips(15, 144.f) == 10.f);
+}
+
+GFX_TEST(SizesNeverRoundToZero) {
+    GFX_CHECK_EQ(sizeDipsToPixels(0.1f, kDefaultDpi), 1);
+    GFX_CHECK_EQ(sizeDipsToPixels(0.f, 192.f), 0);
+    GFX_CHECK_EQ(sizeDipsToPixels(-0.1f, kDefaultDpi), 0);
+    GFX_CHECK_EQ(sizeDipsToPixels(100.f, 120.f), 125);
+}
+
+GFX_TEST(RectsKeepAtLeastOnePixel) {
+    // The edges are rounded on their own, a thin rect that isn't empty gets a pixel.
+    auto rect = toPixelRect(DipRect{10.1f, 10.1f, 0.1f, 0.1f}, kDefaultDpi);
+    GFX_CHECK(rect == (PixelRect{10, 10, 11, 11}));
+    GFX_CHECK(toPixelRect(DipRect{10.f, 10.f, 0.f, 5.f}, kDefaultDpi).isEmpty());
+    GFX_CHECK(toPixelRect(DipRect{10.f, 20.f, 30.f, 40.f}, 192.f) == (PixelRect{20, 40, 80, 120}));
+    auto dips = toDipRect(PixelRect{15, 30, 45, 60}, 144.f);
+    GFX_CHECK(dips.x == 10.f && dips.y == 20.f && dips.width == 20.f && dips.height == 20.f);
+}
+
+GFX_TEST(PixelRectsRoundTripThroughDips) {
+    int32_t mismatches = 0;
+    for (float dpi : {96.f, 120.f, 144.f, 168.f, 192.f, 288.f}) {
+        for (int i = 0; i < 1000; ++i) {
+            int32_t left = std::rand() % 4000 - 2000;
+            int32_t top = std::rand() % 4000 - 2000;
+            PixelRect rect{left, top, left + 1 + std::rand() % 500, top + 1 + std::rand() % 500};
+            mismatches += toPixelRect(toDipRect(rect, dpi), dpi) != rect;
+        }
+    }
+    GFX_CHECK_EQ(mismatches, 0);
+}
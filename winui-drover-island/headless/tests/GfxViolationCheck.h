@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+#include "./GfxAllocationCounter.h"
+
+namespace winui_drover_island {
+namespace test {
+
+// For the tests built against the library counting allocations: any allocation in a
+// GfxNoAllocationScope fails the test, the way the assert does in a debug build of the app.
+inline uint64_t gViolations = 0;
+
+inline void recordViolation(const char* site, uint64_t allocationCount) {
+    std::fprintf(stderr, "%s: %llu heap allocations\n", site, static_cast<unsigned long long>(allocationCount));
+    gViolations++;
+}
+
+// Counts the violations of the scopes ended during its lifetime.
+struct ViolationCheck {
+    ViolationCheck() {
+        gViolations = 0;
+        GfxNoAllocationScope::setViolationHandler(&recordViolation);
+    }
+    ~ViolationCheck() { GfxNoAllocationScope::setViolationHandler(nullptr); }
+
+    ViolationCheck(ViolationCheck const&) = delete;
+    ViolationCheck& operator=(ViolationCheck const&) = delete;
+
+    uint64_t violations() const { return gViolations; }
+};
+
+}  // namespace test
+}  // namespace winui_drover_island
@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxTest.h"
+#include "./GfxVisibilityTracker.h"
+
+using namespace winui_drover_island;
+using State = GfxVisibilityTracker::State;
+using std::chrono::milliseconds;
+
+namespace {
+const GfxVisibilityTracker::Clock::time_point kStart{};
+}  // namespace
+
+GFX_TEST(ReleasesOnlyAfterTheGracePeriod) {
+    GfxVisibilityTracker tracker(milliseconds(100));
+    tracker.onHidden(kStart);
+    GFX_CHECK(tracker.state() == State::kHidden);
+    GFX_CHECK(!tracker.shouldRelease(kStart + milliseconds(99)));
+    GFX_CHECK(tracker.remainingGrace(kStart + milliseconds(40)) == milliseconds(60));
+    GFX_CHECK(tracker.shouldRelease(kStart + milliseconds(100)));
+}
+
+GFX_TEST(ShownDuringTheGracePeriodKeepsTheSurface) {
+    GfxVisibilityTracker tracker(milliseconds(100));
+    tracker.onHidden(kStart);
+    GFX_CHECK(!tracker.onShown(kStart + milliseconds(50)));
+    GFX_CHECK(tracker.state() == State::kVisible);
+    GFX_CHECK(!tracker.shouldRelease(kStart + milliseconds(200)));
+}
+
+GFX_TEST(MeasuresTheRestoreLatency) {
+    GfxVisibilityTracker tracker(milliseconds(100));
+    tracker.onHidden(kStart);
+    tracker.onReleased(4096);
+    GFX_CHECK(tracker.state() == State::kReleased);
+    GFX_CHECK(tracker.onShown(kStart + milliseconds(500)));
+    GFX_CHECK(tracker.state() == State::kRestoring);
+    GFX_CHECK(tracker.isVisible());
+    tracker.onPresented(kStart + milliseconds(520));
+    GFX_CHECK(tracker.state() == State::kVisible);
+    GFX_CHECK_EQ(tracker.stats().restoreCount, 1u);
+    GFX_CHECK_EQ(tracker.stats().bytesReleased, 4096u);
+    GFX_CHECK(tracker.stats().lastRestoreLatency == milliseconds(20));
+}
+
+// The surface may be re-created before the first frame is presented: hiding the control again
+// must start a new grace period, otherwise that surface would never be released.
+GFX_TEST(HiddenWhileRestoringGetsANewGracePeriod) {
+    GfxVisibilityTracker tracker(milliseconds(100));
+    tracker.onHidden(kStart);
+    tracker.onReleased(4096);
+    tracker.onShown(kStart + milliseconds(500));
+    tracker.onHidden(kStart + milliseconds(510));
+    GFX_CHECK(tracker.state() == State::kHidden);
+    GFX_CHECK(!tracker.shouldRelease(kStart + milliseconds(600)));
+    GFX_CHECK(tracker.shouldRelease(kStart + milliseconds(610)));
+    tracker.onReleased(4096);
+    GFX_CHECK(tracker.state() == State::kReleased);
+    GFX_CHECK_EQ(tracker.stats().releaseCount, 2u);
+}
+
+GFX_TEST(ReleasedByTheBudgetWhileHidden) {
+    GfxVisibilityTracker tracker(milliseconds(100));
+    tracker.onHidden(kStart);
+    tracker.onReleased(100);
+    GFX_CHECK(tracker.state() == State::kReleased);
+    GFX_CHECK(!tracker.shouldRelease(kStart + milliseconds(200)));
+}
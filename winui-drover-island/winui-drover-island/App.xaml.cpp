@@ -14,6 +14,11 @@
 #include "pch.h"
 
 #include "App.xaml.h"
+#include "GfxCompressedTileStore.h"
+#include "GfxD2DDeviceManager.h"
+#include "GfxMemoryBudget.h"
+#include "GfxSnapshotStore.h"
+#include "GfxUtils.h"
 
 using namespace winrt;
 using namespace Windows::Foundation;
@@ -54,9 +59,17 @@ App::App()
 /// <param name="e">Details about the launch request and process.</param>
 void App::OnLaunched(LaunchActivatedEventArgs const&)
 {
+    ::winui_drover_island::GfxLog::instance().start(std::make_unique<::winui_drover_island::GfxDebugOutputLogSink>());
+
     mWindow.create();
     mWindow.addContent();
     mWindow.show();
+
+    mMemoryPressureMonitor.start(Microsoft::System::DispatcherQueue::GetForCurrentThread(), [this]() {
+        TrimGraphicsMemory();
+        // The system is short of memory, not only graphics memory: parked layers are dropped too.
+        ::winui_drover_island::GfxCompressedTileStore::instance().clear();
+    });
 }
 
 /// <summary>
@@ -69,4 +82,16 @@ void App::OnLaunched(LaunchActivatedEventArgs const&)
 void App::OnSuspending([[maybe_unused]] IInspectable const& sender, [[maybe_unused]] Windows::ApplicationModel::SuspendingEventArgs const& e)
 {
     // Save application state and stop any background activity
+    ::winui_drover_island::GfxSnapshotStore::instance().saveAll();
+    TrimGraphicsMemory();
+}
+
+/// <summary>
+/// Releases the graphics memory that can be re-created on demand: surfaces of controls that are
+/// not visible, and the cached resources of the shared devices.
+/// </summary>
+void App::TrimGraphicsMemory()
+{
+    ::winui_drover_island::GfxMemoryBudget::instance().trim();
+    ::winui_drover_island::GfxD2DDeviceManager::instance().trim();
 }
\ No newline at end of file
@@ -17,6 +17,7 @@
 #undef GetCurrentTime
 
 #include "App.xaml.g.h"
+#include "GfxMemoryPressureMonitor.h"
 #include "WinUIWindow.h"
 
 #pragma pop_macro("GetCurrentTime")
@@ -31,6 +32,9 @@ namespace winrt::winui_drover_island::implementation
         void OnSuspending(IInspectable const&, Windows::ApplicationModel::SuspendingEventArgs const&);
 
     private:
+        void TrimGraphicsMemory();
+
         ::winui_drover_island::WinUIWindow mWindow;
+        ::winui_drover_island::GfxMemoryPressureMonitor mMemoryPressureMonitor;
     };
 }
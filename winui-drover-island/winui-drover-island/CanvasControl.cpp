@@ -20,12 +20,18 @@
 #include <ddraw.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
 
 #include "winrt/base.h"
 #include "winrt/Microsoft.UI.Xaml.Automation.Peers.h"
 #include "winrt/Microsoft.System.h"
 
-#include "./GfxUtils.h"
+#include "./GfxAllocationCounter.h"
+#include "./GfxEventTrace.h"
+#include "./GfxImageService.h"
+#include "./GfxSnapshotRenderer.h"
 #include "CanvasControl.g.cpp"
 
 namespace winrt {
@@ -44,6 +50,14 @@ namespace winrt::winui_drover_island::implementation {
 
 namespace {
 
+// How long after the last interaction the control renders again at full resolution.
+constexpr winrt::TimeSpan kInteractionIdleDelay = std::chrono::milliseconds(150);
+
+uint64_t nextControlId() {
+    static std::atomic<uint64_t> sNextControlId{1};
+    return sNextControlId.fetch_add(1, std::memory_order_relaxed);
+}
+
 class VirtualSurfaceCallback : public winrt::implements<VirtualSurfaceCallback, IVirtualSurfaceUpdatesCallbackNative> {
 public:
     explicit VirtualSurfaceCallback(std::function<HRESULT()>&& fn) : callback_(std::move(fn)) {}
@@ -60,32 +74,61 @@ private:
 
 }
 
-CanvasControl::CanvasControl(bool useVSIS) : containerDpi_(kDefaultDpi), useVSIS_(useVSIS) {
-    Image image;
-    Content(image);
-    image.Stretch(winrt::Stretch::Fill);
-
-    winrt::AutomationProperties::SetAccessibilityView(image, winrt::Peers::AccessibilityView::Raw);
+CanvasControl::CanvasControl(bool useVSIS)
+    : containerDpi_(kDefaultDpi),
+      frameClock_(GfxVsyncFrameClock::shared()),
+      controlId_(nextControlId()),
+      compositor_(*this, controlId_),
+      effects_(controlId_),
+      useVSIS_(useVSIS) {
+    createImagePresenter();
 
     loadedHandler_ = Loaded(winrt::auto_revoke, { this, &CanvasControl::onContainerLoaded });
     SizeChanged({ this, &CanvasControl::onContainerSizeChanged });
+    visibilityChangedToken_ =
+        RegisterPropertyChangedCallback(winrt::UIElement::VisibilityProperty(), { this, &CanvasControl::onVisibilityChanged });
 }
 
 CanvasControl::~CanvasControl() {
-    if (renderingPending_) {
-        removeRenderingCallback();
+    if (graceTimer_) {
+        graceTimer_.Stop();
+    }
+    if (staleDeadlineTimer_) {
+        staleDeadlineTimer_.Stop();
+    }
+    if (interactionIdleTimer_) {
+        interactionIdleTimer_.Stop();
+    }
+    if (hudTimer_) {
+        hudTimer_.Stop();
+    }
+    UnregisterPropertyChangedCallback(winrt::UIElement::VisibilityProperty(), visibilityChangedToken_);
+    if (framePending_) {
+        cancelFrame();
     }
     resetRenderTarget();
+    releaseRetiredBudgetEntry();
+    if (!snapshotName_.empty()) {
+        GfxSnapshotStore::instance().removeSource(this);
+    }
 }
 
 void CanvasControl::onContainerLoaded(const winrt::IInspectable& sender, const winrt::RoutedEventArgs&) {
     auto container = sender.try_as<FrameworkElement>();
-    // We only want to get a single loaded event.
     // In Xaml Loaded / Unloaded event are async, and are not called in a deterministic order,
-    // so we don't want to rely on them. We only register all the events on load.
-    loadedHandler_.revoke();
+    // so we don't rely on their order. We register all the events on the first load, and later
+    // on only look at IsLoaded to know whether we are still in the tree.
+    attached_ = IsLoaded();
+    if (loaded_) {
+        updateShownState();
+        return;
+    }
+
+    unloadedHandler_ = Unloaded(winrt::auto_revoke, {this, &CanvasControl::onContainerUnloaded});
+    viewportChangedHandler_ = EffectiveViewportChanged(winrt::auto_revoke, {this, &CanvasControl::onEffectiveViewportChanged});
 
     containerDpi_ = static_cast<float>(container.XamlRoot().RasterizationScale() * kDefaultDpi);
+    GfxEventRecorder::instance().record(controlId_, GfxEventRecorder::EventKind::kDpiChange, containerDpi_);
     rootChangedHandler_ = container.XamlRoot().Changed(winrt::auto_revoke, {this, &CanvasControl::onRootChanged});
 
     compositorSurfaceLostHandler_ =
@@ -101,14 +144,38 @@ void CanvasControl::onContainerLoaded(const winrt::IInspectable& sender, const w
     }
 
     loaded_ = true;
+    showSnapshot();
     invalidateDueToInternalChange();
 }
 
+void CanvasControl::onContainerUnloaded(const winrt::IInspectable&, const winrt::RoutedEventArgs&) {
+    attached_ = IsLoaded();
+    updateShownState();
+}
+
+void CanvasControl::onEffectiveViewportChanged(const FrameworkElement&, const winrt::EffectiveViewportChangedEventArgs& args) {
+    // The effective viewport is in our coordinate space, we are visible if it intersects our bounds.
+    auto viewport = args.EffectiveViewport();
+    bool inViewport = viewport.Width > 0 && viewport.Height > 0 && viewport.X < containerSize_.Width &&
+                      viewport.Y < containerSize_.Height && viewport.X + viewport.Width > 0 &&
+                      viewport.Y + viewport.Height > 0;
+    if (inViewport != inViewport_) {
+        inViewport_ = inViewport;
+        updateShownState();
+    }
+}
+
 void CanvasControl::onContainerSizeChanged(
     const winrt::IInspectable&, const winrt::SizeChangedEventArgs& e) {
     auto newSize = e.NewSize();
     if (newSize != containerSize_) {
+        GfxEventRecorder::instance().record(controlId_, GfxEventRecorder::EventKind::kResize, newSize.Width, newSize.Height);
+        if (dynamicResolution_ && containerSize_.Width > 0 && containerSize_.Height > 0) {
+            notifyInteraction();
+        }
+        beginStalePresentation();
         containerSize_ = newSize;
+        showSnapshot();
         invalidateDueToInternalChange();
     }
 }
@@ -116,70 +183,496 @@ void CanvasControl::onContainerSizeChanged(
 void CanvasControl::onRootChanged(const XamlRoot& root, const winrt::Microsoft::UI::Xaml::XamlRootChangedEventArgs&) {
     float newDpi = static_cast<float>(root.RasterizationScale() * kDefaultDpi);
     if (newDpi != containerDpi_) {
+        GfxEventRecorder::instance().record(controlId_, GfxEventRecorder::EventKind::kDpiChange, newDpi);
+        beginStalePresentation();
         containerDpi_ = newDpi;
         invalidateDueToInternalChange();
     }
 }
 
-void CanvasControl::setupRenderingCallback() {
-    assert(!renderingPending_);
-    compositorRenderingHandler_ = winrt::CompositionTarget::Rendering(winrt::auto_revoke, {this, &CanvasControl::onCompositorDraw});
-    renderingPending_ = true;
+void CanvasControl::onVisibilityChanged(const winrt::DependencyObject&, const winrt::DependencyProperty&) {
+    updateShownState();
+}
+
+void CanvasControl::setHiddenSurfaceGracePeriod(winrt::TimeSpan gracePeriod) {
+    visibilityTracker_.setGracePeriod(std::chrono::duration_cast<GfxVisibilityTracker::Clock::duration>(gracePeriod));
+}
+
+void CanvasControl::updateShownState() {
+    if (!loaded_) {
+        return;
+    }
+    auto now = GfxVisibilityTracker::Clock::now();
+    bool shown = isShown();
+    GfxMemoryBudget::instance().setVisible(budgetEntry_, shown);
+    compositor_.setVisible(shown);
+    effects_.setVisible(shown);
+
+    if (!shown) {
+        visibilityTracker_.onHidden(now);
+        // Parked controls keep their surface until the cache or the memory budget drops it.
+        if (!parked_ && visibilityTracker_.state() == GfxVisibilityTracker::State::kHidden) {
+            if (!graceTimer_) {
+                graceTimer_ = DispatcherQueue().CreateTimer();
+                graceTimer_.IsRepeating(false);
+                graceTimerHandler_ = graceTimer_.Tick(winrt::auto_revoke, {this, &CanvasControl::onGraceTimerTick});
+            }
+            graceTimer_.Interval(std::chrono::duration_cast<winrt::TimeSpan>(visibilityTracker_.remainingGrace(now)));
+            graceTimer_.Start();
+        }
+        return;
+    }
+
+    if (graceTimer_) {
+        graceTimer_.Stop();
+    }
+    bool released = visibilityTracker_.onShown(now);
+    if (released || redrawWhenShown_ || !currentTarget_.hasSurface()) {
+        redrawWhenShown_ = false;
+        invalidateDueToInternalChange();
+    }
+}
+
+void CanvasControl::onGraceTimerTick(const winrt::DispatcherQueueTimer&, const winrt::IInspectable&) {
+    // The timer may have been started before the control was parked.
+    if (!parked_ && visibilityTracker_.shouldRelease(GfxVisibilityTracker::Clock::now())) {
+        evictSurface();
+    }
+}
+
+void CanvasControl::setParked(bool parked) {
+    if (parked == parked_) {
+        return;
+    }
+    parked_ = parked;
+    if (parked_) {
+        if (graceTimer_) {
+            graceTimer_.Stop();
+        }
+        return;
+    }
+    // Still detached: the grace period starts now.
+    updateShownState();
+}
+
+bool CanvasControl::isContentReady() const {
+    return currentTarget_.hasSurface() && !framePending_ && !damage_.isPending() && !redrawWhenShown_ && !virtualUpdatesPending_;
+}
+
+void CanvasControl::requestFrame() {
+    assert(!framePending_);
+    frameClock_->requestFrame(this);
+    framePending_ = true;
+}
+
+void CanvasControl::cancelFrame() {
+    assert(framePending_);
+    frameClock_->cancelFrame(this);
+    framePending_ = false;
+}
+
+void CanvasControl::setFrameClock(std::shared_ptr<GfxFrameClock> clock) {
+    assert(clock);
+    if (clock == frameClock_) {
+        return;
+    }
+    bool framePending = framePending_;
+    if (framePending) {
+        cancelFrame();
+    }
+    frameClock_ = std::move(clock);
+    if (framePending) {
+        requestFrame();
+    }
+}
+
+void CanvasControl::setDynamicResolution(bool enabled, const GfxResolutionScaler::Options& options) {
+    dynamicResolution_ = enabled && !useVSIS_;
+    resolutionScaler_.setOptions(options);
+    if (!dynamicResolution_) {
+        resolutionScaler_.reset();
+    }
+}
+
+void CanvasControl::beginInteraction() {
+    interactionDepth_++;
+}
+
+void CanvasControl::endInteraction() {
+    assert(interactionDepth_ > 0);
+    interactionDepth_--;
+    if (interactionDepth_ == 0) {
+        notifyInteraction();
+    }
+}
+
+void CanvasControl::notifyInteraction() {
+    if (!dynamicResolution_) {
+        return;
+    }
+    if (!interactionIdleTimer_) {
+        interactionIdleTimer_ = DispatcherQueue().CreateTimer();
+        interactionIdleTimer_.IsRepeating(false);
+        interactionIdleTimer_.Interval(kInteractionIdleDelay);
+        interactionIdleTimerHandler_ = interactionIdleTimer_.Tick(winrt::auto_revoke, {this, &CanvasControl::onInteractionIdle});
+    }
+    // Restarting the timer pushes the refinement back.
+    interactionIdleTimer_.Stop();
+    interactionIdleTimer_.Start();
+    interactionIdlePending_ = true;
+}
+
+bool CanvasControl::isInteracting() const {
+    return dynamicResolution_ && (interactionDepth_ > 0 || interactionIdlePending_);
+}
+
+float CanvasControl::renderDpi() const {
+    return isInteracting() ? containerDpi_ * resolutionScaler_.scale() : containerDpi_;
+}
+
+void CanvasControl::onInteractionIdle(const winrt::DispatcherQueueTimer&, const winrt::IInspectable&) {
+    interactionIdlePending_ = false;
+    if (isInteracting()) {
+        return;
+    }
+    // Refines the last reduced resolution frame; the scale is kept for the next interaction.
+    if (currentTarget_.hasSurface() && currentTarget_.dpi_ != containerDpi_) {
+        invalidate();
+    }
+}
+
+void CanvasControl::setIsOpaque(bool isOpaque) {
+    assert(!loaded_);
+    isOpaque_ = isOpaque;
+}
+
+void CanvasControl::setSnapshotName(std::wstring name) {
+    assert(!loaded_);
+    auto& store = GfxSnapshotStore::instance();
+    if (!snapshotName_.empty()) {
+        store.removeSource(this);
+    }
+    snapshotName_ = std::move(name);
+    if (!snapshotName_.empty()) {
+        store.addSource(this);
+    }
+}
+
+void CanvasControl::showSnapshot() {
+    // Only the first frame of the control is worth it, later ones have the device ready.
+    if (snapshotName_.empty() || snapshotChecked_ || !loaded_ || containerSize_.Width <= 0 || containerSize_.Height <= 0) {
+        return;
+    }
+    snapshotChecked_ = true;
+    auto image = containerImage();
+    if (!image || image.Source() || currentTarget_.hasSurface()) {
+        return;
+    }
+
+    // The surface replaces the bitmap when the first frame is presented.
+    HRESULT hr = ComExceptionBoundary([&] {
+        if (auto bitmap = GfxSnapshotRenderer::load(snapshotKey())) {
+            image.Source(bitmap);
+        }
+    });
+    LogIfFailed(hr, "showSnapshot", controlId_);
+}
+
+void CanvasControl::saveSnapshot() {
+    // Only what is on screen is worth showing at the next launch.
+    if (!device_ || asyncResetPending_ || !currentTarget_.hasSurface() || !isShown()) {
+        return;
+    }
+    auto key = snapshotKey();
+    auto maximumSize = static_cast<int32_t>(std::min<uint32_t>(device_->maximumBitmapSizeInPixels(), INT32_MAX));
+    if (key.widthInPixels <= 0 || key.heightInPixels <= 0 || key.widthInPixels > maximumSize || key.heightInPixels > maximumSize) {
+        // Tiled controls are too large for a single bitmap, they don't get a snapshot.
+        GfxSnapshotStore::instance().remove(snapshotName_);
+        return;
+    }
+    auto result = runWithDevice([&]() {
+        return GfxSnapshotRenderer::capture(*device_, key, D2D1::SizeF(containerSize_.Width, containerSize_.Height),
+            [&](const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F& rect) {
+                compositor_.draw(context, layerTarget(false), rect);
+            });
+    });
+    LogIfFailed(result, "saveSnapshot", controlId_);
+}
+
+GfxSnapshotStore::Key CanvasControl::snapshotKey() const {
+    return GfxSnapshotStore::Key{snapshotName_, sizeDipsToPixels(containerSize_.Width, containerDpi_),
+        sizeDipsToPixels(containerSize_.Height, containerDpi_), containerDpi_};
 }
 
-void CanvasControl::removeRenderingCallback() {
-    assert(renderingPending_);
-    compositorRenderingHandler_.revoke();
-    renderingPending_ = false;
+void CanvasControl::setUseAtlas(bool useAtlas) {
+    assert(!loaded_);
+    useAtlas_ = useAtlas && !useVSIS_;
 }
 
 winrt::Image CanvasControl::containerImage() {
     return Content().try_as<winrt::Image>();
 }
 
+winrt::Image CanvasControl::createImagePresenter() {
+    if (auto rectangle = Content().try_as<winrt::Shapes::Rectangle>()) {
+        // The atlas slot was released: its brush must not keep the shared atlas surface alive, nor
+        // show a slot handed to another control, for as long as the rectangle lingers.
+        rectangle.Fill(nullptr);
+    }
+    Image image;
+    Content(image);
+    image.Stretch(winrt::Stretch::Fill);
+
+    winrt::AutomationProperties::SetAccessibilityView(image, winrt::Peers::AccessibilityView::Raw);
+    return image;
+}
+
 void CanvasControl::setImageSource(winrt::Imaging::SurfaceImageSource newSource) {
-    if (auto image = containerImage()) {
+    auto image = containerImage();
+    if (!image && newSource) {
+        // We were presenting a slot of an atlas until now.
+        image = createImagePresenter();
+    }
+    if (image) {
         image.Source(newSource);
     }
+    releaseRetiredBudgetEntry();
 }
 
 void CanvasControl::resetImageSource() {
-    setImageSource(nullptr);
+    endStalePresentation();
+    if (auto image = containerImage()) {
+        image.Source(nullptr);
+    } else {
+        // Don't keep showing tiles or an atlas slot we don't own anymore.
+        createImagePresenter();
+    }
+    releaseRetiredBudgetEntry();
+}
+
+void CanvasControl::setTiledPresenter() {
+    const auto& layout = currentTarget_.tileLayout_;
+    const auto dpi = currentTarget_.dpi_;
+    assert(currentTarget_.tiles_.size() == layout.tileCount());
+
+    // Tile edges fall on pixel boundaries, layout rounding would only introduce seams.
+    winrt::Canvas canvas;
+    canvas.UseLayoutRounding(false);
+    for (size_t i = 0; i < layout.tileCount(); ++i) {
+        auto rect = layout.tileRect(i);
+        Image image;
+        image.Stretch(winrt::Stretch::Fill);
+        image.UseLayoutRounding(false);
+        image.Width(pixelsToDips(rect.width(), dpi));
+        image.Height(pixelsToDips(rect.height(), dpi));
+        image.Source(currentTarget_.tiles_[i]);
+        winrt::Canvas::SetLeft(image, pixelsToDips(rect.left, dpi));
+        winrt::Canvas::SetTop(image, pixelsToDips(rect.top, dpi));
+        canvas.Children().Append(image);
+    }
+    winrt::AutomationProperties::SetAccessibilityView(canvas, winrt::Peers::AccessibilityView::Raw);
+    Content(canvas);
+    releaseRetiredBudgetEntry();
+}
+
+void CanvasControl::setStaleContentPresentation(StaleContentMode mode, winrt::TimeSpan deadline) {
+    staleContentMode_ = mode;
+    staleContentDeadline_ = deadline;
+}
+
+void CanvasControl::presentRenderTarget() {
+    presenterPending_ = false;
+    if (!currentTarget_.tiles_.empty()) {
+        setTiledPresenter();
+    } else if (currentTarget_.surface_) {
+        setImageSource(currentTarget_.surface_);
+    }
+    endStalePresentation();
+}
+
+void CanvasControl::beginStalePresentation() {
+    // Only the surfaces we re-create on resize need this, virtual surfaces are resized in place.
+    if (staleContentShown_ || presenterPending_ || staleContentDeadline_.count() <= 0 || useVSIS_ ||
+        currentTarget_.atlas_ || !currentTarget_.hasSurface() || !isShown()) {
+        return;
+    }
+
+    // Tiles are positioned in a canvas, so they already stay anchored.
+    if (auto image = containerImage()) {
+        switch (staleContentMode_) {
+        case StaleContentMode::kStretch:
+            break;
+        case StaleContentMode::kScale:
+            image.Stretch(winrt::Stretch::Uniform);
+            break;
+        case StaleContentMode::kAnchor:
+            image.Width(currentTarget_.size_.Width);
+            image.Height(currentTarget_.size_.Height);
+            image.HorizontalAlignment(winrt::HorizontalAlignment::Left);
+            image.VerticalAlignment(winrt::VerticalAlignment::Top);
+            break;
+        }
+    }
+    staleContentShown_ = true;
+
+    if (!staleDeadlineTimer_) {
+        staleDeadlineTimer_ = DispatcherQueue().CreateTimer();
+        staleDeadlineTimer_.IsRepeating(false);
+        staleDeadlineTimerHandler_ = staleDeadlineTimer_.Tick(winrt::auto_revoke, {this, &CanvasControl::onStaleDeadlineTick});
+    }
+    staleDeadlineTimer_.Interval(staleContentDeadline_);
+    staleDeadlineTimer_.Start();
+}
+
+void CanvasControl::endStalePresentation() {
+    if (!staleContentShown_) {
+        return;
+    }
+    staleContentShown_ = false;
+    staleDeadlineTimer_.Stop();
+
+    if (auto image = containerImage()) {
+        image.ClearValue(FrameworkElement::WidthProperty());
+        image.ClearValue(FrameworkElement::HeightProperty());
+        image.ClearValue(FrameworkElement::HorizontalAlignmentProperty());
+        image.ClearValue(FrameworkElement::VerticalAlignmentProperty());
+        image.Stretch(winrt::Stretch::Fill);
+    }
+}
+
+void CanvasControl::onStaleDeadlineTick(const winrt::DispatcherQueueTimer&, const winrt::IInspectable&) {
+    // The new frame is late, show whatever the new surface has rather than outdated content.
+    if (presenterPending_) {
+        presentRenderTarget();
+    } else {
+        endStalePresentation();
+    }
 }
 
 void CanvasControl::setRenderTarget(const RenderTarget& newTarget) {
     auto oldTarget = currentTarget_;
     currentTarget_ = newTarget;
+    warmFrameCount_ = 0;
+    frameHashes_.clear();
+    presenterPending_ = false;
 
-    if (oldTarget.surface_) {
-        auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(oldTarget.surface_);
-        LogIfFailed(sisNative->SetDevice(nullptr), "sisNative->SetDevice(nullptr)");
+    if (oldTarget.atlas_) {
+        GfxSurfaceAtlasManager::instance().release(oldTarget.atlas_);
     }
-    if (newTarget.surface_) {
-        auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(newTarget.surface_);
+    auto releaseDevice = [](const SurfaceImageSource& surface) {
+        auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(surface);
+        LogIfFailed(sisNative->SetDevice(nullptr), "sisNative->SetDevice(nullptr)");
+    };
+    auto attachDevice = [this](const SurfaceImageSource& surface) {
+        auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(surface);
         LogIfFailed(sisNative->SetDevice(nullptr), "sisNative->SetDevice(nullptr)");
         assert(device_.get());
         LogIfFailed(sisNative->SetDevice(device_->d2dDevice().get()), "sisNative->SetDevice(device_)");
+    };
+
+    if (oldTarget.surface_) {
+        releaseDevice(oldTarget.surface_);
+    }
+    for (const auto& tile : oldTarget.tiles_) {
+        releaseDevice(tile);
+    }
+    if (newTarget.surface_) {
+        attachDevice(newTarget.surface_);
+    }
+    for (const auto& tile : newTarget.tiles_) {
+        attachDevice(tile);
+    }
+
+    auto& budget = GfxMemoryBudget::instance();
+    // The old surface stays on screen until the new source is attached, its memory with it. Its
+    // entry is accounted for only: the eviction callback would release the new surface.
+    if (retiredBudgetEntry_ == GfxMemoryBudget::kInvalidEntry && budgetEntry_ != GfxMemoryBudget::kInvalidEntry) {
+        retiredBudgetEntry_ = budget.add(::winui_drover_island::GfxMemorySubsystem::kSurfaces, surfaceBytes(oldTarget));
+    }
+    // Otherwise an older surface is still the one on screen, this one was never presented.
+    budget.remove(budgetEntry_);
+    budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+    visibleBounds_ = {};
+    if (newTarget.surface_ || !newTarget.tiles_.empty()) {
+        auto wThis = get_weak();
+        budgetEntry_ = budget.add(::winui_drover_island::GfxMemorySubsystem::kSurfaces, surfaceBytes(newTarget), [wThis]() {
+            if (auto pThis = wThis.get()) {
+                pThis->evictSurface();
+            }
+        });
+        budget.setVisible(budgetEntry_, isShown());
     }
 }
 
+void CanvasControl::releaseRetiredBudgetEntry() {
+    GfxMemoryBudget::instance().remove(retiredBudgetEntry_);
+    retiredBudgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+}
+
 void CanvasControl::resetRenderTarget() {
     // We don't really expect this to fail, but let's wrap it in a com exception bondary.
     setRenderTarget({});
 }
 
-HRESULT CanvasControl::runWithDevice(std::function<HRESULT()>&& fn) {
+bool CanvasControl::isShown() {
+    return loaded_ && attached_ && inViewport_ && Visibility() == winrt::Visibility::Visible;
+}
+
+size_t CanvasControl::surfaceBytes(const RenderTarget& target) const {
+    if (target.atlas_) {
+        auto slot = target.atlas_.atlas->slotRect(target.atlas_.slot);
+        return static_cast<size_t>(slot.area()) * 4;
+    }
+    if (!target.surface_ && target.tiles_.empty()) {
+        return 0;
+    }
+    if (useVSIS_) {
+        // Virtual surfaces only allocate the tiles around the visible region.
+        return static_cast<size_t>(visibleBounds_.right - visibleBounds_.left) *
+               static_cast<size_t>(visibleBounds_.bottom - visibleBounds_.top) * 4;
+    }
+    auto actualPixelsWidth = sizeDipsToPixels(target.size_.Width, target.dpi_);
+    auto actualPixelsHeight = sizeDipsToPixels(target.size_.Height, target.dpi_);
+    return static_cast<size_t>(actualPixelsWidth) * static_cast<size_t>(actualPixelsHeight) * 4;
+}
+
+void CanvasControl::updateBudgetEntry() {
+    GfxMemoryBudget::instance().update(budgetEntry_, surfaceBytes(currentTarget_));
+}
+
+void CanvasControl::evictSurface() {
+    // Only surfaces of hidden controls are released, either by the memory budget or when the
+    // grace period is over. They are re-created and redrawn once the control is shown again.
+    if (framePending_) {
+        cancelFrame();
+    }
+    auto bytes = surfaceBytes(currentTarget_);
+    bool hadSurface = currentTarget_.hasSurface();
+    resetRenderTarget();
+    resetImageSource();
+    releaseLayerBitmaps(true);
+    if (hadSurface) {
+        visibilityTracker_.onReleased(bytes);
+    }
+}
+
+// Takes the callable by reference rather than as a std::function, so it is called inline and
+// its captures never end up on the heap.
+template <typename Fn>
+HRESULT CanvasControl::runWithDevice(Fn&& fn) {
     if (!device_) {
         device_ = GfxD2DDeviceManager::instance().sharedDevice();
         if (!device_) {
             Logger::warn("Failed to get the shared device");
             return E_FAIL;
         }
-        ComExceptionBoundaryWithLog([&] { createResources(device_); }, "createResources");
+        ComExceptionBoundaryWithLog([&] { createResources(device_); }, "createResources", controlId_);
     }
     HRESULT hr = fn();
     if (FAILED(hr)) {
         if (isDeviceLostHResult(hr) || hr == E_SURFACE_CONTENTS_LOST) {
+            GfxEventRecorder::instance().record(
+                controlId_, hr == E_SURFACE_CONTENTS_LOST ? GfxEventRecorder::EventKind::kSurfaceLost : GfxEventRecorder::EventKind::kDeviceLost);
             handleDeviceLost();
         }
     }
@@ -193,9 +686,9 @@ std::shared_ptr<GfxD2DDevice> CanvasControl::device() {
 void CanvasControl::ensureSurfaceImageSource() {
     assert(!asyncResetPending_);
     const auto& newSize = containerSize_;
-    const auto& newDpi = containerDpi_;
+    const auto newDpi = renderDpi();
 
-    bool surfaceNotCreated = (currentTarget_.surface_ == nullptr);
+    bool surfaceNotCreated = (currentTarget_.surface_ == nullptr && currentTarget_.tiles_.empty());
     bool dpiChanged = (currentTarget_.dpi_ != newDpi);
     bool sizeChanged = (currentTarget_.size_ != newSize);
     if (!surfaceNotCreated && !dpiChanged && !sizeChanged) {
@@ -206,81 +699,543 @@ void CanvasControl::ensureSurfaceImageSource() {
     auto actualPixelsWidth = sizeDipsToPixels(newSize.Width, newDpi);
     auto actualPixelsHeight = sizeDipsToPixels(newSize.Height, newDpi);
 
-    auto imgSource = winrt::Imaging::SurfaceImageSource(actualPixelsWidth, actualPixelsHeight, false);
+    auto maximumSize = maximumSurfaceSizeInPixels();
+    if (GfxTileLayout::needsTiling(actualPixelsWidth, actualPixelsHeight, maximumSize)) {
+        RenderTarget target;
+        target.size_ = newSize;
+        target.dpi_ = newDpi;
+        target.tileLayout_ = GfxTileLayout(actualPixelsWidth, actualPixelsHeight, maximumSize);
+        target.tiles_.reserve(target.tileLayout_.tileCount());
+        for (size_t i = 0; i < target.tileLayout_.tileCount(); ++i) {
+            auto rect = target.tileLayout_.tileRect(i);
+            target.tiles_.emplace_back(rect.width(), rect.height(), isOpaque_);
+        }
+        setRenderTarget(target);
+    } else {
+        auto imgSource = winrt::Imaging::SurfaceImageSource(actualPixelsWidth, actualPixelsHeight, isOpaque_);
 
-    RenderTarget target{imgSource, newSize, newDpi};
-    setRenderTarget(target);
-    setImageSource(imgSource);
-    assert(currentTarget_.surface_);
+        RenderTarget target{imgSource, newSize, newDpi};
+        setRenderTarget(target);
+        assert(currentTarget_.surface_);
+    }
+    // The new surfaces are presented once drawn, the previous content stays on screen until then.
+    presenterPending_ = true;
+}
+
+int32_t CanvasControl::maximumSurfaceSizeInPixels() {
+    assert(device_);
+    auto maximumSize = static_cast<int32_t>(std::min<uint32_t>(device_->maximumBitmapSizeInPixels(), INT32_MAX));
+    if (tilingThreshold_ > 0) {
+        maximumSize = std::min(maximumSize, tilingThreshold_);
+    }
+    return maximumSize;
 }
 
-HRESULT CanvasControl::performD2DDraw(ISurfaceImageSourceNativeWithD2D* sisNative, const RECT& updateRect) {
+void CanvasControl::setTilingThreshold(int32_t pixels) {
+    if (pixels == tilingThreshold_) {
+        return;
+    }
+    tilingThreshold_ = pixels;
+    if (!useVSIS_ && !currentTarget_.atlas_ && currentTarget_.hasSurface()) {
+        // Forces the surfaces to be re-created with the new layout on the next frame.
+        currentTarget_.size_ = {};
+    }
+    invalidateDueToInternalChange();
+}
+
+// The update rect is in the surface space; origin is the position of the surface in the control,
+// in pixels, which is not zero when the control is split in tiles.
+HRESULT CanvasControl::performD2DDraw(ISurfaceImageSourceNativeWithD2D* sisNative, const RECT& updateRect, POINT origin, int32_t hashSlot) {
     assert(!asyncResetPending_);
+    const auto dpi = currentTarget_.dpi_;
+
+    RECT surfaceRect = updateRect;
+    auto toDrawRect = [&]() {
+        RECT controlRect = surfaceRect;
+        OffsetRect(&controlRect, origin.x, origin.y);
+        auto rc = toRect(controlRect, dpi);
+        return D2D_RECT_F{rc.X, rc.Y, rc.X + rc.Width, rc.Y + rc.Height};
+    };
+    auto drawRect = toDrawRect();
+    bool useLayerCache = !useVSIS_ && currentTarget_.tiles_.empty();
+    // The surface doesn't preserve the update rect, it only needs clearing if the layers leave holes.
+    bool clear = !compositor_.contentCoversSurface(drawCoversUpdateRect_);
+
+    // When skipping unchanged frames, the frame is recorded first and the recording is replayed
+    // into the surface, so the user's draw callback still runs once per frame. The HUD shows new
+    // numbers on every refresh: it is left out of the recording, and drawn over it.
+    winrt::com_ptr<ID2D1CommandList> commandList;
+    uint64_t frameHash = 0;
+    bool hashFrames = shouldHashFrame(hashSlot, useLayerCache);
+    if (hashFrames) {
+        ReturnIfFailed(recordFrame(drawRect, useLayerCache, commandList));
+        frameHash = hashFrame(commandList.get(), updateRect, origin, clear);
+        auto& hashes = frameHashes(hashSlot);
+        if (frameHash != 0 && hashes.presented == frameHash) {
+            frameSkipStats_.skippedFrames++;
+            changedHashedFrames_ = 0;
+            // The content is unchanged, the HUD over it only needs drawing again.
+            auto hudRect = isHudVisible()
+                               ? GfxPerformanceHud::boundsInPixels(dpi).translated(-origin.x, -origin.y).intersection(toPixelRect(updateRect))
+                               : PixelRect{};
+            if (hudRect.isEmpty()) {
+                return S_OK;
+            }
+            surfaceRect = toRECT(hudRect);
+            drawRect = toDrawRect();
+        } else {
+            // The same as the last hashed frame, though unhashed frames were drawn since: the
+            // content settled, every frame is hashed again.
+            bool settled = frameHash != 0 && hashes.hashed == frameHash;
+            hashes.hashed = frameHash;
+            changedHashedFrames_ = settled ? 0 : changedHashedFrames_ + 1;
+        }
+    }
+
     winrt::com_ptr<ID2D1DeviceContext> context;
     POINT offset = {};
-    ReturnIfFailed(sisNative->BeginDraw(updateRect, __uuidof(context), context.put_void(), &offset));
-
-    const auto dpi = currentTarget_.dpi_;
+    ReturnIfFailed(sisNative->BeginDraw(surfaceRect, __uuidof(context), context.put_void(), &offset));
 
-    offset.x -= updateRect.left;
-    offset.y -= updateRect.top;
+    offset.x -= surfaceRect.left + origin.x;
+    offset.y -= surfaceRect.top + origin.y;
     float offsetX = pixelsToDips(offset.x, dpi);
     float offsetY = pixelsToDips(offset.y, dpi);
 
-    context->Clear();
     context->SetTransform(D2D1::Matrix3x2F::Translation(offsetX, offsetY));
     context->SetDpi(dpi, dpi);
     context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    // Nothing outside of the update rect may be touched, the surface keeps those pixels.
+    context->PushAxisAlignedClip(drawRect, D2D1_ANTIALIAS_MODE_ALIASED);
+    if (clear) {
+        context->Clear();
+    }
+
+    if (commandList) {
+        context->DrawImage(commandList.get());
+        compositor_.drawDirectLayer(context, hudLayer_, drawRect);
+    } else {
+        // Call user's draw callback
+        compositor_.draw(context, layerTarget(useLayerCache), drawRect);
+    }
+    context->PopAxisAlignedClip();
+
+    HRESULT hr = sisNative->EndDraw();
+    if (skipUnchangedFrames_ && hashSlot >= 0) {
+        // An unhashed frame leaves the surface with content of unknown hash.
+        frameHashes(hashSlot).presented = SUCCEEDED(hr) ? frameHash : 0;
+    }
+    return hr;
+}
+
+CanvasControl::FrameHashes& CanvasControl::frameHashes(int32_t hashSlot) {
+    auto slot = static_cast<size_t>(hashSlot);
+    if (frameHashes_.size() <= slot) {
+        frameHashes_.resize(slot + 1);
+    }
+    return frameHashes_[slot];
+}
+
+bool CanvasControl::shouldHashFrame(int32_t hashSlot, bool useLayerCache) {
+    if (!skipUnchangedFrames_ || hashSlot < 0) {
+        return false;
+    }
+    // Recording the frame would draw the cached layer into its bitmap, under a new version.
+    bool canMatch = !compositor_.redrawsCachedLayer(layerTarget(useLayerCache));
+    // Content that changes on every frame only has a frame hashed now and then, in case it settles.
+    bool probe = changedHashedFrames_ < kMaxChangedHashedFrames || framesSinceHash_ + 1 >= kHashProbeInterval;
+    if (!canMatch || !probe) {
+        frameSkipStats_.unhashedFrames++;
+        framesSinceHash_++;
+        return false;
+    }
+    framesSinceHash_ = 0;
+    return true;
+}
+
+HRESULT CanvasControl::recordFrame(const D2D_RECT_F& drawRect, bool useLayerCache, winrt::com_ptr<ID2D1CommandList>& commandList) {
+    const auto dpi = currentTarget_.dpi_;
+    auto lease = device_->leaseResourceCreationDeviceContext();
+    winrt::com_ptr<ID2D1DeviceContext> context;
+    context.copy_from(lease.context().get());
+
+    ReturnIfFailed(context->CreateCommandList(commandList.put()));
+    context->SetTarget(commandList.get());
+    context->SetDpi(dpi, dpi);
+    context->SetTransform(D2D1::Matrix3x2F::Identity());
+    context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    context->BeginDraw();
+    auto target = layerTarget(useLayerCache);
+    target.excludedLayer = hudLayer_;
+    compositor_.draw(context, target, drawRect);
+    HRESULT hr = context->EndDraw();
+    context->SetTarget(nullptr);
+    ReturnIfFailed(hr);
+    return commandList->Close();
+}
+
+uint64_t CanvasControl::hashFrame(ID2D1CommandList* commandList, const RECT& updateRect, POINT origin, bool clear) {
+    auto start = std::chrono::steady_clock::now();
+    if (!frameHashSink_) {
+        frameHashSink_ = winrt::make_self<GfxDrawStreamHashSink>();
+    }
+    frameHashSink_->reset();
+    compositor_.addStableImages(*frameHashSink_);
+    effects_.addStableImages(*frameHashSink_);
+
+    auto& hasher = frameHashSink_->hasher();
+    hasher.add(updateRect);
+    hasher.add(origin);
+    hasher.add(currentTarget_.dpi_);
+    hasher.add(clear);
+    HRESULT hr = frameHashSink_->hash(commandList);
+
+    frameSkipStats_.hashedFrames++;
+    frameSkipStats_.hashTime += std::chrono::steady_clock::now() - start;
+    if (FAILED(hr) || !hasher.isDedupable()) {
+        LogIfFailed(hr, "hashFrame", controlId_);
+        frameSkipStats_.notDedupableFrames++;
+        return 0;
+    }
+    return hasher.hash();
+}
 
-    // Call user's draw callback
-    auto rc = toRect(updateRect, dpi);
+void CanvasControl::setSkipUnchangedFrames(bool skip) {
+    skipUnchangedFrames_ = skip && !useVSIS_;
+    frameHashes_.clear();
+    changedHashedFrames_ = 0;
+    framesSinceHash_ = 0;
+    // The next frame creates the hashing sink.
+    warmFrameCount_ = 0;
+}
+
+GfxLayerCompositor::Target CanvasControl::layerTarget(bool useLayerCache) const {
+    GfxLayerCompositor::Target target;
+    target.device = device_.get();
+    target.dpi = currentTarget_.dpi_;
+    target.sizeInDips = D2D1::SizeF(currentTarget_.size_.Width, currentTarget_.size_.Height);
+    target.useLayerCache = useLayerCache;
+    target.contentCoversUpdateRect = drawCoversUpdateRect_;
+    target.partialFrame = damage_.isPartialFrame() ? &damage_.frame() : nullptr;
+    return target;
+}
+
+void CanvasControl::beginLayerFrame(const PixelRect& updateBounds) {
+    // A virtual surface only draws its visible part, other surfaces the whole control.
+    auto viewport = useVSIS_ ? toPixelRect(visibleBounds_) : surfaceBoundsInPixels();
+    const auto dpi = currentTarget_.dpi_;
+    auto toDips = [dpi](const PixelRect& rect) {
+        auto dips = toDipRect(rect, dpi);
+        return PixelRect{static_cast<int32_t>(std::floor(dips.x)), static_cast<int32_t>(std::floor(dips.y)),
+            static_cast<int32_t>(std::ceil(dips.x + dips.width)), static_cast<int32_t>(std::ceil(dips.y + dips.height))};
+    };
+    compositor_.beginFrame(toDips(viewport), toDips(updateBounds));
+}
+
+void CanvasControl::drawLayerContent(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerId layer, const D2D_RECT_F& updateRect) {
+    if (layer == hudLayer_) {
+        ComExceptionBoundaryWithLog(
+            [&]() {
+                GfxPerformanceHud::Info info;
+                info.surfaceBounds = surfaceBoundsInPixels();
+                info.dpi = currentTarget_.dpi_;
+                info.surfaceCount = currentTarget_.tiles_.empty() ? 1 : currentTarget_.tiles_.size();
+                info.device = device_.get();
+                auto effectStats = effects_.totalStats();
+                info.effectHits = effectStats.hits;
+                info.effectLookups = effectStats.hits + effectStats.misses;
+                info.frameSkipRate = frameSkipStats_.skipRate();
+                hud_.draw(context, info);
+            },
+            "drawHud", controlId_);
+        return;
+    }
     ComExceptionBoundaryWithLog(
         [&]() {
-            draw(context, D2D_RECT_F{rc.X, rc.Y, rc.X + rc.Width, rc.Y + rc.Height});
+            if (layer == kContentLayer) {
+                draw(context, updateRect);
+            } else {
+                drawLayer(context, layer, updateRect);
+            }
         },
-        "draw function");
+        "draw function", controlId_);
+}
+
+void CanvasControl::releaseLayerBitmaps(bool park) {
+    compositor_.releaseBitmaps(device_.get(), park);
+    effects_.releaseBitmaps();
+    warmFrameCount_ = 0;
+}
+
+void CanvasControl::drawCachedEffect(const winrt::com_ptr<ID2D1DeviceContext>& context, EffectId id, uint64_t sourceGeneration,
+    const D2D_RECT_F& sourceRect, const Effect& effect, const DrawEffectSource& drawSource) {
+    assert(device_);
+    effects_.draw(context, *device_, currentTarget_.dpi_, id, sourceGeneration, sourceRect, effect, drawSource);
+}
+
+void CanvasControl::releaseCachedEffect(EffectId id) {
+    effects_.release(id);
+}
+
+bool CanvasControl::drawImage(const winrt::com_ptr<ID2D1DeviceContext>& context, const std::wstring& path, const D2D_RECT_F& rect) {
+    assert(device_);
+    auto& images = ::winui_drover_island::GfxImageService::instance();
+    auto key = images.keyFor(path, D2D1::SizeF(rect.right - rect.left, rect.bottom - rect.top), currentTarget_.dpi_);
+    auto wThis = get_weak();
+    auto bitmap = images.bitmap(key, device_, [wThis]() {
+        if (auto pThis = wThis.get()) {
+            pThis->invalidate();
+        }
+    });
+    if (!bitmap) {
+        return false;
+    }
+    auto size = bitmap->GetPixelSize();
+    if (size.width == 0 || size.height == 0) {
+        return false;
+    }
+    float scale = std::min((rect.right - rect.left) / size.width, (rect.bottom - rect.top) / size.height);
+    float width = size.width * scale;
+    float height = size.height * scale;
+    float left = (rect.left + rect.right - width) / 2;
+    float top = (rect.top + rect.bottom - height) / 2;
+    auto destination = D2D1::RectF(left, top, left + width, top + height);
+    context->DrawBitmap(bitmap.get(), &destination, 1.f, D2D1_INTERPOLATION_MODE_LINEAR);
+    return true;
+}
+
+CanvasControl::LayerId CanvasControl::addLayer(std::string name, int32_t order, LayerKind kind) {
+    auto layer = compositor_.addLayer(std::move(name), order, kind);
+    // The next frame creates the layer bitmap.
+    warmFrameCount_ = 0;
+    scheduleRedraw();
+    return layer;
+}
+
+CanvasControl::LayerId CanvasControl::addRasterLayer(std::string name, int32_t order, std::shared_ptr<GfxTiledImage> image) {
+    auto layer = compositor_.addRasterLayer(std::move(name), order, std::move(image));
+    warmFrameCount_ = 0;
+    scheduleRedraw();
+    return layer;
+}
+
+const ::winui_drover_island::GfxRasterLayer* CanvasControl::rasterLayer(LayerId layer) const {
+    return compositor_.rasterLayer(layer);
+}
+
+void CanvasControl::removeLayer(LayerId layer) {
+    compositor_.removeLayer(layer);
+    scheduleRedraw();
+}
+
+void CanvasControl::setLayerKind(LayerId layer, LayerKind kind) {
+    compositor_.setLayerKind(layer, kind);
+    warmFrameCount_ = 0;
+    scheduleRedraw();
+}
+
+void CanvasControl::setLayerVisible(LayerId layer, bool visible) {
+    compositor_.setLayerVisible(layer, visible);
+    scheduleRedraw();
+}
+
+void CanvasControl::invalidateLayer(LayerId layer) {
+    compositor_.invalidateLayer(layer);
+    scheduleRedraw();
+}
 
-    return sisNative->EndDraw();
+void CanvasControl::setHudVisible(bool visible) {
+    if (visible == isHudVisible()) {
+        return;
+    }
+    if (!visible) {
+        hudTimer_.Stop();
+        auto layer = hudLayer_;
+        hudLayer_ = GfxLayerStack::kInvalidLayer;
+        removeLayer(layer);
+        return;
+    }
+    // Above every other layer, drawn straight on the surface: it changes with every refresh.
+    hudLayer_ = addLayer("hud", INT32_MAX, LayerKind::kDirect);
+    if (!hudTimer_) {
+        hudTimer_ = DispatcherQueue().CreateTimer();
+        hudTimer_.IsRepeating(true);
+        hudTimer_.Interval(GfxPerformanceHud::kRefreshInterval);
+        hudTimerHandler_ = hudTimer_.Tick(winrt::auto_revoke, {this, &CanvasControl::onHudTimerTick});
+    }
+    hudTimer_.Start();
+}
+
+void CanvasControl::onHudTimerTick(const winrt::DispatcherQueueTimer&, const winrt::IInspectable&) {
+    // A hidden control refreshes its HUD once shown, the refresh must not redraw its content.
+    if (!isHudVisible() || !isShown()) {
+        return;
+    }
+    if (currentTarget_.dpi_ == 0 || !currentTarget_.hasSurface() || currentTarget_.atlas_) {
+        invalidateLayer(hudLayer_);
+        return;
+    }
+    // Damage without marking the content dirty: the rest of the surface and the cached layers
+    // are left as they are.
+    auto rect = GfxPerformanceHud::boundsInPixels(currentTarget_.dpi_).intersection(surfaceBoundsInPixels());
+    if (!rect.isEmpty()) {
+        damage_.add(rect);
+        scheduleFrame();
+    }
 }
 
-HRESULT CanvasControl::performImageSourceDraw() {
+bool CanvasControl::isHudOnlyUpdate(const PixelRect& updateBounds) const {
+    return isHudVisible() && !updateBounds.isEmpty() && GfxPerformanceHud::boundsInPixels(currentTarget_.dpi_).contains(updateBounds);
+}
+
+HRESULT CanvasControl::performImageSourceDraw(bool fullRedraw) {
+    // Partial frames draw each damage rect on its own and aren't hashed, the surface no longer
+    // shows a frame whose hash is known.
+    auto forgetHash = [&](size_t slot) {
+        if (slot < frameHashes_.size()) {
+            frameHashes_[slot].presented = 0;
+        }
+    };
+    if (!currentTarget_.tiles_.empty()) {
+        const auto& layout = currentTarget_.tileLayout_;
+        for (size_t i = 0; i < layout.tileCount(); ++i) {
+            auto rect = layout.tileRect(i);
+            auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(currentTarget_.tiles_[i]);
+            if (fullRedraw) {
+                RECT updateRect = {0, 0, rect.width(), rect.height()};
+                ReturnIfFailed(performD2DDraw(sisNative.get(), updateRect, POINT{rect.left, rect.top}, static_cast<int32_t>(i)));
+                continue;
+            }
+            for (const auto& damage : damage_.frame().rects()) {
+                auto tileDamage = damage.intersection(rect);
+                if (!tileDamage.isEmpty()) {
+                    forgetHash(i);
+                    RECT updateRect = toRECT(tileDamage.translated(-rect.left, -rect.top));
+                    ReturnIfFailed(performD2DDraw(sisNative.get(), updateRect, POINT{rect.left, rect.top}));
+                }
+            }
+        }
+        return S_OK;
+    }
     assert(currentTarget_.surface_);
 
     auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(currentTarget_.surface_);
+    if (fullRedraw) {
+        return performD2DDraw(sisNative.get(), toRECT(surfaceBoundsInPixels()), POINT{}, 0);
+    }
+    forgetHash(0);
+    for (const auto& damage : damage_.frame().rects()) {
+        ReturnIfFailed(performD2DDraw(sisNative.get(), toRECT(damage)));
+    }
+    return S_OK;
+}
+
+PixelRect CanvasControl::surfaceBoundsInPixels() const {
     auto rc = winrt::Rect{0.f, 0.f, currentTarget_.size_.Width, currentTarget_.size_.Height};
-    RECT updateRect = toRECT(rc, currentTarget_.dpi_);
-    return performD2DDraw(sisNative.get(), updateRect);
+    return toPixelRect(toRECT(rc, currentTarget_.dpi_));
 }
 
 void CanvasControl::onCompositorSurfaceContentsLost(const winrt::IInspectable&, const winrt::IInspectable&) {
+    GfxEventRecorder::instance().record(controlId_, GfxEventRecorder::EventKind::kSurfaceLost);
     handleDeviceLost();
 }
 
-void CanvasControl::onCompositorDraw(const winrt::IInspectable&, const winrt::IInspectable&) {
-    removeRenderingCallback();
+void CanvasControl::onFrame(GfxFrameClock::Clock::time_point) {
+    // The clock consumed the request before calling us.
+    framePending_ = false;
 
     if (asyncResetPending_) {
         return;
     }
+    if (!isShown()) {
+        redrawWhenShown_ = true;
+        return;
+    }
+    if (currentTarget_.atlas_) {
+        currentTarget_.atlas_.atlas->invalidate(currentTarget_.atlas_.slot);
+        return;
+    }
+    if (useVSIS_) {
+        // The virtual surface calls us back with the regions it actually needs.
+        auto vsisNative = currentTarget_.surface_ ? currentTarget_.surface_.try_as<IVirtualSurfaceImageSourceNative>() : nullptr;
+        const auto& rects = damage_.pendingRects();
+        if (vsisNative && rects.empty()) {
+            LogIfFailed(vsisNative->Invalidate(toRECT(surfaceBoundsInPixels())), "Invalidate", controlId_);
+        } else if (vsisNative) {
+            for (const auto& rect : rects) {
+                LogIfFailed(vsisNative->Invalidate(toRECT(rect)), "Invalidate", controlId_);
+            }
+        }
+        // Drawn once the surface asks for the regions.
+        virtualUpdatesPending_ = vsisNative != nullptr;
+        damage_.clearPending();
+        return;
+    }
 
+    auto previousSurface = currentTarget_.surface_;
+    SurfaceImageSource previousTile = currentTarget_.tiles_.empty() ? SurfaceImageSource{nullptr} : currentTarget_.tiles_.front();
     auto result = runWithDevice([&]() {
         ensureSurfaceImageSource();
         return S_OK;
     });
     if (FAILED(result)) {
-        LogIfFailed(result, "ensureSurfaceImageSource");
+        LogIfFailed(result, "ensureSurfaceImageSource", controlId_);
         return;
     }
-    result = runWithDevice([&]() { return performImageSourceDraw(); });
 
-    LogIfFailed(result, "performImageSourceDraw");
+    // Once the surface and the resources exist, drawing the same surface again must not allocate.
+    // Recording the events does, the trace grows.
+    auto& recorder = GfxEventRecorder::instance();
+    {
+        GfxNoAllocationScope noAllocation("CanvasControl::onFrame", warmFrameCount_ > 0 && !recorder.isRecording());
+
+        auto surfaceBounds = surfaceBoundsInPixels();
+        SurfaceImageSource firstTile = currentTarget_.tiles_.empty() ? SurfaceImageSource{nullptr} : currentTarget_.tiles_.front();
+        bool newSurface = !(currentTarget_.surface_ == previousSurface) || !(firstTile == previousTile);
+        bool fullRedraw = damage_.beginFrame(surfaceBounds, newSurface);
+        beginLayerFrame(fullRedraw ? surfaceBounds : damage_.frame().bounds());
+
+        hud_.resetDrawTime();
+        auto drawStart = GfxFrameClock::Clock::now();
+        result = runWithDevice([&]() { return performImageSourceDraw(fullRedraw); });
+        // Diagnostics draw on top of the frame, they aren't part of its cost.
+        auto frameTime = GfxFrameClock::Clock::now() - drawStart - hud_.drawTime();
+        recorder.record(controlId_, GfxEventRecorder::EventKind::kFrame,
+            static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(frameTime).count()));
+        const auto& frameDamage = damage_.frame();
+        if (SUCCEEDED(result) && (fullRedraw || !isHudOnlyUpdate(frameDamage.bounds()))) {
+            hud_.addFrame(frameTime, fullRedraw ? 1 : frameDamage.rects().size(), fullRedraw ? surfaceBounds.area() : frameDamage.area());
+        }
+        damage_.endFrame(SUCCEEDED(result));
+        if (SUCCEEDED(result) && isInteracting()) {
+            // A new scale is picked up by the next frame, which the interaction keeps coming.
+            resolutionScaler_.addFrameTime(frameTime);
+        }
+
+        LogIfFailed(result, "performImageSourceDraw", controlId_);
+        if (presenterPending_ && (SUCCEEDED(result) || !staleContentShown_)) {
+            presentRenderTarget();
+        }
+        if (SUCCEEDED(result)) {
+            GfxMemoryBudget::instance().touch(budgetEntry_);
+            visibilityTracker_.onPresented(GfxVisibilityTracker::Clock::now());
+            warmFrameCount_++;
+        }
+    }
+    // Over budget, evicting allocates and releases the surfaces of other controls, which the
+    // frame above isn't accountable for.
+    GfxMemoryBudget::instance().enforce();
 }
 
 void CanvasControl::handleDeviceLost() {
     if (device_) {
-        ComExceptionBoundaryWithLog([&] { destroyResources(); }, "destroyResources");
+        ComExceptionBoundaryWithLog([&] { destroyResources(); }, "destroyResources", controlId_);
         device_.reset();
     }
+    // The layer bitmaps belong to the lost device.
+    releaseLayerBitmaps();
+    hud_.releaseDeviceResources();
+    frameHashes_.clear();
+    warmFrameCount_ = 0;
 
     postAsyncReset();
 }
@@ -315,17 +1270,60 @@ void CanvasControl::invalidateDueToInternalChange() {
     if (!loaded_ || asyncResetPending_) {
         return;
     }
+    if (!isShown()) {
+        redrawWhenShown_ = true;
+        return;
+    }
 
     if (useVSIS_) {
         auto result = runWithDevice([this]() { return ensureVirtualSurfaceImageSource(); });
-        LogIfFailed(result, "ensureVirtualSurfaceImageSource");
+        LogIfFailed(result, "ensureVirtualSurfaceImageSource", controlId_);
+        GfxMemoryBudget::instance().enforce();
     }
 
-    invalidate();
+    // The content of the layers didn't change; layer bitmaps of another size or DPI, or released
+    // ones, are drawn again anyway.
+    scheduleRedraw();
 }
 
 void CanvasControl::invalidate() {
-    if (!loaded_ || asyncResetPending_ || renderingPending_) {
+    GfxEventRecorder::instance().record(controlId_, GfxEventRecorder::EventKind::kInvalidate);
+    compositor_.invalidateAll();
+    scheduleRedraw();
+}
+
+void CanvasControl::invalidateRect(const D2D_RECT_F& rectInDips) {
+    const auto dpi = currentTarget_.dpi_;
+    if (dpi == 0 || !currentTarget_.hasSurface() || currentTarget_.atlas_) {
+        // No pixels to keep; atlas slots are small, they are drawn whole.
+        invalidate();
+        return;
+    }
+    GfxEventRecorder::instance().record(
+        controlId_, GfxEventRecorder::EventKind::kInvalidateRect, rectInDips.left, rectInDips.top, rectInDips.right, rectInDips.bottom);
+    PixelRect rect{dipsToPixels(rectInDips.left, dpi, DpiRounding::kFloor), dipsToPixels(rectInDips.top, dpi, DpiRounding::kFloor),
+        dipsToPixels(rectInDips.right, dpi, DpiRounding::kCeiling), dipsToPixels(rectInDips.bottom, dpi, DpiRounding::kCeiling)};
+    rect = rect.intersection(surfaceBoundsInPixels());
+    if (rect.isEmpty()) {
+        return;
+    }
+    damage_.add(rect);
+    compositor_.invalidateLayer(kContentLayer);
+    scheduleFrame();
+}
+
+void CanvasControl::scheduleRedraw() {
+    damage_.invalidateAll();
+    scheduleFrame();
+}
+
+void CanvasControl::scheduleFrame() {
+    if (!loaded_ || asyncResetPending_ || framePending_) {
+        return;
+    }
+    if (!isShown()) {
+        // Hidden controls don't draw, we'll catch up once they are shown again.
+        redrawWhenShown_ = true;
         return;
     }
 
@@ -333,19 +1331,89 @@ void CanvasControl::invalidate() {
         return;
     }
 
-    if (useVSIS_) {
-        if (currentTarget_.surface_) {
-            if (auto vsisNative = currentTarget_.surface_.as<IVirtualSurfaceImageSourceNative>()) {
-                winrt::Rect rc{ 0, 0, currentTarget_.size_.Width, currentTarget_.size_.Height };
-                LogIfFailed(vsisNative->Invalidate(toRECT(rc, currentTarget_.dpi_)), "Invalidate");
-            }
+    if (useAtlas_ && ensureAtlasSlot() && frameClock_ == GfxVsyncFrameClock::shared()) {
+        // The atlases run on the same clock, no need to wait for a frame to mark the slot dirty.
+        currentTarget_.atlas_.atlas->invalidate(currentTarget_.atlas_.slot);
+        return;
+    }
+
+    requestFrame();
+}
+
+bool CanvasControl::ensureAtlasSlot() {
+    assert(useAtlas_);
+    const auto& newSize = containerSize_;
+    const auto& newDpi = containerDpi_;
+
+    if (currentTarget_.atlas_ && currentTarget_.dpi_ == newDpi && currentTarget_.size_ == newSize) {
+        return true;
+    }
+
+    auto actualPixelsWidth = sizeDipsToPixels(newSize.Width, newDpi);
+    auto actualPixelsHeight = sizeDipsToPixels(newSize.Height, newDpi);
+
+    auto allocation = GfxSurfaceAtlasManager::instance().allocate(this, actualPixelsWidth, actualPixelsHeight, newDpi);
+    if (!allocation) {
+        // Too big for an atlas slot: fall back to a surface of our own, created on the next frame.
+        if (currentTarget_.atlas_) {
+            resetRenderTarget();
         }
+        return false;
     }
-    else {
-        setupRenderingCallback();
+
+    RenderTarget target;
+    target.atlas_ = allocation;
+    target.size_ = newSize;
+    target.dpi_ = newDpi;
+    setRenderTarget(target);
+    setAtlasPresenter();
+    return true;
+}
+
+void CanvasControl::setAtlasPresenter() {
+    const auto& allocation = currentTarget_.atlas_;
+    assert(allocation);
+
+    // The brush stretches the whole atlas over the control, then the transform scales and moves it
+    // so that only our slot ends up covering the control bounds.
+    auto atlasSize = static_cast<double>(allocation.atlas->sizeInPixels());
+    auto slot = allocation.atlas->slotRect(allocation.slot);
+    auto width = static_cast<double>(currentTarget_.size_.Width);
+    auto height = static_cast<double>(currentTarget_.size_.Height);
+
+    winrt::MatrixTransform transform;
+    transform.Matrix(winrt::Matrix{atlasSize / slot.width(), 0, 0, atlasSize / slot.height(),
+        -slot.left * width / slot.width(), -slot.top * height / slot.height()});
+
+    winrt::ImageBrush brush;
+    brush.ImageSource(allocation.atlas->surface());
+    brush.Stretch(winrt::Stretch::Fill);
+    brush.Transform(transform);
+
+    winrt::Shapes::Rectangle rectangle;
+    rectangle.Fill(brush);
+    winrt::AutomationProperties::SetAccessibilityView(rectangle, winrt::Peers::AccessibilityView::Raw);
+    Content(rectangle);
+    releaseRetiredBudgetEntry();
+}
+
+void CanvasControl::drawAtlasSlot(const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F& slotRect) {
+    if (asyncResetPending_) {
+        return;
     }
+    // Slots are always drawn whole.
+    damage_.clearPending();
+    auto result = runWithDevice([&]() {
+        compositor_.draw(context, layerTarget(false), slotRect);
+        return S_OK;
+    });
+    LogIfFailed(result, "drawAtlasSlot", controlId_);
+    visibilityTracker_.onPresented(GfxVisibilityTracker::Clock::now());
 }
 
+void CanvasControl::atlasDeviceLost() {
+    handleDeviceLost();
+}
 
 HRESULT CanvasControl::ensureVirtualSurfaceImageSource() {
     assert(useVSIS_);
@@ -370,7 +1438,7 @@ HRESULT CanvasControl::ensureVirtualSurfaceImageSource() {
 
     winrt::Imaging::VirtualSurfaceImageSource surface{ nullptr };
     if (surfaceNotCreated) {
-        surface = winrt::Imaging::VirtualSurfaceImageSource{ actualPixelsWidth, actualPixelsHeight, false };
+        surface = winrt::Imaging::VirtualSurfaceImageSource{ actualPixelsWidth, actualPixelsHeight, isOpaque_ };
     }
     else {
         surface = currentTarget_.surface_.as<winrt::Imaging::VirtualSurfaceImageSource>();
@@ -401,9 +1469,10 @@ HRESULT CanvasControl::ensureVirtualSurfaceImageSource() {
         hResult = sisNative->Resize(actualPixelsWidth, actualPixelsHeight);
         if (SUCCEEDED(hResult)) {
             RECT updateRect = { 0, 0, actualPixelsWidth, actualPixelsHeight };
-            LogIfFailed(sisNative->Invalidate(updateRect), "sisNative->Invalidate(updateRect)");
+            LogIfFailed(sisNative->Invalidate(updateRect), "sisNative->Invalidate(updateRect)", controlId_);
             currentTarget_.dpi_ = newDpi;
             currentTarget_.size_ = newSize;
+            warmFrameCount_ = 0;
         }
     }
 
@@ -425,21 +1494,38 @@ HRESULT CanvasControl::performVirtualImageSourceDraw() {
         return S_OK;
     }
 
-    std::vector<RECT> updateRECTs(updateRectCount);
-    ReturnIfFailed(vsisNative->GetUpdateRects(updateRECTs.data(), updateRectCount));
-
-    std::vector<winrt::Rect> updateRects;
-    updateRects.reserve(updateRECTs.size());
-    std::transform(updateRECTs.begin(), updateRECTs.end(), std::back_inserter(updateRects), [&](const RECT& r) {
-        return toRect(r, currentTarget_.dpi_);
-    });
+    // Growing the scratch storage is the only allocation allowed once the surface is warm.
+    updateRects_.resizeForOverwrite(updateRectCount);
+    GfxNoAllocationScope noAllocation("CanvasControl::performVirtualImageSourceDraw", warmFrameCount_ > 0);
+    ReturnIfFailed(vsisNative->GetUpdateRects(updateRects_.data(), updateRectCount));
 
     RECT visibleBounds;
     ReturnIfFailed(vsisNative->GetVisibleBounds(&visibleBounds));
+    if (!EqualRect(&visibleBounds, &visibleBounds_)) {
+        visibleBounds_ = visibleBounds;
+        updateBudgetEntry();
+    }
+    GfxMemoryBudget::instance().touch(budgetEntry_);
 
-    for (auto& updateRect : updateRECTs) {
+    PixelRect updateBounds;
+    int64_t updatePixels = 0;
+    for (const auto& updateRect : updateRects_) {
+        updateBounds = updateBounds.unionWith(toPixelRect(updateRect));
+        updatePixels += toPixelRect(updateRect).area();
+    }
+    beginLayerFrame(updateBounds);
+
+    hud_.resetDrawTime();
+    auto drawStart = GfxFrameClock::Clock::now();
+    for (const auto& updateRect : updateRects_) {
         ReturnIfFailed(performD2DDraw(sisNative.get(), updateRect));
     }
+    if (!isHudOnlyUpdate(updateBounds)) {
+        hud_.addFrame(GfxFrameClock::Clock::now() - drawStart - hud_.drawTime(), updateRectCount, updatePixels);
+    }
+    visibilityTracker_.onPresented(GfxVisibilityTracker::Clock::now());
+    virtualUpdatesPending_ = false;
+    warmFrameCount_++;
     return S_OK;
 }
 
@@ -15,20 +15,40 @@
 
 #include <d2d1_1.h>
 
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "CanvasControl.g.h"
 
+#include "./GfxCompositionFrameClock.h"
 #include "./GfxD2DDeviceManager.h"
+#include "./GfxDrawStreamHashSink.h"
+#include "./GfxEffectCache.h"
+#include "./GfxFrameDamage.h"
+#include "./GfxLayerCompositor.h"
+#include "./GfxPerformanceHud.h"
+#include "./GfxResolutionScaler.h"
+#include "./GfxSmallVector.h"
+#include "./GfxSnapshotStore.h"
+#include "./GfxSurfaceAtlas.h"
+#include "./GfxTileLayout.h"
+#include "./GfxVisibilityTracker.h"
 #include "Microsoft.UI.Xaml.Media.DXInterop.h"
 #include "winrt/Microsoft.UI.Xaml.Media.h"
 #include "winrt/Microsoft.UI.Xaml.Media.Imaging.h"
+#include "winrt/Microsoft.System.h"
 #include "winrt/Windows.Foundation.h"
 
 namespace winrt::winui_drover_island::implementation {
 
-class CanvasControl : public CanvasControlT<CanvasControl> {
+class CanvasControl : public CanvasControlT<CanvasControl>,
+                      private ::winui_drover_island::GfxSurfaceAtlasClient,
+                      private ::winui_drover_island::GfxFrameClockClient,
+                      private ::winui_drover_island::GfxLayerCompositorClient,
+                      private ::winui_drover_island::GfxSnapshotSource {
  protected:
     using Image = Microsoft::UI::Xaml::Controls::Image;
     using XamlRoot = Microsoft::UI::Xaml::XamlRoot;
@@ -40,19 +60,186 @@ class CanvasControl : public CanvasControlT<CanvasControl> {
     template<typename T>
     using EventHandler = Windows::Foundation::EventHandler<T>;
     using GfxD2DDevice = ::winui_drover_island::GfxD2DDevice;
+    using GfxSurfaceAtlasManager = ::winui_drover_island::GfxSurfaceAtlasManager;
+    using GfxMemoryBudget = ::winui_drover_island::GfxMemoryBudget;
+    using GfxVisibilityTracker = ::winui_drover_island::GfxVisibilityTracker;
+    using GfxFrameClock = ::winui_drover_island::GfxFrameClock;
+    using GfxResolutionScaler = ::winui_drover_island::GfxResolutionScaler;
+    using GfxLayerStack = ::winui_drover_island::GfxLayerStack;
+    using GfxLayerCompositor = ::winui_drover_island::GfxLayerCompositor;
+    using GfxRasterLayer = ::winui_drover_island::GfxRasterLayer;
+    using GfxTiledImage = ::winui_drover_island::GfxTiledImage;
+    using GfxEffectCache = ::winui_drover_island::GfxEffectCache;
+    using GfxDrawStreamHashSink = ::winui_drover_island::GfxDrawStreamHashSink;
+    using GfxSnapshotStore = ::winui_drover_island::GfxSnapshotStore;
+    using PixelRect = ::winui_drover_island::PixelRect;
+    using LayerId = GfxLayerCompositor::LayerId;
+    using LayerKind = GfxLayerCompositor::Kind;
 
  public:
     virtual ~CanvasControl();
 
     void invalidate();
+    // Redraws the rect only, in DIPs. The rects invalidated before the next frame are merged in
+    // a few update rects; outside of them the surface keeps its pixels, and the cached content
+    // layer is only drawn again inside them. Drawing must not depend on the update rect beyond
+    // clipping. Invalidating other layers, or the whole control, still redraws everything.
+    void invalidateRect(const D2D_RECT_F& rectInDips);
+
+    const GfxVisibilityTracker::Stats& visibilityStats() const { return visibilityTracker_.stats(); }
+
+    struct FrameSkipStats {
+        uint64_t hashedFrames = 0;
+        uint64_t skippedFrames = 0;
+        // Frames drawing content that can't be hashed, like bitmaps, are always drawn.
+        uint64_t notDedupableFrames = 0;
+        // Frames drawn without recording and hashing them: a cached layer was drawn again, or
+        // the last hashed frames had all changed.
+        uint64_t unhashedFrames = 0;
+        std::chrono::steady_clock::duration hashTime{};
+
+        // Of the frames drawn with skipping on, the ones skipped.
+        double skipRate() const {
+            auto frames = hashedFrames + unhashedFrames;
+            return frames ? static_cast<double>(skippedFrames) / frames : 0.0;
+        }
+    };
+    const FrameSkipStats& frameSkipStats() const { return frameSkipStats_; }
+
+    using EffectId = GfxEffectCache::EffectId;
+    using EffectStats = GfxEffectCache::Stats;
+    // Zeroes for an effect that was never drawn.
+    EffectStats effectStats(EffectId effect) const { return effects_.stats(effect); }
+
+    // Partial frames are the ones drawing only the rects invalidated with invalidateRect().
+    using DamageStats = ::winui_drover_island::GfxFrameDamage::Stats;
+    const DamageStats& damageStats() const { return damage_.stats(); }
+
+    // A heads-up display in the top-left corner: frame times, update rects, surface size and DPI,
+    // device type, context pool occupancy and cache hit rates. It refreshes a few times per
+    // second and only redraws its own area; those frames and the time spent drawing it are left
+    // out of what it shows.
+    void setHudVisible(bool visible);
+    bool isHudVisible() const { return hudLayer_ != GfxLayerStack::kInvalidLayer; }
+
+    // A parked control is detached and kept to be attached again, by a cache of controls: it
+    // keeps its surface past the hidden grace period, so it shows its content again without
+    // drawing it, unless it was invalidated in between. The memory budget can still evict it.
+    void setParked(bool parked);
+    bool isParked() const { return parked_; }
+    // What the surfaces of the control hold, in bytes.
+    size_t surfaceBytes() const { return surfaceBytes(currentTarget_); }
+    // The surface shows a frame of the current content and size, no frame is pending.
+    bool isContentReady() const;
 
  protected:
     explicit CanvasControl(bool useVSIS);
 
     virtual void draw(const com_ptr<ID2D1DeviceContext>&, const D2D_RECT_F& updateRect) = 0;
+    // Draws the layers added with addLayer(), the content layer is drawn by draw().
+    virtual void drawLayer(const com_ptr<ID2D1DeviceContext>&, LayerId, const D2D_RECT_F&) {}
     virtual void createResources(const std::shared_ptr<GfxD2DDevice>&) {}
     virtual void destroyResources() {}
 
+    // Small controls can share an atlas surface with other controls instead of owning one.
+    // Must be called before the control is loaded. Ignored when using a virtual surface.
+    void setUseAtlas(bool useAtlas);
+
+    // Opaque controls get opaque surfaces, which the compositor doesn't need to blend. Every pixel
+    // must then be drawn, what isn't drawn shows as black. Must be called before the control is loaded.
+    // A control whose draw() fills its background sets both this and setDrawCoversUpdateRect(): the
+    // surface is then neither blended nor cleared.
+    void setIsOpaque(bool isOpaque);
+
+    // The last frame is saved when the app suspends or closes, and shown by the next run while
+    // its first frame is rendered. The name identifies the control across runs, it must be unique
+    // in the app. Must be called before the control is loaded.
+    void setSnapshotName(std::wstring name);
+
+    // When draw() fills its whole update rect, the surface doesn't need to be cleared before.
+    void setDrawCoversUpdateRect(bool covers) { drawCoversUpdateRect_ = covers; }
+
+    // How long a hidden or detached control keeps its surface before releasing it.
+    void setHiddenSurfaceGracePeriod(Windows::Foundation::TimeSpan gracePeriod);
+
+    // Surfaces larger than this, in pixels, are split in tiles. The device maximum bitmap size
+    // always applies; zero means there is no additional limit. Ignored when using a virtual surface.
+    void setTilingThreshold(int32_t pixels);
+
+    // How the previous content is shown while the frame at the new size or DPI is rendered.
+    enum class StaleContentMode {
+        // Stretched to the new size, as if nothing was done.
+        kStretch,
+        // Scaled uniformly to fit the new size.
+        kScale,
+        // Kept at its size, anchored at the top-left corner.
+        kAnchor,
+    };
+
+    // The new frame replaces the stale content as soon as it is drawn, or once the deadline is over.
+    // A zero deadline presents new surfaces right away.
+    void setStaleContentPresentation(StaleContentMode mode, Windows::Foundation::TimeSpan deadline);
+
+    // Records each frame in a command list and hashes it; when the hash matches what the surface
+    // already shows, the frame isn't submitted. Worth it for controls invalidated spuriously.
+    // Virtual surfaces always draw, their update rects are regions that have no content. Frames
+    // that can't match aren't hashed: those drawing a cached layer again, and most frames once
+    // kMaxChangedHashedFrames in a row have changed, until one is skipped again.
+    void setSkipUnchangedFrames(bool skip);
+    static constexpr uint32_t kMaxChangedHashedFrames = 8;
+    static constexpr uint32_t kHashProbeInterval = 16;
+
+    // The content drawn by draw() is a layer of its own, direct until made cached.
+    static constexpr LayerId kContentLayer = GfxLayerCompositor::kContentLayer;
+
+    // Layers are composited bottom to top, the content layer has order zero. Cached layers keep
+    // their content in a bitmap and are only drawn again when invalidated, so an overlay can be
+    // invalidated every frame without drawing the layers below. Layers must not be added or
+    // removed while drawing. Surfaces split in tiles, atlas slots and virtual surfaces draw every
+    // layer directly.
+    LayerId addLayer(std::string name, int32_t order, LayerKind kind);
+    void removeLayer(LayerId layer);
+    void setLayerKind(LayerId layer, LayerKind kind);
+    void setLayerVisible(LayerId layer, bool visible);
+    void invalidateLayer(LayerId layer);
+
+    // A direct layer showing a tiled image file, one image pixel per DIP, without draw() being
+    // called. Only the tiles in view are read and uploaded, so with a virtual surface the control
+    // can be as large as the image, however large that is. Removed with removeLayer().
+    LayerId addRasterLayer(std::string name, int32_t order, std::shared_ptr<GfxTiledImage> image);
+    const GfxRasterLayer* rasterLayer(LayerId layer) const;
+
+    // While the user interacts, frames are rendered at a fraction of the container DPI chosen to
+    // fit the target frame time and stretched up; the control renders again at full resolution
+    // once the interaction is idle. Resizing counts as an interaction. Ignored by virtual surfaces.
+    void setDynamicResolution(bool enabled, const GfxResolutionScaler::Options& options = {});
+    void beginInteraction();
+    void endInteraction();
+    // For discrete interactions, like a wheel zoom: interacting until the idle delay is over.
+    void notifyInteraction();
+    float resolutionScale() const { return resolutionScaler_.scale(); }
+
+    // Blurs and shadows of content drawn by a callback, cached in bitmaps by GfxEffectCache.
+    using Effect = GfxEffectCache::Effect;
+    using DrawEffectSource = GfxEffectCache::DrawSource;
+
+    // Called from draw() or drawLayer(): draws the effect of what drawSource draws inside
+    // sourceRect, in the coordinates of the context. The caller changes sourceGeneration whenever
+    // the source content changes; drawSource is only called when the effect is rendered again.
+    void drawCachedEffect(const com_ptr<ID2D1DeviceContext>& context, EffectId id, uint64_t sourceGeneration,
+        const D2D_RECT_F& sourceRect, const Effect& effect, const DrawEffectSource& drawSource);
+    void releaseCachedEffect(EffectId id);
+
+    // Called from draw() or drawLayer(): draws the image file centered in rect, keeping its aspect
+    // ratio. GfxImageService decodes it off the UI thread at the size it is shown at, so until it
+    // is uploaded nothing is drawn, false is returned and the control is invalidated once it is.
+    bool drawImage(const com_ptr<ID2D1DeviceContext>& context, const std::wstring& path, const D2D_RECT_F& rect);
+
+    // Decides when invalidations are drawn: on every composition frame by default, or throttled,
+    // manual, etc. A pending frame moves to the new clock.
+    void setFrameClock(std::shared_ptr<GfxFrameClock> clock);
+    const std::shared_ptr<GfxFrameClock>& frameClock() const { return frameClock_; }
+
  private:
     std::shared_ptr<GfxD2DDevice> device();
 
@@ -60,56 +247,181 @@ class CanvasControl : public CanvasControlT<CanvasControl> {
         SurfaceImageSource surface_{nullptr};
         Windows::Foundation::Size size_;
         float dpi_ = 0;
+        GfxSurfaceAtlasManager::Allocation atlas_;
+        // Used instead of surface_ when the control is larger than a single surface can be.
+        std::vector<SurfaceImageSource> tiles_;
+        ::winui_drover_island::GfxTileLayout tileLayout_;
+
+        bool hasSurface() const { return surface_ || !tiles_.empty() || atlas_; }
     };
 
-    HRESULT runWithDevice(std::function<HRESULT()>&&);
+    template <typename Fn>
+    HRESULT runWithDevice(Fn&& fn);
 
     void onContainerLoaded(const IInspectable& sender, const Microsoft::UI::Xaml::RoutedEventArgs& e);
+    void onContainerUnloaded(const IInspectable& sender, const Microsoft::UI::Xaml::RoutedEventArgs& e);
     void onContainerSizeChanged(const IInspectable& sender, const Microsoft::UI::Xaml::SizeChangedEventArgs& e);
+    void onEffectiveViewportChanged(const FrameworkElement&, const Microsoft::UI::Xaml::EffectiveViewportChangedEventArgs&);
     void onRootChanged(const XamlRoot&, const Microsoft::UI::Xaml::XamlRootChangedEventArgs&);
-    void onCompositorDraw(const IInspectable&, const IInspectable&);
+    void onVisibilityChanged(const Microsoft::UI::Xaml::DependencyObject&, const Microsoft::UI::Xaml::DependencyProperty&);
+    void onFrame(GfxFrameClock::Clock::time_point now) override;
+    void saveSnapshot() override;
+    void showSnapshot();
+    GfxSnapshotStore::Key snapshotKey() const;
     void onCompositorSurfaceContentsLost(const IInspectable&, const IInspectable&);
 
     Image containerImage();
+    Image createImagePresenter();
+    void setTiledPresenter();
+    void presentRenderTarget();
+    void releaseRetiredBudgetEntry();
+    void beginStalePresentation();
+    void endStalePresentation();
+    void onStaleDeadlineTick(const Microsoft::System::DispatcherQueueTimer&, const IInspectable&);
 
     void ensureSurfaceImageSource();
-    HRESULT performD2DDraw(ISurfaceImageSourceNativeWithD2D* sisNative, const RECT& updateRect);
-    HRESULT performImageSourceDraw();
+    int32_t maximumSurfaceSizeInPixels();
+    float renderDpi() const;
+    bool isInteracting() const;
+    void onInteractionIdle(const Microsoft::System::DispatcherQueueTimer&, const IInspectable&);
+    // hashSlot identifies the surface for the frame skipping, negative when it doesn't apply.
+    HRESULT performD2DDraw(ISurfaceImageSourceNativeWithD2D* sisNative, const RECT& updateRect, POINT origin = {}, int32_t hashSlot = -1);
+    bool shouldHashFrame(int32_t hashSlot, bool useLayerCache);
+    HRESULT recordFrame(const D2D_RECT_F& drawRect, bool useLayerCache, com_ptr<ID2D1CommandList>& commandList);
+    uint64_t hashFrame(ID2D1CommandList* commandList, const RECT& updateRect, POINT origin, bool clear);
+    HRESULT performImageSourceDraw(bool fullRedraw);
+    PixelRect surfaceBoundsInPixels() const;
+    GfxLayerCompositor::Target layerTarget(bool useLayerCache) const;
+    // The update bounds are in surface pixels.
+    void beginLayerFrame(const PixelRect& updateBounds);
+    void drawLayerContent(const com_ptr<ID2D1DeviceContext>& context, LayerId layer, const D2D_RECT_F& updateRect) override;
+    void onHudTimerTick(const Microsoft::System::DispatcherQueueTimer&, const IInspectable&);
+    // Frames updating the HUD area only are its own refreshes.
+    bool isHudOnlyUpdate(const PixelRect& updateBounds) const;
+    // Parked layer bitmaps are restored rather than drawn again, see GfxLayerCompositor.
+    void releaseLayerBitmaps(bool park = false);
+    void evictLayerBitmaps() override { releaseLayerBitmaps(true); }
     void setImageSource(SurfaceImageSource source);
     void resetImageSource();
     void setRenderTarget(const RenderTarget&);
     void resetRenderTarget();
 
+    // Visibility tracking and memory budget accounting
+    bool isShown();
+    void updateShownState();
+    void onGraceTimerTick(const Microsoft::System::DispatcherQueueTimer&, const IInspectable&);
+    size_t surfaceBytes(const RenderTarget&) const;
+    void updateBudgetEntry();
+    void evictSurface();
+
+    void scheduleRedraw();
+    void scheduleFrame();
     void invalidateDueToInternalChange();
     void postAsyncReset();
     void resetNowIfNeeded();
     void handleDeviceLost();
 
-    void setupRenderingCallback();
-    void removeRenderingCallback();
+    void requestFrame();
+    void cancelFrame();
+
+    // Atlas specific methods
+    bool ensureAtlasSlot();
+    void setAtlasPresenter();
+    void drawAtlasSlot(const com_ptr<ID2D1DeviceContext>&, const D2D_RECT_F& slotRect) override;
+    void atlasDeviceLost() override;
 
     // Virtual surface specific methods
     HRESULT ensureVirtualSurfaceImageSource();
     HRESULT performVirtualImageSourceDraw();
 
     FrameworkElement::Loaded_revoker loadedHandler_;
+    FrameworkElement::Unloaded_revoker unloadedHandler_;
+    FrameworkElement::EffectiveViewportChanged_revoker viewportChangedHandler_;
     XamlRoot::Changed_revoker rootChangedHandler_;
-    CompositionTarget::Rendering_revoker compositorRenderingHandler_;
     CompositionTarget::SurfaceContentsLost_revoker compositorSurfaceLostHandler_;
 
+    int64_t visibilityChangedToken_ = 0;
+    Microsoft::System::DispatcherQueueTimer graceTimer_{nullptr};
+    Microsoft::System::DispatcherQueueTimer::Tick_revoker graceTimerHandler_;
+    GfxVisibilityTracker visibilityTracker_;
+
+    Microsoft::System::DispatcherQueueTimer staleDeadlineTimer_{nullptr};
+    Microsoft::System::DispatcherQueueTimer::Tick_revoker staleDeadlineTimerHandler_;
+    Windows::Foundation::TimeSpan staleContentDeadline_ = std::chrono::milliseconds(500);
+    StaleContentMode staleContentMode_ = StaleContentMode::kAnchor;
+
+    GfxResolutionScaler resolutionScaler_;
+    Microsoft::System::DispatcherQueueTimer interactionIdleTimer_{nullptr};
+    Microsoft::System::DispatcherQueueTimer::Tick_revoker interactionIdleTimerHandler_;
+    uint32_t interactionDepth_ = 0;
+    bool interactionIdlePending_ = false;
+    bool dynamicResolution_ = false;
+    // The previous content is on screen while the current render target waits for its first frame.
+    bool staleContentShown_ = false;
+    bool presenterPending_ = false;
+
     Windows::Foundation::Size containerSize_;
     float containerDpi_ = 0;
 
     RenderTarget currentTarget_;
+    RECT visibleBounds_ = {};
+    // Reused by every virtual surface update, so a warm frame doesn't allocate.
+    ::winui_drover_island::GfxSmallVector<RECT, 8> updateRects_;
+    // Frames drawn since the render target or the device changed, only later frames must not allocate.
+    uint32_t warmFrameCount_ = 0;
+    GfxMemoryBudget::EntryId budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+    // The entry of the previous render target while its surface is still presented.
+    GfxMemoryBudget::EntryId retiredBudgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+
+    // Per surface, the hash of the frame it shows, zero when unknown, and of the last frame hashed.
+    struct FrameHashes {
+        uint64_t presented = 0;
+        uint64_t hashed = 0;
+    };
+    FrameHashes& frameHashes(int32_t hashSlot);
+    std::vector<FrameHashes> frameHashes_;
+    com_ptr<GfxDrawStreamHashSink> frameHashSink_;
+    FrameSkipStats frameSkipStats_;
+    // Hashed frames in a row that weren't skipped, and frames drawn since the last hashed one.
+    uint32_t changedHashedFrames_ = 0;
+    uint32_t framesSinceHash_ = 0;
+
+    // In surface pixels. The draw callbacks may add damage for the next frame.
+    ::winui_drover_island::GfxFrameDamage damage_;
+    // The virtual surface was invalidated and hasn't asked for the regions yet.
+    bool virtualUpdatesPending_ = false;
+
+    ::winui_drover_island::GfxPerformanceHud hud_;
+    LayerId hudLayer_ = GfxLayerStack::kInvalidLayer;
+    Microsoft::System::DispatcherQueueTimer hudTimer_{nullptr};
+    Microsoft::System::DispatcherQueueTimer::Tick_revoker hudTimerHandler_;
+    bool skipUnchangedFrames_ = false;
 
     std::shared_ptr<GfxD2DDevice> device_;
+    std::shared_ptr<GfxFrameClock> frameClock_;
 
-    bool renderingPending_ = false;
+    bool framePending_ = false;
     bool loaded_ = false;
+    bool attached_ = false;
+    bool inViewport_ = true;
+    bool redrawWhenShown_ = false;
+    bool parked_ = false;
 
     bool asyncResetPending_ = false;
 
+    // Identifies the control in the log records.
+    const uint64_t controlId_;
+    GfxLayerCompositor compositor_;
+    GfxEffectCache effects_;
+
+    std::wstring snapshotName_;
+    bool snapshotChecked_ = false;
+
     const bool useVSIS_ = false;
+    bool useAtlas_ = false;
+    bool isOpaque_ = false;
+    bool drawCoversUpdateRect_ = false;
+    int32_t tilingThreshold_ = 0;
 };
 
 }  // namespace winui_drover_island
@@ -24,20 +24,147 @@ using namespace winrt::Windows::Foundation;
 namespace winui_drover_island {
 
 DroverIsland::DroverIsland(bool useVSIS) : CanvasControl(useVSIS) {
-
+	// The island scene is the expensive part, overlays drawn on top must not redraw it.
+	setLayerKind(kContentLayer, LayerKind::kCached);
+	setIsOpaque(true);
+	setDrawCoversUpdateRect(true);
+	// Containers re-raise size changes that leave the scene as it is.
+	setSkipUnchangedFrames(true);
+	// Shown at the next launch until the scene has been drawn.
+	setSnapshotName(L"DroverIsland");
+	mScene.setChangeListener([this](const GfxScene::Rect& oldBounds, const GfxScene::Rect& newBounds) {
+		for (const auto& bounds : { oldBounds, newBounds }) {
+			if (!bounds.isEmpty()) {
+				invalidateRect(D2D1::RectF(bounds.left, bounds.top, bounds.right, bounds.bottom));
+			}
+		}
+	});
 }
 
 
-void DroverIsland::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F&) {
+bool DroverIsland::loadScene(const std::filesystem::path& path) {
+	bool loaded = mScene.open(path);
+	invalidate();
+	return loaded;
+}
+
+void DroverIsland::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F& updateRect) {
 	// beginDraw and endDraw are not needed. The DPI, offset translation has been taken care of.
 	// It is ok to throw, the control will handle the exceptions.
-	
-	// Nothing here yet... 😢
-	// The code to draw the drover controls will be here.
-	context->Clear(D2D1::ColorF(D2D1::ColorF::Red));
+	if (!mScene.isOpen()) {
+		// Nothing here yet... 😢
+		context->Clear(D2D1::ColorF(D2D1::ColorF::Red));
+		return;
+	}
+
+	context->Clear(D2D1::ColorF(D2D1::ColorF::White));
+	if (!mBrush) {
+		ThrowIfFailed(context->CreateSolidColorBrush(D2D1::ColorF(D2D1::ColorF::Black), mBrush.put()));
+	}
+	mVisibleNodes.clear();
+	mScene.nodesIntersecting({ updateRect.left, updateRect.top, updateRect.right, updateRect.bottom }, mVisibleNodes);
+	for (auto index : mVisibleNodes) {
+		drawNode(context, mScene.node(index));
+	}
+}
+
+void DroverIsland::drawNode(const winrt::com_ptr<ID2D1DeviceContext>& context, const GfxScene::Node& node) {
+	const auto& style = mScene.style(node.style);
+	auto color = [](const float(&rgba)[4]) { return D2D1::ColorF(rgba[0], rgba[1], rgba[2], rgba[3]); };
+	bool fill = (style.flags & GfxScene::kFill) != 0;
+	bool stroke = (style.flags & GfxScene::kStroke) != 0 && style.strokeWidth > 0;
+	// The node bounds include the stroke, which is centered on the shape outline.
+	float inset = stroke ? style.strokeWidth / 2 : 0;
+	auto shape = D2D1::RectF(node.bounds.left + inset, node.bounds.top + inset, node.bounds.right - inset, node.bounds.bottom - inset);
+
+	switch (node.kind) {
+	case GfxScene::NodeKind::kRect: {
+		auto rounded = D2D1::RoundedRect(shape, style.cornerRadius, style.cornerRadius);
+		if (fill) {
+			mBrush->SetColor(color(style.fill));
+			if (style.cornerRadius > 0) {
+				context->FillRoundedRectangle(rounded, mBrush.get());
+			} else {
+				context->FillRectangle(shape, mBrush.get());
+			}
+		}
+		if (stroke) {
+			mBrush->SetColor(color(style.stroke));
+			if (style.cornerRadius > 0) {
+				context->DrawRoundedRectangle(rounded, mBrush.get(), style.strokeWidth);
+			} else {
+				context->DrawRectangle(shape, mBrush.get(), style.strokeWidth);
+			}
+		}
+		break;
+	}
+	case GfxScene::NodeKind::kEllipse: {
+		auto center = D2D1::Point2F((shape.left + shape.right) / 2, (shape.top + shape.bottom) / 2);
+		auto ellipse = D2D1::Ellipse(center, (shape.right - shape.left) / 2, (shape.bottom - shape.top) / 2);
+		if (fill) {
+			mBrush->SetColor(color(style.fill));
+			context->FillEllipse(ellipse, mBrush.get());
+		}
+		if (stroke) {
+			mBrush->SetColor(color(style.stroke));
+			context->DrawEllipse(ellipse, mBrush.get(), style.strokeWidth);
+		}
+		break;
+	}
+	case GfxScene::NodeKind::kPolyline: {
+		uint32_t count = 0;
+		const auto* points = mScene.points(node, count);
+		if (!stroke || count < 2) {
+			break;
+		}
+		mBrush->SetColor(color(style.stroke));
+		for (uint32_t i = 1; i < count; ++i) {
+			context->DrawLine(D2D1::Point2F(points[i - 1].x, points[i - 1].y), D2D1::Point2F(points[i].x, points[i].y),
+				mBrush.get(), style.strokeWidth);
+		}
+		break;
+	}
+	case GfxScene::NodeKind::kText: {
+		auto text = mScene.text(node);
+		auto* format = textFormat(style.fontSize);
+		if (text.empty() || !format) {
+			break;
+		}
+		auto length = MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), nullptr, 0);
+		mText.resize(static_cast<size_t>(length));
+		MultiByteToWideChar(CP_UTF8, 0, text.data(), static_cast<int>(text.size()), mText.data(), length);
+		mBrush->SetColor(color(style.fill));
+		auto layoutRect = D2D1::RectF(node.bounds.left, node.bounds.top, node.bounds.right, node.bounds.bottom);
+		context->DrawText(mText.data(), static_cast<UINT32>(mText.size()), format, layoutRect, mBrush.get());
+		break;
+	}
+	case GfxScene::NodeKind::kGroup:
+		break;
+	}
+}
+
+IDWriteTextFormat* DroverIsland::textFormat(float fontSize) {
+	if (!(fontSize > 0)) {
+		return nullptr;
+	}
+	for (const auto& entry : mTextFormats) {
+		if (entry.first == fontSize) {
+			return entry.second.get();
+		}
+	}
+	if (!mTextFactory) {
+		ThrowIfFailed(DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory), reinterpret_cast<IUnknown**>(mTextFactory.put())));
+	}
+	winrt::com_ptr<IDWriteTextFormat> format;
+	ThrowIfFailed(mTextFactory->CreateTextFormat(L"Segoe UI", nullptr, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+		DWRITE_FONT_STRETCH_NORMAL, fontSize, L"", format.put()));
+	mTextFormats.emplace_back(fontSize, format);
+	return format.get();
 }
 
 void DroverIsland::destroyResources() {
+	// The text formats don't depend on the device.
+	mBrush = nullptr;
 }
 
 }  // namespace winrt::winui_drover_island::implementation
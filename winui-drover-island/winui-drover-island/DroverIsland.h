@@ -13,7 +13,15 @@
 
 #pragma once
 
+#include <dwrite.h>
+
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "./CanvasControl.h"
+#include "./GfxScene.h"
 
 namespace winui_drover_island {
 
@@ -22,9 +30,26 @@ class DroverIsland : public winrt::winui_drover_island::implementation::CanvasCo
     explicit DroverIsland(bool useVSIS);
     ~DroverIsland() override = default;
 
+    // The document is drawn straight from the mapping of its scene file: opening it costs the
+    // same whatever its size, and only the nodes in the update rect are read.
+    bool loadScene(const std::filesystem::path& path);
+    // Node edits made through the scene redraw only the area the nodes covered and now cover.
+    GfxScene& scene() { return mScene; }
+
 protected:
     void draw(const winrt::com_ptr<ID2D1DeviceContext>&, const D2D_RECT_F& updateRect) override;
     void destroyResources() override;
+
+    void drawNode(const winrt::com_ptr<ID2D1DeviceContext>&, const GfxScene::Node& node);
+    IDWriteTextFormat* textFormat(float fontSize);
+
+    GfxScene mScene;
+    std::vector<uint32_t> mVisibleNodes;
+    std::wstring mText;
+    // One brush for every node, its color is set before each draw.
+    winrt::com_ptr<ID2D1SolidColorBrush> mBrush;
+    winrt::com_ptr<IDWriteFactory> mTextFactory;
+    std::vector<std::pair<float, winrt::com_ptr<IDWriteTextFormat>>> mTextFormats;
 };
 
 }  // namespace winui_drover_island
@@ -16,6 +16,11 @@
 #include "./EllipseShape.h"
 #include "./GfxUtils.h"
 
+#include <cmath>
+
+#include <winrt/Windows.ApplicationModel.h>
+#include <winrt/Windows.Storage.h>
+
 namespace winrt {
 using namespace winrt::Windows::Foundation;
 }  // namespace winrt
@@ -23,8 +28,23 @@ using namespace winrt::Windows::Foundation;
 
 namespace winui_drover_island {
 
-EllipseShape::EllipseShape(bool useVSIS) : CanvasControl(useVSIS) {
+namespace {
+
+// The logo of the package, shown as a skin in the ellipse.
+std::wstring skinPath() {
+	try {
+		return std::wstring(winrt::Windows::ApplicationModel::Package::Current().InstalledLocation().Path()) + L"\\Images\\Square150x150Logo.scale-200.png";
+	} catch (const winrt::hresult_error&) {
+		// Not running packaged, there is no skin.
+		return {};
+	}
+}
+
+}  // namespace
 
+EllipseShape::EllipseShape(bool useVSIS) : CanvasControl(useVSIS), mSkinPath(skinPath()) {
+	setIsOpaque(true);
+	setDrawCoversUpdateRect(true);
 }
 
 void EllipseShape::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F& rect) {
@@ -43,6 +63,13 @@ void EllipseShape::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const
 	}
 
 	context->FillEllipse(ellipse, mEllipseBrush.get());
+
+	if (!mSkinPath.empty()) {
+		// In the square inscribed in the ellipse. Decoded at that size, the first frames draw without it.
+		float halfWidth = rx / std::sqrt(2.f);
+		float halfHeight = ry / std::sqrt(2.f);
+		drawImage(context, mSkinPath, D2D1::RectF(center.x - halfWidth, center.y - halfHeight, center.x + halfWidth, center.y + halfHeight));
+	}
 }
 
 void EllipseShape::destroyResources() {
@@ -27,6 +27,7 @@ protected:
     void destroyResources() override;
 
     winrt::com_ptr<ID2D1Brush> mEllipseBrush;
+    std::wstring mSkinPath;
 };
 
 }  // namespace winui_drover_island
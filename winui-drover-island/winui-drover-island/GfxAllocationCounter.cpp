@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxAllocationCounter.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace winui_drover_island {
+
+namespace {
+
+thread_local uint64_t tAllocationCount = 0;
+std::atomic<GfxNoAllocationScope::ViolationHandler> sViolationHandler{nullptr};
+std::atomic<uint64_t> sViolationCount{0};
+
+}  // namespace
+
+uint64_t GfxAllocationCounter::threadAllocationCount() {
+    return tAllocationCount;
+}
+
+void GfxAllocationCounter::recordAllocation() {
+    tAllocationCount++;
+}
+
+GfxNoAllocationScope::GfxNoAllocationScope(const char* site, bool enabled)
+    : site_(site), enabled_(enabled && GfxAllocationCounter::isEnabled()) {
+    if (enabled_) {
+        start_ = GfxAllocationCounter::threadAllocationCount();
+    }
+}
+
+GfxNoAllocationScope::~GfxNoAllocationScope() {
+    auto count = allocationCount();
+    if (count == 0) {
+        return;
+    }
+    sViolationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto handler = sViolationHandler.load(std::memory_order_acquire)) {
+        handler(site_, count);
+    } else {
+        assert(!"Heap allocation in a GfxNoAllocationScope");
+    }
+}
+
+uint64_t GfxNoAllocationScope::allocationCount() const {
+    return enabled_ ? GfxAllocationCounter::threadAllocationCount() - start_ : 0;
+}
+
+void GfxNoAllocationScope::setViolationHandler(ViolationHandler handler) {
+    sViolationHandler.store(handler, std::memory_order_release);
+}
+
+uint64_t GfxNoAllocationScope::violationCount() {
+    return sViolationCount.load(std::memory_order_relaxed);
+}
+
+}  // namespace winui_drover_island
+
+#if defined(GFX_COUNT_ALLOCATIONS)
+
+// The array and nothrow forms of the default operator new all end up here.
+void* operator new(std::size_t size) {
+    winui_drover_island::GfxAllocationCounter::recordAllocation();
+    if (size == 0) {
+        size = 1;
+    }
+    while (true) {
+        if (void* p = std::malloc(size)) {
+            return p;
+        }
+        auto handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+#endif
@@ -0,0 +1,61 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace winui_drover_island {
+
+// Counts the heap allocations made through the global operator new on the calling thread.
+// Counting is only compiled in when GFX_COUNT_ALLOCATIONS is defined, in which case the global
+// operator new is replaced; otherwise the count stays at zero and the scopes below do nothing.
+class GfxAllocationCounter {
+ public:
+    static constexpr bool isEnabled() {
+#if defined(GFX_COUNT_ALLOCATIONS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static uint64_t threadAllocationCount();
+    static void recordAllocation();
+};
+
+// Marks a region that must not allocate, such as a frame drawn once the surface and the
+// resources exist. Allocations made on the calling thread while the scope is alive are reported
+// to the violation handler when it ends; by default they trigger an assert.
+class GfxNoAllocationScope {
+ public:
+    using ViolationHandler = void (*)(const char* site, uint64_t allocationCount);
+
+    explicit GfxNoAllocationScope(const char* site, bool enabled = true);
+    ~GfxNoAllocationScope();
+
+    GfxNoAllocationScope(GfxNoAllocationScope const&) = delete;
+    GfxNoAllocationScope& operator=(GfxNoAllocationScope const&) = delete;
+
+    uint64_t allocationCount() const;
+
+    static void setViolationHandler(ViolationHandler handler);
+    static uint64_t violationCount();
+
+ private:
+    const char* site_;
+    uint64_t start_ = 0;
+    bool enabled_ = false;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxAtlasLayout.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace winui_drover_island {
+
+GfxAtlasLayout::GfxAtlasLayout(int32_t width, int32_t height) : packer_(width, height) {}
+
+GfxAtlasLayout::SlotId GfxAtlasLayout::addSlot(int32_t width, int32_t height) {
+    auto rect = packer_.allocate(width, height);
+    if (!rect) {
+        return kInvalidSlot;
+    }
+    SlotId id = nextSlotId_++;
+    if (nextSlotId_ == kInvalidSlot) {
+        nextSlotId_++;
+    }
+    // New slots have undefined content, so they always start dirty.
+    slots_.emplace(id, Slot{*rect, true});
+    dirtyCount_++;
+    return id;
+}
+
+void GfxAtlasLayout::removeSlot(SlotId slot) {
+    auto it = slots_.find(slot);
+    assert(it != slots_.end());
+    if (it == slots_.end()) {
+        return;
+    }
+    if (it->second.dirty) {
+        dirtyCount_--;
+    }
+    packer_.release(it->second.rect);
+    slots_.erase(it);
+}
+
+PixelRect GfxAtlasLayout::slotRect(SlotId slot) const {
+    auto it = slots_.find(slot);
+    return it != slots_.end() ? it->second.rect : PixelRect{};
+}
+
+void GfxAtlasLayout::markDirty(SlotId slot) {
+    auto it = slots_.find(slot);
+    if (it != slots_.end() && !it->second.dirty) {
+        it->second.dirty = true;
+        dirtyCount_++;
+    }
+}
+
+void GfxAtlasLayout::markAllDirty() {
+    for (auto& entry : slots_) {
+        entry.second.dirty = true;
+    }
+    dirtyCount_ = slots_.size();
+}
+
+bool GfxAtlasLayout::takeBatch(Batch& batch) {
+    batch.updateRect = {};
+    batch.slots.clear();
+    if (dirtyCount_ == 0) {
+        return false;
+    }
+
+    for (const auto& entry : slots_) {
+        if (entry.second.dirty) {
+            batch.updateRect = batch.updateRect.unionWith(entry.second.rect);
+        }
+    }
+    for (auto& entry : slots_) {
+        if (entry.second.dirty || entry.second.rect.intersects(batch.updateRect)) {
+            batch.slots.push_back(entry.first);
+            entry.second.dirty = false;
+        }
+    }
+    std::sort(batch.slots.begin(), batch.slots.end());
+    dirtyCount_ = 0;
+    return true;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "./GfxRect.h"
+#include "./GfxRectPacker.h"
+
+namespace winui_drover_island {
+
+// Bookkeeping for an atlas surface shared by many small controls: which slot belongs to which
+// control, which slots are dirty, and which single update rect has to be drawn this frame.
+// It has no graphics dependencies so the packing and batching decisions can be tested headless.
+class GfxAtlasLayout {
+ public:
+    using SlotId = uint32_t;
+    static constexpr SlotId kInvalidSlot = 0;
+
+    struct Batch {
+        // The only rect passed to BeginDraw this frame.
+        PixelRect updateRect;
+        // Every slot intersecting updateRect, sorted by id. The surface does not preserve pixels
+        // inside the update rect, so clean slots that happen to overlap it are redrawn as well.
+        std::vector<SlotId> slots;
+    };
+
+    GfxAtlasLayout(int32_t width, int32_t height);
+
+    SlotId addSlot(int32_t width, int32_t height);
+    void removeSlot(SlotId slot);
+
+    PixelRect slotRect(SlotId slot) const;
+
+    void markDirty(SlotId slot);
+    void markAllDirty();
+    bool hasDirtySlots() const { return dirtyCount_ != 0; }
+
+    // Fills the batch for this frame and clears the dirty flags. Returns false if nothing is dirty.
+    bool takeBatch(Batch& batch);
+
+    size_t slotCount() const { return slots_.size(); }
+    bool isEmpty() const { return slots_.empty(); }
+
+    int32_t width() const { return packer_.width(); }
+    int32_t height() const { return packer_.height(); }
+
+ private:
+    struct Slot {
+        PixelRect rect;
+        bool dirty = false;
+    };
+
+    GfxRectPacker packer_;
+    std::unordered_map<SlotId, Slot> slots_;
+    SlotId nextSlotId_ = kInvalidSlot + 1;
+    size_t dirtyCount_ = 0;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,232 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxBlur.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define GFX_BLUR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace winui_drover_island {
+
+namespace {
+
+#if GFX_BLUR_SSE2
+inline __m128i loadPixel(const uint8_t* pixel) {
+    uint32_t value;
+    memcpy(&value, pixel, 4);
+    auto zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(value)), zero), zero);
+}
+
+inline void storePixel(uint8_t* pixel, __m128i sum, __m128 scale) {
+    auto average = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale), _mm_set1_ps(0.5f)));
+    auto packed = _mm_packus_epi16(_mm_packs_epi32(average, average), average);
+    auto value = static_cast<uint32_t>(_mm_cvtsi128_si32(packed));
+    memcpy(pixel, &value, 4);
+}
+#endif
+
+inline uint8_t average(uint32_t sum, float scale) {
+    return static_cast<uint8_t>(static_cast<int32_t>(static_cast<float>(sum) * scale + 0.5f));
+}
+
+}  // namespace
+
+void GfxBlur::gaussianBoxRadii(float standardDeviation, int32_t (&radii)[kGaussianPasses]) {
+    // Box widths whose successive passes have the variance of the Gaussian: all the passes use the
+    // odd width just below the ideal one, or the next odd width.
+    const float n = kGaussianPasses;
+    float variance = std::max(standardDeviation, 0.f) * std::max(standardDeviation, 0.f);
+    auto lower = static_cast<int32_t>(std::floor(std::sqrt(12.f * variance / n + 1.f)));
+    if (lower % 2 == 0) {
+        lower--;
+    }
+    auto lowerCount = static_cast<int32_t>(
+        std::lround((12.f * variance - n * lower * lower - 4.f * n * lower - 3.f * n) / (-4.f * lower - 4.f)));
+    for (int32_t i = 0; i < kGaussianPasses; ++i) {
+        auto boxWidth = i < lowerCount ? lower : lower + 2;
+        radii[i] = (boxWidth - 1) / 2;
+    }
+}
+
+int32_t GfxBlur::gaussianExtent(float standardDeviation) {
+    int32_t radii[kGaussianPasses];
+    gaussianBoxRadii(standardDeviation, radii);
+    int32_t extent = 0;
+    for (auto radius : radii) {
+        extent += radius;
+    }
+    return extent;
+}
+
+void GfxBlur::gaussianBlur(uint8_t* pixels, int32_t width, int32_t height, size_t stride, float standardDeviation) {
+    int32_t radii[kGaussianPasses];
+    gaussianBoxRadii(standardDeviation, radii);
+    for (auto radius : radii) {
+        boxBlur(pixels, width, height, stride, radius);
+    }
+}
+
+void GfxBlur::boxBlur(uint8_t* pixels, int32_t width, int32_t height, size_t stride, int32_t radius) {
+    if (radius <= 0 || width <= 0 || height <= 0) {
+        return;
+    }
+    horizontalPass(pixels, width, height, stride, radius);
+    verticalPass(pixels, width, height, stride, radius);
+}
+
+void GfxBlur::horizontalPass(uint8_t* pixels, int32_t width, int32_t height, size_t stride, int32_t radius) {
+    // Each row is copied between transparent margins, so the window never needs bounds checks.
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const size_t marginBytes = static_cast<size_t>(radius) * 4;
+    paddedRow_.assign(rowBytes + 2 * marginBytes, 0);
+    const float scale = 1.f / static_cast<float>(2 * radius + 1);
+    const int32_t window = 2 * radius;
+
+    for (int32_t y = 0; y < height; ++y) {
+        uint8_t* row = pixels + static_cast<size_t>(y) * stride;
+        memcpy(paddedRow_.data() + marginBytes, row, rowBytes);
+        const uint8_t* padded = paddedRow_.data();
+#if GFX_BLUR_SSE2
+        auto scaleVector = _mm_set1_ps(scale);
+        auto sum = _mm_setzero_si128();
+        for (int32_t x = 0; x < window; ++x) {
+            sum = _mm_add_epi32(sum, loadPixel(padded + x * 4));
+        }
+        for (int32_t x = 0; x < width; ++x) {
+            sum = _mm_add_epi32(sum, loadPixel(padded + (x + window) * 4));
+            storePixel(row + x * 4, sum, scaleVector);
+            sum = _mm_sub_epi32(sum, loadPixel(padded + x * 4));
+        }
+#else
+        uint32_t sum[4] = {};
+        for (int32_t x = 0; x < window; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                sum[c] += padded[x * 4 + c];
+            }
+        }
+        for (int32_t x = 0; x < width; ++x) {
+            for (int c = 0; c < 4; ++c) {
+                sum[c] += padded[(x + window) * 4 + c];
+                row[x * 4 + c] = average(sum[c], scale);
+                sum[c] -= padded[x * 4 + c];
+            }
+        }
+#endif
+    }
+}
+
+void GfxBlur::verticalPass(uint8_t* pixels, int32_t width, int32_t height, size_t stride, int32_t radius) {
+    // Runs down the image with the sums of each column of channels. The rows are blurred in place:
+    // the original rows still inside the window are kept in a ring.
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+    const size_t ringRows = static_cast<size_t>(radius) + 1;
+    rowRing_.resize(ringRows * rowBytes);
+    columnSums_.assign(rowBytes, 0);
+    const float scale = 1.f / static_cast<float>(2 * radius + 1);
+    uint32_t* sums = columnSums_.data();
+
+    auto addRow = [&](const uint8_t* row) {
+        size_t i = 0;
+#if GFX_BLUR_SSE2
+        auto zero = _mm_setzero_si128();
+        for (; i + 16 <= rowBytes; i += 16) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            auto low = _mm_unpacklo_epi8(bytes, zero);
+            auto high = _mm_unpackhi_epi8(bytes, zero);
+            auto* sum = reinterpret_cast<__m128i*>(sums + i);
+            _mm_storeu_si128(sum, _mm_add_epi32(_mm_loadu_si128(sum), _mm_unpacklo_epi16(low, zero)));
+            _mm_storeu_si128(sum + 1, _mm_add_epi32(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi16(low, zero)));
+            _mm_storeu_si128(sum + 2, _mm_add_epi32(_mm_loadu_si128(sum + 2), _mm_unpacklo_epi16(high, zero)));
+            _mm_storeu_si128(sum + 3, _mm_add_epi32(_mm_loadu_si128(sum + 3), _mm_unpackhi_epi16(high, zero)));
+        }
+#endif
+        for (; i < rowBytes; ++i) {
+            sums[i] += row[i];
+        }
+    };
+    auto subtractRow = [&](const uint8_t* row) {
+        size_t i = 0;
+#if GFX_BLUR_SSE2
+        auto zero = _mm_setzero_si128();
+        for (; i + 16 <= rowBytes; i += 16) {
+            auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            auto low = _mm_unpacklo_epi8(bytes, zero);
+            auto high = _mm_unpackhi_epi8(bytes, zero);
+            auto* sum = reinterpret_cast<__m128i*>(sums + i);
+            _mm_storeu_si128(sum, _mm_sub_epi32(_mm_loadu_si128(sum), _mm_unpacklo_epi16(low, zero)));
+            _mm_storeu_si128(sum + 1, _mm_sub_epi32(_mm_loadu_si128(sum + 1), _mm_unpackhi_epi16(low, zero)));
+            _mm_storeu_si128(sum + 2, _mm_sub_epi32(_mm_loadu_si128(sum + 2), _mm_unpacklo_epi16(high, zero)));
+            _mm_storeu_si128(sum + 3, _mm_sub_epi32(_mm_loadu_si128(sum + 3), _mm_unpackhi_epi16(high, zero)));
+        }
+#endif
+        for (; i < rowBytes; ++i) {
+            sums[i] -= row[i];
+        }
+    };
+    auto storeRow = [&](uint8_t* row) {
+        size_t i = 0;
+#if GFX_BLUR_SSE2
+        auto scaleVector = _mm_set1_ps(scale);
+        auto half = _mm_set1_ps(0.5f);
+        auto averageOf = [&](const uint32_t* sum) {
+            auto values = _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sum)));
+            return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(values, scaleVector), half));
+        };
+        for (; i + 16 <= rowBytes; i += 16) {
+            auto low = _mm_packs_epi32(averageOf(sums + i), averageOf(sums + i + 4));
+            auto high = _mm_packs_epi32(averageOf(sums + i + 8), averageOf(sums + i + 12));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_packus_epi16(low, high));
+        }
+#endif
+        for (; i < rowBytes; ++i) {
+            row[i] = average(sums[i], scale);
+        }
+    };
+
+    auto rowAt = [&](int32_t y) { return pixels + static_cast<size_t>(y) * stride; };
+    for (int32_t y = 0; y < std::min(radius, height); ++y) {
+        addRow(rowAt(y));
+    }
+    for (int32_t y = 0; y < height; ++y) {
+        if (y + radius < height) {
+            addRow(rowAt(y + radius));
+        }
+        uint8_t* saved = rowRing_.data() + (static_cast<size_t>(y) % ringRows) * rowBytes;
+        memcpy(saved, rowAt(y), rowBytes);
+        storeRow(rowAt(y));
+        if (y - radius >= 0) {
+            subtractRow(rowRing_.data() + (static_cast<size_t>(y - radius) % ringRows) * rowBytes);
+        }
+    }
+}
+
+void GfxBlur::tint(uint8_t* pixels, int32_t width, int32_t height, size_t stride, const uint8_t (&color)[4]) {
+    for (int32_t y = 0; y < height; ++y) {
+        uint8_t* pixel = pixels + static_cast<size_t>(y) * stride;
+        for (int32_t x = 0; x < width; ++x, pixel += 4) {
+            uint32_t alpha = pixel[3];
+            for (int c = 0; c < 4; ++c) {
+                pixel[c] = static_cast<uint8_t>((color[c] * alpha + 127) / 255);
+            }
+        }
+    }
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace winui_drover_island {
+
+// Separable blurs of premultiplied BGRA pixels, for when effects are rendered on the CPU, like on
+// software devices. The pixels outside the image are transparent. Sliding window sums make the
+// cost independent of the radius; the inner loops use SSE2 where available.
+class GfxBlur {
+ public:
+    // Three box passes are within a few percent of a Gaussian.
+    static constexpr int kGaussianPasses = 3;
+
+    // The radii of the box passes approximating a Gaussian of the standard deviation, in pixels.
+    static void gaussianBoxRadii(float standardDeviation, int32_t (&radii)[kGaussianPasses]);
+
+    // The extent of the Gaussian blur beyond the content, in pixels: what the image must be padded
+    // with to hold the whole blur.
+    static int32_t gaussianExtent(float standardDeviation);
+
+    void gaussianBlur(uint8_t* pixels, int32_t width, int32_t height, size_t stride, float standardDeviation);
+    void boxBlur(uint8_t* pixels, int32_t width, int32_t height, size_t stride, int32_t radius);
+
+    // Replaces every pixel by the color, premultiplied BGRA, scaled by the pixel alpha: turns a
+    // silhouette in a shadow or a glow.
+    static void tint(uint8_t* pixels, int32_t width, int32_t height, size_t stride, const uint8_t (&color)[4]);
+
+ private:
+    void horizontalPass(uint8_t* pixels, int32_t width, int32_t height, size_t stride, int32_t radius);
+    void verticalPass(uint8_t* pixels, int32_t width, int32_t height, size_t stride, int32_t radius);
+
+    // Reused across calls, so warm effects don't allocate.
+    std::vector<uint8_t> paddedRow_;
+    std::vector<uint8_t> rowRing_;
+    std::vector<uint32_t> columnSums_;
+};
+
+}  // namespace winui_drover_island
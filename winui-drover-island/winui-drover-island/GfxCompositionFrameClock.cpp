@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxCompositionFrameClock.h"
+
+#include <cassert>
+
+namespace winrt {
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Microsoft::System;
+using namespace winrt::Microsoft::UI::Xaml::Media;
+}  // namespace winrt
+
+namespace winui_drover_island {
+
+GfxVsyncFrameClock::GfxVsyncFrameClock() : GfxFrameClock(true) {
+    renderingDelegate_ = winrt::EventHandler<winrt::IInspectable>{this, &GfxVsyncFrameClock::onRendering};
+}
+
+GfxVsyncFrameClock::~GfxVsyncFrameClock() {
+    detach();
+}
+
+const std::shared_ptr<GfxVsyncFrameClock>& GfxVsyncFrameClock::shared() {
+    // Leaked on purpose: destroyed with the statics, it would revoke its Rendering handler after
+    // XAML is gone. close() stops it while the window is still alive.
+    static auto* obj = new std::shared_ptr<GfxVsyncFrameClock>(std::make_shared<GfxVsyncFrameClock>());
+    return *obj;
+}
+
+void GfxVsyncFrameClock::close() {
+    detach();
+}
+
+void GfxVsyncFrameClock::startTicking() {
+    renderingToken_ = winrt::CompositionTarget::Rendering(renderingDelegate_);
+}
+
+void GfxVsyncFrameClock::stopTicking() {
+    winrt::CompositionTarget::Rendering(renderingToken_);
+    renderingToken_ = {};
+}
+
+void GfxVsyncFrameClock::onRendering(const winrt::IInspectable&, const winrt::IInspectable&) {
+    tick(Clock::now());
+}
+
+GfxThrottledFrameClock::GfxThrottledFrameClock(Clock::duration interval) : GfxFrameClock(true), interval_(interval) {
+    renderingDelegate_ = winrt::EventHandler<winrt::IInspectable>{this, &GfxThrottledFrameClock::onRendering};
+}
+
+GfxThrottledFrameClock::~GfxThrottledFrameClock() {
+    detach();
+}
+
+std::shared_ptr<GfxThrottledFrameClock> GfxThrottledFrameClock::withFrameRate(double framesPerSecond) {
+    assert(framesPerSecond > 0);
+    auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / framesPerSecond));
+    return std::make_shared<GfxThrottledFrameClock>(interval);
+}
+
+void GfxThrottledFrameClock::startTicking() {
+    arm();
+}
+
+void GfxThrottledFrameClock::stopTicking() {
+    if (timer_) {
+        timer_.Stop();
+    }
+    unregisterFromRendering();
+}
+
+void GfxThrottledFrameClock::arm() {
+    auto delay = lastFrame_ + interval_ - Clock::now();
+    if (delay <= Clock::duration::zero()) {
+        registerForRendering();
+        return;
+    }
+    if (!timer_) {
+        timer_ = winrt::DispatcherQueue::GetForCurrentThread().CreateTimer();
+        timer_.IsRepeating(false);
+        timerHandler_ = timer_.Tick(winrt::auto_revoke, {this, &GfxThrottledFrameClock::onTimerTick});
+    }
+    timer_.Interval(std::chrono::duration_cast<winrt::TimeSpan>(delay));
+    timer_.Start();
+}
+
+void GfxThrottledFrameClock::onTimerTick(const winrt::DispatcherQueueTimer&, const winrt::IInspectable&) {
+    registerForRendering();
+}
+
+void GfxThrottledFrameClock::onRendering(const winrt::IInspectable&, const winrt::IInspectable&) {
+    unregisterFromRendering();
+    auto now = Clock::now();
+    lastFrame_ = now;
+    tick(now);
+    // Frames requested while delivering wait for the next interval.
+    if (hasPendingFrames() && !isPaused()) {
+        arm();
+    }
+}
+
+void GfxThrottledFrameClock::registerForRendering() {
+    if (!renderingRegistered_) {
+        renderingToken_ = winrt::CompositionTarget::Rendering(renderingDelegate_);
+        renderingRegistered_ = true;
+    }
+}
+
+void GfxThrottledFrameClock::unregisterFromRendering() {
+    if (renderingRegistered_) {
+        winrt::CompositionTarget::Rendering(renderingToken_);
+        renderingToken_ = {};
+        renderingRegistered_ = false;
+    }
+}
+
+}  // namespace winui_drover_island
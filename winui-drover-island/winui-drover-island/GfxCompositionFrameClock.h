@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "./GfxFrameClock.h"
+#include "winrt/Microsoft.System.h"
+#include "winrt/Microsoft.UI.Xaml.Media.h"
+#include "winrt/Windows.Foundation.h"
+
+namespace winui_drover_island {
+
+// Ticks on CompositionTarget::Rendering, once per composition frame, while frames are requested.
+class GfxVsyncFrameClock : public GfxFrameClock {
+ public:
+    GfxVsyncFrameClock();
+    ~GfxVsyncFrameClock() override;
+
+    // Used by the controls and the atlases unless they are given another clock.
+    static const std::shared_ptr<GfxVsyncFrameClock>& shared();
+
+    // Stops ticking for good and drops the pending requests. Called when the window closes, while
+    // the Rendering handler can still be revoked.
+    void close();
+
+ protected:
+    void startTicking() override;
+    void stopTicking() override;
+
+ private:
+    void onRendering(const winrt::Windows::Foundation::IInspectable&, const winrt::Windows::Foundation::IInspectable&);
+
+    winrt::Windows::Foundation::EventHandler<winrt::Windows::Foundation::IInspectable> renderingDelegate_{nullptr};
+    winrt::event_token renderingToken_{};
+};
+
+// Delivers at most one frame per interval, still aligned on composition frames. Between frames
+// it waits on a timer rather than on the rendering event, so an idle meter doesn't wake up the
+// compositor every frame.
+class GfxThrottledFrameClock : public GfxFrameClock {
+ public:
+    explicit GfxThrottledFrameClock(Clock::duration interval);
+    ~GfxThrottledFrameClock() override;
+
+    static std::shared_ptr<GfxThrottledFrameClock> withFrameRate(double framesPerSecond);
+
+    Clock::duration interval() const { return interval_; }
+
+ protected:
+    void startTicking() override;
+    void stopTicking() override;
+
+ private:
+    void arm();
+    void onTimerTick(const winrt::Microsoft::System::DispatcherQueueTimer&, const winrt::Windows::Foundation::IInspectable&);
+    void onRendering(const winrt::Windows::Foundation::IInspectable&, const winrt::Windows::Foundation::IInspectable&);
+    void registerForRendering();
+    void unregisterFromRendering();
+
+    const Clock::duration interval_;
+    Clock::time_point lastFrame_{};
+    winrt::Microsoft::System::DispatcherQueueTimer timer_{nullptr};
+    winrt::Microsoft::System::DispatcherQueueTimer::Tick_revoker timerHandler_;
+    winrt::Windows::Foundation::EventHandler<winrt::Windows::Foundation::IInspectable> renderingDelegate_{nullptr};
+    winrt::event_token renderingToken_{};
+    bool renderingRegistered_ = false;
+};
+
+}  // namespace winui_drover_island
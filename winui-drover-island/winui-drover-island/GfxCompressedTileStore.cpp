@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxCompressedTileStore.h"
+
+#include "./GfxSnapshotCodec.h"
+
+namespace winui_drover_island {
+
+double GfxCompressedTileStore::Stats::decodeBytesPerSecond() const {
+    auto seconds = std::chrono::duration<double>(decodeTime).count();
+    return seconds > 0 ? decodedBytes / seconds : 0;
+}
+
+GfxCompressedTileStore& GfxCompressedTileStore::instance() {
+    static GfxCompressedTileStore obj;
+    return obj;
+}
+
+GfxCompressedTileStore::GfxCompressedTileStore(size_t capacityInBytes) : tiles_(capacityInBytes) {}
+
+void GfxCompressedTileStore::store(const Key& key, const uint8_t* pixels, int32_t width, int32_t height, size_t stride) {
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+    GfxSnapshotCodec::encode(pixels, width, height, stride, encoded_);
+    if (encoded_.empty()) {
+        return;
+    }
+    Tile tile;
+    tile.width = width;
+    tile.height = height;
+    tile.data.assign(encoded_.begin(), encoded_.end());
+
+    stats_.storedTiles++;
+    stats_.rawBytes += static_cast<uint64_t>(width) * height * 4;
+    stats_.compressedBytes += tile.data.size();
+    auto cost = tile.data.size();
+    tiles_.insert(key, std::move(tile), cost);
+}
+
+bool GfxCompressedTileStore::restore(const Key& key, int32_t width, int32_t height, std::vector<uint8_t>& pixels) {
+    Tile tile;
+    if (!tiles_.take(key, tile) || tile.width != width || tile.height != height) {
+        stats_.missedTiles++;
+        return false;
+    }
+    auto start = std::chrono::steady_clock::now();
+    GfxSnapshotImage image;
+    bool decoded = GfxSnapshotCodec::decode(tile.data.data(), tile.data.size(), image);
+    stats_.decodeTime += std::chrono::steady_clock::now() - start;
+    if (!decoded || image.width != width || image.height != height) {
+        stats_.missedTiles++;
+        return false;
+    }
+    pixels = std::move(image.pixels);
+    stats_.restoredTiles++;
+    stats_.decodedBytes += pixels.size();
+    return true;
+}
+
+void GfxCompressedTileStore::remove(const Key& key) {
+    tiles_.erase(key);
+}
+
+void GfxCompressedTileStore::removeOwner(uint64_t owner) {
+    tiles_.eraseIf([owner](const Key& key, const Tile&) { return key.owner == owner; });
+}
+
+void GfxCompressedTileStore::clear() {
+    tiles_.clear();
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "./GfxLruCache.h"
+
+namespace winui_drover_island {
+
+// Second cache tier for pixels evicted from graphics memory. Tiles are kept compressed in CPU
+// memory, so content that still is valid can be restored with a decode and an upload instead of
+// being drawn again. Tiles use the snapshot codec: its runs make flat UI areas nearly free and it
+// decodes faster than most content can be drawn. The store is bounded; the least recently used tiles are dropped
+// first.
+// Used on the UI thread only.
+class GfxCompressedTileStore {
+ public:
+    static constexpr size_t kDefaultCapacityInBytes = 64 * 1024 * 1024;
+
+    struct Key {
+        // Whoever stored the tile, e.g. a control id, and which of its tiles it is.
+        uint64_t owner = 0;
+        uint64_t tile = 0;
+
+        bool operator==(const Key& other) const { return owner == other.owner && tile == other.tile; }
+    };
+
+    struct Stats {
+        uint64_t storedTiles = 0;
+        uint64_t restoredTiles = 0;
+        uint64_t missedTiles = 0;
+        uint64_t rawBytes = 0;
+        uint64_t compressedBytes = 0;
+        uint64_t decodedBytes = 0;
+        std::chrono::steady_clock::duration decodeTime{};
+
+        double compressionRatio() const { return compressedBytes ? static_cast<double>(rawBytes) / compressedBytes : 0; }
+        double decodeBytesPerSecond() const;
+    };
+
+    static GfxCompressedTileStore& instance();
+
+    explicit GfxCompressedTileStore(size_t capacityInBytes = kDefaultCapacityInBytes);
+
+    GfxCompressedTileStore(GfxCompressedTileStore const&) = delete;
+    GfxCompressedTileStore& operator=(GfxCompressedTileStore const&) = delete;
+
+    // The pixels are premultiplied BGRA. Replaces the previous tile of the key.
+    void store(const Key& key, const uint8_t* pixels, int32_t width, int32_t height, size_t stride);
+    // Moves the tile out of the store, tightly packed. Fails when the tile was dropped or has
+    // another size.
+    bool restore(const Key& key, int32_t width, int32_t height, std::vector<uint8_t>& pixels);
+
+    void remove(const Key& key);
+    void removeOwner(uint64_t owner);
+    void clear();
+
+    void setCapacity(size_t bytes) { tiles_.setCapacity(bytes); }
+    size_t sizeInBytes() const { return tiles_.cost(); }
+    size_t tileCount() const { return tiles_.size(); }
+    const Stats& stats() const { return stats_; }
+
+ private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return static_cast<size_t>(key.owner * 0x9e3779b97f4a7c15ull ^ key.tile);
+        }
+    };
+
+    struct Tile {
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<uint8_t> data;
+    };
+
+    GfxLruCache<Key, Tile, KeyHash> tiles_;
+    // Reused by every store, the tiles only keep what the encoding needed.
+    std::vector<uint8_t> encoded_;
+    Stats stats_;
+};
+
+}  // namespace winui_drover_island
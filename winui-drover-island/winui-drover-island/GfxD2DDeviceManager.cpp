@@ -72,7 +72,7 @@ GfxD2DDevice::DebugLevel GfxD2DDevice::sDebugLevel_ = GfxD2DDevice::DebugLevel::
 
 GfxD2DDevice::GfxD2DDevice(
     const winrt::com_ptr<IDXGIDevice3>& dxgiDevice, const winrt::com_ptr<ID2D1Device1>& d2dDevice, bool isSoftware)
-    : dxgiDevice_(dxgiDevice), d2dDevice_(d2dDevice), contextPool_(d2dDevice.get()), isSoftware_(isSoftware) {}
+    : dxgiDevice_(dxgiDevice), d2dDevice_(d2dDevice), contextPool_(d2dDevice), isSoftware_(isSoftware) {}
 
 std::shared_ptr<GfxD2DDevice> GfxD2DDevice::create(bool software) {
     auto d2dFactory = create2D2Factory(sDebugLevel_);
@@ -91,8 +91,14 @@ GfxD2DContextLease GfxD2DDevice::leaseResourceCreationDeviceContext() {
 }
 
 uint32_t GfxD2DDevice::maximumBitmapSizeInPixels() {
-    auto lease = leaseResourceCreationDeviceContext();
-    return lease.context()->GetMaximumBitmapSize();
+    // The limit is fixed for the lifetime of the device, so we only lease a context once.
+    auto maximumSize = maximumBitmapSize_.load(std::memory_order_relaxed);
+    if (maximumSize == 0) {
+        auto lease = leaseResourceCreationDeviceContext();
+        maximumSize = lease.context()->GetMaximumBitmapSize();
+        maximumBitmapSize_.store(maximumSize, std::memory_order_relaxed);
+    }
+    return maximumSize;
 }
 
 bool GfxD2DDevice::isValid() const {
@@ -106,6 +112,7 @@ HRESULT GfxD2DDevice::deviceRemovedErrorCode() const {
 }
 
 void GfxD2DDevice::trim() {
+    contextPool_.trim();
     if (d2dDevice_) {
         d2dDevice_->ClearResources();
     }
@@ -159,6 +166,19 @@ std::shared_ptr<GfxD2DDevice> GfxD2DDeviceManager::sharedDevice(bool software) {
     return device;
 }
 
+void GfxD2DDeviceManager::trim() {
+    std::unique_lock<std::mutex> guard(mutex_);
+    auto hardwareDevice = sharedHardwareDevice_.lock();
+    auto softwareDevice = sharedSoftwareDevice_.lock();
+    guard.unlock();
+
+    for (auto& device : {hardwareDevice, softwareDevice}) {
+        if (device && device->isValid()) {
+            device->trim();
+        }
+    }
+}
+
 GfxD2DContextLease::GfxD2DContextLease() : owner_(nullptr) {}
 
 GfxD2DContextLease::GfxD2DContextLease(winrt::com_ptr<ID2D1DeviceContext1>&& deviceContext)
@@ -192,38 +212,75 @@ void GfxD2DContextLease::returnLease() {
     }
 }
 
-GfxD2DContextPool::GfxD2DContextPool(ID2D1Device1* d2dDevice) : d2dDevice_(d2dDevice) {}
+GfxD2DContextPool::GfxD2DContextPool(winrt::com_ptr<ID2D1Device1> d2dDevice)
+    : d2dDevice_(std::move(d2dDevice)), deviceContexts_(std::max(std::thread::hardware_concurrency(), 1U)) {
+    budgetEntry_ = GfxMemoryBudget::instance().add(GfxMemorySubsystem::kContextPool, 0);
+}
+
+GfxD2DContextPool::~GfxD2DContextPool() {
+    GfxMemoryBudget::instance().remove(budgetEntry_);
+}
+
+void GfxD2DContextPool::updateBudgetEntry() {
+    // Every context the pool has handed out and not dropped, idle or leased. Updated outside of
+    // the pool lock, a concurrent lease may make it briefly stale.
+    auto poolStats = deviceContexts_.stats();
+    GfxMemoryBudget::instance().update(budgetEntry_, (poolStats.idle + poolStats.outstanding) * kEstimatedBytesPerContext);
+}
 
 GfxD2DContextLease GfxD2DContextPool::takeLease() {
-    std::lock_guard<std::mutex> guard(mutex_);
-    assert(d2dDevice_);
-    if (deviceContexts_.empty()) {
-        winrt::com_ptr<ID2D1DeviceContext1> deviceContext;
-        winrt::check_hresult(d2dDevice_->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, deviceContext.put()));
+    winrt::com_ptr<ID2D1DeviceContext1> deviceContext;
+    if (deviceContexts_.take(deviceContext)) {
         return GfxD2DContextLease(this, std::move(deviceContext));
     }
-    GfxD2DContextLease newLease(this, std::move(deviceContexts_.back()));
-    deviceContexts_.pop_back();
-    return newLease;
+    winrt::com_ptr<ID2D1Device1> d2dDevice;
+    {
+        std::lock_guard<std::mutex> guard(deviceMutex_);
+        d2dDevice = d2dDevice_;
+    }
+    // Created without holding the pool, the other threads can keep leasing the idle contexts.
+    // A closed device is a lost one to the callers.
+    HRESULT hr = d2dDevice ? d2dDevice->CreateDeviceContext(D2D1_DEVICE_CONTEXT_OPTIONS_NONE, deviceContext.put())
+                           : DXGI_ERROR_DEVICE_REMOVED;
+    if (FAILED(hr)) {
+        deviceContexts_.cancelTake();
+        winrt::throw_hresult(hr);
+    }
+    updateBudgetEntry();
+    return GfxD2DContextLease(this, std::move(deviceContext));
 }
 
-void GfxD2DContextPool::close() {
-    std::lock_guard<std::mutex> guard(mutex_);
+GfxD2DContextPool::Stats GfxD2DContextPool::stats() {
+    auto poolStats = deviceContexts_.stats();
+    Stats stats;
+    stats.idleContexts = poolStats.idle;
+    stats.leasedContexts = poolStats.outstanding;
+    stats.leases = poolStats.takes;
+    stats.createdContexts = poolStats.takes - poolStats.hits;
+    stats.contendedLocks = poolStats.contended;
+    return stats;
+}
+
+void GfxD2DContextPool::trim() {
     deviceContexts_.clear();
-    d2dDevice_ = nullptr;
+    updateBudgetEntry();
+}
+
+void GfxD2DContextPool::close() {
+    deviceContexts_.close();
+    updateBudgetEntry();
+    winrt::com_ptr<ID2D1Device1> d2dDevice;
+    std::lock_guard<std::mutex> guard(deviceMutex_);
+    // Released once the lock is; a lease that copied it holds its own reference.
+    d2dDevice = std::move(d2dDevice_);
 }
 
 void GfxD2DContextPool::returnLease(winrt::com_ptr<ID2D1DeviceContext1>&& deviceContext) {
     if (!deviceContext) {
         return;
     }
-    std::lock_guard<std::mutex> guard(mutex_);
-    if (!d2dDevice_) {
-        return;
-    }
-    static const auto kMaxPoolSize = std::max(std::thread::hardware_concurrency(), 1U);
-    if (deviceContexts_.size() < kMaxPoolSize) {
-        deviceContexts_.emplace_back(std::move(deviceContext));
+    if (!deviceContexts_.give(std::move(deviceContext))) {
+        updateBudgetEntry();
     }
 }
 
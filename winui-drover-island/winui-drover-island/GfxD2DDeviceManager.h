@@ -17,10 +17,14 @@
 #include <dxgi1_3.h>
 #include <winrt/base.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <vector>
 
+#include "./GfxMemoryBudget.h"
+#include "./GfxObjectPool.h"
+
 namespace winui_drover_island {
 
 class GfxD2DContextPool;
@@ -50,22 +54,43 @@ class GfxD2DContextLease {
 };
 
 class GfxD2DContextPool {
-    ID2D1Device1* d2dDevice_ = nullptr;
-    std::mutex mutex_;
-    std::vector<winrt::com_ptr<ID2D1DeviceContext1>> deviceContexts_;
+    // Reset by close(). A lease copies it under the lock and creates its context outside of it:
+    // closing the device on another thread can't release it under the creation.
+    std::mutex deviceMutex_;
+    winrt::com_ptr<ID2D1Device1> d2dDevice_;
+    GfxObjectPool<winrt::com_ptr<ID2D1DeviceContext1>> deviceContexts_;
+    GfxMemoryBudget::EntryId budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
 
  public:
-    explicit GfxD2DContextPool(ID2D1Device1* d2dDevice);
+    // D2D doesn't report the memory held by a device context, this is a rough estimate used for accounting.
+    static constexpr size_t kEstimatedBytesPerContext = 64 * 1024;
+
+    explicit GfxD2DContextPool(winrt::com_ptr<ID2D1Device1> d2dDevice);
+    ~GfxD2DContextPool();
 
     GfxD2DContextPool(GfxD2DContextPool const&) = delete;
     GfxD2DContextPool& operator=(GfxD2DContextPool const&) = delete;
 
     GfxD2DContextLease takeLease();
 
+    struct Stats {
+        size_t idleContexts = 0;
+        size_t leasedContexts = 0;
+        uint64_t leases = 0;
+        // Leases that found no idle context; leases - createdContexts were served by the pool.
+        uint64_t createdContexts = 0;
+        // Leases and returns that waited for another thread to release the pool.
+        uint64_t contendedLocks = 0;
+    };
+    Stats stats();
+
+    // Drops the idle device contexts, the pool stays usable.
+    void trim();
     void close();
 
  private:
     void returnLease(winrt::com_ptr<ID2D1DeviceContext1>&& deviceContext);
+    void updateBudgetEntry();
 
     friend class GfxD2DContextLease;
 };
@@ -84,6 +109,7 @@ class GfxD2DDevice {
     const winrt::com_ptr<ID2D1Device1>& d2dDevice() const { return d2dDevice_; }
 
     GfxD2DContextLease leaseResourceCreationDeviceContext();
+    GfxD2DContextPool::Stats contextPoolStats() { return contextPool_.stats(); }
 
     void trim();
     void close();
@@ -105,6 +131,7 @@ class GfxD2DDevice {
     winrt::com_ptr<IDXGIDevice3> dxgiDevice_;
     winrt::com_ptr<ID2D1Device1> d2dDevice_;
     GfxD2DContextPool contextPool_;
+    std::atomic<uint32_t> maximumBitmapSize_{0};
 
     static DebugLevel sDebugLevel_;
 
@@ -119,6 +146,9 @@ class GfxD2DDeviceManager {
 
     std::shared_ptr<GfxD2DDevice> sharedDevice(bool software = false);
 
+    // Trims the shared devices that are currently alive.
+    void trim();
+
  private:
     GfxD2DDeviceManager();
 
@@ -0,0 +1,92 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxDamageRegion.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace winui_drover_island {
+
+GfxDamageRegion::GfxDamageRegion(size_t maxRects) : maxRects_(std::max<size_t>(maxRects, 1)) {
+    // Adding and simplifying never allocate past this.
+    rects_.reserve(2 * maxRects_ + 1);
+}
+
+void GfxDamageRegion::add(const PixelRect& rect) {
+    if (rect.isEmpty()) {
+        return;
+    }
+    for (const auto& existing : rects_) {
+        if (existing.contains(rect)) {
+            return;
+        }
+    }
+    rects_.erase(std::remove_if(rects_.begin(), rects_.end(), [&](const auto& existing) { return rect.contains(existing); }),
+        rects_.end());
+    rects_.push_back(rect);
+    if (rects_.size() > 2 * maxRects_) {
+        reduceTo(maxRects_);
+    }
+}
+
+void GfxDamageRegion::simplify() {
+    reduceTo(maxRects_);
+}
+
+void GfxDamageRegion::reduceTo(size_t count) {
+    // Greedy: merge the pair whose union wastes the least area, as long as merging is free or
+    // there are too many rects. A handful of rects, the quadratic search is cheap.
+    while (rects_.size() > 1) {
+        int64_t bestWaste = std::numeric_limits<int64_t>::max();
+        size_t bestA = 0, bestB = 0;
+        for (size_t a = 0; a < rects_.size(); ++a) {
+            for (size_t b = a + 1; b < rects_.size(); ++b) {
+                auto waste = rects_[a].unionWith(rects_[b]).area() - rects_[a].area() - rects_[b].area();
+                if (waste < bestWaste) {
+                    bestWaste = waste;
+                    bestA = a;
+                    bestB = b;
+                }
+            }
+        }
+        if (bestWaste > 0 && rects_.size() <= count) {
+            break;
+        }
+        auto merged = rects_[bestA].unionWith(rects_[bestB]);
+        rects_.erase(rects_.begin() + static_cast<std::ptrdiff_t>(bestB));
+        rects_.erase(rects_.begin() + static_cast<std::ptrdiff_t>(bestA));
+        // The union may now contain other rects.
+        rects_.erase(std::remove_if(rects_.begin(), rects_.end(), [&](const auto& existing) { return merged.contains(existing); }),
+            rects_.end());
+        rects_.push_back(merged);
+    }
+}
+
+int64_t GfxDamageRegion::area() const {
+    int64_t total = 0;
+    for (const auto& rect : rects_) {
+        total += rect.area();
+    }
+    return total;
+}
+
+PixelRect GfxDamageRegion::bounds() const {
+    PixelRect result;
+    for (const auto& rect : rects_) {
+        result = result.unionWith(rect);
+    }
+    return result;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "./GfxRect.h"
+
+namespace winui_drover_island {
+
+// The parts of a surface to redraw this frame, as a few rects. Rects are merged when their union
+// costs no more area than drawing them apart; past the maximum count, the pairs wasting the
+// least area are merged. No graphics dependencies, so it can be measured headless.
+class GfxDamageRegion {
+ public:
+    static constexpr size_t kDefaultMaxRects = 8;
+
+    explicit GfxDamageRegion(size_t maxRects = kDefaultMaxRects);
+
+    void add(const PixelRect& rect);
+    void clear() { rects_.clear(); }
+
+    bool isEmpty() const { return rects_.empty(); }
+    // Reduces the rects to at most the maximum count. Adding rects keeps them bounded, twice the
+    // maximum at most, until the region is simplified at frame time.
+    void simplify();
+    const std::vector<PixelRect>& rects() const { return rects_; }
+
+    // The area to redraw, overlaps counted once per rect.
+    int64_t area() const;
+    PixelRect bounds() const;
+
+ private:
+    void reduceTo(size_t count);
+
+    std::vector<PixelRect> rects_;
+    size_t maxRects_;
+};
+
+}  // namespace winui_drover_island
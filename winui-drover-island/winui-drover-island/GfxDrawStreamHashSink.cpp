@@ -0,0 +1,504 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxDrawStreamHashSink.h"
+
+#include <dwrite_3.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace winui_drover_island {
+
+namespace {
+
+// Feeds the figures of path geometries, or the simplified outline of other geometries, to the hasher.
+class HashingGeometrySink : public winrt::implements<HashingGeometrySink, ID2D1GeometrySink, ID2D1SimplifiedGeometrySink> {
+ public:
+    explicit HashingGeometrySink(GfxDrawStreamHasher& hasher) : hasher_(hasher) {}
+
+    STDMETHOD_(void, SetFillMode)(D2D1_FILL_MODE fillMode) override { hasher_.add(fillMode); }
+    STDMETHOD_(void, SetSegmentFlags)(D2D1_PATH_SEGMENT vertexFlags) override { hasher_.add(vertexFlags); }
+    STDMETHOD_(void, BeginFigure)(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin) override {
+        hasher_.add(startPoint);
+        hasher_.add(figureBegin);
+    }
+    STDMETHOD_(void, AddLines)(const D2D1_POINT_2F* points, UINT32 pointsCount) override {
+        hasher_.addArray(points, pointsCount);
+    }
+    STDMETHOD_(void, AddBeziers)(const D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override {
+        hasher_.addArray(beziers, beziersCount);
+    }
+    STDMETHOD_(void, EndFigure)(D2D1_FIGURE_END figureEnd) override { hasher_.add(figureEnd); }
+    STDMETHOD(Close)() override { return S_OK; }
+
+    // ID2D1GeometrySink, the segments as they were added to the path.
+    STDMETHOD_(void, AddLine)(D2D1_POINT_2F point) override { hasher_.add(point); }
+    STDMETHOD_(void, AddBezier)(const D2D1_BEZIER_SEGMENT* bezier) override { hasher_.add(*bezier); }
+    STDMETHOD_(void, AddQuadraticBezier)(const D2D1_QUADRATIC_BEZIER_SEGMENT* bezier) override { hasher_.add(*bezier); }
+    STDMETHOD_(void, AddQuadraticBeziers)(const D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override {
+        hasher_.addArray(beziers, beziersCount);
+    }
+    STDMETHOD_(void, AddArc)(const D2D1_ARC_SEGMENT* arc) override { hasher_.add(*arc); }
+
+ private:
+    GfxDrawStreamHasher& hasher_;
+};
+
+}  // namespace
+
+enum class GfxDrawStreamHashSink::Command : uint32_t {
+    kSetAntialiasMode = 1,
+    kSetTags,
+    kSetTextAntialiasMode,
+    kSetTextRenderingParams,
+    kSetTransform,
+    kSetPrimitiveBlend,
+    kSetUnitMode,
+    kClear,
+    kDrawGlyphRun,
+    kDrawLine,
+    kDrawGeometry,
+    kDrawRectangle,
+    kDrawBitmap,
+    kDrawImage,
+    kFillGeometry,
+    kFillRectangle,
+    kPushAxisAlignedClip,
+    kPushLayer,
+    kPopAxisAlignedClip,
+    kPopLayer,
+};
+
+GfxDrawStreamHashSink::GfxDrawStreamHashSink() {
+    geometrySink_ = winrt::make_self<HashingGeometrySink>(pathHasher_).as<ID2D1GeometrySink>();
+}
+
+void GfxDrawStreamHashSink::reset() {
+    hasher_.reset();
+    stableImages_.clear();
+}
+
+void GfxDrawStreamHashSink::addStableImage(ID2D1Image* image, uint64_t version) {
+    stableImages_.emplace_back(image, version);
+}
+
+uint64_t GfxDrawStreamHashSink::nextImageVersion() {
+    static std::atomic<uint64_t> sLastVersion{0};
+    return sLastVersion.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+HRESULT GfxDrawStreamHashSink::hash(ID2D1CommandList* commandList) {
+    return commandList->Stream(this);
+}
+
+void GfxDrawStreamHashSink::addCommand(Command command) {
+    hasher_.add(command);
+}
+
+template <typename T>
+void GfxDrawStreamHashSink::addOptional(const T* value) {
+    hasher_.add(value != nullptr);
+    if (value) {
+        hasher_.add(*value);
+    }
+}
+
+void GfxDrawStreamHashSink::addBrush(ID2D1Brush* brush) {
+    if (!brush) {
+        hasher_.add(0);
+        return;
+    }
+    winrt::com_ptr<ID2D1SolidColorBrush> solidBrush;
+    if (FAILED(brush->QueryInterface(solidBrush.put()))) {
+        hasher_.markNotDedupable();
+        return;
+    }
+    D2D1_MATRIX_3X2_F transform;
+    brush->GetTransform(&transform);
+    hasher_.add(1);
+    hasher_.add(solidBrush->GetColor());
+    hasher_.add(brush->GetOpacity());
+    hasher_.add(transform);
+}
+
+void GfxDrawStreamHashSink::addStrokeStyle(ID2D1StrokeStyle* strokeStyle) {
+    hasher_.add(strokeStyle != nullptr);
+    if (!strokeStyle) {
+        return;
+    }
+    hasher_.add(strokeStyle->GetStartCap());
+    hasher_.add(strokeStyle->GetEndCap());
+    hasher_.add(strokeStyle->GetDashCap());
+    hasher_.add(strokeStyle->GetMiterLimit());
+    hasher_.add(strokeStyle->GetLineJoin());
+    hasher_.add(strokeStyle->GetDashOffset());
+    hasher_.add(strokeStyle->GetDashStyle());
+    // Keeps its capacity, so a steady stream of dashed strokes doesn't allocate.
+    dashes_.resize(strokeStyle->GetDashesCount());
+    if (!dashes_.empty()) {
+        strokeStyle->GetDashes(dashes_.data(), static_cast<UINT32>(dashes_.size()));
+    }
+    hasher_.addArray(dashes_.data(), dashes_.size());
+}
+
+void GfxDrawStreamHashSink::addGeometry(GfxDrawStreamHasher& hasher, ID2D1Geometry* geometry) {
+    hasher.add(geometry != nullptr);
+    if (!geometry) {
+        return;
+    }
+    // The geometries drawn most, and the cheapest to hash, first.
+    winrt::com_ptr<ID2D1RectangleGeometry> rectangle;
+    if (SUCCEEDED(geometry->QueryInterface(rectangle.put()))) {
+        D2D1_RECT_F rect;
+        rectangle->GetRect(&rect);
+        hasher.add(1);
+        hasher.add(rect);
+        return;
+    }
+    winrt::com_ptr<ID2D1EllipseGeometry> ellipse;
+    if (SUCCEEDED(geometry->QueryInterface(ellipse.put()))) {
+        D2D1_ELLIPSE value;
+        ellipse->GetEllipse(&value);
+        hasher.add(2);
+        hasher.add(value);
+        return;
+    }
+    winrt::com_ptr<ID2D1RoundedRectangleGeometry> roundedRectangle;
+    if (SUCCEEDED(geometry->QueryInterface(roundedRectangle.put()))) {
+        D2D1_ROUNDED_RECT value;
+        roundedRectangle->GetRoundedRect(&value);
+        hasher.add(3);
+        hasher.add(value);
+        return;
+    }
+    winrt::com_ptr<ID2D1TransformedGeometry> transformed;
+    if (SUCCEEDED(geometry->QueryInterface(transformed.put()))) {
+        D2D1_MATRIX_3X2_F transform;
+        transformed->GetTransform(&transform);
+        winrt::com_ptr<ID2D1Geometry> source;
+        transformed->GetSourceGeometry(source.put());
+        hasher.add(4);
+        hasher.add(transform);
+        addGeometry(hasher, source.get());
+        return;
+    }
+
+    uint64_t hash = geometries_.find(geometry);
+    if (hash == 0) {
+        winrt::com_ptr<ID2D1PathGeometry> path;
+        winrt::com_ptr<ID2D1GeometryGroup> group;
+        if (SUCCEEDED(geometry->QueryInterface(path.put()))) {
+            hash = hashPathGeometry(path.get());
+        } else if (SUCCEEDED(geometry->QueryInterface(group.put()))) {
+            hash = hashGeometryGroup(group.get());
+        }
+        if (hash == 0) {
+            hasher.markNotDedupable();
+            return;
+        }
+        winrt::com_ptr<ID2D1Geometry> reference;
+        reference.copy_from(geometry);
+        geometries_.insert(std::move(reference), hash);
+    }
+    hasher.add(5);
+    hasher.add(hash);
+}
+
+uint64_t GfxDrawStreamHashSink::hashPathGeometry(ID2D1PathGeometry* geometry) {
+    // Streaming fails unless the path is closed, it can't change afterwards.
+    pathHasher_.reset();
+    if (FAILED(geometry->Stream(geometrySink_.get()))) {
+        return 0;
+    }
+    return pathHasher_.hash();
+}
+
+uint64_t GfxDrawStreamHashSink::hashGeometryGroup(ID2D1GeometryGroup* geometry) {
+    // Only on a cache miss, the allocation doesn't happen on every frame.
+    std::vector<winrt::com_ptr<ID2D1Geometry>> sources(geometry->GetSourceGeometryCount());
+    static_assert(sizeof(winrt::com_ptr<ID2D1Geometry>) == sizeof(ID2D1Geometry*), "com_ptr is a plain pointer");
+    geometry->GetSourceGeometries(reinterpret_cast<ID2D1Geometry**>(sources.data()), static_cast<UINT32>(sources.size()));
+
+    GfxDrawStreamHasher groupHasher;
+    groupHasher.add(geometry->GetFillMode());
+    groupHasher.add(sources.size());
+    for (const auto& source : sources) {
+        addGeometry(groupHasher, source.get());
+    }
+    return groupHasher.isDedupable() ? groupHasher.hash() : 0;
+}
+
+void GfxDrawStreamHashSink::addFontFace(IDWriteFontFace* fontFace) {
+    hasher_.add(fontFace != nullptr);
+    if (!fontFace) {
+        return;
+    }
+    uint64_t hash = fontFaces_.find(fontFace);
+    if (hash == 0) {
+        // The same font file, face and simulations draw the same glyphs, whichever factory or
+        // text layout created the face. Local font files are keyed by their path and time.
+        GfxDrawStreamHasher faceHasher;
+        faceHasher.add(fontFace->GetType());
+        faceHasher.add(fontFace->GetIndex());
+        faceHasher.add(fontFace->GetSimulations());
+        UINT32 fileCount = 0;
+        HRESULT hr = fontFace->GetFiles(&fileCount, nullptr);
+        std::vector<winrt::com_ptr<IDWriteFontFile>> files(fileCount);
+        if (SUCCEEDED(hr) && fileCount > 0) {
+            hr = fontFace->GetFiles(&fileCount, reinterpret_cast<IDWriteFontFile**>(files.data()));
+        }
+        faceHasher.add(fileCount);
+        for (const auto& file : files) {
+            const void* key = nullptr;
+            UINT32 keySize = 0;
+            if (SUCCEEDED(hr)) {
+                hr = file->GetReferenceKey(&key, &keySize);
+            }
+            if (SUCCEEDED(hr)) {
+                faceHasher.addArray(static_cast<const uint8_t*>(key), keySize);
+            }
+        }
+        if (FAILED(hr)) {
+            hasher_.markNotDedupable();
+            return;
+        }
+        hash = faceHasher.hash();
+        winrt::com_ptr<IDWriteFontFace> reference;
+        reference.copy_from(fontFace);
+        fontFaces_.insert(std::move(reference), hash);
+    }
+    hasher_.add(hash);
+}
+
+void GfxDrawStreamHashSink::addImage(ID2D1Image* image) {
+    auto it = std::find_if(stableImages_.begin(), stableImages_.end(), [&](const auto& entry) { return entry.first == image; });
+    if (it == stableImages_.end()) {
+        // We can't tell whether the pixels changed since the last frame.
+        hasher_.markNotDedupable();
+        return;
+    }
+    hasher_.add(it->second);
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::BeginDraw() {
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::EndDraw() {
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetAntialiasMode(D2D1_ANTIALIAS_MODE antialiasMode) {
+    addCommand(Command::kSetAntialiasMode);
+    hasher_.add(antialiasMode);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetTags(D2D1_TAG tag1, D2D1_TAG tag2) {
+    addCommand(Command::kSetTags);
+    hasher_.add(tag1);
+    hasher_.add(tag2);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE textAntialiasMode) {
+    addCommand(Command::kSetTextAntialiasMode);
+    hasher_.add(textAntialiasMode);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetTextRenderingParams(IDWriteRenderingParams* textRenderingParams) {
+    addCommand(Command::kSetTextRenderingParams);
+    hasher_.add(textRenderingParams != nullptr);
+    if (!textRenderingParams) {
+        return S_OK;
+    }
+    hasher_.add(textRenderingParams->GetGamma());
+    hasher_.add(textRenderingParams->GetEnhancedContrast());
+    hasher_.add(textRenderingParams->GetClearTypeLevel());
+    hasher_.add(textRenderingParams->GetPixelGeometry());
+    hasher_.add(textRenderingParams->GetRenderingMode());
+    winrt::com_ptr<IDWriteRenderingParams1> params1;
+    if (SUCCEEDED(textRenderingParams->QueryInterface(params1.put()))) {
+        hasher_.add(params1->GetGrayscaleEnhancedContrast());
+    }
+    winrt::com_ptr<IDWriteRenderingParams2> params2;
+    if (SUCCEEDED(textRenderingParams->QueryInterface(params2.put()))) {
+        hasher_.add(params2->GetGridFitMode());
+    }
+    winrt::com_ptr<IDWriteRenderingParams3> params3;
+    if (SUCCEEDED(textRenderingParams->QueryInterface(params3.put()))) {
+        hasher_.add(params3->GetRenderingMode1());
+    }
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetTransform(const D2D1_MATRIX_3X2_F* transform) {
+    addCommand(Command::kSetTransform);
+    addOptional(transform);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetPrimitiveBlend(D2D1_PRIMITIVE_BLEND primitiveBlend) {
+    addCommand(Command::kSetPrimitiveBlend);
+    hasher_.add(primitiveBlend);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::SetUnitMode(D2D1_UNIT_MODE unitMode) {
+    addCommand(Command::kSetUnitMode);
+    hasher_.add(unitMode);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::Clear(const D2D1_COLOR_F* color) {
+    addCommand(Command::kClear);
+    addOptional(color);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawGlyphRun(D2D1_POINT_2F baselineOrigin, const DWRITE_GLYPH_RUN* glyphRun,
+    const DWRITE_GLYPH_RUN_DESCRIPTION*, ID2D1Brush* foregroundBrush, DWRITE_MEASURING_MODE measuringMode) {
+    addCommand(Command::kDrawGlyphRun);
+    hasher_.add(baselineOrigin);
+    hasher_.add(measuringMode);
+    addFontFace(glyphRun->fontFace);
+    hasher_.add(glyphRun->fontEmSize);
+    hasher_.add(glyphRun->isSideways);
+    hasher_.add(glyphRun->bidiLevel);
+    hasher_.addArray(glyphRun->glyphIndices, glyphRun->glyphCount);
+    hasher_.addArray(glyphRun->glyphAdvances, glyphRun->glyphAdvances ? glyphRun->glyphCount : 0);
+    hasher_.addArray(glyphRun->glyphOffsets, glyphRun->glyphOffsets ? glyphRun->glyphCount : 0);
+    addBrush(foregroundBrush);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawLine(D2D1_POINT_2F point0, D2D1_POINT_2F point1, ID2D1Brush* brush,
+    FLOAT strokeWidth, ID2D1StrokeStyle* strokeStyle) {
+    addCommand(Command::kDrawLine);
+    hasher_.add(point0);
+    hasher_.add(point1);
+    hasher_.add(strokeWidth);
+    addBrush(brush);
+    addStrokeStyle(strokeStyle);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawGeometry(ID2D1Geometry* geometry, ID2D1Brush* brush, FLOAT strokeWidth,
+    ID2D1StrokeStyle* strokeStyle) {
+    addCommand(Command::kDrawGeometry);
+    addGeometry(hasher_, geometry);
+    hasher_.add(strokeWidth);
+    addBrush(brush);
+    addStrokeStyle(strokeStyle);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawRectangle(const D2D1_RECT_F* rect, ID2D1Brush* brush, FLOAT strokeWidth,
+    ID2D1StrokeStyle* strokeStyle) {
+    addCommand(Command::kDrawRectangle);
+    addOptional(rect);
+    hasher_.add(strokeWidth);
+    addBrush(brush);
+    addStrokeStyle(strokeStyle);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawBitmap(ID2D1Bitmap* bitmap, const D2D1_RECT_F* destinationRectangle, FLOAT opacity,
+    D2D1_INTERPOLATION_MODE interpolationMode, const D2D1_RECT_F* sourceRectangle,
+    const D2D1_MATRIX_4X4_F* perspectiveTransform) {
+    addCommand(Command::kDrawBitmap);
+    addImage(bitmap);
+    addOptional(destinationRectangle);
+    hasher_.add(opacity);
+    hasher_.add(interpolationMode);
+    addOptional(sourceRectangle);
+    addOptional(perspectiveTransform);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawImage(ID2D1Image* image, const D2D1_POINT_2F* targetOffset,
+    const D2D1_RECT_F* imageRectangle, D2D1_INTERPOLATION_MODE interpolationMode, D2D1_COMPOSITE_MODE compositeMode) {
+    addCommand(Command::kDrawImage);
+    addImage(image);
+    addOptional(targetOffset);
+    addOptional(imageRectangle);
+    hasher_.add(interpolationMode);
+    hasher_.add(compositeMode);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::DrawGdiMetafile(ID2D1GdiMetafile*, const D2D1_POINT_2F*) {
+    hasher_.markNotDedupable();
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::FillMesh(ID2D1Mesh*, ID2D1Brush*) {
+    hasher_.markNotDedupable();
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::FillOpacityMask(ID2D1Bitmap*, ID2D1Brush*, const D2D1_RECT_F*, const D2D1_RECT_F*) {
+    hasher_.markNotDedupable();
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::FillGeometry(ID2D1Geometry* geometry, ID2D1Brush* brush, ID2D1Brush* opacityBrush) {
+    addCommand(Command::kFillGeometry);
+    addGeometry(hasher_, geometry);
+    addBrush(brush);
+    addBrush(opacityBrush);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::FillRectangle(const D2D1_RECT_F* rect, ID2D1Brush* brush) {
+    addCommand(Command::kFillRectangle);
+    addOptional(rect);
+    addBrush(brush);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::PushAxisAlignedClip(const D2D1_RECT_F* clipRect, D2D1_ANTIALIAS_MODE antialiasMode) {
+    addCommand(Command::kPushAxisAlignedClip);
+    addOptional(clipRect);
+    hasher_.add(antialiasMode);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::PushLayer(const D2D1_LAYER_PARAMETERS1* layerParameters1, ID2D1Layer*) {
+    addCommand(Command::kPushLayer);
+    hasher_.add(layerParameters1->contentBounds);
+    addGeometry(hasher_, layerParameters1->geometricMask);
+    hasher_.add(layerParameters1->maskAntialiasMode);
+    hasher_.add(layerParameters1->maskTransform);
+    hasher_.add(layerParameters1->opacity);
+    addBrush(layerParameters1->opacityBrush);
+    hasher_.add(layerParameters1->layerOptions);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::PopAxisAlignedClip() {
+    addCommand(Command::kPopAxisAlignedClip);
+    return S_OK;
+}
+
+STDMETHODIMP GfxDrawStreamHashSink::PopLayer() {
+    addCommand(Command::kPopLayer);
+    return S_OK;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,109 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+#include <dwrite.h>
+#include <winrt/base.h>
+
+#include <utility>
+#include <vector>
+
+#include "./GfxDrawStreamHasher.h"
+#include "./GfxObjectHashCache.h"
+
+namespace winui_drover_island {
+
+// Hashes a closed ID2D1CommandList through ID2D1CommandList::Stream. Everything is hashed through
+// its properties, never its address: rectangles, ellipses and transformed geometries through their
+// parameters; path geometries, geometry groups and font faces, which are immutable but costly to
+// read, once through their figures or font files, the hash being kept in a GfxObjectHashCache.
+// Other brushes than solid colors, meshes, metafiles and images mark the stream as not dedupable,
+// except for the images registered as stable, whose content is identified by a version instead.
+// Created once and reused, hashing a frame doesn't allocate once its paths and fonts are cached.
+class GfxDrawStreamHashSink : public winrt::implements<GfxDrawStreamHashSink, ID2D1CommandSink> {
+ public:
+    GfxDrawStreamHashSink();
+
+    void reset();
+    // The caller guarantees the image content only changes along with the version.
+    void addStableImage(ID2D1Image* image, uint64_t version);
+    // Versions are unique in the process, a bitmap created where a released one was never gets
+    // its version, whoever owns them.
+    static uint64_t nextImageVersion();
+
+    HRESULT hash(ID2D1CommandList* commandList);
+    GfxDrawStreamHasher& hasher() { return hasher_; }
+
+    // ID2D1CommandSink
+    STDMETHOD(BeginDraw)() override;
+    STDMETHOD(EndDraw)() override;
+    STDMETHOD(SetAntialiasMode)(D2D1_ANTIALIAS_MODE antialiasMode) override;
+    STDMETHOD(SetTags)(D2D1_TAG tag1, D2D1_TAG tag2) override;
+    STDMETHOD(SetTextAntialiasMode)(D2D1_TEXT_ANTIALIAS_MODE textAntialiasMode) override;
+    STDMETHOD(SetTextRenderingParams)(IDWriteRenderingParams* textRenderingParams) override;
+    STDMETHOD(SetTransform)(const D2D1_MATRIX_3X2_F* transform) override;
+    STDMETHOD(SetPrimitiveBlend)(D2D1_PRIMITIVE_BLEND primitiveBlend) override;
+    STDMETHOD(SetUnitMode)(D2D1_UNIT_MODE unitMode) override;
+    STDMETHOD(Clear)(const D2D1_COLOR_F* color) override;
+    STDMETHOD(DrawGlyphRun)(D2D1_POINT_2F baselineOrigin, const DWRITE_GLYPH_RUN* glyphRun,
+        const DWRITE_GLYPH_RUN_DESCRIPTION* glyphRunDescription, ID2D1Brush* foregroundBrush,
+        DWRITE_MEASURING_MODE measuringMode) override;
+    STDMETHOD(DrawLine)(D2D1_POINT_2F point0, D2D1_POINT_2F point1, ID2D1Brush* brush, FLOAT strokeWidth,
+        ID2D1StrokeStyle* strokeStyle) override;
+    STDMETHOD(DrawGeometry)(ID2D1Geometry* geometry, ID2D1Brush* brush, FLOAT strokeWidth, ID2D1StrokeStyle* strokeStyle) override;
+    STDMETHOD(DrawRectangle)(const D2D1_RECT_F* rect, ID2D1Brush* brush, FLOAT strokeWidth, ID2D1StrokeStyle* strokeStyle) override;
+    STDMETHOD(DrawBitmap)(ID2D1Bitmap* bitmap, const D2D1_RECT_F* destinationRectangle, FLOAT opacity,
+        D2D1_INTERPOLATION_MODE interpolationMode, const D2D1_RECT_F* sourceRectangle,
+        const D2D1_MATRIX_4X4_F* perspectiveTransform) override;
+    STDMETHOD(DrawImage)(ID2D1Image* image, const D2D1_POINT_2F* targetOffset, const D2D1_RECT_F* imageRectangle,
+        D2D1_INTERPOLATION_MODE interpolationMode, D2D1_COMPOSITE_MODE compositeMode) override;
+    STDMETHOD(DrawGdiMetafile)(ID2D1GdiMetafile* gdiMetafile, const D2D1_POINT_2F* targetOffset) override;
+    STDMETHOD(FillMesh)(ID2D1Mesh* mesh, ID2D1Brush* brush) override;
+    STDMETHOD(FillOpacityMask)(ID2D1Bitmap* opacityMask, ID2D1Brush* brush, const D2D1_RECT_F* destinationRectangle,
+        const D2D1_RECT_F* sourceRectangle) override;
+    STDMETHOD(FillGeometry)(ID2D1Geometry* geometry, ID2D1Brush* brush, ID2D1Brush* opacityBrush) override;
+    STDMETHOD(FillRectangle)(const D2D1_RECT_F* rect, ID2D1Brush* brush) override;
+    STDMETHOD(PushAxisAlignedClip)(const D2D1_RECT_F* clipRect, D2D1_ANTIALIAS_MODE antialiasMode) override;
+    STDMETHOD(PushLayer)(const D2D1_LAYER_PARAMETERS1* layerParameters1, ID2D1Layer* layer) override;
+    STDMETHOD(PopAxisAlignedClip)() override;
+    STDMETHOD(PopLayer)() override;
+
+ private:
+    enum class Command : uint32_t;
+
+    void addCommand(Command command);
+    void addBrush(ID2D1Brush* brush);
+    void addStrokeStyle(ID2D1StrokeStyle* strokeStyle);
+    void addGeometry(GfxDrawStreamHasher& hasher, ID2D1Geometry* geometry);
+    uint64_t hashPathGeometry(ID2D1PathGeometry* geometry);
+    uint64_t hashGeometryGroup(ID2D1GeometryGroup* geometry);
+    void addFontFace(IDWriteFontFace* fontFace);
+    void addImage(ID2D1Image* image);
+    template <typename T>
+    void addOptional(const T* value);
+
+    static constexpr size_t kCachedObjects = 64;
+
+    GfxDrawStreamHasher hasher_;
+    // The figures of one path geometry at a time.
+    GfxDrawStreamHasher pathHasher_;
+    winrt::com_ptr<ID2D1GeometrySink> geometrySink_;
+    GfxObjectHashCache<winrt::com_ptr<ID2D1Geometry>> geometries_{kCachedObjects};
+    GfxObjectHashCache<winrt::com_ptr<IDWriteFontFace>> fontFaces_{kCachedObjects};
+    std::vector<std::pair<ID2D1Image*, uint64_t>> stableImages_;
+    std::vector<float> dashes_;
+};
+
+}  // namespace winui_drover_island
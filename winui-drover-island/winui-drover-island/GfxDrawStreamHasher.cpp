@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxDrawStreamHasher.h"
+
+#include <cstring>
+
+namespace winui_drover_island {
+
+namespace {
+
+constexpr uint64_t kMultiplier1 = 0xbf58476d1ce4e5b9ull;
+constexpr uint64_t kMultiplier2 = 0x94d049bb133111ebull;
+
+inline uint64_t rotateLeft(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t mix(uint64_t state, uint64_t word) {
+    return rotateLeft(state ^ (word * kMultiplier1), 29) * kMultiplier2;
+}
+
+}  // namespace
+
+void GfxDrawStreamHasher::reset() {
+    state_ = kSeed;
+    length_ = 0;
+    dedupable_ = true;
+}
+
+void GfxDrawStreamHasher::addBytes(const void* data, size_t size) {
+    auto bytes = static_cast<const uint8_t*>(data);
+    length_ += size;
+    while (size >= sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        state_ = mix(state_, word);
+        bytes += sizeof(word);
+        size -= sizeof(word);
+    }
+    if (size > 0) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes, size);
+        state_ = mix(state_, word ^ (static_cast<uint64_t>(size) << 56));
+    }
+}
+
+uint64_t GfxDrawStreamHasher::hash() const {
+    // Final avalanche, folding in the length so that streams differing by trailing zeros differ.
+    uint64_t h = state_ ^ length_;
+    h ^= h >> 30;
+    h *= kMultiplier1;
+    h ^= h >> 27;
+    h *= kMultiplier2;
+    h ^= h >> 31;
+    return h != 0 ? h : 1;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,60 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace winui_drover_island {
+
+// Incremental 64-bit hash of a recorded draw stream. Commands whose result can't be derived from
+// their parameters, like drawing a bitmap whose pixels may have changed, make the stream not
+// dedupable: such a frame is always drawn.
+class GfxDrawStreamHasher {
+ public:
+    void reset();
+
+    void addBytes(const void* data, size_t size);
+
+    template <typename T>
+    void add(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed");
+        addBytes(&value, sizeof(T));
+    }
+
+    template <typename T>
+    void addArray(const T* values, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be hashed");
+        add(count);
+        if (values && count) {
+            addBytes(values, sizeof(T) * count);
+        }
+    }
+
+    void markNotDedupable() { dedupable_ = false; }
+    bool isDedupable() const { return dedupable_; }
+
+    // Never zero, so zero can stand for "nothing presented".
+    uint64_t hash() const;
+
+ private:
+    static constexpr uint64_t kSeed = 0x9e3779b97f4a7c15ull;
+
+    uint64_t state_ = kSeed;
+    uint64_t length_ = 0;
+    bool dedupable_ = true;
+};
+
+}  // namespace winui_drover_island
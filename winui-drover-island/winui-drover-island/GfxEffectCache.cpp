@@ -0,0 +1,251 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxEffectCache.h"
+#include "./GfxUtils.h"
+
+#include <d2d1effects.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace winui_drover_island {
+
+GfxEffectCache::GfxEffectCache(uint64_t controlId) : controlId_(controlId) {}
+
+GfxEffectCache::~GfxEffectCache() {
+    GfxMemoryBudget::instance().remove(budgetEntry_);
+}
+
+void GfxEffectCache::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, GfxD2DDevice& device, float dpi, EffectId id,
+    uint64_t sourceGeneration, const D2D_RECT_F& sourceRect, const Effect& effect, const DrawSource& drawSource) {
+    if (sourceRect.right <= sourceRect.left || sourceRect.bottom <= sourceRect.top) {
+        return;
+    }
+    auto it = std::find_if(entries_.begin(), entries_.end(), [&](const auto& entry) { return entry.id == id; });
+    if (it == entries_.end()) {
+        entries_.push_back({});
+        it = entries_.end() - 1;
+        it->id = id;
+    }
+    auto& entry = *it;
+
+    float deviationInPixels = std::max(effect.blurRadiusInDips, 0.f) * dpi / kDefaultDpi;
+    bool valid = entry.bitmap && entry.sourceGeneration == sourceGeneration && entry.dpi == dpi &&
+                 entry.deviationInPixels == deviationInPixels && entry.kind == effect.kind &&
+                 (effect.kind == Effect::Kind::kBlur ||
+                     (entry.color.r == effect.color.r && entry.color.g == effect.color.g &&
+                         entry.color.b == effect.color.b && entry.color.a == effect.color.a)) &&
+                 entry.sourceRect.left == sourceRect.left && entry.sourceRect.top == sourceRect.top &&
+                 entry.sourceRect.right == sourceRect.right && entry.sourceRect.bottom == sourceRect.bottom;
+    if (valid) {
+        entry.stats.hits++;
+    } else {
+        entry.stats.misses++;
+        entry.bitmap = nullptr;
+        auto start = std::chrono::steady_clock::now();
+        HRESULT hr = render(entry, device, sourceRect, effect, deviationInPixels, dpi, drawSource);
+        entry.stats.lastRenderTime = std::chrono::steady_clock::now() - start;
+        entry.stats.renderTime += entry.stats.lastRenderTime;
+        if (FAILED(hr)) {
+            LogIfFailed(hr, "GfxEffectCache::render", controlId_);
+            entry.bitmap = nullptr;
+            updateBudgetEntry();
+            return;
+        }
+        entry.kind = effect.kind;
+        entry.color = effect.color;
+        entry.deviationInPixels = deviationInPixels;
+        entry.sourceGeneration = sourceGeneration;
+        entry.sourceRect = sourceRect;
+        entry.dpi = dpi;
+        entry.version = GfxDrawStreamHashSink::nextImageVersion();
+        updateBudgetEntry();
+    }
+
+    auto destination = entry.bitmapRect;
+    destination.left += effect.offsetInDips.x;
+    destination.right += effect.offsetInDips.x;
+    destination.top += effect.offsetInDips.y;
+    destination.bottom += effect.offsetInDips.y;
+    context->DrawBitmap(entry.bitmap.get(), &destination, 1.f, D2D1_INTERPOLATION_MODE_LINEAR);
+}
+
+HRESULT GfxEffectCache::render(Entry& entry, GfxD2DDevice& device, const D2D_RECT_F& sourceRect, const Effect& effect,
+    float deviationInPixels, float dpi, const DrawSource& drawSource) {
+    // The bitmap is aligned on the surface pixels and holds the whole blur of the box passes. The
+    // Direct2D blur goes slightly further, by less than one 8-bit level.
+    auto extent = GfxBlur::gaussianExtent(deviationInPixels);
+    auto left = dipsToPixels(sourceRect.left, dpi, DpiRounding::kFloor) - extent;
+    auto top = dipsToPixels(sourceRect.top, dpi, DpiRounding::kFloor) - extent;
+    auto right = dipsToPixels(sourceRect.right, dpi, DpiRounding::kCeiling) + extent;
+    auto bottom = dipsToPixels(sourceRect.bottom, dpi, DpiRounding::kCeiling) + extent;
+    auto maximumSize = static_cast<int32_t>(device.maximumBitmapSizeInPixels());
+    if (right - left > maximumSize || bottom - top > maximumSize) {
+        return D2DERR_MAX_TEXTURE_SIZE_EXCEEDED;
+    }
+    auto size = D2D1::SizeU(static_cast<UINT32>(right - left), static_cast<UINT32>(bottom - top));
+    entry.bitmapRect = D2D1::RectF(pixelsToDips(left, dpi), pixelsToDips(top, dpi), pixelsToDips(right, dpi), pixelsToDips(bottom, dpi));
+
+    // The calling context is in the middle of its own BeginDraw, the effect is rendered with another one.
+    auto lease = device.leaseResourceCreationDeviceContext();
+    winrt::com_ptr<ID2D1DeviceContext> context;
+    context.copy_from(lease.context().get());
+    auto targetProperties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpi, dpi);
+
+    winrt::com_ptr<ID2D1Bitmap1> source;
+    ReturnIfFailed(context->CreateBitmap(size, nullptr, 0, targetProperties, source.put()));
+    context->SetTarget(source.get());
+    context->SetDpi(dpi, dpi);
+    context->SetTransform(D2D1::Matrix3x2F::Translation(-entry.bitmapRect.left, -entry.bitmapRect.top));
+    context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    context->BeginDraw();
+    context->Clear();
+    context->PushAxisAlignedClip(sourceRect, D2D1_ANTIALIAS_MODE_ALIASED);
+    ComExceptionBoundaryWithLog([&]() { drawSource(context); }, "effect source", controlId_);
+    context->PopAxisAlignedClip();
+    HRESULT hr = context->EndDraw();
+    context->SetTarget(nullptr);
+    ReturnIfFailed(hr);
+
+    if (device.isSoftware()) {
+        // WARP runs the Direct2D effects on the CPU as well, but not as fast as the box passes.
+        winrt::com_ptr<ID2D1Bitmap1> readback;
+        auto readbackProperties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpi, dpi);
+        ReturnIfFailed(context->CreateBitmap(size, nullptr, 0, readbackProperties, readback.put()));
+        ReturnIfFailed(readback->CopyFromBitmap(nullptr, source.get(), nullptr));
+
+        const size_t rowBytes = static_cast<size_t>(size.width) * 4;
+        pixels_.resize(rowBytes * size.height);
+        D2D1_MAPPED_RECT mapped = {};
+        ReturnIfFailed(readback->Map(D2D1_MAP_OPTIONS_READ, &mapped));
+        for (UINT32 y = 0; y < size.height; ++y) {
+            memcpy(pixels_.data() + y * rowBytes, mapped.bits + static_cast<size_t>(y) * mapped.pitch, rowBytes);
+        }
+        readback->Unmap();
+
+        auto width = static_cast<int32_t>(size.width);
+        auto height = static_cast<int32_t>(size.height);
+        if (effect.kind == Effect::Kind::kShadow) {
+            auto channel = [&](float value) { return static_cast<uint8_t>(std::lround(std::clamp(value * effect.color.a, 0.f, 1.f) * 255.f)); };
+            const uint8_t color[4] = {channel(effect.color.b), channel(effect.color.g), channel(effect.color.r), channel(1.f)};
+            GfxBlur::tint(pixels_.data(), width, height, rowBytes, color);
+        }
+        blur_.gaussianBlur(pixels_.data(), width, height, rowBytes, deviationInPixels);
+
+        auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpi, dpi);
+        ReturnIfFailed(context->CreateBitmap(size, pixels_.data(), static_cast<UINT32>(rowBytes), properties, entry.bitmap.put()));
+        entry.stats.cpuRenders++;
+        return S_OK;
+    }
+
+    winrt::com_ptr<ID2D1Effect> d2dEffect;
+    if (effect.kind == Effect::Kind::kShadow) {
+        ReturnIfFailed(context->CreateEffect(CLSID_D2D1Shadow, d2dEffect.put()));
+        ReturnIfFailed(d2dEffect->SetValue(D2D1_SHADOW_PROP_BLUR_STANDARD_DEVIATION, effect.blurRadiusInDips));
+        ReturnIfFailed(d2dEffect->SetValue(D2D1_SHADOW_PROP_COLOR,
+            D2D1::Vector4F(effect.color.r, effect.color.g, effect.color.b, effect.color.a)));
+    } else {
+        ReturnIfFailed(context->CreateEffect(CLSID_D2D1GaussianBlur, d2dEffect.put()));
+        ReturnIfFailed(d2dEffect->SetValue(D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, effect.blurRadiusInDips));
+    }
+    d2dEffect->SetInput(0, source.get());
+
+    ReturnIfFailed(context->CreateBitmap(size, nullptr, 0, targetProperties, entry.bitmap.put()));
+    context->SetTarget(entry.bitmap.get());
+    context->SetTransform(D2D1::Matrix3x2F::Identity());
+    context->BeginDraw();
+    context->Clear();
+    context->DrawImage(d2dEffect.get());
+    hr = context->EndDraw();
+    context->SetTarget(nullptr);
+    return hr;
+}
+
+void GfxEffectCache::release(EffectId id) {
+    auto it = std::find_if(entries_.begin(), entries_.end(), [&](const auto& entry) { return entry.id == id; });
+    if (it == entries_.end()) {
+        return;
+    }
+    entries_.erase(it);
+    updateBudgetEntry();
+}
+
+void GfxEffectCache::releaseBitmaps() {
+    for (auto& entry : entries_) {
+        entry.bitmap = nullptr;
+    }
+    updateBudgetEntry();
+}
+
+GfxEffectCache::Stats GfxEffectCache::stats(EffectId id) const {
+    auto it = std::find_if(entries_.begin(), entries_.end(), [&](const auto& entry) { return entry.id == id; });
+    return it != entries_.end() ? it->stats : Stats{};
+}
+
+GfxEffectCache::Stats GfxEffectCache::totalStats() const {
+    Stats total;
+    for (const auto& entry : entries_) {
+        total.hits += entry.stats.hits;
+        total.misses += entry.stats.misses;
+        total.cpuRenders += entry.stats.cpuRenders;
+        total.renderTime += entry.stats.renderTime;
+    }
+    return total;
+}
+
+void GfxEffectCache::addStableImages(GfxDrawStreamHashSink& sink) const {
+    for (const auto& entry : entries_) {
+        if (entry.bitmap) {
+            sink.addStableImage(entry.bitmap.get(), entry.version);
+        }
+    }
+}
+
+void GfxEffectCache::setVisible(bool visible) {
+    visible_ = visible;
+    GfxMemoryBudget::instance().setVisible(budgetEntry_, visible);
+}
+
+void GfxEffectCache::updateBudgetEntry() {
+    size_t bytes = 0;
+    for (const auto& entry : entries_) {
+        if (entry.bitmap) {
+            auto size = entry.bitmap->GetPixelSize();
+            bytes += static_cast<size_t>(size.width) * size.height * 4;
+        }
+    }
+
+    auto& budget = GfxMemoryBudget::instance();
+    if (bytes == 0) {
+        budget.remove(budgetEntry_);
+        budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+        return;
+    }
+    if (budgetEntry_ != GfxMemoryBudget::kInvalidEntry) {
+        budget.update(budgetEntry_, bytes);
+        return;
+    }
+    // The entry is removed before the cache is destroyed.
+    budgetEntry_ = budget.add(GfxMemorySubsystem::kCaches, bytes, [this]() { releaseBitmaps(); });
+    budget.setVisible(budgetEntry_, visible_);
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,116 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "./GfxBlur.h"
+#include "./GfxD2DDeviceManager.h"
+#include "./GfxDrawStreamHashSink.h"
+#include "./GfxMemoryBudget.h"
+#include "winrt/base.h"
+
+namespace winui_drover_island {
+
+// Blurs and shadows of content drawn by a callback, for one control. The effect output is kept in
+// a bitmap and rendered again only when the source generation, the effect or the DPI change, so
+// a static shadow costs a bitmap draw per frame. Moving the effect by its offset doesn't render it. Software devices render the effects with
+// GfxBlur. The bitmaps are accounted in the memory budget, which may drop them.
+// Used on the UI thread only.
+class GfxEffectCache {
+ public:
+    using EffectId = uint32_t;
+
+    struct Effect {
+        enum class Kind { kBlur, kShadow };
+        Kind kind = Kind::kShadow;
+        // The standard deviation of the blur.
+        float blurRadiusInDips = 4.f;
+        // The shadow color, with straight alpha. Ignored by blurs.
+        D2D1_COLOR_F color = {0.f, 0.f, 0.f, 0.5f};
+        D2D1_POINT_2F offsetInDips = {0.f, 0.f};
+    };
+
+    struct Stats {
+        // hits / (hits + misses) is the cache hit rate of the effect.
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        // Renders done with GfxBlur rather than with the Direct2D effects.
+        uint64_t cpuRenders = 0;
+        std::chrono::steady_clock::duration renderTime{};
+        std::chrono::steady_clock::duration lastRenderTime{};
+    };
+
+    using DrawSource = std::function<void(const winrt::com_ptr<ID2D1DeviceContext>&)>;
+
+    // The id identifies the control in the log records.
+    explicit GfxEffectCache(uint64_t controlId);
+    ~GfxEffectCache();
+
+    GfxEffectCache(GfxEffectCache const&) = delete;
+    GfxEffectCache& operator=(GfxEffectCache const&) = delete;
+
+    // Draws the effect of what drawSource draws inside sourceRect, in the coordinates of the
+    // context, whose DPI is dpi. drawSource is only called when the effect is rendered again.
+    void draw(const winrt::com_ptr<ID2D1DeviceContext>& context, GfxD2DDevice& device, float dpi, EffectId id,
+        uint64_t sourceGeneration, const D2D_RECT_F& sourceRect, const Effect& effect, const DrawSource& drawSource);
+    void release(EffectId id);
+    // The bitmaps belong to the device. The effects keep their stats, their next draw renders them again.
+    void releaseBitmaps();
+
+    // Zeroes for an effect that was never drawn.
+    Stats stats(EffectId id) const;
+    // Every effect together.
+    Stats totalStats() const;
+
+    // The bitmaps only change along with their version.
+    void addStableImages(GfxDrawStreamHashSink& sink) const;
+    void setVisible(bool visible);
+
+ private:
+    struct Entry {
+        EffectId id = 0;
+        // What the bitmap was rendered with: the offset isn't part of it, and the blur is the
+        // deviation in the pixels of the bitmap.
+        Effect::Kind kind = Effect::Kind::kShadow;
+        D2D1_COLOR_F color = {};
+        float deviationInPixels = 0;
+        uint64_t sourceGeneration = 0;
+        D2D_RECT_F sourceRect = {};
+        float dpi = 0;
+        winrt::com_ptr<ID2D1Bitmap1> bitmap;
+        // Where the bitmap is drawn, before the effect offset.
+        D2D_RECT_F bitmapRect = {};
+        uint64_t version = 0;
+        Stats stats;
+    };
+
+    HRESULT render(Entry& entry, GfxD2DDevice& device, const D2D_RECT_F& sourceRect, const Effect& effect, float deviationInPixels,
+        float dpi, const DrawSource& drawSource);
+    void updateBudgetEntry();
+
+    const uint64_t controlId_;
+    std::vector<Entry> entries_;
+    GfxBlur blur_;
+    std::vector<uint8_t> pixels_;
+    GfxMemoryBudget::EntryId budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+    bool visible_ = true;
+};
+
+}  // namespace winui_drover_island
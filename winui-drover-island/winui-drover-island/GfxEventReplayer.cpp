@@ -0,0 +1,92 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxEventReplayer.h"
+
+#include <algorithm>
+
+namespace winui_drover_island {
+
+GfxFrameTimeStats GfxFrameTimeStats::from(std::vector<Clock::duration>& samples) {
+    GfxFrameTimeStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&](size_t percent) { return samples[(samples.size() - 1) * percent / 100]; };
+    stats.frames = samples.size();
+    for (auto sample : samples) {
+        stats.total += sample;
+    }
+    stats.mean = stats.total / static_cast<Clock::rep>(samples.size());
+    stats.p50 = percentile(50);
+    stats.p95 = percentile(95);
+    stats.p99 = percentile(99);
+    stats.max = samples.back();
+    return stats;
+}
+
+GfxEventReplayer::Result GfxEventReplayer::replay(const GfxEventTrace& trace, GfxEventReplayTarget& target,
+    GfxManualFrameClock& clock, const Options& options) {
+    using EventKind = GfxEventTrace::EventKind;
+    Result result;
+    const auto& events = trace.events();
+    const auto interval = std::max(options.frameInterval, std::chrono::microseconds(1));
+
+    std::vector<Clock::duration> recorded;
+    for (const auto& event : events) {
+        if (event.kind == EventKind::kFrame) {
+            recorded.push_back(std::chrono::microseconds(static_cast<int64_t>(event.values[0])));
+        }
+    }
+    result.recorded = GfxFrameTimeStats::from(recorded);
+
+    std::vector<Clock::duration> replayed;
+    // The virtual time starts at the epoch of the clock, the same for every replay.
+    const Clock::time_point origin{};
+    std::chrono::microseconds frameTime{};
+    size_t next = 0;
+    uint32_t trailingFrames = 0;
+    while (next < events.size() || (clock.hasPendingFrames() && trailingFrames < options.trailingFrames)) {
+        for (; next < events.size() && events[next].time <= frameTime; ++next) {
+            if (events[next].kind != EventKind::kFrame) {
+                target.applyEvent(events[next]);
+                result.events++;
+            }
+        }
+
+        if (clock.hasPendingFrames()) {
+            auto frameCount = clock.frameCount();
+            auto start = Clock::now();
+            clock.advance(origin + frameTime);
+            auto elapsed = Clock::now() - start;
+            if (clock.frameCount() != frameCount) {
+                replayed.push_back(elapsed);
+            }
+        }
+        if (next == events.size()) {
+            trailingFrames++;
+        }
+
+        frameTime += interval;
+        if (!clock.hasPendingFrames() && next < events.size() && events[next].time > frameTime) {
+            // Nothing to draw until the next event, skip to the tick following it.
+            auto ticks = (events[next].time.count() + interval.count() - 1) / interval.count();
+            frameTime = std::chrono::microseconds(ticks * interval.count());
+        }
+    }
+    result.replayed = GfxFrameTimeStats::from(replayed);
+    return result;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,77 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "./GfxEventTrace.h"
+#include "./GfxFrameClock.h"
+
+namespace winui_drover_island {
+
+class GfxEventReplayTarget {
+ public:
+    virtual ~GfxEventReplayTarget() = default;
+
+    // Called for every event of the trace but the kFrame ones, in order. The target requests its
+    // frames from the clock given to the replayer, like a control does.
+    virtual void applyEvent(const GfxEventTrace::Event& event) = 0;
+};
+
+struct GfxFrameTimeStats {
+    using Clock = std::chrono::steady_clock;
+
+    uint64_t frames = 0;
+    Clock::duration total{};
+    Clock::duration mean{};
+    Clock::duration p50{};
+    Clock::duration p95{};
+    Clock::duration p99{};
+    Clock::duration max{};
+
+    // Sorts the samples.
+    static GfxFrameTimeStats from(std::vector<Clock::duration>& samples);
+};
+
+// Replays a trace on a manual clock. The frames are ticked on a fixed interval of virtual time and
+// the events are applied at their recorded time, so a replay is the same sequence of frames every
+// time whatever the machine. Only the time spent in the frames is measured, on the real clock.
+class GfxEventReplayer {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        std::chrono::microseconds frameInterval{16667};
+        // Frames still ticked once the events are over, for what they left pending.
+        uint32_t trailingFrames = 8;
+    };
+
+    struct Result {
+        uint64_t events = 0;
+        // Ticks that had frames to deliver.
+        GfxFrameTimeStats replayed;
+        // What the kFrame events of the trace measured in the session.
+        GfxFrameTimeStats recorded;
+    };
+
+    static Result replay(const GfxEventTrace& trace, GfxEventReplayTarget& target, GfxManualFrameClock& clock,
+        const Options& options);
+    static Result replay(const GfxEventTrace& trace, GfxEventReplayTarget& target, GfxManualFrameClock& clock) {
+        return replay(trace, target, clock, Options{});
+    }
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,219 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxEventTrace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace winui_drover_island {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x54564547;  // "GEVT", stored little endian like every integer
+
+void writeUInt32(std::vector<uint8_t>& data, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void writeVarint(std::vector<uint8_t>& data, uint64_t value) {
+    while (value >= 0x80) {
+        data.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<uint8_t>(value));
+}
+
+void writeFloat(std::vector<uint8_t>& data, float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(data, bits);
+}
+
+class Reader {
+ public:
+    Reader(const uint8_t* data, size_t size) : data_(data), end_(data + size) {}
+
+    bool readUInt32(uint32_t& value) {
+        if (end_ - data_ < 4) {
+            return false;
+        }
+        value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(data_[i]) << (8 * i);
+        }
+        data_ += 4;
+        return true;
+    }
+
+    bool readVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (data_ == end_) {
+                return false;
+            }
+            uint8_t byte = *data_++;
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readByte(uint8_t& value) {
+        if (data_ == end_) {
+            return false;
+        }
+        value = *data_++;
+        return true;
+    }
+
+    bool readFloat(float& value) {
+        uint32_t bits;
+        if (!readUInt32(bits)) {
+            return false;
+        }
+        std::memcpy(&value, &bits, sizeof(value));
+        return true;
+    }
+
+ private:
+    const uint8_t* data_;
+    const uint8_t* end_;
+};
+
+}  // namespace
+
+size_t GfxEventTrace::valueCount(EventKind kind) {
+    switch (kind) {
+    case EventKind::kResize: return 2;
+    case EventKind::kDpiChange: return 1;
+    case EventKind::kInvalidateRect: return 4;
+    case EventKind::kPickControl: return 1;
+    case EventKind::kFrame: return 1;
+    case EventKind::kInvalidate:
+    case EventKind::kDeviceLost:
+    case EventKind::kSurfaceLost: return 0;
+    }
+    return 0;
+}
+
+void GfxEventTrace::encode(std::vector<uint8_t>& data) const {
+    data.clear();
+    writeUInt32(data, kMagic);
+    writeUInt32(data, kVersion);
+    writeUInt32(data, static_cast<uint32_t>(events_.size()));
+    int64_t previousTime = 0;
+    for (const auto& event : events_) {
+        // Events are appended in time order, a negative delta can only come from a hand made trace.
+        int64_t time = event.time.count();
+        writeVarint(data, static_cast<uint64_t>(time > previousTime ? time - previousTime : 0));
+        previousTime = std::max(previousTime, time);
+        writeVarint(data, event.source);
+        data.push_back(static_cast<uint8_t>(event.kind));
+        for (size_t i = 0; i < valueCount(event.kind); ++i) {
+            writeFloat(data, event.values[i]);
+        }
+    }
+}
+
+bool GfxEventTrace::decode(const uint8_t* data, size_t size) {
+    events_.clear();
+    Reader reader(data, size);
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if (!reader.readUInt32(magic) || magic != kMagic || !reader.readUInt32(version) || version != kVersion || !reader.readUInt32(count)) {
+        return false;
+    }
+    // Every event takes 3 bytes at least, a corrupted count must not reserve gigabytes.
+    events_.reserve(std::min<size_t>(count, size / 3));
+    int64_t time = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        Event event;
+        uint64_t delta = 0;
+        uint8_t kind = 0;
+        if (!reader.readVarint(delta) || !reader.readVarint(event.source) || !reader.readByte(kind) ||
+            kind < static_cast<uint8_t>(EventKind::kResize) || kind > static_cast<uint8_t>(EventKind::kFrame)) {
+            events_.clear();
+            return false;
+        }
+        time += static_cast<int64_t>(delta);
+        event.time = std::chrono::microseconds(time);
+        event.kind = static_cast<EventKind>(kind);
+        for (size_t j = 0; j < valueCount(event.kind); ++j) {
+            if (!reader.readFloat(event.values[j])) {
+                events_.clear();
+                return false;
+            }
+        }
+        events_.push_back(event);
+    }
+    return true;
+}
+
+bool GfxEventTrace::save(const std::filesystem::path& path) const {
+    std::vector<uint8_t> data;
+    encode(data);
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        return false;
+    }
+    stream.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(stream);
+}
+
+bool GfxEventTrace::load(const std::filesystem::path& path) {
+    events_.clear();
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    return decode(data.data(), data.size());
+}
+
+GfxEventRecorder& GfxEventRecorder::instance() {
+    static GfxEventRecorder recorder;
+    return recorder;
+}
+
+void GfxEventRecorder::start() {
+    trace_.clear();
+    start_ = Clock::now();
+    recording_ = true;
+}
+
+GfxEventTrace GfxEventRecorder::stop() {
+    recording_ = false;
+    GfxEventTrace trace;
+    std::swap(trace, trace_);
+    return trace;
+}
+
+void GfxEventRecorder::append(uint64_t source, EventKind kind, const Values& values) {
+    GfxEventTrace::Event event;
+    event.time = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start_);
+    event.source = source;
+    event.kind = kind;
+    std::memcpy(event.values, values.values, sizeof(event.values));
+    trace_.append(event);
+}
+
+}  // namespace winui_drover_island
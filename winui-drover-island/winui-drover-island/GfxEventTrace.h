@@ -0,0 +1,114 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace winui_drover_island {
+
+// The events that drive the rendering pipeline of the controls, as they happened in a session.
+// Replayed against a GfxEventReplayTarget they reproduce the same sequence of frames, so a resize
+// storm or a device loss seen in the field becomes a benchmark.
+//
+// File layout: "GEVT", the version and the event count as little-endian uint32, then the events.
+// Each event is the time since the previous one in microseconds and the source as unsigned LEB128
+// varints, the kind as a byte, and the float values of the kind. A resize takes 12 bytes or so.
+class GfxEventTrace {
+ public:
+    static constexpr uint32_t kVersion = 1;
+
+    enum class EventKind : uint8_t {
+        // values: width and height in DIPs.
+        kResize = 1,
+        // values: the DPI.
+        kDpiChange,
+        kInvalidate,
+        // values: left, top, right and bottom in DIPs.
+        kInvalidateRect,
+        kDeviceLost,
+        kSurfaceLost,
+        // values: the index of the control picked. The source is the window.
+        kPickControl,
+        // values: the draw time in microseconds. Not replayed, it is what the session measured.
+        kFrame,
+    };
+    static constexpr size_t kMaxValues = 4;
+    static size_t valueCount(EventKind kind);
+
+    struct Event {
+        // Since the recording started.
+        std::chrono::microseconds time{};
+        // Identifies the control, or the window, in the session.
+        uint64_t source = 0;
+        EventKind kind = EventKind::kInvalidate;
+        float values[kMaxValues] = {};
+    };
+
+    GfxEventTrace() = default;
+
+    void append(const Event& event) { events_.push_back(event); }
+    void clear() { events_.clear(); }
+    const std::vector<Event>& events() const { return events_; }
+    bool isEmpty() const { return events_.empty(); }
+    std::chrono::microseconds duration() const { return events_.empty() ? std::chrono::microseconds{} : events_.back().time; }
+
+    void encode(std::vector<uint8_t>& data) const;
+    // Fails, leaving the trace empty, on data that isn't a trace of this version or is truncated.
+    bool decode(const uint8_t* data, size_t size);
+
+    bool save(const std::filesystem::path& path) const;
+    bool load(const std::filesystem::path& path);
+
+ private:
+    std::vector<Event> events_;
+};
+
+// Records the events of the session while started. Recording costs a branch when stopped, the
+// call sites don't need to check. Used on the UI thread only.
+class GfxEventRecorder {
+ public:
+    using Clock = std::chrono::steady_clock;
+    using EventKind = GfxEventTrace::EventKind;
+
+    static GfxEventRecorder& instance();
+
+    void start();
+    // Returns what was recorded since start().
+    GfxEventTrace stop();
+    bool isRecording() const { return recording_; }
+
+    void record(uint64_t source, EventKind kind, float value0 = 0, float value1 = 0, float value2 = 0, float value3 = 0) {
+        if (recording_) {
+            append(source, kind, {value0, value1, value2, value3});
+        }
+    }
+
+ private:
+    GfxEventRecorder() = default;
+
+    struct Values {
+        float values[GfxEventTrace::kMaxValues];
+    };
+    void append(uint64_t source, EventKind kind, const Values& values);
+
+    GfxEventTrace trace_;
+    Clock::time_point start_;
+    bool recording_ = false;
+};
+
+}  // namespace winui_drover_island
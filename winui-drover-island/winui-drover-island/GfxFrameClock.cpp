@@ -0,0 +1,137 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxFrameClock.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace winui_drover_island {
+
+namespace {
+
+std::vector<GfxFrameClock*>& liveClocks() {
+    static std::vector<GfxFrameClock*> clocks;
+    return clocks;
+}
+
+bool sOccluded = false;
+
+}  // namespace
+
+GfxFrameClock::GfxFrameClock(bool pauseWhenOccluded) : pauseWhenOccluded_(pauseWhenOccluded) {
+    paused_ = pauseWhenOccluded_ && sOccluded;
+    liveClocks().push_back(this);
+}
+
+GfxFrameClock::~GfxFrameClock() {
+    assert(detached_);
+    auto& clocks = liveClocks();
+    clocks.erase(std::remove(clocks.begin(), clocks.end(), this), clocks.end());
+}
+
+void GfxFrameClock::detach() {
+    if (ticking_) {
+        stopTicking();
+        ticking_ = false;
+    }
+    pending_.clear();
+    detached_ = true;
+}
+
+void GfxFrameClock::requestFrame(GfxFrameClockClient* client) {
+    assert(client);
+    if (isFramePending(client)) {
+        return;
+    }
+    pending_.push_back(client);
+    updateTicking();
+}
+
+void GfxFrameClock::cancelFrame(GfxFrameClockClient* client) {
+    pending_.erase(std::remove(pending_.begin(), pending_.end(), client), pending_.end());
+    // The client may be going away while we are delivering frames.
+    std::replace(delivering_.begin(), delivering_.end(), client, static_cast<GfxFrameClockClient*>(nullptr));
+    updateTicking();
+}
+
+bool GfxFrameClock::isFramePending(const GfxFrameClockClient* client) const {
+    return std::find(pending_.begin(), pending_.end(), client) != pending_.end();
+}
+
+void GfxFrameClock::setPaused(bool paused) {
+    if (paused_ == paused) {
+        return;
+    }
+    paused_ = paused;
+    updateTicking();
+}
+
+void GfxFrameClock::setOccluded(bool occluded) {
+    sOccluded = occluded;
+    for (auto* clock : liveClocks()) {
+        if (clock->pauseWhenOccluded_) {
+            clock->setPaused(occluded);
+        }
+    }
+}
+
+bool GfxFrameClock::isOccluded() {
+    return sOccluded;
+}
+
+bool GfxFrameClock::shouldTick() const {
+    return !detached_ && !paused_ && !pending_.empty();
+}
+
+void GfxFrameClock::updateTicking() {
+    bool shouldTick = this->shouldTick();
+    if (shouldTick == ticking_) {
+        return;
+    }
+    ticking_ = shouldTick;
+    if (ticking_) {
+        startTicking();
+    } else {
+        stopTicking();
+    }
+}
+
+void GfxFrameClock::tick(Clock::time_point now) {
+    if (paused_ || pending_.empty()) {
+        return;
+    }
+    // Swapping keeps the capacity of both vectors, a steady animation doesn't allocate.
+    assert(delivering_.empty());
+    delivering_.swap(pending_);
+    frameCount_++;
+    auto start = Clock::now();
+    for (size_t i = 0; i < delivering_.size(); ++i) {
+        if (auto* client = delivering_[i]) {
+            client->onFrame(now);
+            tickStats_.clientFrames++;
+        }
+    }
+    auto elapsed = Clock::now() - start;
+    tickStats_.ticks++;
+    tickStats_.totalTime += elapsed;
+    tickStats_.maxTime = std::max(tickStats_.maxTime, elapsed);
+    delivering_.clear();
+    updateTicking();
+}
+
+void GfxManualFrameClock::advance(Clock::time_point now) {
+    tick(now);
+}
+
+}  // namespace winui_drover_island
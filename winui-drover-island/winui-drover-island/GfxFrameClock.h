@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace winui_drover_island {
+
+class GfxFrameClock;
+
+class GfxFrameClockClient {
+ public:
+    virtual ~GfxFrameClockClient() = default;
+
+    // Called once per requested frame; the request is consumed before the call.
+    virtual void onFrame(std::chrono::steady_clock::time_point now) = 0;
+};
+
+// Decides when the frames requested by its clients are delivered. Requests are one-shot, a client
+// animating requests the next frame from onFrame. Subclasses only provide the tick source: they
+// start ticking when there are pending requests and call tick() until asked to stop.
+// Clocks are created and used on a single thread, the UI thread in the app.
+class GfxFrameClock {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit GfxFrameClock(bool pauseWhenOccluded);
+    virtual ~GfxFrameClock();
+
+    GfxFrameClock(GfxFrameClock const&) = delete;
+    GfxFrameClock& operator=(GfxFrameClock const&) = delete;
+
+    void requestFrame(GfxFrameClockClient* client);
+    void cancelFrame(GfxFrameClockClient* client);
+    bool isFramePending(const GfxFrameClockClient* client) const;
+    bool hasPendingFrames() const { return !pending_.empty(); }
+
+    // Paused clocks keep the requests and deliver them once resumed.
+    void setPaused(bool paused);
+    bool isPaused() const { return paused_; }
+
+    uint64_t frameCount() const { return frameCount_; }
+
+    // The time spent delivering each tick, every client of the clock together.
+    struct TickStats {
+        uint64_t ticks = 0;
+        // Frames delivered to the clients, one per pending client per tick.
+        uint64_t clientFrames = 0;
+        Clock::duration totalTime{};
+        Clock::duration maxTime{};
+    };
+    const TickStats& tickStats() const { return tickStats_; }
+    void resetTickStats() { tickStats_ = TickStats{}; }
+
+    // Pauses the clocks that don't need to run while the window is occluded or minimized.
+    static void setOccluded(bool occluded);
+    static bool isOccluded();
+
+ protected:
+    virtual void startTicking() = 0;
+    virtual void stopTicking() = 0;
+
+    // Delivers the pending frames. Requests made while delivering are kept for the next tick.
+    void tick(Clock::time_point now);
+
+    // Subclasses call this from their destructor, the base destructor can't call stopTicking().
+    void detach();
+
+ private:
+    bool shouldTick() const;
+    void updateTicking();
+
+    std::vector<GfxFrameClockClient*> pending_;
+    std::vector<GfxFrameClockClient*> delivering_;
+    uint64_t frameCount_ = 0;
+    TickStats tickStats_;
+    const bool pauseWhenOccluded_;
+    bool paused_ = false;
+    bool ticking_ = false;
+    bool detached_ = false;
+};
+
+// Only ticks when told to. Drives the controls headless, in tests, or for on-demand rendering.
+class GfxManualFrameClock : public GfxFrameClock {
+ public:
+    GfxManualFrameClock() : GfxFrameClock(false) {}
+    ~GfxManualFrameClock() override { detach(); }
+
+    // Delivers the frames requested so far, if the clock isn't paused.
+    void advance(Clock::time_point now);
+
+ protected:
+    void startTicking() override {}
+    void stopTicking() override {}
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,66 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxFrameDamage.h"
+
+#include <cassert>
+#include <utility>
+
+namespace winui_drover_island {
+
+void GfxFrameDamage::clearPending() {
+    pending_.clear();
+    fullRedrawPending_ = false;
+}
+
+const std::vector<PixelRect>& GfxFrameDamage::pendingRects() {
+    if (fullRedrawPending_) {
+        return noRects_;
+    }
+    pending_.simplify();
+    return pending_.rects();
+}
+
+bool GfxFrameDamage::beginFrame(const PixelRect& surfaceBounds, bool newSurface) {
+    assert(!inFrame_);
+    surfaceArea_ = surfaceBounds.area();
+    fullFrame_ = fullRedrawPending_ || pending_.isEmpty() || newSurface;
+    if (!fullFrame_) {
+        pending_.simplify();
+        fullFrame_ = pending_.area() * 2 > surfaceArea_;
+    }
+    std::swap(pending_, frame_);
+    pending_.clear();
+    fullRedrawPending_ = false;
+    inFrame_ = true;
+    return fullFrame_;
+}
+
+void GfxFrameDamage::endFrame(bool succeeded) {
+    assert(inFrame_);
+    if (fullFrame_) {
+        stats_.fullFrames++;
+        stats_.redrawnPixels += static_cast<uint64_t>(surfaceArea_);
+    } else {
+        stats_.partialFrames++;
+        stats_.redrawnPixels += static_cast<uint64_t>(frame_.area());
+        stats_.partialFrameSurfacePixels += static_cast<uint64_t>(surfaceArea_);
+    }
+    frame_.clear();
+    inFrame_ = false;
+    if (!succeeded) {
+        fullRedrawPending_ = true;
+    }
+}
+
+}  // namespace winui_drover_island
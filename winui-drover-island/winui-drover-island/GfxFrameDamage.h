@@ -0,0 +1,71 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "./GfxDamageRegion.h"
+#include "./GfxRect.h"
+
+namespace winui_drover_island {
+
+// What the next frame of a surface draws: all of it, or only the rects damaged since the previous
+// frame. Past half of the surface, a single update is cheaper than the rects. Damage added while
+// a frame is drawn goes to the next one. No graphics dependencies, so the decisions can be tested
+// headless.
+class GfxFrameDamage {
+ public:
+    struct Stats {
+        uint64_t fullFrames = 0;
+        // Frames drawing only the damaged rects.
+        uint64_t partialFrames = 0;
+        uint64_t redrawnPixels = 0;
+        // What the partial frames would have drawn without the damage tracking.
+        uint64_t partialFrameSurfacePixels = 0;
+    };
+
+    // The rect is in surface pixels, inside the surface.
+    void add(const PixelRect& rect) { pending_.add(rect); }
+    void invalidateAll() { fullRedrawPending_ = true; }
+    // The surface was drawn whole by other means.
+    void clearPending();
+    bool isPending() const { return fullRedrawPending_ || !pending_.isEmpty(); }
+
+    // For surfaces asking for the regions they need, like virtual surfaces: the pending rects,
+    // simplified, or none when all of the surface is damaged. Cleared by clearPending().
+    const std::vector<PixelRect>& pendingRects();
+
+    // Takes the pending damage for the frame. A new surface has no pixels to keep. Returns
+    // whether the frame draws all of the surface; otherwise it draws the rects of frame().
+    bool beginFrame(const PixelRect& surfaceBounds, bool newSurface);
+    bool isPartialFrame() const { return inFrame_ && !fullFrame_; }
+    const GfxDamageRegion& frame() const { return frame_; }
+    // What a failed frame left on the surface is unknown, the next frame draws all of it.
+    void endFrame(bool succeeded);
+
+    const Stats& stats() const { return stats_; }
+
+ private:
+    GfxDamageRegion pending_;
+    GfxDamageRegion frame_;
+    std::vector<PixelRect> noRects_;
+    int64_t surfaceArea_ = 0;
+    bool fullRedrawPending_ = true;
+    bool inFrame_ = false;
+    bool fullFrame_ = false;
+    Stats stats_;
+};
+
+}  // namespace winui_drover_island
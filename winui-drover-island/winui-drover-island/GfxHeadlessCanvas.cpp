@@ -0,0 +1,219 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxHeadlessCanvas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+namespace winui_drover_island {
+
+GfxHeadlessCanvas::GfxHeadlessCanvas(std::shared_ptr<GfxFrameClock> clock) : clock_(std::move(clock)) {
+    assert(clock_);
+}
+
+GfxHeadlessCanvas::~GfxHeadlessCanvas() {
+    clock_->cancelFrame(this);
+}
+
+void GfxHeadlessCanvas::applyEvent(const GfxEventTrace::Event& event) {
+    using EventKind = GfxEventTrace::EventKind;
+    switch (event.kind) {
+    case EventKind::kResize:
+        width_ = std::max(event.values[0], 0.f);
+        height_ = std::max(event.values[1], 0.f);
+        damage_.invalidateAll();
+        break;
+    case EventKind::kDpiChange:
+        if (event.values[0] > 0) {
+            dpi_ = event.values[0];
+        }
+        damage_.invalidateAll();
+        break;
+    case EventKind::kInvalidate:
+        damage_.invalidateAll();
+        break;
+    case EventKind::kInvalidateRect: {
+        if (tiles_.empty()) {
+            damage_.invalidateAll();
+            break;
+        }
+        PixelRect rect{dipsToPixels(event.values[0], surfaceDpi_, DpiRounding::kFloor), dipsToPixels(event.values[1], surfaceDpi_, DpiRounding::kFloor),
+            dipsToPixels(event.values[2], surfaceDpi_, DpiRounding::kCeiling), dipsToPixels(event.values[3], surfaceDpi_, DpiRounding::kCeiling)};
+        rect = rect.intersection(PixelRect{0, 0, layout_.width(), layout_.height()});
+        if (rect.isEmpty()) {
+            return;
+        }
+        damage_.add(rect);
+        break;
+    }
+    case EventKind::kDeviceLost:
+    case EventKind::kSurfaceLost:
+        if (!tiles_.empty()) {
+            surfacesLost_++;
+        }
+        releaseSurface();
+        break;
+    case EventKind::kPickControl:
+        // A new control starts without a surface, the first choice is no control at all.
+        releaseSurface();
+        shown_ = event.values[0] != 0;
+        break;
+    case EventKind::kFrame:
+        return;
+    }
+    scheduleFrame();
+}
+
+void GfxHeadlessCanvas::scheduleFrame() {
+    if (shown_ && width_ > 0 && height_ > 0) {
+        clock_->requestFrame(this);
+    }
+}
+
+void GfxHeadlessCanvas::releaseSurface() {
+    tiles_.clear();
+    layout_ = GfxTileLayout();
+    surfaceDpi_ = 0;
+    damage_.clearPending();
+    damage_.invalidateAll();
+}
+
+bool GfxHeadlessCanvas::ensureSurface() {
+    int32_t width = sizeDipsToPixels(width_, dpi_);
+    int32_t height = sizeDipsToPixels(height_, dpi_);
+    if (!tiles_.empty() && surfaceDpi_ == dpi_ && layout_.width() == width && layout_.height() == height) {
+        return false;
+    }
+    // A threshold of zero keeps a single tile of the surface size.
+    int32_t tileSize = tilingThreshold_ > 0 ? tilingThreshold_ : std::max(width, height);
+    layout_ = GfxTileLayout(width, height, tileSize);
+    tiles_.resize(layout_.tileCount());
+    for (size_t i = 0; i < tiles_.size(); ++i) {
+        auto rect = layout_.tileRect(i);
+        // The surfaces are created again, what they held is gone.
+        tiles_[i].assign(static_cast<size_t>(rect.area()), 0);
+    }
+    surfaceDpi_ = dpi_;
+    surfacesCreated_++;
+    return true;
+}
+
+void GfxHeadlessCanvas::drawRect(const PixelRect& rect) {
+    layout_.forEachTileIntersecting(rect, [&](size_t index, const PixelRect& tileRect) {
+        auto clipped = rect.intersection(tileRect);
+        auto* pixels = tiles_[index].data();
+        auto stride = static_cast<size_t>(tileRect.width());
+        if (draw_) {
+            draw_(pixels, stride, tileRect, clipped);
+            return;
+        }
+        for (int32_t y = clipped.top; y < clipped.bottom; ++y) {
+            auto* row = pixels + static_cast<size_t>(y - tileRect.top) * stride;
+            std::fill(row + (clipped.left - tileRect.left), row + (clipped.right - tileRect.left), 0xffffffffu);
+        }
+    });
+}
+
+void GfxHeadlessCanvas::onFrame(std::chrono::steady_clock::time_point) {
+    if (!shown_ || width_ <= 0 || height_ <= 0) {
+        return;
+    }
+    bool newSurface = ensureSurface();
+    const PixelRect bounds{0, 0, layout_.width(), layout_.height()};
+    // The same decision as CanvasControl, from the same class.
+    if (damage_.beginFrame(bounds, newSurface)) {
+        drawRect(bounds);
+    } else {
+        for (const auto& rect : damage_.frame().rects()) {
+            drawRect(rect);
+        }
+    }
+    damage_.endFrame(true);
+}
+
+GfxHeadlessCanvas::Stats GfxHeadlessCanvas::stats() const {
+    Stats stats;
+    stats.frames = damage_.stats();
+    stats.surfacesCreated = surfacesCreated_;
+    stats.surfacesLost = surfacesLost_;
+    return stats;
+}
+
+size_t GfxHeadlessCanvas::surfaceBytes() const {
+    size_t bytes = 0;
+    for (const auto& tile : tiles_) {
+        bytes += tile.size() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+GfxHeadlessCanvasGroup::GfxHeadlessCanvasGroup(std::shared_ptr<GfxFrameClock> clock) : clock_(std::move(clock)) {
+    assert(clock_);
+}
+
+GfxHeadlessCanvas& GfxHeadlessCanvasGroup::canvas(uint64_t source) {
+    auto it = std::lower_bound(canvases_.begin(), canvases_.end(), source,
+        [](const Entry& entry, uint64_t source) { return entry.source < source; });
+    if (it == canvases_.end() || it->source != source) {
+        it = canvases_.insert(it, Entry{source, std::make_unique<GfxHeadlessCanvas>(clock_)});
+    }
+    return *it->canvas;
+}
+
+void GfxHeadlessCanvasGroup::setTilingThreshold(uint64_t source, int32_t pixels) {
+    canvas(source).setTilingThreshold(pixels);
+}
+
+void GfxHeadlessCanvasGroup::applyEvent(const GfxEventTrace::Event& event) {
+    if (event.source != 0) {
+        canvas(event.source).applyEvent(event);
+        return;
+    }
+    for (auto& entry : canvases_) {
+        entry.canvas->applyEvent(event);
+    }
+}
+
+GfxHeadlessCanvas::Stats GfxHeadlessCanvasGroup::stats() const {
+    GfxHeadlessCanvas::Stats total;
+    for (const auto& entry : canvases_) {
+        auto stats = entry.canvas->stats();
+        total.frames.fullFrames += stats.frames.fullFrames;
+        total.frames.partialFrames += stats.frames.partialFrames;
+        total.frames.redrawnPixels += stats.frames.redrawnPixels;
+        total.frames.partialFrameSurfacePixels += stats.frames.partialFrameSurfacePixels;
+        total.surfacesCreated += stats.surfacesCreated;
+        total.surfacesLost += stats.surfacesLost;
+    }
+    return total;
+}
+
+size_t GfxHeadlessCanvasGroup::surfaceCount() const {
+    size_t count = 0;
+    for (const auto& entry : canvases_) {
+        count += entry.canvas->tileCount();
+    }
+    return count;
+}
+
+size_t GfxHeadlessCanvasGroup::surfaceBytes() const {
+    size_t bytes = 0;
+    for (const auto& entry : canvases_) {
+        bytes += entry.canvas->surfaceBytes();
+    }
+    return bytes;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,124 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "./GfxEventReplayer.h"
+#include "./GfxFrameClock.h"
+#include "./GfxFrameDamage.h"
+#include "./GfxRect.h"
+#include "./GfxTileLayout.h"
+#include "./GfxUnits.h"
+
+namespace winui_drover_island {
+
+// What CanvasControl does with its surfaces, without Windows: the container size and DPI give the
+// surface size, surfaces over the tiling threshold are split in tiles, invalidated rects go to the
+// same GfxFrameDamage, and losing the device or the surface drops the pixels. Frames are
+// drawn in CPU memory by a callback. Replaying a trace against it measures how the pipeline copes
+// with a sequence of events, not what Direct2D costs. It stands for the single control a window
+// shows at a time, the events of every source apply to it.
+class GfxHeadlessCanvas : public GfxEventReplayTarget, private GfxFrameClockClient {
+ public:
+    // Draws rect, in surface pixels, into the premultiplied BGRA pixels of a tile whose origin is
+    // at tileRect.left, tileRect.top in the surface. Stride is in pixels.
+    using DrawFn = std::function<void(uint32_t* pixels, size_t stride, const PixelRect& tileRect, const PixelRect& rect)>;
+
+    struct Stats {
+        GfxFrameDamage::Stats frames;
+        uint64_t surfacesCreated = 0;
+        uint64_t surfacesLost = 0;
+    };
+
+    explicit GfxHeadlessCanvas(std::shared_ptr<GfxFrameClock> clock);
+    ~GfxHeadlessCanvas() override;
+
+    GfxHeadlessCanvas(GfxHeadlessCanvas const&) = delete;
+    GfxHeadlessCanvas& operator=(GfxHeadlessCanvas const&) = delete;
+
+    // Fills with opaque white when not set.
+    void setDrawFn(DrawFn draw) { draw_ = std::move(draw); }
+    // Like CanvasControl::setTilingThreshold(), zero means a single surface whatever the size.
+    void setTilingThreshold(int32_t pixels) { tilingThreshold_ = pixels; }
+
+    void applyEvent(const GfxEventTrace::Event& event) override;
+
+    Stats stats() const;
+    int32_t widthInPixels() const { return layout_.width(); }
+    int32_t heightInPixels() const { return layout_.height(); }
+    size_t tileCount() const { return tiles_.size(); }
+    size_t surfaceBytes() const;
+
+ private:
+    void onFrame(std::chrono::steady_clock::time_point now) override;
+    // Returns whether the surface was created.
+    bool ensureSurface();
+    void releaseSurface();
+    void scheduleFrame();
+    void drawRect(const PixelRect& rect);
+
+    std::shared_ptr<GfxFrameClock> clock_;
+    DrawFn draw_;
+    int32_t tilingThreshold_ = 0;
+
+    float width_ = 0;
+    float height_ = 0;
+    float dpi_ = kDefaultDpi;
+    // No control is picked, nothing is drawn.
+    bool shown_ = true;
+
+    GfxTileLayout layout_;
+    float surfaceDpi_ = 0;
+    std::vector<std::vector<uint32_t>> tiles_;
+    GfxFrameDamage damage_;
+    uint64_t surfacesCreated_ = 0;
+    uint64_t surfacesLost_ = 0;
+};
+
+// Replays the events of many controls at once: one GfxHeadlessCanvas per event source, created on
+// the first event of the source. The events of the window, source zero, apply to every canvas.
+class GfxHeadlessCanvasGroup : public GfxEventReplayTarget {
+ public:
+    explicit GfxHeadlessCanvasGroup(std::shared_ptr<GfxFrameClock> clock);
+
+    // Sets up the canvas of a source before its first event is applied.
+    void setTilingThreshold(uint64_t source, int32_t pixels);
+
+    void applyEvent(const GfxEventTrace::Event& event) override;
+
+    size_t canvasCount() const { return canvases_.size(); }
+    GfxHeadlessCanvas::Stats stats() const;
+    // Surfaces and tiles allocated at the moment, and their pixels.
+    size_t surfaceCount() const;
+    size_t surfaceBytes() const;
+
+ private:
+    GfxHeadlessCanvas& canvas(uint64_t source);
+
+    struct Entry {
+        uint64_t source = 0;
+        std::unique_ptr<GfxHeadlessCanvas> canvas;
+    };
+
+    std::shared_ptr<GfxFrameClock> clock_;
+    // Sorted by source.
+    std::vector<Entry> canvases_;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,120 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxImageResampler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace winui_drover_island {
+
+void GfxImageResampler::premultiply(uint8_t* pixels, int32_t width, int32_t height, size_t stride) {
+    for (int32_t y = 0; y < height; ++y) {
+        uint8_t* p = pixels + stride * y;
+        for (int32_t x = 0; x < width; ++x, p += 4) {
+            uint32_t a = p[3];
+            if (a == 255) {
+                continue;
+            }
+            // (v * a + 127) / 255, exact for all 8-bit inputs.
+            auto scale = [a](uint32_t v) {
+                uint32_t t = v * a + 128;
+                return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+            };
+            p[0] = scale(p[0]);
+            p[1] = scale(p[1]);
+            p[2] = scale(p[2]);
+        }
+    }
+}
+
+void GfxImageResampler::fitSize(int32_t width, int32_t height, int32_t maxWidth, int32_t maxHeight, int32_t& fitWidth,
+    int32_t& fitHeight) {
+    double scale = 1.0;
+    if (maxWidth > 0 && width > maxWidth) {
+        scale = std::min(scale, static_cast<double>(maxWidth) / width);
+    }
+    if (maxHeight > 0 && height > maxHeight) {
+        scale = std::min(scale, static_cast<double>(maxHeight) / height);
+    }
+    fitWidth = std::max(1, static_cast<int32_t>(std::lround(width * scale)));
+    fitHeight = std::max(1, static_cast<int32_t>(std::lround(height * scale)));
+    if (maxWidth > 0) {
+        fitWidth = std::min(fitWidth, maxWidth);
+    }
+    if (maxHeight > 0) {
+        fitHeight = std::min(fitHeight, maxHeight);
+    }
+}
+
+void GfxImageResampler::computeContributions(int32_t sourceSize, int32_t size, Contributions& contributions) {
+    contributions.first.resize(size);
+    contributions.weightsBegin.resize(static_cast<size_t>(size) + 1);
+    contributions.weights.clear();
+
+    double ratio = static_cast<double>(sourceSize) / size;
+    for (int32_t i = 0; i < size; ++i) {
+        double begin = i * ratio;
+        double end = std::min<double>((i + 1) * ratio, sourceSize);
+        auto first = static_cast<int32_t>(begin);
+        auto last = std::min(static_cast<int32_t>(std::ceil(end)), sourceSize);
+        contributions.first[i] = first;
+        contributions.weightsBegin[i] = static_cast<uint32_t>(contributions.weights.size());
+        for (int32_t s = first; s < last; ++s) {
+            double covered = std::min<double>(s + 1, end) - std::max<double>(s, begin);
+            contributions.weights.push_back(static_cast<float>(covered / ratio));
+        }
+    }
+    contributions.weightsBegin[size] = static_cast<uint32_t>(contributions.weights.size());
+}
+
+void GfxImageResampler::downscale(const uint8_t* source, int32_t sourceWidth, int32_t sourceHeight, size_t sourceStride,
+    uint8_t* destination, int32_t width, int32_t height, size_t stride) {
+    assert(width > 0 && height > 0 && width <= sourceWidth && height <= sourceHeight);
+    computeContributions(sourceWidth, width, columns_);
+    computeContributions(sourceHeight, height, rows_);
+    rowSum_.resize(static_cast<size_t>(sourceWidth) * 4);
+
+    for (int32_t y = 0; y < height; ++y) {
+        // Vertical pass: the weighted sum of the source rows covered by this destination row.
+        std::fill(rowSum_.begin(), rowSum_.end(), 0.f);
+        auto firstRow = rows_.first[y];
+        for (auto w = rows_.weightsBegin[y]; w < rows_.weightsBegin[y + 1]; ++w) {
+            float weight = rows_.weights[w];
+            const uint8_t* row = source + sourceStride * (firstRow + (w - rows_.weightsBegin[y]));
+            for (size_t i = 0; i < rowSum_.size(); ++i) {
+                rowSum_[i] += row[i] * weight;
+            }
+        }
+
+        // Horizontal pass over the summed row.
+        uint8_t* out = destination + stride * y;
+        for (int32_t x = 0; x < width; ++x) {
+            float sum[4] = {};
+            const float* column = rowSum_.data() + static_cast<size_t>(columns_.first[x]) * 4;
+            for (auto w = columns_.weightsBegin[x]; w < columns_.weightsBegin[x + 1]; ++w, column += 4) {
+                float weight = columns_.weights[w];
+                sum[0] += column[0] * weight;
+                sum[1] += column[1] * weight;
+                sum[2] += column[2] * weight;
+                sum[3] += column[3] * weight;
+            }
+            for (int c = 0; c < 4; ++c) {
+                out[x * 4 + c] = static_cast<uint8_t>(std::min(sum[c] + 0.5f, 255.f));
+            }
+        }
+    }
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace winui_drover_island {
+
+// CPU stages of the image pipeline, on BGRA pixels. They run on the decode workers, so they
+// don't depend on any graphics API.
+class GfxImageResampler {
+ public:
+    // Converts straight alpha to premultiplied alpha, in place.
+    static void premultiply(uint8_t* pixels, int32_t width, int32_t height, size_t stride);
+
+    // The largest size fitting in the bounds with the aspect ratio of the image, never larger than
+    // the image. A zero bound doesn't constrain its dimension.
+    static void fitSize(int32_t width, int32_t height, int32_t maxWidth, int32_t maxHeight, int32_t& fitWidth,
+        int32_t& fitHeight);
+
+    // Area-averaging downscale of premultiplied pixels: each destination pixel is the mean of the
+    // source area it covers, which doesn't alias however large the ratio is.
+    void downscale(const uint8_t* source, int32_t sourceWidth, int32_t sourceHeight, size_t sourceStride,
+        uint8_t* destination, int32_t width, int32_t height, size_t stride);
+
+ private:
+    struct Contributions {
+        // For each destination pixel, its first source pixel and the range of its weights.
+        std::vector<int32_t> first;
+        std::vector<uint32_t> weightsBegin;
+        std::vector<float> weights;
+    };
+
+    static void computeContributions(int32_t sourceSize, int32_t size, Contributions& contributions);
+
+    // Reused across calls, a worker resamples many images.
+    Contributions columns_;
+    Contributions rows_;
+    std::vector<float> rowSum_;
+};
+
+}  // namespace winui_drover_island
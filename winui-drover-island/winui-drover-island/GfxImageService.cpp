@@ -0,0 +1,312 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxImageService.h"
+#include "./GfxImageResampler.h"
+#include "./GfxUtils.h"
+
+#include <wincodec.h>
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+namespace winui_drover_island {
+
+namespace {
+
+struct DecodeTask {
+    GfxImageService::Key key;
+    uint32_t maximumBitmapSize = 0;
+    winrt::Microsoft::System::DispatcherQueue queue{nullptr};
+    std::weak_ptr<bool> alive;
+};
+
+winrt::com_ptr<IWICImagingFactory> imagingFactory() {
+    // The factory is free threaded, all the workers share it. It lives in the MTA, which is kept
+    // alive for it: otherwise the last worker leaving COM would tear the MTA down under it.
+    // Leaked on purpose, a static com_ptr would be released after COM is uninitialized. A failed
+    // creation isn't kept, the next decode tries again.
+    static std::mutex mutex;
+    static IWICImagingFactory* factory = nullptr;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!factory) {
+        CO_MTA_USAGE_COOKIE cookie = nullptr;
+        HRESULT hr = CoIncrementMTAUsage(&cookie);
+        if (FAILED(hr)) {
+            LogIfFailed(hr, "CoIncrementMTAUsage");
+            return nullptr;
+        }
+        hr = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+        if (FAILED(hr)) {
+            LogIfFailed(hr, "CoCreateInstance(CLSID_WICImagingFactory)");
+            factory = nullptr;
+            CoDecrementMTAUsage(cookie);
+            return nullptr;
+        }
+    }
+    winrt::com_ptr<IWICImagingFactory> result;
+    result.copy_from(factory);
+    return result;
+}
+
+}  // namespace
+
+GfxImageService& GfxImageService::instance() {
+    static GfxImageService obj;
+    return obj;
+}
+
+GfxImageService::GfxImageService()
+    : cache_(kDefaultCacheCapacityInBytes), frameClock_(GfxVsyncFrameClock::shared()), alive_(std::make_shared<bool>(true)) {}
+
+GfxImageService::~GfxImageService() {
+    // Destroyed with the statics: the shared frame clock is leaked on purpose, so it is still
+    // there to cancel the frame.
+    alive_.reset();
+    if (framePending_) {
+        frameClock_->cancelFrame(this);
+    }
+    GfxMemoryBudget::instance().remove(budgetEntry_);
+}
+
+GfxImageService::Key GfxImageService::keyFor(std::wstring path, D2D1_SIZE_F displaySizeInDips, float dpi) {
+    Key key;
+    key.path = std::move(path);
+    key.maxWidthInPixels = sizeDipsToPixels(displaySizeInDips.width, dpi);
+    key.maxHeightInPixels = sizeDipsToPixels(displaySizeInDips.height, dpi);
+    return key;
+}
+
+winrt::com_ptr<ID2D1Bitmap1> GfxImageService::bitmap(const Key& key, const std::shared_ptr<GfxD2DDevice>& device, ReadyCallback onReady) {
+    assert(device);
+    useDevice(device);
+    if (auto* bitmap = cache_.find(key)) {
+        stats_.cacheHits++;
+        return *bitmap;
+    }
+    stats_.cacheMisses++;
+
+    auto load = std::find_if(loads_.begin(), loads_.end(), [&](const auto& entry) { return entry.key == key; });
+    if (load == loads_.end()) {
+        loads_.push_back({key, {}});
+        load = loads_.end() - 1;
+        startDecode(key);
+    }
+    if (onReady) {
+        load->callbacks.push_back(std::move(onReady));
+    }
+    return nullptr;
+}
+
+void GfxImageService::useDevice(const std::shared_ptr<GfxD2DDevice>& device) {
+    if (device == device_) {
+        return;
+    }
+    // Bitmaps belong to the device that created them; the controls moved to another one, after a
+    // device loss. Decoded images waiting for upload are still good.
+    cache_.clear();
+    updateBudgetEntry();
+    device_ = device;
+}
+
+void GfxImageService::startDecode(const Key& key) {
+    if (!queue_) {
+        queue_ = winrt::Microsoft::System::DispatcherQueue::GetForCurrentThread();
+    }
+    auto task = std::make_unique<DecodeTask>();
+    task->key = key;
+    task->maximumBitmapSize = device_->maximumBitmapSizeInPixels();
+    task->queue = queue_;
+    task->alive = alive_;
+
+    auto callback = [](PTP_CALLBACK_INSTANCE, void* context) {
+        std::unique_ptr<DecodeTask> task(static_cast<DecodeTask*>(context));
+        auto decoded = std::make_shared<Decoded>();
+        decoded->key = task->key;
+        {
+            // Thread pool threads don't have COM initialized.
+            HRESULT init = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+            decode(task->key, task->maximumBitmapSize, *decoded);
+            if (SUCCEEDED(init)) {
+                CoUninitialize();
+            }
+        }
+        std::weak_ptr<bool> alive = task->alive;
+        task->queue.TryEnqueue([alive, decoded]() {
+            if (alive.lock()) {
+                GfxImageService::instance().onDecoded(decoded);
+            }
+        });
+    };
+    if (TrySubmitThreadpoolCallback(callback, task.get(), nullptr)) {
+        task.release();
+        return;
+    }
+    auto decoded = std::make_shared<Decoded>();
+    decoded->key = key;
+    decoded->result = HRESULT_FROM_WIN32(GetLastError());
+    onDecoded(decoded);
+}
+
+void GfxImageService::decode(const Key& key, uint32_t maximumBitmapSize, Decoded& decoded) {
+    decoded.result = [&]() -> HRESULT {
+        auto factory = imagingFactory();
+        if (!factory) {
+            return E_FAIL;
+        }
+        winrt::com_ptr<IWICBitmapDecoder> decoder;
+        ReturnIfFailed(factory->CreateDecoderFromFilename(key.path.c_str(), nullptr, GENERIC_READ,
+            WICDecodeMetadataCacheOnDemand, decoder.put()));
+        winrt::com_ptr<IWICBitmapFrameDecode> frame;
+        ReturnIfFailed(decoder->GetFrame(0, frame.put()));
+        // Straight alpha: premultiplying is done with the downscale, in the portable stage.
+        winrt::com_ptr<IWICFormatConverter> converter;
+        ReturnIfFailed(factory->CreateFormatConverter(converter.put()));
+        ReturnIfFailed(converter->Initialize(frame.get(), GUID_WICPixelFormat32bppBGRA, WICBitmapDitherTypeNone,
+            nullptr, 0, WICBitmapPaletteTypeMedianCut));
+
+        UINT width = 0, height = 0;
+        ReturnIfFailed(converter->GetSize(&width, &height));
+        if (width == 0 || height == 0 || width > INT32_MAX / 4 || static_cast<uint64_t>(width) * height > UINT32_MAX / 4) {
+            return WINCODEC_ERR_IMAGESIZEOUTOFRANGE;
+        }
+        auto sourceStride = static_cast<UINT>(width) * 4;
+        std::vector<uint8_t> pixels(static_cast<size_t>(sourceStride) * height);
+        ReturnIfFailed(converter->CopyPixels(nullptr, sourceStride, static_cast<UINT>(pixels.size()), pixels.data()));
+
+        auto sourceWidth = static_cast<int32_t>(width);
+        auto sourceHeight = static_cast<int32_t>(height);
+        GfxImageResampler::premultiply(pixels.data(), sourceWidth, sourceHeight, sourceStride);
+
+        // Never larger than what the device can hold in one bitmap.
+        auto maximumSize = static_cast<int32_t>(std::min<uint32_t>(maximumBitmapSize, INT32_MAX));
+        auto maxWidth = key.maxWidthInPixels > 0 ? std::min(key.maxWidthInPixels, maximumSize) : maximumSize;
+        auto maxHeight = key.maxHeightInPixels > 0 ? std::min(key.maxHeightInPixels, maximumSize) : maximumSize;
+        int32_t fitWidth = 0, fitHeight = 0;
+        GfxImageResampler::fitSize(sourceWidth, sourceHeight, maxWidth, maxHeight, fitWidth, fitHeight);
+        if (fitWidth == sourceWidth && fitHeight == sourceHeight) {
+            decoded.width = sourceWidth;
+            decoded.height = sourceHeight;
+            decoded.pixels = std::move(pixels);
+            return S_OK;
+        }
+
+        // One resampler per worker thread, so its buffers are reused across images.
+        thread_local GfxImageResampler resampler;
+        decoded.width = fitWidth;
+        decoded.height = fitHeight;
+        decoded.pixels.resize(static_cast<size_t>(fitWidth) * fitHeight * 4);
+        resampler.downscale(pixels.data(), sourceWidth, sourceHeight, sourceStride, decoded.pixels.data(), fitWidth,
+            fitHeight, static_cast<size_t>(fitWidth) * 4);
+        return S_OK;
+    }();
+}
+
+void GfxImageService::onDecoded(std::shared_ptr<Decoded> decoded) {
+    if (FAILED(decoded->result)) {
+        LogIfFailed(decoded->result, "GfxImageService::decode");
+        stats_.failedImages++;
+        completeLoad(decoded->key);
+        return;
+    }
+    stats_.decodedImages++;
+    uploads_.push_back(std::move(decoded));
+    if (!framePending_) {
+        frameClock_->requestFrame(this);
+        framePending_ = true;
+    }
+}
+
+void GfxImageService::onFrame(GfxFrameClock::Clock::time_point) {
+    framePending_ = false;
+    if (uploads_.empty() || !device_) {
+        return;
+    }
+
+    auto lease = device_->leaseResourceCreationDeviceContext();
+    const auto& context = lease.context();
+    auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), kDefaultDpi, kDefaultDpi);
+    size_t uploadedBytes = 0;
+    // At least one image per frame, however large.
+    while (!uploads_.empty() && (uploadedBytes == 0 || uploadedBytes + uploads_.front()->pixels.size() <= kUploadBytesPerFrame)) {
+        auto decoded = std::move(uploads_.front());
+        uploads_.pop_front();
+
+        winrt::com_ptr<ID2D1Bitmap1> bitmap;
+        auto size = D2D1::SizeU(static_cast<UINT32>(decoded->width), static_cast<UINT32>(decoded->height));
+        HRESULT hr = context->CreateBitmap(size, decoded->pixels.data(), static_cast<UINT32>(decoded->width) * 4,
+            properties, bitmap.put());
+        if (SUCCEEDED(hr)) {
+            cache_.insert(decoded->key, std::move(bitmap), decoded->pixels.size());
+            uploadedBytes += decoded->pixels.size();
+            stats_.uploadedImages++;
+        } else {
+            LogIfFailed(hr, "GfxImageService::upload");
+            stats_.failedImages++;
+        }
+        completeLoad(decoded->key);
+    }
+    stats_.uploadedBytes += uploadedBytes;
+    stats_.uploadFrames++;
+    updateBudgetEntry();
+
+    if (!uploads_.empty()) {
+        frameClock_->requestFrame(this);
+        framePending_ = true;
+    }
+}
+
+void GfxImageService::completeLoad(const Key& key) {
+    auto load = std::find_if(loads_.begin(), loads_.end(), [&](const auto& entry) { return entry.key == key; });
+    if (load == loads_.end()) {
+        return;
+    }
+    auto callbacks = std::move(load->callbacks);
+    loads_.erase(load);
+    // The callbacks may ask for more images.
+    for (auto& callback : callbacks) {
+        callback();
+    }
+}
+
+void GfxImageService::setCacheCapacity(size_t bytes) {
+    cache_.setCapacity(bytes);
+    updateBudgetEntry();
+}
+
+void GfxImageService::trim() {
+    cache_.clear();
+    updateBudgetEntry();
+}
+
+void GfxImageService::updateBudgetEntry() {
+    auto& budget = GfxMemoryBudget::instance();
+    auto bytes = cache_.cost();
+    if (bytes == 0) {
+        budget.remove(budgetEntry_);
+        budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+        return;
+    }
+    if (budgetEntry_ != GfxMemoryBudget::kInvalidEntry) {
+        budget.update(budgetEntry_, bytes);
+        return;
+    }
+    // Never visible: the cache is the first thing dropped when the budget is exceeded.
+    budgetEntry_ = budget.add(GfxMemorySubsystem::kCaches, bytes, []() { GfxImageService::instance().trim(); });
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./GfxCompositionFrameClock.h"
+#include "./GfxD2DDeviceManager.h"
+#include "./GfxLruCache.h"
+#include "./GfxMemoryBudget.h"
+#include "winrt/Microsoft.System.h"
+
+namespace winui_drover_island {
+
+// Loads image files into bitmaps without blocking the UI thread: files are decoded, premultiplied
+// and downscaled on thread pool workers, and the results are uploaded on the next composition
+// frames, a bounded number of bytes per frame, with one leased device context. The uploaded
+// bitmaps are kept in an LRU bounded in bytes, accounted in the memory budget.
+// The service is used on the UI thread only.
+class GfxImageService : private GfxFrameClockClient {
+ public:
+    static constexpr size_t kDefaultCacheCapacityInBytes = 64 * 1024 * 1024;
+    // Beyond this, the remaining uploads wait for the next frame.
+    static constexpr size_t kUploadBytesPerFrame = 8 * 1024 * 1024;
+
+    struct Key {
+        std::wstring path;
+        // The image is downscaled on decode to fit these, zero keeps its size. Never upscaled.
+        int32_t maxWidthInPixels = 0;
+        int32_t maxHeightInPixels = 0;
+
+        bool operator==(const Key& other) const {
+            return maxWidthInPixels == other.maxWidthInPixels && maxHeightInPixels == other.maxHeightInPixels &&
+                   path == other.path;
+        }
+    };
+
+    struct Stats {
+        uint64_t cacheHits = 0;
+        uint64_t cacheMisses = 0;
+        uint64_t decodedImages = 0;
+        uint64_t failedImages = 0;
+        uint64_t uploadedImages = 0;
+        uint64_t uploadedBytes = 0;
+        uint64_t uploadFrames = 0;
+    };
+
+    using ReadyCallback = std::function<void()>;
+
+    static GfxImageService& instance();
+
+    // Fits the image in the display size of a control, at its DPI.
+    static Key keyFor(std::wstring path, D2D1_SIZE_F displaySizeInDips, float dpi);
+
+    // Returns the bitmap once uploaded to the device. Until then it returns null and starts
+    // loading the image; onReady is called on the UI thread when the bitmap is available, or when
+    // loading it failed. Controls usually invalidate themselves from it.
+    winrt::com_ptr<ID2D1Bitmap1> bitmap(const Key& key, const std::shared_ptr<GfxD2DDevice>& device, ReadyCallback onReady = nullptr);
+
+    void setCacheCapacity(size_t bytes);
+    // Drops the uploaded bitmaps, loads in flight go on.
+    void trim();
+
+    const Stats& stats() const { return stats_; }
+
+ private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<std::wstring>()(key.path) ^ (static_cast<size_t>(key.maxWidthInPixels) << 16) ^
+                   static_cast<size_t>(key.maxHeightInPixels);
+        }
+    };
+
+    struct Decoded {
+        Key key;
+        HRESULT result = S_OK;
+        int32_t width = 0;
+        int32_t height = 0;
+        std::vector<uint8_t> pixels;
+    };
+
+    struct Load {
+        Key key;
+        std::vector<ReadyCallback> callbacks;
+    };
+
+    GfxImageService();
+    ~GfxImageService() override;
+
+    void useDevice(const std::shared_ptr<GfxD2DDevice>& device);
+    void startDecode(const Key& key);
+    static void decode(const Key& key, uint32_t maximumBitmapSize, Decoded& decoded);
+    void onDecoded(std::shared_ptr<Decoded> decoded);
+    void onFrame(GfxFrameClock::Clock::time_point now) override;
+    void completeLoad(const Key& key);
+    void updateBudgetEntry();
+
+    GfxLruCache<Key, winrt::com_ptr<ID2D1Bitmap1>, KeyHash> cache_;
+    std::vector<Load> loads_;
+    std::deque<std::shared_ptr<Decoded>> uploads_;
+    std::shared_ptr<GfxD2DDevice> device_;
+    std::shared_ptr<GfxVsyncFrameClock> frameClock_;
+    winrt::Microsoft::System::DispatcherQueue queue_{nullptr};
+    // Decodes finishing after the service is gone must not touch it.
+    std::shared_ptr<bool> alive_;
+    GfxMemoryBudget::EntryId budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+    bool framePending_ = false;
+    Stats stats_;
+};
+
+}  // namespace winui_drover_island
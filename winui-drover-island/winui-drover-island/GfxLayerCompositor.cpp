@@ -0,0 +1,402 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxLayerCompositor.h"
+#include "./GfxCompressedTileStore.h"
+#include "./GfxUtils.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace winui_drover_island {
+
+GfxLayerCompositor::GfxLayerCompositor(GfxLayerCompositorClient& client, uint64_t controlId)
+    : client_(client), controlId_(controlId) {
+    auto contentLayer = layers_.add("content", 0, Kind::kDirect);
+    assert(contentLayer == kContentLayer);
+    (void)contentLayer;
+}
+
+GfxLayerCompositor::~GfxLayerCompositor() {
+    GfxMemoryBudget::instance().remove(budgetEntry_);
+    dropParkedLayers();
+}
+
+GfxLayerCompositor::LayerId GfxLayerCompositor::addLayer(std::string name, int32_t order, Kind kind) {
+    return layers_.add(std::move(name), order, kind);
+}
+
+GfxLayerCompositor::LayerId GfxLayerCompositor::addRasterLayer(std::string name, int32_t order, std::shared_ptr<GfxTiledImage> image) {
+    // The tiles are cached by the raster layer itself, a layer bitmap would only duplicate them.
+    auto layer = addLayer(std::move(name), order, Kind::kDirect);
+    rasterLayers_.push_back({layer, std::make_unique<GfxRasterLayer>(std::move(image))});
+    return layer;
+}
+
+const GfxRasterLayer* GfxLayerCompositor::rasterLayer(LayerId layer) const {
+    auto it = std::find_if(rasterLayers_.begin(), rasterLayers_.end(), [&](const auto& entry) { return entry.layer == layer; });
+    return it != rasterLayers_.end() ? it->raster.get() : nullptr;
+}
+
+void GfxLayerCompositor::removeLayer(LayerId layer) {
+    assert(layer != kContentLayer);
+    dropParkedLayers(layer);
+    layers_.remove(layer);
+    rasterLayers_.erase(std::remove_if(rasterLayers_.begin(), rasterLayers_.end(),
+                                       [&](const auto& entry) { return entry.layer == layer; }),
+                        rasterLayers_.end());
+    removeLayerBitmap(layer);
+}
+
+void GfxLayerCompositor::setLayerKind(LayerId layer, Kind kind) {
+    assert(kind == Kind::kDirect || !rasterLayer(layer));
+    layers_.setKind(layer, kind);
+    if (kind == Kind::kDirect) {
+        dropParkedLayers(layer);
+        removeLayerBitmap(layer);
+    }
+}
+
+void GfxLayerCompositor::setLayerVisible(LayerId layer, bool visible) {
+    layers_.setVisible(layer, visible);
+}
+
+void GfxLayerCompositor::invalidateLayer(LayerId layer) {
+    dropParkedLayers(layer);
+    layers_.markDirty(layer);
+}
+
+void GfxLayerCompositor::invalidateAll() {
+    dropParkedLayers();
+    layers_.markAllDirty();
+}
+
+bool GfxLayerCompositor::contentCoversSurface(bool contentCoversUpdateRect) const {
+    if (!contentCoversUpdateRect) {
+        return false;
+    }
+    // Cached content is drawn with its bitmap, which is opaque as well when draw() covers it.
+    for (const auto& layer : layers_.layers()) {
+        if (layer.visible) {
+            return layer.id == kContentLayer;
+        }
+    }
+    return false;
+}
+
+void GfxLayerCompositor::beginFrame(const PixelRect& viewport, const PixelRect& updateBounds) {
+    if (rasterLayers_.empty()) {
+        return;
+    }
+    size_t cachedBytes = 0;
+    for (auto& entry : rasterLayers_) {
+        cachedBytes += entry.raster->cachedBytes();
+        entry.raster->beginFrame(viewport, updateBounds);
+        cachedBytes -= entry.raster->cachedBytes();
+    }
+    // Trimmed to a smaller viewport.
+    if (cachedBytes != 0) {
+        updateBudgetEntry();
+    }
+}
+
+void GfxLayerCompositor::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const Target& target, const D2D_RECT_F& updateRect) {
+    // Indexes rather than iterators: the layers are read again after each client callback.
+    for (size_t i = 0; i < layers_.size(); ++i) {
+        const auto& layer = layers_.layers()[i];
+        if (!layer.visible || layer.id == target.excludedLayer) {
+            continue;
+        }
+        auto id = layer.id;
+        if (target.useLayerCache && layer.kind == Kind::kCached) {
+            auto& entry = layerBitmap(id);
+            HRESULT hr = updateLayerBitmap(context, target, entry);
+            if (SUCCEEDED(hr)) {
+                // Same size and DPI as the surface, the bitmap maps 1:1 to the surface pixels.
+                auto size = entry.bitmap->GetSize();
+                auto destination = D2D1::RectF(0, 0, size.width, size.height);
+                context->DrawBitmap(entry.bitmap.get(), &destination, 1.f, D2D1_INTERPOLATION_MODE_NEAREST_NEIGHBOR);
+                continue;
+            }
+            LogIfFailed(hr, "updateLayerBitmap", controlId_);
+            if (isDeviceLostHResult(hr)) {
+                return;
+            }
+        }
+        drawContent(context, id, updateRect);
+        layers_.markClean(id);
+    }
+}
+
+void GfxLayerCompositor::drawDirectLayer(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerId layer, const D2D_RECT_F& updateRect) {
+    auto it = std::find_if(layers_.layers().begin(), layers_.layers().end(), [&](const auto& entry) { return entry.id == layer; });
+    if (it == layers_.layers().end() || !it->visible) {
+        return;
+    }
+    assert(it->kind == Kind::kDirect);
+    drawContent(context, layer, updateRect);
+    layers_.markClean(layer);
+}
+
+bool GfxLayerCompositor::redrawsCachedLayer(const Target& target) const {
+    if (!target.useLayerCache) {
+        return false;
+    }
+    for (const auto& layer : layers_.layers()) {
+        if (!layer.visible || layer.kind != Kind::kCached) {
+            continue;
+        }
+        auto it = std::find_if(layerBitmaps_.begin(), layerBitmaps_.end(), [&](const auto& entry) { return entry.layer == layer.id; });
+        if (layers_.isDirty(layer.id) || it == layerBitmaps_.end() || !it->bitmap) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void GfxLayerCompositor::drawContent(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerId layer, const D2D_RECT_F& updateRect) {
+    auto raster = std::find_if(rasterLayers_.begin(), rasterLayers_.end(), [&](const auto& entry) { return entry.layer == layer; });
+    if (raster == rasterLayers_.end()) {
+        client_.drawLayerContent(context, layer, updateRect);
+        return;
+    }
+    auto cachedBytes = raster->raster->cachedBytes();
+    LogIfFailed(raster->raster->draw(context, updateRect), "GfxRasterLayer::draw", controlId_);
+    if (raster->raster->cachedBytes() != cachedBytes) {
+        updateBudgetEntry();
+    }
+}
+
+GfxLayerCompositor::LayerBitmap& GfxLayerCompositor::layerBitmap(LayerId layer) {
+    auto it = std::find_if(layerBitmaps_.begin(), layerBitmaps_.end(), [&](const auto& entry) { return entry.layer == layer; });
+    if (it != layerBitmaps_.end()) {
+        return *it;
+    }
+    layerBitmaps_.push_back({layer, nullptr, 0});
+    return layerBitmaps_.back();
+}
+
+HRESULT GfxLayerCompositor::updateLayerBitmap(const winrt::com_ptr<ID2D1DeviceContext>& surfaceContext, const Target& target,
+    LayerBitmap& layerBitmap) {
+    assert(target.device);
+    auto layer = layerBitmap.layer;
+    auto& bitmap = layerBitmap.bitmap;
+    const auto dpi = target.dpi;
+    auto widthInPixels = static_cast<UINT32>(sizeDipsToPixels(target.sizeInDips.width, dpi));
+    auto heightInPixels = static_cast<UINT32>(sizeDipsToPixels(target.sizeInDips.height, dpi));
+
+    bool dirty = layers_.isDirty(layer);
+    // Invalidated rects only need drawing again in a bitmap that already has the rest.
+    bool drawDamageOnly = target.partialFrame && layer == kContentLayer;
+    if (bitmap) {
+        auto pixelSize = bitmap->GetPixelSize();
+        float dpiX = 0, dpiY = 0;
+        bitmap->GetDpi(&dpiX, &dpiY);
+        if (pixelSize.width != widthInPixels || pixelSize.height != heightInPixels || dpiX != dpi) {
+            bitmap = nullptr;
+        }
+    }
+    if (!bitmap && restoreLayerBitmap(surfaceContext, layerBitmap, D2D1::SizeU(widthInPixels, heightInPixels), dpi)) {
+        updateBudgetEntry();
+        return S_OK;
+    }
+    if (!bitmap) {
+        auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET,
+            D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpi, dpi);
+        ReturnIfFailed(surfaceContext->CreateBitmap(D2D1::SizeU(widthInPixels, heightInPixels), nullptr, 0, properties, bitmap.put()));
+        updateBudgetEntry();
+        dirty = true;
+        drawDamageOnly = false;
+    }
+    if (!dirty) {
+        return S_OK;
+    }
+
+    // The surface context is in the middle of its own BeginDraw, the layer is drawn with another one.
+    auto lease = target.device->leaseResourceCreationDeviceContext();
+    winrt::com_ptr<ID2D1DeviceContext> context;
+    context.copy_from(lease.context().get());
+
+    context->SetTarget(bitmap.get());
+    context->SetDpi(dpi, dpi);
+    context->SetTransform(D2D1::Matrix3x2F::Identity());
+    context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    context->BeginDraw();
+    bool clear = layer != kContentLayer || !target.contentCoversUpdateRect;
+    if (drawDamageOnly) {
+        for (const auto& rect : target.partialFrame->rects()) {
+            auto damageRect = D2D1::RectF(pixelsToDips(rect.left, dpi), pixelsToDips(rect.top, dpi), pixelsToDips(rect.right, dpi),
+                pixelsToDips(rect.bottom, dpi));
+            context->PushAxisAlignedClip(damageRect, D2D1_ANTIALIAS_MODE_ALIASED);
+            if (clear) {
+                context->Clear();
+            }
+            drawContent(context, layer, damageRect);
+            context->PopAxisAlignedClip();
+        }
+    } else {
+        if (clear) {
+            context->Clear();
+        }
+        drawContent(context, layer, D2D_RECT_F{0, 0, target.sizeInDips.width, target.sizeInDips.height});
+    }
+    HRESULT hr = context->EndDraw();
+    context->SetTarget(nullptr);
+    ReturnIfFailed(hr);
+
+    layers_.markClean(layer);
+    layerBitmap.version = GfxDrawStreamHashSink::nextImageVersion();
+    return S_OK;
+}
+
+void GfxLayerCompositor::releaseBitmaps(GfxD2DDevice* device, bool park) {
+    if (layerBitmaps_.empty() && rasterLayers_.empty()) {
+        return;
+    }
+    for (auto& entry : rasterLayers_) {
+        entry.raster->releaseBitmaps();
+    }
+    for (const auto& entry : layerBitmaps_) {
+        if (park && device && entry.bitmap && !layers_.isDirty(entry.layer)) {
+            LogIfFailed(parkLayerBitmap(*device, entry), "parkLayerBitmap", controlId_);
+        }
+        layers_.markDirty(entry.layer);
+    }
+    layerBitmaps_.clear();
+    updateBudgetEntry();
+}
+
+HRESULT GfxLayerCompositor::parkLayerBitmap(GfxD2DDevice& device, const LayerBitmap& layerBitmap) {
+    auto size = layerBitmap.bitmap->GetPixelSize();
+    float dpiX = 0, dpiY = 0;
+    layerBitmap.bitmap->GetDpi(&dpiX, &dpiY);
+
+    auto lease = device.leaseResourceCreationDeviceContext();
+    winrt::com_ptr<ID2D1Bitmap1> readback;
+    auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpiX, dpiY);
+    ReturnIfFailed(lease.context()->CreateBitmap(size, nullptr, 0, properties, readback.put()));
+    ReturnIfFailed(readback->CopyFromBitmap(nullptr, layerBitmap.bitmap.get(), nullptr));
+
+    D2D1_MAPPED_RECT mapped = {};
+    ReturnIfFailed(readback->Map(D2D1_MAP_OPTIONS_READ, &mapped));
+    GfxCompressedTileStore::instance().store({controlId_, layerBitmap.layer}, mapped.bits, static_cast<int32_t>(size.width),
+        static_cast<int32_t>(size.height), mapped.pitch);
+    readback->Unmap();
+
+    parkedLayers_.erase(std::remove_if(parkedLayers_.begin(), parkedLayers_.end(),
+                                       [&](const auto& parked) { return parked.layer == layerBitmap.layer; }),
+                        parkedLayers_.end());
+    parkedLayers_.push_back({layerBitmap.layer, size, dpiX});
+    return S_OK;
+}
+
+bool GfxLayerCompositor::restoreLayerBitmap(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerBitmap& layerBitmap,
+    D2D1_SIZE_U size, float dpi) {
+    auto layer = layerBitmap.layer;
+    auto it = std::find_if(parkedLayers_.begin(), parkedLayers_.end(), [&](const auto& parked) { return parked.layer == layer; });
+    if (it == parkedLayers_.end()) {
+        return false;
+    }
+    bool matches = it->size.width == size.width && it->size.height == size.height && it->dpi == dpi;
+    parkedLayers_.erase(it);
+
+    // Restoring takes the pixels out of the store, they are in the bitmap again.
+    auto& store = GfxCompressedTileStore::instance();
+    GfxCompressedTileStore::Key key{controlId_, layer};
+    std::vector<uint8_t> pixels;
+    if (!matches) {
+        store.remove(key);
+        return false;
+    }
+    if (!store.restore(key, static_cast<int32_t>(size.width), static_cast<int32_t>(size.height), pixels)) {
+        return false;
+    }
+    auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), dpi, dpi);
+    HRESULT hr = context->CreateBitmap(size, pixels.data(), size.width * 4, properties, layerBitmap.bitmap.put());
+    if (FAILED(hr)) {
+        LogIfFailed(hr, "restoreLayerBitmap", controlId_);
+        return false;
+    }
+    layers_.markClean(layer);
+    layerBitmap.version = GfxDrawStreamHashSink::nextImageVersion();
+    return true;
+}
+
+void GfxLayerCompositor::dropParkedLayers(LayerId layer) {
+    if (parkedLayers_.empty()) {
+        return;
+    }
+    auto& store = GfxCompressedTileStore::instance();
+    parkedLayers_.erase(std::remove_if(parkedLayers_.begin(), parkedLayers_.end(),
+                                       [&](const auto& parked) {
+                                           if (layer != GfxLayerStack::kInvalidLayer && parked.layer != layer) {
+                                               return false;
+                                           }
+                                           store.remove({controlId_, parked.layer});
+                                           return true;
+                                       }),
+                        parkedLayers_.end());
+}
+
+void GfxLayerCompositor::removeLayerBitmap(LayerId layer) {
+    layerBitmaps_.erase(std::remove_if(layerBitmaps_.begin(), layerBitmaps_.end(),
+                                       [&](const auto& entry) { return entry.layer == layer; }),
+                        layerBitmaps_.end());
+    updateBudgetEntry();
+}
+
+void GfxLayerCompositor::addStableImages(GfxDrawStreamHashSink& sink) const {
+    for (const auto& entry : layerBitmaps_) {
+        if (entry.bitmap) {
+            sink.addStableImage(entry.bitmap.get(), entry.version);
+        }
+    }
+}
+
+void GfxLayerCompositor::setVisible(bool visible) {
+    visible_ = visible;
+    GfxMemoryBudget::instance().setVisible(budgetEntry_, visible);
+}
+
+void GfxLayerCompositor::updateBudgetEntry() {
+    size_t bytes = 0;
+    for (const auto& entry : layerBitmaps_) {
+        if (entry.bitmap) {
+            auto size = entry.bitmap->GetPixelSize();
+            bytes += static_cast<size_t>(size.width) * size.height * 4;
+        }
+    }
+    for (const auto& entry : rasterLayers_) {
+        bytes += entry.raster->cachedBytes();
+    }
+
+    auto& budget = GfxMemoryBudget::instance();
+    if (bytes == 0) {
+        budget.remove(budgetEntry_);
+        budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+        return;
+    }
+    if (budgetEntry_ != GfxMemoryBudget::kInvalidEntry) {
+        budget.update(budgetEntry_, bytes);
+        return;
+    }
+    // The entry is removed before the compositor is destroyed.
+    budgetEntry_ = budget.add(GfxMemorySubsystem::kCaches, bytes, [this]() { client_.evictLayerBitmaps(); });
+    budget.setVisible(budgetEntry_, visible_);
+}
+
+}  // namespace winui_drover_island
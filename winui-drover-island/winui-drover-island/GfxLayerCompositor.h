@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "./GfxD2DDeviceManager.h"
+#include "./GfxDamageRegion.h"
+#include "./GfxDrawStreamHashSink.h"
+#include "./GfxLayerStack.h"
+#include "./GfxMemoryBudget.h"
+#include "./GfxRasterLayer.h"
+#include "winrt/base.h"
+
+namespace winui_drover_island {
+
+class GfxLayerCompositorClient {
+ public:
+    virtual ~GfxLayerCompositorClient() = default;
+
+    // Draws a layer other than a raster layer, into the surface or into the layer bitmap.
+    virtual void drawLayerContent(const winrt::com_ptr<ID2D1DeviceContext>& context, GfxLayerStack::LayerId layer,
+        const D2D_RECT_F& updateRect) = 0;
+    // The memory budget evicts the layer bitmaps, the client calls releaseBitmaps().
+    virtual void evictLayerBitmaps() = 0;
+};
+
+// Composites the layers of a control into its surface, bottom to top. Cached layers keep their
+// content in a bitmap of the surface size, drawn again only when dirty; raster layers keep the
+// tiles of their image; direct layers are drawn every frame. The bitmaps are accounted in the
+// memory budget, and the ones evicted while their content is still valid are parked, compressed,
+// in CPU memory: uploading them again is cheaper than drawing them again.
+// Used on the UI thread only.
+class GfxLayerCompositor {
+ public:
+    using LayerId = GfxLayerStack::LayerId;
+    using Kind = GfxLayerStack::Kind;
+    // Drawn by the client's draw(), added first.
+    static constexpr LayerId kContentLayer = GfxLayerStack::kInvalidLayer + 1;
+
+    // The surface the layers are drawn into.
+    struct Target {
+        GfxD2DDevice* device = nullptr;
+        float dpi = 0;
+        D2D1_SIZE_F sizeInDips = {};
+        // Cached layers are drawn from their bitmaps, otherwise every layer is drawn directly.
+        bool useLayerCache = false;
+        // The content layer fills its update rect, its bitmap doesn't need clearing.
+        bool contentCoversUpdateRect = false;
+        // The rects of a partial frame, a dirty content bitmap is only drawn again inside them.
+        const GfxDamageRegion* partialFrame = nullptr;
+        // Left out by draw(), for a direct layer drawn apart with drawDirectLayer().
+        LayerId excludedLayer = GfxLayerStack::kInvalidLayer;
+    };
+
+    // The id identifies the control in the log records and in the compressed tile store.
+    GfxLayerCompositor(GfxLayerCompositorClient& client, uint64_t controlId);
+    ~GfxLayerCompositor();
+
+    GfxLayerCompositor(GfxLayerCompositor const&) = delete;
+    GfxLayerCompositor& operator=(GfxLayerCompositor const&) = delete;
+
+    LayerId addLayer(std::string name, int32_t order, Kind kind);
+    LayerId addRasterLayer(std::string name, int32_t order, std::shared_ptr<GfxTiledImage> image);
+    const GfxRasterLayer* rasterLayer(LayerId layer) const;
+    void removeLayer(LayerId layer);
+    void setLayerKind(LayerId layer, Kind kind);
+    void setLayerVisible(LayerId layer, bool visible);
+    void invalidateLayer(LayerId layer);
+    void invalidateAll();
+
+    // The bottom visible layer is the content layer, which draws every pixel of the update rect.
+    bool contentCoversSurface(bool contentCoversUpdateRect) const;
+
+    // Once per frame, before its update rects are drawn; in DIPs, see GfxRasterLayer::beginFrame().
+    void beginFrame(const PixelRect& viewport, const PixelRect& updateBounds);
+    void draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const Target& target, const D2D_RECT_F& updateRect);
+    void drawDirectLayer(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerId layer, const D2D_RECT_F& updateRect);
+    // Whether draw() draws a cached layer again into its bitmap. Its version then changes, and so
+    // does the hash of the frame.
+    bool redrawsCachedLayer(const Target& target) const;
+
+    // The bitmaps belong to the device. Parking reads the clean ones back with it first.
+    void releaseBitmaps(GfxD2DDevice* device, bool park);
+
+    // The layer bitmaps only change along with their version.
+    void addStableImages(GfxDrawStreamHashSink& sink) const;
+    void setVisible(bool visible);
+
+ private:
+    struct LayerBitmap {
+        LayerId layer = GfxLayerStack::kInvalidLayer;
+        winrt::com_ptr<ID2D1Bitmap1> bitmap;
+        // Changes whenever the bitmap is drawn, identifies its content for the frame hashing.
+        uint64_t version = 0;
+    };
+    struct RasterLayer {
+        LayerId layer = GfxLayerStack::kInvalidLayer;
+        std::unique_ptr<GfxRasterLayer> raster;
+    };
+    struct ParkedLayer {
+        LayerId layer = GfxLayerStack::kInvalidLayer;
+        D2D1_SIZE_U size = {};
+        float dpi = 0;
+    };
+
+    void drawContent(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerId layer, const D2D_RECT_F& updateRect);
+    LayerBitmap& layerBitmap(LayerId layer);
+    HRESULT updateLayerBitmap(const winrt::com_ptr<ID2D1DeviceContext>& surfaceContext, const Target& target, LayerBitmap& layerBitmap);
+    HRESULT parkLayerBitmap(GfxD2DDevice& device, const LayerBitmap& layerBitmap);
+    bool restoreLayerBitmap(const winrt::com_ptr<ID2D1DeviceContext>& context, LayerBitmap& layerBitmap, D2D1_SIZE_U size, float dpi);
+    void dropParkedLayers(LayerId layer = GfxLayerStack::kInvalidLayer);
+    void removeLayerBitmap(LayerId layer);
+    void updateBudgetEntry();
+
+    GfxLayerCompositorClient& client_;
+    const uint64_t controlId_;
+    GfxLayerStack layers_;
+    std::vector<LayerBitmap> layerBitmaps_;
+    std::vector<RasterLayer> rasterLayers_;
+    std::vector<ParkedLayer> parkedLayers_;
+    GfxMemoryBudget::EntryId budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+    bool visible_ = true;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,87 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxLayerStack.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace winui_drover_island {
+
+GfxLayerStack::LayerId GfxLayerStack::add(std::string name, int32_t order, Kind kind) {
+    Layer layer;
+    auto id = nextLayerId_++;
+    layer.id = id;
+    layer.name = std::move(name);
+    layer.order = order;
+    layer.kind = kind;
+    auto it = std::upper_bound(layers_.begin(), layers_.end(), order,
+                               [](int32_t value, const Layer& other) { return value < other.order; });
+    layers_.insert(it, std::move(layer));
+    return id;
+}
+
+void GfxLayerStack::remove(LayerId id) {
+    layers_.erase(std::remove_if(layers_.begin(), layers_.end(), [&](const Layer& layer) { return layer.id == id; }),
+                  layers_.end());
+}
+
+void GfxLayerStack::setKind(LayerId id, Kind kind) {
+    if (auto* layer = findLayer(id)) {
+        if (layer->kind != kind) {
+            layer->kind = kind;
+            layer->dirty = true;
+        }
+    }
+}
+
+void GfxLayerStack::setVisible(LayerId id, bool visible) {
+    if (auto* layer = findLayer(id)) {
+        layer->visible = visible;
+    }
+}
+
+void GfxLayerStack::markDirty(LayerId id) {
+    if (auto* layer = findLayer(id)) {
+        layer->dirty = true;
+    }
+}
+
+void GfxLayerStack::markAllDirty() {
+    for (auto& layer : layers_) {
+        layer.dirty = true;
+    }
+}
+
+void GfxLayerStack::markClean(LayerId id) {
+    if (auto* layer = findLayer(id)) {
+        layer->dirty = false;
+    }
+}
+
+bool GfxLayerStack::isDirty(LayerId id) const {
+    auto* layer = findLayer(id);
+    return layer && layer->dirty;
+}
+
+GfxLayerStack::Layer* GfxLayerStack::findLayer(LayerId id) {
+    auto it = std::find_if(layers_.begin(), layers_.end(), [&](const Layer& layer) { return layer.id == id; });
+    return it != layers_.end() ? &*it : nullptr;
+}
+
+const GfxLayerStack::Layer* GfxLayerStack::findLayer(LayerId id) const {
+    auto it = std::find_if(layers_.begin(), layers_.end(), [&](const Layer& layer) { return layer.id == id; });
+    return it != layers_.end() ? &*it : nullptr;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,69 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace winui_drover_island {
+
+// Bookkeeping for the layers of a control: their order, whether their content is cached in a
+// bitmap or drawn straight into the surface every frame, and which ones need to be drawn again.
+// It has no graphics dependencies so the invalidation decisions can be tested headless.
+class GfxLayerStack {
+ public:
+    using LayerId = uint32_t;
+    static constexpr LayerId kInvalidLayer = 0;
+
+    enum class Kind {
+        // Drawn into its own bitmap when dirty, the bitmap is composited every frame.
+        kCached,
+        // Drawn into the surface every frame, for content that changes all the time.
+        kDirect,
+    };
+
+    struct Layer {
+        LayerId id = kInvalidLayer;
+        std::string name;
+        int32_t order = 0;
+        Kind kind = Kind::kDirect;
+        bool visible = true;
+        bool dirty = true;
+    };
+
+    LayerId add(std::string name, int32_t order, Kind kind);
+    void remove(LayerId id);
+
+    void setKind(LayerId id, Kind kind);
+    void setVisible(LayerId id, bool visible);
+
+    void markDirty(LayerId id);
+    void markAllDirty();
+    void markClean(LayerId id);
+    bool isDirty(LayerId id) const;
+
+    // Bottom to top; layers with the same order keep the order they were added in.
+    const std::vector<Layer>& layers() const { return layers_; }
+    size_t size() const { return layers_.size(); }
+
+ private:
+    Layer* findLayer(LayerId id);
+    const Layer* findLayer(LayerId id) const;
+
+    std::vector<Layer> layers_;
+    LayerId nextLayerId_ = kInvalidLayer + 1;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,252 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxLog.h"
+
+#include <cassert>
+#include <cinttypes>
+#include <functional>
+
+namespace winui_drover_island {
+
+namespace {
+
+std::atomic<uint64_t> sNextLogId{1};
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+int GfxLogSink::format(const GfxLogRecord& record, char* buffer, size_t size) {
+    const char* what = record.kind == GfxLogKind::kException ? "has thrown an exception" : "has failed";
+    const char* tag = record.kind == GfxLogKind::kException ? "ComException" : "ComError";
+    int length = snprintf(buffer, size, "[%s][CanvasControl] %s function %s 0x%08" PRIX32 " (control %" PRIu64 ")",
+        tag, record.site ? record.site : "?", what, static_cast<uint32_t>(record.hresult), record.controlId);
+    if (length >= 0 && static_cast<size_t>(length) < size && record.suppressed) {
+        length += snprintf(buffer + length, size - length, ", %" PRIu32 " similar messages suppressed", record.suppressed);
+    }
+    if (length >= 0 && static_cast<size_t>(length) + 1 < size) {
+        buffer[length++] = '\n';
+        buffer[length] = 0;
+    }
+    return length;
+}
+
+GfxStreamLogSink::GfxStreamLogSink(FILE* stream) : stream_(stream) {}
+
+GfxStreamLogSink::GfxStreamLogSink(const char* path) : stream_(fopen(path, "a")), ownsStream_(true) {}
+
+GfxStreamLogSink::~GfxStreamLogSink() {
+    if (ownsStream_ && stream_) {
+        fclose(stream_);
+    }
+}
+
+void GfxStreamLogSink::write(const GfxLogRecord& record) {
+    if (!stream_) {
+        return;
+    }
+    char buffer[512];
+    if (format(record, buffer, sizeof(buffer)) > 0) {
+        fputs(buffer, stream_);
+    }
+}
+
+void GfxStreamLogSink::flush() {
+    if (stream_) {
+        fflush(stream_);
+    }
+}
+
+GfxLog& GfxLog::instance() {
+    static GfxLog obj;
+    return obj;
+}
+
+GfxLog::GfxLog() : id_(sNextLogId.fetch_add(1, std::memory_order_relaxed)) {}
+
+GfxLog::~GfxLog() {
+    stop();
+}
+
+void GfxLog::start(std::unique_ptr<GfxLogSink>&& sink) {
+    stop();
+    std::lock_guard<std::mutex> guard(drainMutex_);
+    sink_ = std::move(sink);
+    stopping_ = false;
+    drainThread_ = std::thread(&GfxLog::drainLoop, this);
+}
+
+void GfxLog::stop() {
+    {
+        std::lock_guard<std::mutex> guard(drainMutex_);
+        if (!drainThread_.joinable()) {
+            return;
+        }
+        stopping_ = true;
+    }
+    drainCondition_.notify_all();
+    drainThread_.join();
+
+    std::lock_guard<std::mutex> guard(drainMutex_);
+    drainOnce();
+    if (sink_) {
+        sink_->flush();
+    }
+    sink_.reset();
+}
+
+void GfxLog::flush() {
+    std::unique_lock<std::mutex> guard(drainMutex_);
+    if (!drainThread_.joinable()) {
+        return;
+    }
+    // Wait for two complete drain passes, the first one may have started before our records.
+    auto target = drainGeneration_ + 2;
+    drainCondition_.notify_all();
+    drainCondition_.wait(guard, [&] { return drainGeneration_ >= target || stopping_; });
+}
+
+GfxLog::Ring& GfxLog::threadRing() {
+    // Rings are owned by the logger and freed with it, a thread registers its ring once per
+    // logger. The last few loggers used by the thread are remembered, keyed by the logger id
+    // rather than its address, which a new logger may reuse.
+    struct CachedRing {
+        uint64_t owner = 0;
+        Ring* ring = nullptr;
+    };
+    thread_local std::array<CachedRing, 4> cache;
+    thread_local size_t nextCacheSlot = 0;
+    for (const auto& cached : cache) {
+        if (cached.owner == id_) {
+            return *cached.ring;
+        }
+    }
+
+    // Evicted from the cache, or the first record of the thread: the ring may already exist.
+    auto thread = std::this_thread::get_id();
+    Ring* ring = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(ringsMutex_);
+        for (auto& existing : rings_) {
+            if (existing->owner == thread) {
+                ring = existing.get();
+                break;
+            }
+        }
+        if (!ring) {
+            rings_.push_back(std::make_unique<Ring>());
+            ring = rings_.back().get();
+            ring->owner = thread;
+        }
+    }
+    cache[nextCacheSlot] = {id_, ring};
+    nextCacheSlot = (nextCacheSlot + 1) % cache.size();
+    return *ring;
+}
+
+bool GfxLog::admit(const char* site, int64_t timestampNs, uint32_t& suppressed) {
+    auto& limit = siteLimits_[std::hash<const void*>{}(site) % kRateLimitSlots];
+    auto window = timestampNs / std::chrono::duration_cast<std::chrono::nanoseconds>(kRateLimitWindow).count();
+    // Races between threads only make the limit approximate, which is fine.
+    if (limit.window.load(std::memory_order_relaxed) != window) {
+        limit.window.store(window, std::memory_order_relaxed);
+        limit.count.store(0, std::memory_order_relaxed);
+    }
+    if (limit.count.fetch_add(1, std::memory_order_relaxed) < kMaxRecordsPerSitePerWindow) {
+        suppressed = limit.suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void GfxLog::log(GfxLogKind kind, const char* site, int32_t hresult, uint64_t controlId) {
+    logged_.fetch_add(1, std::memory_order_relaxed);
+    auto timestamp = nowNs();
+    uint32_t suppressed = 0;
+    if (!admit(site, timestamp, suppressed)) {
+        droppedRateLimited_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    auto& ring = threadRing();
+    auto head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= kRingCapacity) {
+        droppedRingFull_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    auto& record = ring.records[head % kRingCapacity];
+    record.timestampNs = timestamp;
+    record.site = site;
+    record.controlId = controlId;
+    record.hresult = hresult;
+    record.suppressed = suppressed;
+    record.kind = kind;
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+size_t GfxLog::drainOnce() {
+    // Records are moved out under the lock and written after it is released: a slow sink must
+    // not hold up the threads registering their ring.
+    drained_.clear();
+    {
+        std::lock_guard<std::mutex> guard(ringsMutex_);
+        for (auto& ring : rings_) {
+            auto tail = ring->tail.load(std::memory_order_relaxed);
+            auto head = ring->head.load(std::memory_order_acquire);
+            for (; tail != head; ++tail) {
+                drained_.push_back(ring->records[tail % kRingCapacity]);
+            }
+            ring->tail.store(tail, std::memory_order_release);
+        }
+    }
+    if (sink_) {
+        for (const auto& record : drained_) {
+            sink_->write(record);
+        }
+    }
+    written_.fetch_add(drained_.size(), std::memory_order_relaxed);
+    return drained_.size();
+}
+
+void GfxLog::drainLoop() {
+    std::unique_lock<std::mutex> guard(drainMutex_);
+    while (!stopping_) {
+        if (drainOnce() && sink_) {
+            sink_->flush();
+        }
+        drainGeneration_++;
+        drainCondition_.notify_all();
+        drainCondition_.wait_for(guard, kDrainInterval);
+    }
+}
+
+GfxLog::Stats GfxLog::stats() const {
+    Stats result;
+    result.logged = logged_.load(std::memory_order_relaxed);
+    result.written = written_.load(std::memory_order_relaxed);
+    result.droppedRingFull = droppedRingFull_.load(std::memory_order_relaxed);
+    result.droppedRateLimited = droppedRateLimited_.load(std::memory_order_relaxed);
+    return result;
+}
+
+size_t GfxLog::ringCount() const {
+    std::lock_guard<std::mutex> guard(ringsMutex_);
+    return rings_.size();
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,151 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace winui_drover_island {
+
+enum class GfxLogKind : uint8_t {
+    kFailed,
+    kException,
+};
+
+struct GfxLogRecord {
+    int64_t timestampNs = 0;
+    // Must point to a string literal, records are formatted later on the drain thread.
+    const char* site = nullptr;
+    uint64_t controlId = 0;
+    int32_t hresult = 0;
+    // Number of records of the same site dropped by the rate limiter since the previous one.
+    uint32_t suppressed = 0;
+    GfxLogKind kind = GfxLogKind::kFailed;
+};
+
+class GfxLogSink {
+ public:
+    virtual ~GfxLogSink() = default;
+    virtual void write(const GfxLogRecord& record) = 0;
+    virtual void flush() {}
+
+    // Formats a record the same way for every sink. Returns the number of characters written.
+    static int format(const GfxLogRecord& record, char* buffer, size_t size);
+};
+
+// Writes records to a stdio stream: stderr, or a file opened by the sink.
+class GfxStreamLogSink : public GfxLogSink {
+ public:
+    explicit GfxStreamLogSink(FILE* stream);
+    explicit GfxStreamLogSink(const char* path);
+    ~GfxStreamLogSink() override;
+
+    void write(const GfxLogRecord& record) override;
+    void flush() override;
+
+ private:
+    FILE* stream_ = nullptr;
+    bool ownsStream_ = false;
+};
+
+// Structured logger for the render paths. Logging a record is lock-free: each thread appends to
+// its own ring buffer, and a background thread drains the buffers into the sink. Records are rate
+// limited per site, so an error storm (e.g. during device loss) can't flood the sink or stall the
+// caller. When a ring is full, records are dropped rather than blocking.
+class GfxLog {
+ public:
+    static constexpr size_t kRingCapacity = 256;
+    static constexpr size_t kRateLimitSlots = 256;
+    static constexpr uint32_t kMaxRecordsPerSitePerWindow = 8;
+    static constexpr std::chrono::milliseconds kRateLimitWindow{1000};
+    static constexpr std::chrono::milliseconds kDrainInterval{20};
+
+    struct Stats {
+        uint64_t logged = 0;
+        uint64_t written = 0;
+        uint64_t droppedRingFull = 0;
+        uint64_t droppedRateLimited = 0;
+    };
+
+    static GfxLog& instance();
+
+    GfxLog();
+    ~GfxLog();
+
+    GfxLog(GfxLog const&) = delete;
+    GfxLog& operator=(GfxLog const&) = delete;
+
+    // Starts the drain thread. Records logged before start() wait in the ring buffers.
+    void start(std::unique_ptr<GfxLogSink>&& sink);
+    // Drains what is left and stops the drain thread.
+    void stop();
+    // Blocks until everything logged so far by this thread has been written.
+    void flush();
+
+    void log(GfxLogKind kind, const char* site, int32_t hresult, uint64_t controlId = 0);
+
+    Stats stats() const;
+    // One per thread that logged, however many loggers the thread alternates between.
+    size_t ringCount() const;
+
+ private:
+    struct Ring {
+        std::array<GfxLogRecord, kRingCapacity> records;
+        // The only thread appending to the ring. A thread started later may get the id of a
+        // finished one, and its ring with it.
+        std::thread::id owner;
+        std::atomic<uint64_t> head{0};
+        std::atomic<uint64_t> tail{0};
+    };
+
+    struct SiteLimit {
+        std::atomic<int64_t> window{-1};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint32_t> suppressed{0};
+    };
+
+    Ring& threadRing();
+    bool admit(const char* site, int64_t timestampNs, uint32_t& suppressed);
+    size_t drainOnce();
+    void drainLoop();
+
+    const uint64_t id_;
+    mutable std::mutex ringsMutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::array<SiteLimit, kRateLimitSlots> siteLimits_;
+
+    std::mutex drainMutex_;
+    std::condition_variable drainCondition_;
+    std::unique_ptr<GfxLogSink> sink_;
+    // Records taken from the rings by drainOnce(), kept to reuse its capacity.
+    std::vector<GfxLogRecord> drained_;
+    std::thread drainThread_;
+    bool stopping_ = false;
+    uint64_t drainGeneration_ = 0;
+
+    std::atomic<uint64_t> logged_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> droppedRingFull_{0};
+    std::atomic<uint64_t> droppedRateLimited_{0};
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,148 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace winui_drover_island {
+
+// Map bounded by the total cost of its values: adding past the capacity evicts the least recently
+// used entries first. Not thread safe.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class GfxLruCache {
+ public:
+    explicit GfxLruCache(size_t capacity = SIZE_MAX) : capacity_(capacity) {}
+
+    GfxLruCache(GfxLruCache const&) = delete;
+    GfxLruCache& operator=(GfxLruCache const&) = delete;
+
+    // Makes the entry the most recently used one. The pointer is valid until the cache changes.
+    Value* find(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return nullptr;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return &it->second->value;
+    }
+
+    bool contains(const Key& key) const { return index_.find(key) != index_.end(); }
+
+    // Replaces any previous value of the key. A value costing more than the capacity isn't kept.
+    void insert(const Key& key, Value value, size_t cost) {
+        erase(key);
+        if (cost > capacity_) {
+            return;
+        }
+        entries_.push_front(Entry{key, std::move(value), cost});
+        index_.emplace(key, entries_.begin());
+        cost_ += cost;
+        trim(capacity_);
+    }
+
+    bool erase(const Key& key) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        cost_ -= it->second->cost;
+        entries_.erase(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    // Moves the value out of the cache.
+    bool take(const Key& key, Value& value) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        value = std::move(it->second->value);
+        return erase(key);
+    }
+
+    template <typename Predicate>
+    size_t eraseIf(Predicate&& predicate) {
+        size_t erased = 0;
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if (predicate(it->key, it->value)) {
+                cost_ -= it->cost;
+                index_.erase(it->key);
+                it = entries_.erase(it);
+                erased++;
+            } else {
+                ++it;
+            }
+        }
+        return erased;
+    }
+
+    // For values whose cost changes while cached: cost(key, value) is asked again for every entry,
+    // then the least recently used ones are evicted past the capacity. The order is kept.
+    template <typename CostFn>
+    void updateCosts(CostFn&& cost) {
+        cost_ = 0;
+        for (auto& entry : entries_) {
+            entry.cost = cost(entry.key, entry.value);
+            cost_ += entry.cost;
+        }
+        trim(capacity_);
+    }
+
+    void clear() {
+        entries_.clear();
+        index_.clear();
+        cost_ = 0;
+    }
+
+    void setCapacity(size_t capacity) {
+        capacity_ = capacity;
+        trim(capacity_);
+    }
+
+    size_t capacity() const { return capacity_; }
+    size_t cost() const { return cost_; }
+    size_t size() const { return index_.size(); }
+    size_t evictionCount() const { return evictionCount_; }
+
+ private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t cost = 0;
+    };
+
+    void trim(size_t capacity) {
+        while (cost_ > capacity && !entries_.empty()) {
+            auto& last = entries_.back();
+            cost_ -= last.cost;
+            index_.erase(last.key);
+            entries_.pop_back();
+            evictionCount_++;
+        }
+    }
+
+    std::list<Entry> entries_;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    size_t capacity_ = SIZE_MAX;
+    size_t cost_ = 0;
+    size_t evictionCount_ = 0;
+};
+
+}  // namespace winui_drover_island
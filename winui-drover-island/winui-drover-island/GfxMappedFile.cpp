@@ -0,0 +1,180 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxMappedFile.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace winui_drover_island {
+
+namespace {
+
+// The ranges are widened to whole pages, the OS only works with those.
+bool pageRange(const uint8_t* data, size_t fileSize, size_t offset, size_t size, uintptr_t& begin, size_t& length) {
+    if (!data || offset >= fileSize || size == 0) {
+        return false;
+    }
+    size = std::min(size, fileSize - offset);
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    size_t pageSize = info.dwPageSize;
+#else
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    begin = reinterpret_cast<uintptr_t>(data + offset) & ~(pageSize - 1);
+    auto end = reinterpret_cast<uintptr_t>(data + offset + size);
+    length = end - begin;
+    return true;
+}
+
+}  // namespace
+
+GfxMappedFile::~GfxMappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool GfxMappedFile::open(const std::filesystem::path& path) {
+    close();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize = {};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0 ||
+        static_cast<uint64_t>(fileSize.QuadPart) > static_cast<uint64_t>(SIZE_MAX)) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    auto* data = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    file_ = file;
+    mapping_ = mapping;
+    data_ = data;
+    size_ = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void GfxMappedFile::close() {
+    if (data_) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    if (file_) {
+        CloseHandle(file_);
+        file_ = nullptr;
+    }
+    size_ = 0;
+}
+
+void GfxMappedFile::prefetch(size_t offset, size_t size) const {
+    uintptr_t begin = 0;
+    size_t length = 0;
+    if (pageRange(data_, size_, offset, size, begin, length)) {
+        WIN32_MEMORY_RANGE_ENTRY range{reinterpret_cast<void*>(begin), length};
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+}
+
+void GfxMappedFile::discard(size_t offset, size_t size) const {
+    uintptr_t begin = 0;
+    size_t length = 0;
+    if (pageRange(data_, size_, offset, size, begin, length)) {
+        // Unlocking pages that aren't locked removes them from the working set.
+        VirtualUnlock(reinterpret_cast<void*>(begin), length);
+    }
+}
+
+#else
+
+bool GfxMappedFile::open(const std::filesystem::path& path) {
+    close();
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat info = {};
+    if (fstat(file, &info) != 0 || info.st_size <= 0) {
+        ::close(file);
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (data == MAP_FAILED) {
+        ::close(file);
+        return false;
+    }
+    madvise(data, static_cast<size_t>(info.st_size), MADV_RANDOM);
+    file_ = file;
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+void GfxMappedFile::close() {
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+        data_ = nullptr;
+    }
+    if (file_ >= 0) {
+        ::close(file_);
+        file_ = -1;
+    }
+    size_ = 0;
+}
+
+void GfxMappedFile::prefetch(size_t offset, size_t size) const {
+    uintptr_t begin = 0;
+    size_t length = 0;
+    if (pageRange(data_, size_, offset, size, begin, length)) {
+        madvise(reinterpret_cast<void*>(begin), length, MADV_WILLNEED);
+    }
+}
+
+void GfxMappedFile::discard(size_t offset, size_t size) const {
+    uintptr_t begin = 0;
+    size_t length = 0;
+    if (pageRange(data_, size_, offset, size, begin, length)) {
+        madvise(reinterpret_cast<void*>(begin), length, MADV_DONTNEED);
+    }
+}
+
+#endif
+
+}  // namespace winui_drover_island
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace winui_drover_island {
+
+// Read-only view of a whole file. Pages are loaded by the OS when touched and can be dropped
+// again under memory pressure, so files much larger than the RAM can be read this way.
+class GfxMappedFile {
+ public:
+    GfxMappedFile() = default;
+    ~GfxMappedFile();
+
+    GfxMappedFile(GfxMappedFile const&) = delete;
+    GfxMappedFile& operator=(GfxMappedFile const&) = delete;
+
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    // Hints that the range is about to be read, the OS starts loading it in the background.
+    void prefetch(size_t offset, size_t size) const;
+    // Hints that the range won't be read for a while, its pages are the first to be dropped.
+    void discard(size_t offset, size_t size) const;
+
+ private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int file_ = -1;
+#endif
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxMemoryBudget.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace winui_drover_island {
+
+GfxMemoryBudget& GfxMemoryBudget::instance() {
+    static GfxMemoryBudget obj;
+    return obj;
+}
+
+void GfxMemoryBudget::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    budgetInBytes_ = bytes;
+}
+
+size_t GfxMemoryBudget::budget() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return budgetInBytes_;
+}
+
+GfxMemoryBudget::EntryId GfxMemoryBudget::add(GfxMemorySubsystem subsystem, size_t bytes, EvictCallback onEvict) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    EntryId id = nextEntryId_++;
+    Entry entry;
+    entry.subsystem = subsystem;
+    entry.bytes = bytes;
+    entry.lastVisible = ++clock_;
+    entry.onEvict = std::move(onEvict);
+    entries_.emplace(id, std::move(entry));
+
+    auto index = static_cast<size_t>(subsystem);
+    counters_.bytes[index] += bytes;
+    counters_.entries[index]++;
+    counters_.totalBytes += bytes;
+    return id;
+}
+
+void GfxMemoryBudget::update(EntryId entry, size_t bytes) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(entry);
+    if (it == entries_.end()) {
+        return;
+    }
+    auto index = static_cast<size_t>(it->second.subsystem);
+    counters_.bytes[index] = counters_.bytes[index] - it->second.bytes + bytes;
+    counters_.totalBytes = counters_.totalBytes - it->second.bytes + bytes;
+    it->second.bytes = bytes;
+}
+
+void GfxMemoryBudget::remove(EntryId entry) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(entry);
+    if (it == entries_.end()) {
+        return;
+    }
+    auto index = static_cast<size_t>(it->second.subsystem);
+    counters_.bytes[index] -= it->second.bytes;
+    counters_.entries[index]--;
+    counters_.totalBytes -= it->second.bytes;
+    entries_.erase(it);
+}
+
+void GfxMemoryBudget::setVisible(EntryId entry, bool visible) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(entry);
+    if (it == entries_.end()) {
+        return;
+    }
+    if (visible || it->second.visible) {
+        it->second.lastVisible = ++clock_;
+    }
+    it->second.visible = visible;
+}
+
+void GfxMemoryBudget::touch(EntryId entry) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto it = entries_.find(entry);
+    if (it != entries_.end()) {
+        it->second.lastVisible = ++clock_;
+    }
+}
+
+size_t GfxMemoryBudget::enforce() {
+    size_t target = 0;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (counters_.totalBytes <= budgetInBytes_) {
+            return 0;
+        }
+        target = counters_.totalBytes - budgetInBytes_;
+    }
+    return evict(target);
+}
+
+size_t GfxMemoryBudget::trim() {
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        counters_.trimCount++;
+    }
+    return evict(SIZE_MAX);
+}
+
+size_t GfxMemoryBudget::evict(size_t targetBytes) {
+    std::vector<std::pair<uint64_t, EvictCallback>> victims;
+    size_t evictedBytes = 0;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        std::vector<std::pair<uint64_t, EntryId>> candidates;
+        for (const auto& entry : entries_) {
+            if (!entry.second.visible && entry.second.onEvict) {
+                candidates.emplace_back(entry.second.lastVisible, entry.first);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const auto& candidate : candidates) {
+            if (evictedBytes >= targetBytes) {
+                break;
+            }
+            auto& entry = entries_[candidate.second];
+            evictedBytes += entry.bytes;
+            victims.emplace_back(entry.bytes, entry.onEvict);
+            // The owner is not allowed to be evicted twice while the callback is pending.
+            entry.onEvict = nullptr;
+        }
+        counters_.evictionCount += victims.size();
+        counters_.evictedBytes += evictedBytes;
+    }
+
+    for (auto& victim : victims) {
+        victim.second();
+    }
+    return evictedBytes;
+}
+
+GfxMemoryBudget::Counters GfxMemoryBudget::counters() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto result = counters_;
+    result.budgetInBytes = budgetInBytes_;
+    return result;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,103 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+namespace winui_drover_island {
+
+enum class GfxMemorySubsystem {
+    kSurfaces = 0,
+    kAtlases,
+    kContextPool,
+    kCaches,
+    kCount,
+};
+
+// Process-wide accounting of graphics memory. Subsystems report the bytes they hold; entries that
+// can be dropped and re-created later provide an eviction callback. When the total goes over
+// budget, the least recently visible evictable entries are evicted first.
+// Eviction callbacks are invoked without holding the internal lock, on the thread calling
+// enforce() or trim(), and are expected to call remove() for their entry.
+class GfxMemoryBudget {
+ public:
+    using EntryId = uint64_t;
+    using EvictCallback = std::function<void()>;
+
+    static constexpr EntryId kInvalidEntry = 0;
+    static constexpr size_t kDefaultBudgetInBytes = 256 * 1024 * 1024;
+    static constexpr size_t kSubsystemCount = static_cast<size_t>(GfxMemorySubsystem::kCount);
+
+    struct Counters {
+        std::array<size_t, kSubsystemCount> bytes{};
+        std::array<size_t, kSubsystemCount> entries{};
+        size_t totalBytes = 0;
+        size_t budgetInBytes = 0;
+        uint64_t evictionCount = 0;
+        uint64_t evictedBytes = 0;
+        uint64_t trimCount = 0;
+    };
+
+    static GfxMemoryBudget& instance();
+
+    GfxMemoryBudget() = default;
+    GfxMemoryBudget(GfxMemoryBudget const&) = delete;
+    GfxMemoryBudget& operator=(GfxMemoryBudget const&) = delete;
+
+    void setBudget(size_t bytes);
+    size_t budget() const;
+
+    // Entries without an eviction callback are only accounted for, never evicted.
+    EntryId add(GfxMemorySubsystem subsystem, size_t bytes, EvictCallback onEvict = nullptr);
+    void update(EntryId entry, size_t bytes);
+    void remove(EntryId entry);
+
+    // Visible entries are never evicted. Marking an entry visible also refreshes its recency.
+    void setVisible(EntryId entry, bool visible);
+    void touch(EntryId entry);
+
+    // Evicts the least recently visible entries until the total fits in the budget.
+    // Returns the number of bytes evicted.
+    size_t enforce();
+
+    // Evicts every evictable entry that is not visible, regardless of the budget.
+    size_t trim();
+
+    Counters counters() const;
+
+ private:
+    struct Entry {
+        GfxMemorySubsystem subsystem = GfxMemorySubsystem::kSurfaces;
+        size_t bytes = 0;
+        uint64_t lastVisible = 0;
+        bool visible = true;
+        EvictCallback onEvict;
+    };
+
+    size_t evict(size_t targetBytes);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<EntryId, Entry> entries_;
+    Counters counters_;
+    size_t budgetInBytes_ = kDefaultBudgetInBytes;
+    EntryId nextEntryId_ = kInvalidEntry + 1;
+    uint64_t clock_ = 0;
+};
+
+}  // namespace winui_drover_island
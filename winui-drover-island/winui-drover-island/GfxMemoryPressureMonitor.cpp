@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxMemoryPressureMonitor.h"
+#include "./GfxUtils.h"
+
+namespace winrt {
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Microsoft::System;
+}  // namespace winrt
+
+namespace winui_drover_island {
+
+GfxMemoryPressureMonitor::~GfxMemoryPressureMonitor() {
+    stop();
+}
+
+void GfxMemoryPressureMonitor::start(const winrt::DispatcherQueue& queue, Callback&& callback) {
+    assert(!notification_);
+    notification_ = CreateMemoryResourceNotification(LowMemoryResourceNotification);
+    if (!notification_) {
+        Logger::warn("CreateMemoryResourceNotification has failed");
+        return;
+    }
+    queue_ = queue;
+    callback_ = std::move(callback);
+    alive_ = std::make_shared<bool>(true);
+
+    rearmTimer_ = queue_.CreateTimer();
+    rearmTimer_.Interval(kRearmInterval);
+    rearmTimer_.IsRepeating(false);
+    rearmTimer_.Tick([this](const winrt::DispatcherQueueTimer&, const winrt::IInspectable&) { arm(); });
+
+    arm();
+}
+
+void GfxMemoryPressureMonitor::stop() {
+    if (!notification_) {
+        return;
+    }
+    // A callback in flight reads alive_, it has to return before the token goes away.
+    disarm();
+    alive_.reset();
+    rearmTimer_.Stop();
+    rearmTimer_ = nullptr;
+    CloseHandle(notification_);
+    notification_ = nullptr;
+    callback_ = nullptr;
+    queue_ = nullptr;
+}
+
+void GfxMemoryPressureMonitor::arm() {
+    assert(!waitHandle_);
+    // The notification stays signaled as long as memory is low, so we only wait once and
+    // re-arm after a delay instead of being called back in a loop.
+    if (!RegisterWaitForSingleObject(&waitHandle_, notification_, &GfxMemoryPressureMonitor::onLowMemory, this,
+            INFINITE, WT_EXECUTEONLYONCE)) {
+        waitHandle_ = nullptr;
+        Logger::warn("RegisterWaitForSingleObject has failed");
+    }
+}
+
+void GfxMemoryPressureMonitor::disarm() {
+    if (waitHandle_) {
+        // Blocks until a callback in flight has returned, so it can't outlive the monitor.
+        UnregisterWaitEx(waitHandle_, INVALID_HANDLE_VALUE);
+        waitHandle_ = nullptr;
+    }
+}
+
+void CALLBACK GfxMemoryPressureMonitor::onLowMemory(PVOID context, BOOLEAN) {
+    auto self = static_cast<GfxMemoryPressureMonitor*>(context);
+    std::weak_ptr<bool> alive = self->alive_;
+    self->queue_.TryEnqueue([self, alive]() {
+        if (alive.lock()) {
+            self->handleLowMemory();
+        }
+    });
+}
+
+void GfxMemoryPressureMonitor::handleLowMemory() {
+    disarm();
+    if (callback_) {
+        callback_();
+    }
+    rearmTimer_.Start();
+}
+
+}  // namespace winui_drover_island
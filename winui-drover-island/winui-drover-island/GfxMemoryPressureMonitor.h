@@ -0,0 +1,58 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <Windows.h>
+
+#include <functional>
+#include <memory>
+
+#include "winrt/Microsoft.System.h"
+
+namespace winui_drover_island {
+
+// Watches the system low memory notification and invokes a callback on the given dispatcher queue.
+// While memory stays low, the callback is invoked at most once per kRearmInterval.
+class GfxMemoryPressureMonitor {
+ public:
+    using Callback = std::function<void()>;
+
+    static constexpr winrt::Windows::Foundation::TimeSpan kRearmInterval = std::chrono::seconds(10);
+
+    GfxMemoryPressureMonitor() = default;
+    ~GfxMemoryPressureMonitor();
+
+    GfxMemoryPressureMonitor(GfxMemoryPressureMonitor const&) = delete;
+    GfxMemoryPressureMonitor& operator=(GfxMemoryPressureMonitor const&) = delete;
+
+    void start(const winrt::Microsoft::System::DispatcherQueue& queue, Callback&& callback);
+    void stop();
+
+ private:
+    static void CALLBACK onLowMemory(PVOID context, BOOLEAN timedOut);
+
+    void arm();
+    void disarm();
+    void handleLowMemory();
+
+    HANDLE notification_ = nullptr;
+    HANDLE waitHandle_ = nullptr;
+    winrt::Microsoft::System::DispatcherQueue queue_{nullptr};
+    winrt::Microsoft::System::DispatcherQueueTimer rearmTimer_{nullptr};
+    Callback callback_;
+    // Work posted to the queue from the thread pool checks this token before touching the monitor.
+    std::shared_ptr<bool> alive_;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace winui_drover_island {
+
+// The hashes of immutable objects, like closed path geometries and font faces, whose properties
+// are costly to read again on every frame. Keyed by address: the cache holds a reference to each
+// object, so another object can't be created at that address while the hash is cached. Once
+// full, the oldest entry is replaced. Reference is a smart pointer with get(), like com_ptr.
+// Doesn't allocate once full.
+template <typename Reference>
+class GfxObjectHashCache {
+ public:
+    explicit GfxObjectHashCache(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    GfxObjectHashCache(GfxObjectHashCache const&) = delete;
+    GfxObjectHashCache& operator=(GfxObjectHashCache const&) = delete;
+
+    // Zero when the object isn't in the cache, hashes are never zero.
+    uint64_t find(const void* object) {
+        if (lastHit_ < entries_.size() && entries_[lastHit_].reference.get() == object) {
+            return entries_[lastHit_].hash;
+        }
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].reference.get() == object) {
+                lastHit_ = i;
+                return entries_[i].hash;
+            }
+        }
+        return 0;
+    }
+
+    void insert(Reference reference, uint64_t hash) {
+        if (entries_.size() < capacity_) {
+            entries_.reserve(capacity_);
+            entries_.push_back({std::move(reference), hash});
+            return;
+        }
+        entries_[next_] = {std::move(reference), hash};
+        next_ = (next_ + 1) % capacity_;
+    }
+
+    // Releases the references.
+    void clear() {
+        entries_.clear();
+        next_ = 0;
+        lastHit_ = 0;
+    }
+
+    size_t size() const { return entries_.size(); }
+    size_t capacity() const { return capacity_; }
+
+ private:
+    struct Entry {
+        Reference reference;
+        uint64_t hash = 0;
+    };
+
+    const size_t capacity_;
+    std::vector<Entry> entries_;
+    // The entry replaced next once full.
+    size_t next_ = 0;
+    // Frames draw the same object many times in a row.
+    size_t lastHit_ = 0;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,144 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace winui_drover_island {
+
+// Idle objects kept for reuse, shared between threads. The lock only covers moving an object in
+// or out of the idle list: objects are created by the caller when take() finds none, outside of
+// the lock, so a slow creation doesn't hold up the other threads. Returning an object past the
+// maximum idle count, or once the pool is closed, drops it.
+template <typename T>
+class GfxObjectPool {
+ public:
+    struct Stats {
+        size_t idle = 0;
+        // Taken and not given back yet.
+        size_t outstanding = 0;
+        uint64_t takes = 0;
+        // Takes served by an idle object.
+        uint64_t hits = 0;
+        uint64_t drops = 0;
+        // Takes and gives that found the lock held by another thread.
+        uint64_t contended = 0;
+    };
+
+    explicit GfxObjectPool(size_t maxIdle) : maxIdle_(maxIdle) { idle_.reserve(maxIdle); }
+
+    GfxObjectPool(GfxObjectPool const&) = delete;
+    GfxObjectPool& operator=(GfxObjectPool const&) = delete;
+
+    // Moves an idle object to object; false when there is none, the caller then creates one.
+    // Either way the object is outstanding until given back.
+    bool take(T& object) {
+        auto guard = lock();
+        takes_++;
+        outstanding_++;
+        if (idle_.empty()) {
+            return false;
+        }
+        object = std::move(idle_.back());
+        idle_.pop_back();
+        hits_++;
+        return true;
+    }
+
+    // For a take that found no idle object and then failed to create one.
+    void cancelTake() {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (outstanding_ > 0) {
+            outstanding_--;
+        }
+    }
+
+    // Returns false when the object was dropped rather than kept.
+    bool give(T&& object) {
+        T dropped;
+        {
+            auto guard = lock();
+            if (outstanding_ > 0) {
+                outstanding_--;
+            }
+            if (!closed_ && idle_.size() < maxIdle_) {
+                idle_.push_back(std::move(object));
+                return true;
+            }
+            drops_++;
+            // Destroyed once the lock is released.
+            dropped = std::move(object);
+        }
+        return false;
+    }
+
+    // Drops the idle objects, the pool stays usable.
+    void clear() {
+        std::vector<T> idle;
+        std::lock_guard<std::mutex> guard(mutex_);
+        idle.swap(idle_);
+        idle_.reserve(maxIdle_);
+    }
+
+    // Drops the idle objects and the ones given back from now on.
+    void close() {
+        std::vector<T> idle;
+        std::lock_guard<std::mutex> guard(mutex_);
+        closed_ = true;
+        idle.swap(idle_);
+    }
+
+    size_t idleCount() const {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return idle_.size();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> guard(mutex_);
+        Stats stats;
+        stats.idle = idle_.size();
+        stats.outstanding = outstanding_;
+        stats.takes = takes_;
+        stats.hits = hits_;
+        stats.drops = drops_;
+        stats.contended = contended_;
+        return stats;
+    }
+
+ private:
+    std::unique_lock<std::mutex> lock() {
+        std::unique_lock<std::mutex> guard(mutex_, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            guard.lock();
+            contended_++;
+        }
+        return guard;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<T> idle_;
+    const size_t maxIdle_;
+    size_t outstanding_ = 0;
+    uint64_t takes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t drops_ = 0;
+    uint64_t contended_ = 0;
+    bool closed_ = false;
+};
+
+}  // namespace winui_drover_island
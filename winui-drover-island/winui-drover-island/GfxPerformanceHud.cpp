@@ -0,0 +1,126 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxPerformanceHud.h"
+#include "./GfxImageService.h"
+#include "./GfxUtils.h"
+
+#include <algorithm>
+#include <cwchar>
+
+namespace winui_drover_island {
+
+namespace {
+
+// The HUD area in DIPs, from the top-left corner of the control.
+constexpr float kMargin = 4.f;
+constexpr float kWidth = 260.f;
+constexpr float kHeight = 150.f;
+constexpr float kSparklineHeight = 36.f;
+
+}  // namespace
+
+PixelRect GfxPerformanceHud::boundsInPixels(float dpi) {
+    return PixelRect{dipsToPixels(kMargin, dpi, DpiRounding::kFloor), dipsToPixels(kMargin, dpi, DpiRounding::kFloor),
+        dipsToPixels(kMargin + kWidth, dpi, DpiRounding::kCeiling), dipsToPixels(kMargin + kHeight, dpi, DpiRounding::kCeiling)};
+}
+
+GfxPerformanceHud::GfxPerformanceHud() {
+    history_.reserve(kHistoryFrameCount);
+}
+
+void GfxPerformanceHud::addFrame(GfxFrameClock::Clock::duration frameTime, size_t updateRects, int64_t updatePixels) {
+    frameTimes_[nextFrame_] = std::chrono::duration<float, std::milli>(frameTime).count();
+    nextFrame_ = (nextFrame_ + 1) % kFrameCount;
+    frameCount_ = std::min(frameCount_ + 1, kFrameCount);
+    if (history_.size() == kHistoryFrameCount) {
+        history_.clear();
+    }
+    history_.append(frameTimes_[(nextFrame_ + kFrameCount - 1) % kFrameCount]);
+    updateRects_ = updateRects;
+    updatePixels_ = updatePixels;
+}
+
+void GfxPerformanceHud::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const Info& info) {
+    auto start = GfxFrameClock::Clock::now();
+    if (!textFormat_) {
+        if (!textFactory_) {
+            ThrowIfFailed(DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory), reinterpret_cast<IUnknown**>(textFactory_.put())));
+        }
+        ThrowIfFailed(textFactory_->CreateTextFormat(L"Consolas", nullptr, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL, 11.f, L"", textFormat_.put()));
+    }
+    if (!brush_) {
+        ThrowIfFailed(context->CreateSolidColorBrush(D2D1::ColorF(0.f, 0.f, 0.f, 0.7f), brush_.put()));
+    }
+
+    float lastFrame = 0;
+    float averageFrame = 0;
+    float maxFrame = 0;
+    for (size_t i = 0; i < frameCount_; ++i) {
+        averageFrame += frameTimes_[i];
+        maxFrame = std::max(maxFrame, frameTimes_[i]);
+    }
+    if (frameCount_ > 0) {
+        averageFrame /= static_cast<float>(frameCount_);
+        lastFrame = frameTimes_[(nextFrame_ + kFrameCount - 1) % kFrameCount];
+    }
+    auto percent = [](uint64_t part, uint64_t total) { return total ? 100.0 * part / total : 0.0; };
+    const auto& imageStats = GfxImageService::instance().stats();
+    GfxD2DContextPool::Stats poolStats;
+    if (info.device) {
+        poolStats = info.device->contextPoolStats();
+    }
+
+    // A fixed buffer, the HUD must not allocate in a warm frame.
+    wchar_t text[640];
+    swprintf_s(text,
+        L"frame %.2f ms  avg %.2f  max %.2f\n"
+        L"update %zu rects  %.1f kpx\n"
+        L"surface %dx%d px  %.0f dpi  %zu %ls\n"
+        L"device %ls\n"
+        L"contexts %zu idle  %zu leased  %.0f%% reused\n"
+        L"hits effects %.0f%%  images %.0f%%  skipped %.0f%%",
+        lastFrame, averageFrame, maxFrame, updateRects_, updatePixels_ / 1000.0, info.surfaceBounds.width(),
+        info.surfaceBounds.height(), info.dpi, info.surfaceCount, info.surfaceCount == 1 ? L"surface" : L"tiles",
+        !info.device ? L"none" : info.device->isSoftware() ? L"software (WARP)" : L"hardware",
+        poolStats.idleContexts, poolStats.leasedContexts, percent(poolStats.leases - poolStats.createdContexts, poolStats.leases),
+        percent(info.effectHits, info.effectLookups), percent(imageStats.cacheHits, imageStats.cacheHits + imageStats.cacheMisses),
+        info.frameSkipRate * 100.0);
+
+    auto bounds = D2D1::RectF(kMargin, kMargin, kMargin + kWidth, kMargin + kHeight);
+    brush_->SetColor(D2D1::ColorF(0.f, 0.f, 0.f, 0.7f));
+    context->FillRectangle(bounds, brush_.get());
+    brush_->SetColor(D2D1::ColorF(D2D1::ColorF::White));
+    auto textRect = D2D1::RectF(bounds.left + 4, bounds.top + 4, bounds.right - 4, bounds.bottom - kSparklineHeight - 4);
+    context->DrawText(text, static_cast<UINT32>(wcslen(text)), textFormat_.get(), textRect, brush_.get());
+
+    // The frame times since the HUD was created, oldest on the left, scaled to a 60Hz frame at
+    // least. However long the history, it is reduced to the min and max of each pixel column, so
+    // a single slow frame still shows.
+    auto graph = D2D1::RectF(bounds.left + 4, bounds.bottom - kSparklineHeight - 2, bounds.right - 4, bounds.bottom - 4);
+    GfxSeriesPolyline::View view;
+    view.samplesPerDip = static_cast<double>(std::max(history_.size(), kFrameCount) - 1) / (graph.right - graph.left);
+    view.minValue = 0.f;
+    view.maxValue = std::max(history_.range(0, history_.size()).max, 1000.f / 60.f);
+    auto y = graph.bottom - (graph.bottom - graph.top) * (1000.f / 60.f) / view.maxValue;
+    brush_->SetColor(D2D1::ColorF(D2D1::ColorF::Red, 0.6f));
+    context->DrawLine(D2D1::Point2F(graph.left, y), D2D1::Point2F(graph.right, y), brush_.get(), 1.f);
+    brush_->SetColor(D2D1::ColorF(D2D1::ColorF::LimeGreen));
+    ThrowIfFailed(historyLine_.draw(context, history_, graph, view, brush_.get()));
+    drawTime_ += GfxFrameClock::Clock::now() - start;
+}
+
+}  // namespace winui_drover_island
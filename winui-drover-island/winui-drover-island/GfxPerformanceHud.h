@@ -0,0 +1,88 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+#include <dwrite.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "./GfxD2DDeviceManager.h"
+#include "./GfxFrameClock.h"
+#include "./GfxRect.h"
+#include "./GfxSeriesPolyline.h"
+#include "winrt/base.h"
+
+namespace winui_drover_island {
+
+// The heads-up display of a control, in its top-left corner: frame times, update rects, surface
+// size and DPI, device type, context pool occupancy and cache hit rates, and a graph of the frame
+// times. The control draws it on top of its layers and refreshes it a few times per second. Used
+// on the UI thread only.
+class GfxPerformanceHud {
+ public:
+    GfxPerformanceHud();
+
+    static constexpr std::chrono::milliseconds kRefreshInterval{250};
+
+    // What the control shows besides its frame times.
+    struct Info {
+        PixelRect surfaceBounds;
+        float dpi = 0;
+        // More than one when the control is split in tiles.
+        size_t surfaceCount = 1;
+        GfxD2DDevice* device = nullptr;
+        uint64_t effectHits = 0;
+        uint64_t effectLookups = 0;
+        // Of the frames drawn with frame skipping on, from 0 to 1.
+        double frameSkipRate = 0;
+    };
+
+    static PixelRect boundsInPixels(float dpi);
+
+    void addFrame(GfxFrameClock::Clock::duration frameTime, size_t updateRects, int64_t updatePixels);
+    // Spent drawing the HUD since the last reset, the frame times leave it out.
+    GfxFrameClock::Clock::duration drawTime() const { return drawTime_; }
+    void resetDrawTime() { drawTime_ = {}; }
+
+    // Throws on failure, like the draw callbacks of the control. Doesn't allocate on the heap once
+    // the text format and the brush exist; Direct2D allocates the geometry of the graph.
+    void draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const Info& info);
+    // The brush belongs to the device.
+    void releaseDeviceResources() { brush_ = nullptr; }
+
+ private:
+    static constexpr size_t kFrameCount = 64;
+    // About twenty minutes at 60Hz, the graph starts over beyond.
+    static constexpr size_t kHistoryFrameCount = 64 * 1024;
+
+    // The last frame times in milliseconds, a ring starting at nextFrame_ once full.
+    std::array<float, kFrameCount> frameTimes_{};
+    size_t nextFrame_ = 0;
+    size_t frameCount_ = 0;
+    size_t updateRects_ = 0;
+    int64_t updatePixels_ = 0;
+    // Every frame time, reserved up front: adding frames doesn't allocate.
+    GfxSeriesSummary history_;
+    GfxSeriesPolyline historyLine_;
+    GfxFrameClock::Clock::duration drawTime_{};
+    winrt::com_ptr<IDWriteFactory> textFactory_;
+    winrt::com_ptr<IDWriteTextFormat> textFormat_;
+    winrt::com_ptr<ID2D1SolidColorBrush> brush_;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxRasterLayer.h"
+#include "./GfxUtils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace winui_drover_island {
+
+GfxRasterLayer::GfxRasterLayer(std::shared_ptr<GfxTiledImage> image, size_t maxCachedTiles)
+    : image_(std::move(image)), maxCachedTiles_(std::max<size_t>(maxCachedTiles, 1)) {
+    assert(image_ && image_->isOpen());
+}
+
+void GfxRasterLayer::beginFrame(const PixelRect& viewport, const PixelRect& updateBounds) {
+    const int32_t margin = kReadAheadTiles * image_->tileSize();
+    // The pages of the tiles coming into view are loaded while these ones are uploaded.
+    image_->prefetch(GfxTiledImage::readAheadRect(previousUpdateBounds_, updateBounds, margin));
+    if (!updateBounds.isEmpty()) {
+        previousUpdateBounds_ = updateBounds;
+    }
+    if (viewport.isEmpty()) {
+        return;
+    }
+    PixelRect cached{viewport.left - margin, viewport.top - margin, viewport.right + margin, viewport.bottom + margin};
+    maxCachedTiles_ = std::max<size_t>(image_->tileCountIntersecting(cached), 1);
+    trim(maxCachedTiles_);
+}
+
+HRESULT GfxRasterLayer::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F& updateRect) {
+    PixelRect rect{static_cast<int32_t>(std::floor(updateRect.left)), static_cast<int32_t>(std::floor(updateRect.top)),
+        static_cast<int32_t>(std::ceil(updateRect.right)), static_cast<int32_t>(std::ceil(updateRect.bottom))};
+
+    tiles_.clear();
+    image_->tilesIntersecting(rect, tiles_);
+    // All the tiles of one draw must fit, or they would evict each other. The next frame sizes
+    // the cache to its viewport again.
+    maxCachedTiles_ = std::max(maxCachedTiles_, tiles_.size());
+    for (const auto& tile : tiles_) {
+        winrt::com_ptr<ID2D1Bitmap1> bitmap;
+        ReturnIfFailed(tileBitmap(context.get(), tile, bitmap.put()));
+        auto tileRect = image_->tileRect(tile);
+        auto destination = D2D1::RectF(static_cast<float>(tileRect.left), static_cast<float>(tileRect.top),
+            static_cast<float>(tileRect.right), static_cast<float>(tileRect.bottom));
+        // Edge tiles are padded, only their part of the image is drawn.
+        auto source = D2D1::RectF(0, 0, static_cast<float>(tileRect.width()), static_cast<float>(tileRect.height()));
+        context->DrawBitmap(bitmap.get(), &destination, 1.f, D2D1_INTERPOLATION_MODE_LINEAR, &source);
+    }
+    return S_OK;
+}
+
+HRESULT GfxRasterLayer::tileBitmap(ID2D1DeviceContext* context, const GfxTiledImage::Tile& tile, ID2D1Bitmap1** bitmap) {
+    ++useCount_;
+    auto it = std::find_if(cache_.begin(), cache_.end(),
+        [&](const auto& entry) { return entry.tile.column == tile.column && entry.tile.row == tile.row; });
+    if (it != cache_.end()) {
+        it->lastUse = useCount_;
+        stats_.reusedTiles++;
+        it->bitmap.copy_to(bitmap);
+        return S_OK;
+    }
+
+    trim(maxCachedTiles_ - 1);
+
+    // Tiles are 96 DPI bitmaps, one pixel per DIP; the bits are copied straight from the mapping.
+    auto properties = D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_NONE,
+        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED), kDefaultDpi, kDefaultDpi);
+    auto size = D2D1::SizeU(static_cast<UINT32>(image_->tileSize()), static_cast<UINT32>(image_->tileSize()));
+    CachedTile entry;
+    entry.tile = tile;
+    entry.lastUse = useCount_;
+    ReturnIfFailed(context->CreateBitmap(size, image_->tilePixels(tile), static_cast<UINT32>(image_->tileStride()),
+        properties, entry.bitmap.put()));
+    stats_.uploadedTiles++;
+    entry.bitmap.copy_to(bitmap);
+    cache_.push_back(std::move(entry));
+    return S_OK;
+}
+
+void GfxRasterLayer::trim(size_t maxTiles) {
+    while (cache_.size() > maxTiles) {
+        auto oldest = std::min_element(cache_.begin(), cache_.end(),
+            [](const auto& a, const auto& b) { return a.lastUse < b.lastUse; });
+        // Its pages won't be needed until it is scrolled back into view.
+        image_->discard(image_->tileRect(oldest->tile));
+        cache_.erase(oldest);
+        stats_.evictedTiles++;
+    }
+}
+
+void GfxRasterLayer::releaseBitmaps() {
+    cache_.clear();
+    previousUpdateBounds_ = {};
+}
+
+}  // namespace winui_drover_island
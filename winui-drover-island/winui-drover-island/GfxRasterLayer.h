@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <memory>
+#include <vector>
+
+#include "./GfxTiledImage.h"
+#include "winrt/base.h"
+
+namespace winui_drover_island {
+
+// Draws a GfxTiledImage into a control, one image pixel per DIP. Only the tiles intersecting the
+// update rect are uploaded, from the file mapping, and kept in a cache of bitmaps sized to the
+// viewport; the tiles ahead of the scroll direction are prefetched from the file meanwhile. Meant
+// for virtual surfaces, whose update rects follow the viewport. Used on the UI thread only.
+class GfxRasterLayer {
+ public:
+    // Until the first frame tells the viewport.
+    static constexpr size_t kDefaultMaxCachedTiles = 64;
+    // Tiles prefetched ahead of the update rects, in the direction they move, and cached around
+    // the viewport.
+    static constexpr int32_t kReadAheadTiles = 2;
+
+    struct Stats {
+        uint64_t uploadedTiles = 0;
+        uint64_t reusedTiles = 0;
+        uint64_t evictedTiles = 0;
+    };
+
+    explicit GfxRasterLayer(std::shared_ptr<GfxTiledImage> image, size_t maxCachedTiles = kDefaultMaxCachedTiles);
+
+    GfxRasterLayer(GfxRasterLayer const&) = delete;
+    GfxRasterLayer& operator=(GfxRasterLayer const&) = delete;
+
+    const std::shared_ptr<GfxTiledImage>& image() const { return image_; }
+
+    // Called once per frame, before draw() is called for each of its update rects. In DIPs, the
+    // viewport is the visible part of the control and updateBounds the union of the update rects.
+    // The read-ahead follows how the update bounds move from one frame to the next, rather than
+    // from one update rect to the next; the cache keeps the tiles of the viewport and of the
+    // read-ahead margin around it, and is trimmed when the viewport shrinks.
+    void beginFrame(const PixelRect& viewport, const PixelRect& updateBounds);
+    HRESULT draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const D2D_RECT_F& updateRect);
+
+    // The bitmaps belong to the device, they are released when it is lost.
+    void releaseBitmaps();
+    size_t cachedBytes() const { return cache_.size() * image_->tileBytes(); }
+    size_t maxCachedTiles() const { return maxCachedTiles_; }
+
+    const Stats& stats() const { return stats_; }
+
+ private:
+    struct CachedTile {
+        GfxTiledImage::Tile tile;
+        winrt::com_ptr<ID2D1Bitmap1> bitmap;
+        uint64_t lastUse = 0;
+    };
+
+    HRESULT tileBitmap(ID2D1DeviceContext* context, const GfxTiledImage::Tile& tile, ID2D1Bitmap1** bitmap);
+    void trim(size_t maxTiles);
+
+    std::shared_ptr<GfxTiledImage> image_;
+    std::vector<CachedTile> cache_;
+    // Reused by every draw.
+    std::vector<GfxTiledImage::Tile> tiles_;
+    PixelRect previousUpdateBounds_;
+    uint64_t useCount_ = 0;
+    size_t maxCachedTiles_ = 0;
+    Stats stats_;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+namespace winui_drover_island {
+
+// Integer rectangle in surface pixels. It mirrors the layout of RECT, but does not depend on
+// any Windows header, so the layout code using it can be compiled and tested headless.
+struct PixelRect {
+    int32_t left = 0;
+    int32_t top = 0;
+    int32_t right = 0;
+    int32_t bottom = 0;
+
+    int32_t width() const { return right - left; }
+    int32_t height() const { return bottom - top; }
+
+    bool isEmpty() const { return right <= left || bottom <= top; }
+
+    int64_t area() const { return isEmpty() ? 0 : static_cast<int64_t>(width()) * height(); }
+
+    bool intersects(const PixelRect& other) const {
+        return !isEmpty() && !other.isEmpty() && left < other.right && other.left < right && top < other.bottom &&
+               other.top < bottom;
+    }
+
+    bool contains(const PixelRect& other) const {
+        return other.left >= left && other.top >= top && other.right <= right && other.bottom <= bottom;
+    }
+
+    PixelRect intersection(const PixelRect& other) const {
+        PixelRect result{std::max(left, other.left), std::max(top, other.top), std::min(right, other.right),
+            std::min(bottom, other.bottom)};
+        return result.isEmpty() ? PixelRect{} : result;
+    }
+
+    PixelRect unionWith(const PixelRect& other) const {
+        if (isEmpty()) {
+            return other;
+        }
+        if (other.isEmpty()) {
+            return *this;
+        }
+        return PixelRect{std::min(left, other.left), std::min(top, other.top), std::max(right, other.right),
+            std::max(bottom, other.bottom)};
+    }
+
+    PixelRect translated(int32_t dx, int32_t dy) const { return PixelRect{left + dx, top + dy, right + dx, bottom + dy}; }
+};
+
+inline bool operator==(const PixelRect& a, const PixelRect& b) {
+    return a.left == b.left && a.top == b.top && a.right == b.right && a.bottom == b.bottom;
+}
+
+inline bool operator!=(const PixelRect& a, const PixelRect& b) {
+    return !(a == b);
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxRectPacker.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace winui_drover_island {
+
+GfxRectPacker::GfxRectPacker(int32_t width, int32_t height, int32_t padding)
+    : width_(width), height_(height), padding_(padding) {
+    assert(width_ > 0 && height_ > 0 && padding_ >= 0);
+}
+
+std::optional<int32_t> GfxRectPacker::takeSpan(Shelf& shelf, int32_t paddedWidth) {
+    for (auto it = shelf.freeSpans.begin(); it != shelf.freeSpans.end(); ++it) {
+        if (it->second - it->first >= paddedWidth) {
+            int32_t left = it->first;
+            it->first += paddedWidth;
+            if (it->first == it->second) {
+                shelf.freeSpans.erase(it);
+            }
+            return left;
+        }
+    }
+    if (shelf.cursor + paddedWidth <= width_) {
+        int32_t left = shelf.cursor;
+        shelf.cursor += paddedWidth;
+        return left;
+    }
+    return std::nullopt;
+}
+
+std::optional<PixelRect> GfxRectPacker::allocate(int32_t width, int32_t height) {
+    if (width <= 0 || height <= 0) {
+        return std::nullopt;
+    }
+    const int32_t paddedWidth = width + padding_;
+    const int32_t paddedHeight = height + padding_;
+    if (paddedWidth > width_ || paddedHeight > height_) {
+        return std::nullopt;
+    }
+
+    // Best fit: the shortest shelf that is tall enough and still has room.
+    Shelf* best = nullptr;
+    int32_t bestWaste = std::numeric_limits<int32_t>::max();
+    for (auto& shelf : shelves_) {
+        if (shelf.height < paddedHeight) {
+            continue;
+        }
+        int32_t waste = shelf.height - paddedHeight;
+        // Don't let tiny controls claim tall shelves unless they are otherwise unused.
+        if (waste > paddedHeight && shelf.liveCount != 0) {
+            continue;
+        }
+        if (waste >= bestWaste) {
+            continue;
+        }
+        bool hasRoom = shelf.cursor + paddedWidth <= width_ ||
+                       std::any_of(shelf.freeSpans.begin(), shelf.freeSpans.end(),
+                           [&](const auto& span) { return span.second - span.first >= paddedWidth; });
+        if (hasRoom) {
+            best = &shelf;
+            bestWaste = waste;
+        }
+    }
+
+    if (!best) {
+        if (nextShelfTop_ + paddedHeight > height_) {
+            return std::nullopt;
+        }
+        Shelf shelf;
+        shelf.top = nextShelfTop_;
+        shelf.height = paddedHeight;
+        nextShelfTop_ += paddedHeight;
+        shelves_.push_back(std::move(shelf));
+        best = &shelves_.back();
+    }
+
+    auto left = takeSpan(*best, paddedWidth);
+    assert(left);
+    best->liveCount++;
+    allocationCount_++;
+    allocatedArea_ += static_cast<int64_t>(width) * height;
+    return PixelRect{*left, best->top, *left + width, best->top + height};
+}
+
+void GfxRectPacker::release(const PixelRect& rect) {
+    auto shelf = std::find_if(shelves_.begin(), shelves_.end(), [&](const Shelf& s) { return s.top == rect.top; });
+    assert(shelf != shelves_.end());
+    if (shelf == shelves_.end()) {
+        return;
+    }
+    assert(shelf->liveCount > 0);
+    shelf->liveCount--;
+    allocationCount_--;
+    allocatedArea_ -= rect.area();
+
+    auto& spans = shelf->freeSpans;
+    std::pair<int32_t, int32_t> span{rect.left, rect.right + padding_};
+    spans.insert(std::lower_bound(spans.begin(), spans.end(), span), span);
+
+    // Coalesce neighbouring spans, and give the tail back to the cursor.
+    size_t out = 0;
+    for (size_t i = 1; i < spans.size(); ++i) {
+        if (spans[out].second == spans[i].first) {
+            spans[out].second = spans[i].second;
+        } else {
+            spans[++out] = spans[i];
+        }
+    }
+    spans.resize(out + 1);
+    if (spans.back().second == shelf->cursor) {
+        shelf->cursor = spans.back().first;
+        spans.pop_back();
+    }
+
+    trimEmptyShelves();
+}
+
+void GfxRectPacker::trimEmptyShelves() {
+    while (!shelves_.empty() && shelves_.back().liveCount == 0) {
+        nextShelfTop_ = shelves_.back().top;
+        shelves_.pop_back();
+    }
+}
+
+void GfxRectPacker::reset() {
+    shelves_.clear();
+    nextShelfTop_ = 0;
+    allocationCount_ = 0;
+    allocatedArea_ = 0;
+}
+
+}  // namespace winui_drover_island
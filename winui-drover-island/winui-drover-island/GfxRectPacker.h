@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "./GfxRect.h"
+
+namespace winui_drover_island {
+
+// Shelf based rectangle packer used to hand out sub-regions of an atlas surface.
+// Rectangles are placed on horizontal shelves; released space is kept in a per shelf
+// free list and coalesced, so controls that come and go do not fragment the atlas forever.
+class GfxRectPacker {
+ public:
+    GfxRectPacker(int32_t width, int32_t height, int32_t padding = 1);
+
+    // Returns the allocated rectangle (without padding), or nothing if it does not fit.
+    std::optional<PixelRect> allocate(int32_t width, int32_t height);
+
+    // Releases a rectangle previously returned by allocate().
+    void release(const PixelRect& rect);
+
+    void reset();
+
+    int32_t width() const { return width_; }
+    int32_t height() const { return height_; }
+
+    size_t allocationCount() const { return allocationCount_; }
+    int64_t allocatedArea() const { return allocatedArea_; }
+
+ private:
+    struct Shelf {
+        int32_t top = 0;
+        int32_t height = 0;
+        int32_t cursor = 0;
+        size_t liveCount = 0;
+        // Padded spans [left, right) that were released, sorted by left.
+        std::vector<std::pair<int32_t, int32_t>> freeSpans;
+    };
+
+    std::optional<int32_t> takeSpan(Shelf& shelf, int32_t paddedWidth);
+    void trimEmptyShelves();
+
+    int32_t width_ = 0;
+    int32_t height_ = 0;
+    int32_t padding_ = 0;
+    int32_t nextShelfTop_ = 0;
+    size_t allocationCount_ = 0;
+    int64_t allocatedArea_ = 0;
+    std::vector<Shelf> shelves_;
+};
+
+}  // namespace winui_drover_island
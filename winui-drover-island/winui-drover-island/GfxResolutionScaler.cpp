@@ -0,0 +1,93 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxResolutionScaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace winui_drover_island {
+
+namespace {
+
+// Scale back up once frames take less than this fraction of the target.
+constexpr double kScaleUpThreshold = 0.7;
+// Scale down once frames take more than this fraction of the target.
+constexpr double kScaleDownThreshold = 1.05;
+
+}  // namespace
+
+void GfxResolutionScaler::setOptions(const Options& options) {
+    options_ = options;
+    scale_ = std::clamp(quantize(scale_), options_.minScale, 1.f);
+}
+
+GfxResolutionScaler::Clock::duration GfxResolutionScaler::averageFrameTime() const {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(averageSeconds_));
+}
+
+float GfxResolutionScaler::quantize(float scale) const {
+    if (options_.step <= 0) {
+        return scale;
+    }
+    return std::floor(scale / options_.step + 1e-4f) * options_.step;
+}
+
+bool GfxResolutionScaler::addFrameTime(Clock::duration frameTime) {
+    double seconds = std::chrono::duration<double>(frameTime).count();
+    if (!hasAverage_) {
+        averageSeconds_ = seconds;
+        hasAverage_ = true;
+    } else {
+        averageSeconds_ += options_.smoothing * (seconds - averageSeconds_);
+    }
+
+    if (++framesAtScale_ < options_.settleFrames) {
+        return false;
+    }
+
+    double target = std::chrono::duration<double>(options_.targetFrameTime).count();
+    if (target <= 0 || averageSeconds_ <= 0) {
+        return false;
+    }
+    double ratio = averageSeconds_ / target;
+
+    float newScale = scale_;
+    auto desired = static_cast<float>(scale_ / std::sqrt(ratio));
+    if (ratio > kScaleDownThreshold) {
+        newScale = std::min(quantize(desired), scale_ - std::max(options_.step, 0.f));
+    } else if (ratio < kScaleUpThreshold) {
+        // Without steps, straight to the scale fitting the target.
+        newScale = options_.step > 0 ? scale_ + options_.step : desired;
+    }
+    newScale = std::clamp(newScale, options_.minScale, 1.f);
+    if (newScale == scale_) {
+        return false;
+    }
+
+    // Predicts the cost at the new scale so the average doesn't lag behind the change.
+    double area = static_cast<double>(newScale) / scale_;
+    averageSeconds_ *= area * area;
+    scale_ = newScale;
+    framesAtScale_ = 0;
+    return true;
+}
+
+void GfxResolutionScaler::reset() {
+    scale_ = 1.f;
+    averageSeconds_ = 0;
+    framesAtScale_ = 0;
+    hasAverage_ = false;
+}
+
+}  // namespace winui_drover_island
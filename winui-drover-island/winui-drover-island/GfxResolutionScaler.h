@@ -0,0 +1,65 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace winui_drover_island {
+
+// Picks the fraction of the full resolution to render at so that frames fit in a target time.
+// The render cost is assumed to be proportional to the pixel count, so the scale follows the
+// square root of the measured to target time ratio. Scales are quantized and only change after
+// a few frames, since every change means new surfaces.
+class GfxResolutionScaler {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        Clock::duration targetFrameTime = std::chrono::microseconds(16667);
+        float minScale = 0.5f;
+        // Scales are multiples of the step, any scale when zero.
+        float step = 0.125f;
+        // Frames measured at a scale before it can change again.
+        uint32_t settleFrames = 4;
+        // Weight of the latest frame in the moving average.
+        float smoothing = 0.3f;
+    };
+
+    GfxResolutionScaler() : GfxResolutionScaler(Options{}) {}
+    explicit GfxResolutionScaler(const Options& options) : options_(options) {}
+
+    void setOptions(const Options& options);
+    const Options& options() const { return options_; }
+
+    float scale() const { return scale_; }
+    Clock::duration averageFrameTime() const;
+
+    // Records how long a frame rendered at the current scale took. Returns true if the scale changed.
+    bool addFrameTime(Clock::duration frameTime);
+
+    // Back to full resolution, forgetting the measurements.
+    void reset();
+
+ private:
+    float quantize(float scale) const;
+
+    Options options_;
+    float scale_ = 1.f;
+    double averageSeconds_ = 0;
+    uint32_t framesAtScale_ = 0;
+    bool hasAverage_ = false;
+};
+
+}  // namespace winui_drover_island
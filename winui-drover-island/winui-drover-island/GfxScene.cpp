@@ -0,0 +1,427 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxScene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace winui_drover_island {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x4e435347;  // "GSCN"
+constexpr uint32_t kMaxGridSize = 4096;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t nodeCount;
+    uint32_t styleCount;
+    uint32_t pointCount;
+    uint32_t stringBytes;
+    uint32_t gridColumns;
+    uint32_t gridRows;
+    uint32_t cellNodeCount;
+    uint32_t reserved;
+    GfxScene::Rect bounds;
+    float cellWidth;
+    float cellHeight;
+    uint64_t nodesOffset;
+    uint64_t stylesOffset;
+    uint64_t pointsOffset;
+    uint64_t stringsOffset;
+    uint64_t cellsOffset;
+    uint64_t cellNodesOffset;
+};
+
+// The sections are read in place, their layout is the file format.
+static_assert(sizeof(Header) == 112, "the header is part of the file format");
+static_assert(sizeof(GfxScene::Node) == 40, "nodes are part of the file format");
+static_assert(sizeof(GfxScene::Style) == 48, "styles are part of the file format");
+static_assert(std::is_trivially_copyable<GfxScene::Node>::value && std::is_trivially_copyable<GfxScene::Style>::value,
+    "sections are read from the mapping");
+
+constexpr GfxScene::Style kDefaultStyle = {};
+
+size_t alignSection(size_t offset) {
+    return (offset + 7) & ~size_t{7};
+}
+
+bool sectionFits(uint64_t offset, uint64_t count, size_t elementSize, size_t fileSize) {
+    return offset % 8 == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+}  // namespace
+
+bool GfxScene::open(const std::filesystem::path& path) {
+    close();
+    if (!file_.open(path)) {
+        return false;
+    }
+    Header header;
+    if (file_.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    auto size = file_.size();
+    uint64_t cellCount = static_cast<uint64_t>(header.gridColumns) * header.gridRows;
+    // Only the section bounds are checked here, the references inside are checked when read.
+    if (header.magic != kMagic || header.version != kVersion || header.gridColumns == 0 || header.gridRows == 0 ||
+        header.gridColumns > kMaxGridSize || header.gridRows > kMaxGridSize || !(header.cellWidth > 0) ||
+        !(header.cellHeight > 0) || !sectionFits(header.nodesOffset, header.nodeCount, sizeof(Node), size) ||
+        !sectionFits(header.stylesOffset, header.styleCount, sizeof(Style), size) ||
+        !sectionFits(header.pointsOffset, header.pointCount, sizeof(Point), size) ||
+        !sectionFits(header.stringsOffset, header.stringBytes, 1, size) ||
+        !sectionFits(header.cellsOffset, cellCount, sizeof(Cell), size) ||
+        !sectionFits(header.cellNodesOffset, header.cellNodeCount, sizeof(uint32_t), size)) {
+        close();
+        return false;
+    }
+
+    const auto* data = file_.data();
+    nodes_ = reinterpret_cast<const Node*>(data + header.nodesOffset);
+    styles_ = reinterpret_cast<const Style*>(data + header.stylesOffset);
+    points_ = reinterpret_cast<const Point*>(data + header.pointsOffset);
+    strings_ = reinterpret_cast<const char*>(data + header.stringsOffset);
+    cells_ = reinterpret_cast<const Cell*>(data + header.cellsOffset);
+    cellNodes_ = reinterpret_cast<const uint32_t*>(data + header.cellNodesOffset);
+    nodeCount_ = header.nodeCount;
+    styleCount_ = header.styleCount;
+    pointCount_ = header.pointCount;
+    stringBytes_ = header.stringBytes;
+    gridColumns_ = header.gridColumns;
+    gridRows_ = header.gridRows;
+    cellNodeCount_ = header.cellNodeCount;
+    bounds_ = header.bounds;
+    cellWidth_ = header.cellWidth;
+    cellHeight_ = header.cellHeight;
+    return true;
+}
+
+void GfxScene::close() {
+    file_.close();
+    edits_.clear();
+    nodes_ = nullptr;
+    styles_ = nullptr;
+    points_ = nullptr;
+    strings_ = nullptr;
+    cells_ = nullptr;
+    cellNodes_ = nullptr;
+    nodeCount_ = styleCount_ = pointCount_ = stringBytes_ = 0;
+    gridColumns_ = gridRows_ = cellNodeCount_ = 0;
+    bounds_ = {};
+    cellWidth_ = cellHeight_ = 0;
+}
+
+const GfxScene::Style& GfxScene::style(uint32_t index) const {
+    return index < styleCount_ ? styles_[index] : kDefaultStyle;
+}
+
+const GfxScene::Point* GfxScene::points(const Node& node, uint32_t& count) const {
+    if (node.first > pointCount_ || node.count > pointCount_ - node.first) {
+        count = 0;
+        return nullptr;
+    }
+    count = node.count;
+    return points_ + node.first;
+}
+
+std::string_view GfxScene::text(const Node& node) const {
+    if (node.first > stringBytes_ || node.count > stringBytes_ - node.first) {
+        return {};
+    }
+    return std::string_view(strings_ + node.first, node.count);
+}
+
+void GfxScene::nodesIntersecting(const Rect& rect, std::vector<uint32_t>& nodes) const {
+    if (!isOpen() || rect.isEmpty()) {
+        return;
+    }
+    size_t start = nodes.size();
+    auto isDrawn = [&](const Node& node) { return !(node.flags & kHidden) && node.bounds.intersects(rect); };
+    for (const auto& edit : edits_) {
+        if (isDrawn(edit.second)) {
+            nodes.push_back(edit.first);
+        }
+    }
+    if (rect.intersects(bounds_)) {
+        gridNodesIntersecting(rect, nodes);
+    }
+    // Nodes spanning several cells are listed in each of them.
+    std::sort(nodes.begin() + start, nodes.end());
+    nodes.erase(std::unique(nodes.begin() + start, nodes.end()), nodes.end());
+}
+
+void GfxScene::gridNodesIntersecting(const Rect& rect, std::vector<uint32_t>& nodes) const {
+    auto cellIndex = [](float offset, float cellSize, uint32_t cells) {
+        auto index = std::floor(offset / cellSize);
+        return static_cast<uint32_t>(std::clamp(index, 0.f, static_cast<float>(cells - 1)));
+    };
+    uint32_t firstColumn = cellIndex(rect.left - bounds_.left, cellWidth_, gridColumns_);
+    uint32_t lastColumn = cellIndex(rect.right - bounds_.left, cellWidth_, gridColumns_);
+    uint32_t firstRow = cellIndex(rect.top - bounds_.top, cellHeight_, gridRows_);
+    uint32_t lastRow = cellIndex(rect.bottom - bounds_.top, cellHeight_, gridRows_);
+
+    for (uint32_t row = firstRow; row <= lastRow; ++row) {
+        for (uint32_t column = firstColumn; column <= lastColumn; ++column) {
+            const auto& cell = cells_[static_cast<size_t>(row) * gridColumns_ + column];
+            if (cell.first > cellNodeCount_ || cell.count > cellNodeCount_ - cell.first) {
+                continue;
+            }
+            for (uint32_t i = 0; i < cell.count; ++i) {
+                auto index = cellNodes_[cell.first + i];
+                // Edited nodes were listed already, the grid has their original bounds.
+                if (index < nodeCount_ && !(nodes_[index].flags & kHidden) && nodes_[index].bounds.intersects(rect) &&
+                    (edits_.empty() || edits_.count(index) == 0)) {
+                    nodes.push_back(index);
+                }
+            }
+        }
+    }
+}
+
+GfxScene::Node* GfxScene::editableNode(uint32_t index) {
+    if (index >= nodeCount_) {
+        return nullptr;
+    }
+    return &edits_.emplace(index, nodes_[index]).first->second;
+}
+
+void GfxScene::notifyChange(const Node& before, const Node& after) const {
+    if (!changeListener_) {
+        return;
+    }
+    // Hidden nodes cover nothing.
+    auto covered = [](const Node& node) { return (node.flags & kHidden) ? Rect{} : node.bounds; };
+    changeListener_(covered(before), covered(after));
+}
+
+float GfxScene::strokeInset(uint32_t styleIndex) const {
+    const auto& nodeStyle = style(styleIndex);
+    return (nodeStyle.flags & kStroke) ? nodeStyle.strokeWidth / 2 : 0.f;
+}
+
+bool GfxScene::setNodeBounds(uint32_t index, const Rect& bounds) {
+    if (index >= nodeCount_ || node(index).kind == NodeKind::kPolyline || node(index).kind == NodeKind::kGroup) {
+        return false;
+    }
+    auto* edited = editableNode(index);
+    auto before = *edited;
+    // Like the builder: the node bounds include the stroke, except for texts.
+    float inset = edited->kind == NodeKind::kText ? 0.f : strokeInset(edited->style);
+    edited->bounds = Rect{bounds.left - inset, bounds.top - inset, bounds.right + inset, bounds.bottom + inset};
+    notifyChange(before, *edited);
+    return true;
+}
+
+bool GfxScene::setNodeStyle(uint32_t index, uint32_t nodeStyle) {
+    if (index >= nodeCount_ || node(index).kind == NodeKind::kGroup) {
+        return false;
+    }
+    auto* edited = editableNode(index);
+    auto before = *edited;
+    if (edited->kind != NodeKind::kText) {
+        float grow = strokeInset(nodeStyle) - strokeInset(edited->style);
+        edited->bounds = Rect{edited->bounds.left - grow, edited->bounds.top - grow, edited->bounds.right + grow,
+            edited->bounds.bottom + grow};
+    }
+    edited->style = nodeStyle;
+    notifyChange(before, *edited);
+    return true;
+}
+
+bool GfxScene::setNodeVisible(uint32_t index, bool visible) {
+    if (index >= nodeCount_ || node(index).kind == NodeKind::kGroup) {
+        return false;
+    }
+    auto* edited = editableNode(index);
+    auto before = *edited;
+    edited->flags = static_cast<uint16_t>(visible ? (edited->flags & ~kHidden) : (edited->flags | kHidden));
+    notifyChange(before, *edited);
+    return true;
+}
+
+uint32_t GfxSceneBuilder::addStyle(const Style& style) {
+    styles_.push_back(style);
+    return static_cast<uint32_t>(styles_.size() - 1);
+}
+
+uint32_t GfxSceneBuilder::addNode(GfxScene::NodeKind kind, const Rect& bounds, uint32_t style, uint32_t parent,
+    uint32_t first, uint32_t count) {
+    GfxScene::Node node = {};
+    node.kind = kind;
+    node.style = style;
+    node.parent = parent;
+    node.first = first;
+    node.count = count;
+    node.bounds = bounds;
+    nodes_.push_back(node);
+    return static_cast<uint32_t>(nodes_.size() - 1);
+}
+
+GfxSceneBuilder::Rect GfxSceneBuilder::strokeBounds(const Rect& rect, uint32_t style) const {
+    float inset = 0;
+    if (style < styles_.size() && (styles_[style].flags & GfxScene::kStroke)) {
+        inset = styles_[style].strokeWidth / 2;
+    }
+    return Rect{rect.left - inset, rect.top - inset, rect.right + inset, rect.bottom + inset};
+}
+
+uint32_t GfxSceneBuilder::addGroup(uint32_t parent) {
+    return addNode(GfxScene::NodeKind::kGroup, Rect{}, 0, parent);
+}
+
+uint32_t GfxSceneBuilder::addRect(const Rect& rect, uint32_t style, uint32_t parent) {
+    return addNode(GfxScene::NodeKind::kRect, strokeBounds(rect, style), style, parent);
+}
+
+uint32_t GfxSceneBuilder::addEllipse(const Rect& rect, uint32_t style, uint32_t parent) {
+    return addNode(GfxScene::NodeKind::kEllipse, strokeBounds(rect, style), style, parent);
+}
+
+uint32_t GfxSceneBuilder::addPolyline(const Point* points, uint32_t count, uint32_t style, uint32_t parent) {
+    Rect bounds{INFINITY, INFINITY, -INFINITY, -INFINITY};
+    for (uint32_t i = 0; i < count; ++i) {
+        bounds.left = std::min(bounds.left, points[i].x);
+        bounds.top = std::min(bounds.top, points[i].y);
+        bounds.right = std::max(bounds.right, points[i].x);
+        bounds.bottom = std::max(bounds.bottom, points[i].y);
+    }
+    auto first = static_cast<uint32_t>(points_.size());
+    points_.insert(points_.end(), points, points + count);
+    // Horizontal or vertical lines still cover their stroke.
+    bounds = count > 0 ? strokeBounds(bounds, style) : Rect{};
+    return addNode(GfxScene::NodeKind::kPolyline, bounds, style, parent, first, count);
+}
+
+uint32_t GfxSceneBuilder::addText(const Rect& rect, std::string_view utf8, uint32_t style, uint32_t parent) {
+    auto first = static_cast<uint32_t>(strings_.size());
+    strings_.append(utf8);
+    return addNode(GfxScene::NodeKind::kText, rect, style, parent, first, static_cast<uint32_t>(utf8.size()));
+}
+
+bool GfxSceneBuilder::write(const std::filesystem::path& path) const {
+    // The grid covers the union of the node bounds, with cells about as wide as they are high.
+    Rect bounds{INFINITY, INFINITY, -INFINITY, -INFINITY};
+    size_t drawnNodes = 0;
+    for (const auto& node : nodes_) {
+        if (node.bounds.isEmpty()) {
+            continue;
+        }
+        bounds.left = std::min(bounds.left, node.bounds.left);
+        bounds.top = std::min(bounds.top, node.bounds.top);
+        bounds.right = std::max(bounds.right, node.bounds.right);
+        bounds.bottom = std::max(bounds.bottom, node.bounds.bottom);
+        drawnNodes++;
+    }
+    if (drawnNodes == 0) {
+        bounds = Rect{0, 0, 1, 1};
+    }
+    float width = bounds.right - bounds.left;
+    float height = bounds.bottom - bounds.top;
+    double cellCount = std::max<double>(1, static_cast<double>(drawnNodes) / kNodesPerCell);
+    auto columns = static_cast<uint32_t>(std::clamp(std::ceil(std::sqrt(cellCount * width / height)), 1.0, static_cast<double>(kMaxGridSize)));
+    auto rows = static_cast<uint32_t>(std::clamp(std::ceil(cellCount / columns), 1.0, static_cast<double>(kMaxGridSize)));
+    float cellWidth = width / static_cast<float>(columns);
+    float cellHeight = height / static_cast<float>(rows);
+
+    auto forEachCell = [&](const Rect& rect, auto&& fn) {
+        auto cellIndex = [](float offset, float cellSize, uint32_t cells) {
+            return static_cast<uint32_t>(std::clamp(std::floor(offset / cellSize), 0.f, static_cast<float>(cells - 1)));
+        };
+        uint32_t lastColumn = cellIndex(rect.right - bounds.left, cellWidth, columns);
+        uint32_t lastRow = cellIndex(rect.bottom - bounds.top, cellHeight, rows);
+        for (uint32_t row = cellIndex(rect.top - bounds.top, cellHeight, rows); row <= lastRow; ++row) {
+            for (uint32_t column = cellIndex(rect.left - bounds.left, cellWidth, columns); column <= lastColumn; ++column) {
+                fn(static_cast<size_t>(row) * columns + column);
+            }
+        }
+    };
+
+    // Counted first, so the node lists of the cells are laid out contiguously.
+    std::vector<uint32_t> cellFirst(static_cast<size_t>(columns) * rows + 1, 0);
+    for (const auto& node : nodes_) {
+        if (!node.bounds.isEmpty()) {
+            forEachCell(node.bounds, [&](size_t cell) { cellFirst[cell + 1]++; });
+        }
+    }
+    for (size_t i = 1; i < cellFirst.size(); ++i) {
+        cellFirst[i] += cellFirst[i - 1];
+    }
+    std::vector<uint32_t> cellNodes(cellFirst.back());
+    std::vector<uint32_t> cellFill(cellFirst.begin(), cellFirst.end() - 1);
+    for (uint32_t index = 0; index < nodes_.size(); ++index) {
+        if (!nodes_[index].bounds.isEmpty()) {
+            forEachCell(nodes_[index].bounds, [&](size_t cell) { cellNodes[cellFill[cell]++] = index; });
+        }
+    }
+    std::vector<uint32_t> cells(2 * (cellFirst.size() - 1));
+    for (size_t i = 0; i + 1 < cellFirst.size(); ++i) {
+        cells[2 * i] = cellFirst[i];
+        cells[2 * i + 1] = cellFirst[i + 1] - cellFirst[i];
+    }
+
+    Header header = {};
+    header.magic = kMagic;
+    header.version = GfxScene::kVersion;
+    header.nodeCount = static_cast<uint32_t>(nodes_.size());
+    header.styleCount = static_cast<uint32_t>(styles_.size());
+    header.pointCount = static_cast<uint32_t>(points_.size());
+    header.stringBytes = static_cast<uint32_t>(strings_.size());
+    header.gridColumns = columns;
+    header.gridRows = rows;
+    header.cellNodeCount = static_cast<uint32_t>(cellNodes.size());
+    header.bounds = bounds;
+    header.cellWidth = cellWidth;
+    header.cellHeight = cellHeight;
+
+    struct Section {
+        uint64_t& offset;
+        const void* data;
+        size_t bytes;
+    };
+    Section sections[] = {
+        {header.nodesOffset, nodes_.data(), nodes_.size() * sizeof(GfxScene::Node)},
+        {header.stylesOffset, styles_.data(), styles_.size() * sizeof(Style)},
+        {header.pointsOffset, points_.data(), points_.size() * sizeof(Point)},
+        {header.stringsOffset, strings_.data(), strings_.size()},
+        {header.cellsOffset, cells.data(), cells.size() * sizeof(uint32_t)},
+        {header.cellNodesOffset, cellNodes.data(), cellNodes.size() * sizeof(uint32_t)},
+    };
+    size_t offset = alignSection(sizeof(Header));
+    for (auto& section : sections) {
+        section.offset = offset;
+        offset = alignSection(offset + section.bytes);
+    }
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        return false;
+    }
+    const char padding[8] = {};
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    size_t written = sizeof(header);
+    for (const auto& section : sections) {
+        stream.write(padding, static_cast<std::streamsize>(section.offset - written));
+        stream.write(static_cast<const char*>(section.data), static_cast<std::streamsize>(section.bytes));
+        written = section.offset + section.bytes;
+    }
+    return static_cast<bool>(stream.flush());
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,206 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "./GfxMappedFile.h"
+
+namespace winui_drover_island {
+
+// A Drover document: a retained list of nodes in paint order, the styles, polyline points and
+// strings they refer to, and a grid indexing the nodes by the area they cover. The file is flat
+// and relocation free, every reference is an index into a section, so a scene is drawn straight
+// from its memory mapping: opening a file of millions of nodes reads its header only, and
+// drawing a viewport only touches the pages of the nodes in view.
+//
+// File layout: a header, then the sections, each 8-byte aligned: nodes, styles, points, strings,
+// grid cells and the node indices of the cells. Values are little-endian. Coordinates are DIPs.
+//
+// Nodes can be edited: the edits are kept in memory over the mapped nodes, the file isn't
+// modified. Each edit reports the bounds the node covered before and covers after, which is all
+// that has to be redrawn.
+class GfxScene {
+ public:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kNoParent = UINT32_MAX;
+
+    struct Rect {
+        float left;
+        float top;
+        float right;
+        float bottom;
+
+        bool isEmpty() const { return !(right > left && bottom > top); }
+        bool intersects(const Rect& other) const {
+            return left < other.right && other.left < right && top < other.bottom && other.top < bottom;
+        }
+    };
+
+    struct Point {
+        float x;
+        float y;
+    };
+
+    enum class NodeKind : uint16_t {
+        // Groups only structure the scene, they aren't drawn.
+        kGroup,
+        kRect,
+        kEllipse,
+        kPolyline,
+        kText,
+    };
+
+    struct Node {
+        NodeKind kind;
+        uint16_t flags;
+        uint32_t style;
+        uint32_t parent;
+        // Polylines: a range of the points. Text: a range of the bytes of the strings, UTF-8.
+        uint32_t first;
+        uint32_t count;
+        uint32_t reserved;
+        // Includes the stroke; empty for groups.
+        Rect bounds;
+    };
+
+    enum NodeFlags : uint16_t {
+        kHidden = 1,
+    };
+
+    enum StyleFlags : uint32_t {
+        kFill = 1,
+        kStroke = 2,
+    };
+
+    struct Style {
+        // Straight alpha RGBA.
+        float fill[4];
+        float stroke[4];
+        float strokeWidth;
+        float fontSize;
+        float cornerRadius;
+        uint32_t flags;
+    };
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+
+    uint32_t nodeCount() const { return nodeCount_; }
+    const Node& node(uint32_t index) const {
+        if (!edits_.empty()) {
+            auto edit = edits_.find(index);
+            if (edit != edits_.end()) {
+                return edit->second;
+            }
+        }
+        return nodes_[index];
+    }
+    // Unknown styles read as the default style, which draws nothing.
+    const Style& style(uint32_t index) const;
+    // Empty when the node references points or strings beyond their section: a damaged file
+    // draws less rather than reading outside of the mapping.
+    const Point* points(const Node& node, uint32_t& count) const;
+    std::string_view text(const Node& node) const;
+    const Rect& bounds() const { return bounds_; }
+
+    // Appends the visible nodes whose bounds intersect the rect, in paint order.
+    void nodesIntersecting(const Rect& rect, std::vector<uint32_t>& nodes) const;
+
+    using ChangeListener = std::function<void(const Rect& oldBounds, const Rect& newBounds)>;
+    void setChangeListener(ChangeListener listener) { changeListener_ = std::move(listener); }
+
+    // Moves or resizes a rect, an ellipse or a text. Polylines keep their points, their bounds
+    // can't be set.
+    bool setNodeBounds(uint32_t index, const Rect& bounds);
+    // The node bounds follow the stroke width of the new style.
+    bool setNodeStyle(uint32_t index, uint32_t style);
+    bool setNodeVisible(uint32_t index, bool visible);
+    size_t editedNodeCount() const { return edits_.size(); }
+
+ private:
+    struct Cell {
+        uint32_t first;
+        uint32_t count;
+    };
+
+    void gridNodesIntersecting(const Rect& rect, std::vector<uint32_t>& nodes) const;
+    Node* editableNode(uint32_t index);
+    void notifyChange(const Node& before, const Node& after) const;
+    float strokeInset(uint32_t styleIndex) const;
+
+    GfxMappedFile file_;
+    const Node* nodes_ = nullptr;
+    const Style* styles_ = nullptr;
+    const Point* points_ = nullptr;
+    const char* strings_ = nullptr;
+    const Cell* cells_ = nullptr;
+    const uint32_t* cellNodes_ = nullptr;
+    uint32_t nodeCount_ = 0;
+    uint32_t styleCount_ = 0;
+    uint32_t pointCount_ = 0;
+    uint32_t stringBytes_ = 0;
+    uint32_t gridColumns_ = 0;
+    uint32_t gridRows_ = 0;
+    uint32_t cellNodeCount_ = 0;
+    Rect bounds_ = {};
+    float cellWidth_ = 0;
+    float cellHeight_ = 0;
+    // The edited nodes, by index; they are found by their current bounds, not by the grid.
+    std::unordered_map<uint32_t, Node> edits_;
+    ChangeListener changeListener_;
+};
+
+// Builds a scene in memory and writes its file. Nodes are drawn in the order they are added.
+class GfxSceneBuilder {
+ public:
+    using Rect = GfxScene::Rect;
+    using Point = GfxScene::Point;
+    using Style = GfxScene::Style;
+
+    // The grid aims at this many nodes per cell.
+    static constexpr uint32_t kNodesPerCell = 8;
+
+    uint32_t addStyle(const Style& style);
+
+    uint32_t addGroup(uint32_t parent = GfxScene::kNoParent);
+    uint32_t addRect(const Rect& rect, uint32_t style, uint32_t parent = GfxScene::kNoParent);
+    uint32_t addEllipse(const Rect& rect, uint32_t style, uint32_t parent = GfxScene::kNoParent);
+    uint32_t addPolyline(const Point* points, uint32_t count, uint32_t style, uint32_t parent = GfxScene::kNoParent);
+    uint32_t addText(const Rect& rect, std::string_view utf8, uint32_t style, uint32_t parent = GfxScene::kNoParent);
+
+    uint32_t nodeCount() const { return static_cast<uint32_t>(nodes_.size()); }
+
+    bool write(const std::filesystem::path& path) const;
+
+ private:
+    uint32_t addNode(GfxScene::NodeKind kind, const Rect& bounds, uint32_t style, uint32_t parent, uint32_t first = 0,
+        uint32_t count = 0);
+    Rect strokeBounds(const Rect& rect, uint32_t style) const;
+
+    std::vector<GfxScene::Node> nodes_;
+    std::vector<Style> styles_;
+    std::vector<Point> points_;
+    std::string strings_;
+};
+
+}  // namespace winui_drover_island
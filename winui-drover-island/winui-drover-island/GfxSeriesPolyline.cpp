@@ -0,0 +1,119 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxSeriesPolyline.h"
+#include "./GfxUtils.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace winui_drover_island {
+
+HRESULT GfxSeriesPolyline::draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const GfxSeriesSummary& series,
+    const D2D_RECT_F& rect, const View& view, ID2D1Brush* brush, float strokeWidth) {
+    if (rect.right <= rect.left || rect.bottom <= rect.top || view.samplesPerDip <= 0 || series.size() == 0) {
+        return S_OK;
+    }
+    float dpiX = 0, dpiY = 0;
+    context->GetDpi(&dpiX, &dpiY);
+    const float columnWidth = kDefaultDpi / dpiX;
+    const double samplesPerColumn = view.samplesPerDip * columnWidth;
+
+    points_.clear();
+    figures_.clear();
+    if (samplesPerColumn <= 1) {
+        addSamplePoints(series, rect, view);
+    } else {
+        columns_.resize(static_cast<size_t>(sizeDipsToPixels(rect.right - rect.left, dpiX)));
+        series.decimate(view.firstSample, samplesPerColumn, columns_.data(), columns_.size());
+        addColumnPoints(rect, view, columnWidth);
+    }
+    if (points_.empty()) {
+        return S_OK;
+    }
+
+    winrt::com_ptr<ID2D1Factory> factory;
+    context->GetFactory(factory.put());
+    winrt::com_ptr<ID2D1PathGeometry> geometry;
+    ReturnIfFailed(factory->CreatePathGeometry(geometry.put()));
+    winrt::com_ptr<ID2D1GeometrySink> sink;
+    ReturnIfFailed(geometry->Open(sink.put()));
+    for (size_t i = 0; i < figures_.size(); ++i) {
+        size_t begin = figures_[i];
+        size_t end = i + 1 < figures_.size() ? figures_[i + 1] : points_.size();
+        sink->BeginFigure(points_[begin], D2D1_FIGURE_BEGIN_HOLLOW);
+        sink->AddLines(points_.data() + begin + 1, static_cast<UINT32>(end - begin - 1));
+        sink->EndFigure(D2D1_FIGURE_END_OPEN);
+    }
+    ReturnIfFailed(sink->Close());
+
+    context->PushAxisAlignedClip(rect, D2D1_ANTIALIAS_MODE_ALIASED);
+    context->DrawGeometry(geometry.get(), brush, strokeWidth);
+    context->PopAxisAlignedClip();
+    return S_OK;
+}
+
+void GfxSeriesPolyline::addColumnPoints(const D2D_RECT_F& rect, const View& view, float columnWidth) {
+    const float valueRange = view.maxValue != view.minValue ? view.maxValue - view.minValue : 1.f;
+    const float scale = (rect.bottom - rect.top) / valueRange;
+    auto y = [&](float value) { return rect.bottom - (value - view.minValue) * scale; };
+
+    // Each column is a vertical stroke from its min to its max, joined to the next one by a
+    // zigzag. A column is stretched to reach the range of the previous one, a steep edge spanning
+    // two columns would show a gap otherwise.
+    auto previous = GfxSeriesSummary::Range::empty();
+    size_t figureStart = points_.size();
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        auto column = columns_[i];
+        if (column.isEmpty()) {
+            previous = column;
+            continue;
+        }
+        if (previous.isEmpty()) {
+            figureStart = points_.size();
+            figures_.push_back(figureStart);
+        } else {
+            column.min = std::min(column.min, previous.max);
+            column.max = std::max(column.max, previous.min);
+        }
+        previous = columns_[i];
+
+        float x = rect.left + (static_cast<float>(i) + 0.5f) * columnWidth;
+        bool upward = (points_.size() - figureStart) % 4 == 0;
+        points_.push_back(D2D1::Point2F(x, y(upward ? column.min : column.max)));
+        points_.push_back(D2D1::Point2F(x, y(upward ? column.max : column.min)));
+    }
+}
+
+void GfxSeriesPolyline::addSamplePoints(const GfxSeriesSummary& series, const D2D_RECT_F& rect, const View& view) {
+    const float valueRange = view.maxValue != view.minValue ? view.maxValue - view.minValue : 1.f;
+    const float scale = (rect.bottom - rect.top) / valueRange;
+    const auto& samples = series.samples();
+
+    // One sample beyond each edge, so the line reaches the edges of the rect.
+    double lastSample = view.firstSample + (rect.right - rect.left) * view.samplesPerDip;
+    auto begin = static_cast<size_t>(std::max(std::floor(view.firstSample), 0.0));
+    auto end = static_cast<size_t>(std::min(std::ceil(lastSample) + 1, static_cast<double>(samples.size())));
+    if (begin >= end) {
+        return;
+    }
+    figures_.push_back(points_.size());
+    for (size_t i = begin; i < end; ++i) {
+        float x = rect.left + static_cast<float>((static_cast<double>(i) - view.firstSample) / view.samplesPerDip);
+        points_.push_back(D2D1::Point2F(x, rect.bottom - (samples[i] - view.minValue) * scale));
+    }
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <vector>
+
+#include "./GfxSeriesSummary.h"
+
+namespace winui_drover_island {
+
+// Draws a GfxSeriesSummary as a polyline reduced to one min/max column per device pixel, so the
+// cost of a redraw depends on the width of the view, not on the number of samples. Zoomed in
+// past one sample per pixel, the samples themselves are drawn.
+class GfxSeriesPolyline {
+ public:
+    struct View {
+        // The sample at the left edge of the rect; fractional while scrolling smoothly.
+        double firstSample = 0;
+        double samplesPerDip = 1;
+        // The values at the bottom and at the top of the rect.
+        float minValue = -1.f;
+        float maxValue = 1.f;
+    };
+
+    // The columns follow the DPI of the context.
+    HRESULT draw(const winrt::com_ptr<ID2D1DeviceContext>& context, const GfxSeriesSummary& series, const D2D_RECT_F& rect,
+        const View& view, ID2D1Brush* brush, float strokeWidth = 1.f);
+
+ private:
+    void addColumnPoints(const D2D_RECT_F& rect, const View& view, float columnWidth);
+    void addSamplePoints(const GfxSeriesSummary& series, const D2D_RECT_F& rect, const View& view);
+
+    // Reused by each draw.
+    std::vector<GfxSeriesSummary::Range> columns_;
+    std::vector<D2D1_POINT_2F> points_;
+    // Where each figure of points_ starts.
+    std::vector<size_t> figures_;
+};
+
+}  // namespace winui_drover_island
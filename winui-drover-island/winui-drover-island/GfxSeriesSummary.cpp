@@ -0,0 +1,168 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxSeriesSummary.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#define GFX_SERIES_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace winui_drover_island {
+
+GfxSeriesSummary::Range GfxSeriesSummary::Range::empty() {
+    return {std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+}
+
+GfxSeriesSummary::Range GfxSeriesSummary::minMax(const float* samples, size_t count) {
+    auto result = Range::empty();
+    size_t i = 0;
+#if GFX_SERIES_SSE2
+    if (count >= 8) {
+        // Two accumulators per bound hide the latency of minps/maxps.
+        auto min0 = _mm_loadu_ps(samples);
+        auto max0 = min0;
+        auto min1 = _mm_loadu_ps(samples + 4);
+        auto max1 = min1;
+        for (i = 8; i + 8 <= count; i += 8) {
+            auto a = _mm_loadu_ps(samples + i);
+            auto b = _mm_loadu_ps(samples + i + 4);
+            min0 = _mm_min_ps(min0, a);
+            max0 = _mm_max_ps(max0, a);
+            min1 = _mm_min_ps(min1, b);
+            max1 = _mm_max_ps(max1, b);
+        }
+        auto minimum = _mm_min_ps(min0, min1);
+        auto maximum = _mm_max_ps(max0, max1);
+        minimum = _mm_min_ps(minimum, _mm_shuffle_ps(minimum, minimum, _MM_SHUFFLE(1, 0, 3, 2)));
+        maximum = _mm_max_ps(maximum, _mm_shuffle_ps(maximum, maximum, _MM_SHUFFLE(1, 0, 3, 2)));
+        minimum = _mm_min_ss(minimum, _mm_shuffle_ps(minimum, minimum, _MM_SHUFFLE(2, 3, 0, 1)));
+        maximum = _mm_max_ss(maximum, _mm_shuffle_ps(maximum, maximum, _MM_SHUFFLE(2, 3, 0, 1)));
+        result.min = _mm_cvtss_f32(minimum);
+        result.max = _mm_cvtss_f32(maximum);
+    }
+#endif
+    for (; i < count; ++i) {
+        result.min = samples[i] < result.min ? samples[i] : result.min;
+        result.max = samples[i] > result.max ? samples[i] : result.max;
+    }
+    return result;
+}
+
+void GfxSeriesSummary::append(const float* samples, size_t count) {
+    samples_.insert(samples_.end(), samples, samples + count);
+
+    // Only complete blocks are summarized, the partial ones at the end are read from the samples.
+    if (levels_.empty()) {
+        levels_.emplace_back();
+    }
+    size_t completeBlocks = samples_.size() / kBlockSize;
+    for (size_t block = levels_[0].size(); block < completeBlocks; ++block) {
+        levels_[0].push_back(minMax(samples_.data() + block * kBlockSize, kBlockSize));
+    }
+    for (size_t level = 0; levels_[level].size() >= kFanout; ++level) {
+        if (levels_.size() == level + 1) {
+            levels_.emplace_back();
+        }
+        const auto& lower = levels_[level];
+        auto& upper = levels_[level + 1];
+        for (size_t entry = upper.size(); entry < lower.size() / kFanout; ++entry) {
+            auto range = Range::empty();
+            for (size_t i = 0; i < kFanout; ++i) {
+                range.add(lower[entry * kFanout + i]);
+            }
+            upper.push_back(range);
+        }
+    }
+}
+
+void GfxSeriesSummary::reserve(size_t samples) {
+    samples_.reserve(samples);
+    size_t entries = samples / kBlockSize;
+    for (size_t level = 0; level == 0 || entries > 0; ++level, entries /= kFanout) {
+        if (levels_.size() == level) {
+            levels_.emplace_back();
+        }
+        levels_[level].reserve(entries);
+    }
+}
+
+void GfxSeriesSummary::clear() {
+    samples_.clear();
+    // The levels stay, empty, with their memory.
+    for (auto& level : levels_) {
+        level.clear();
+    }
+}
+
+size_t GfxSeriesSummary::summaryBytes() const {
+    size_t bytes = 0;
+    for (const auto& level : levels_) {
+        bytes += level.capacity() * sizeof(Range);
+    }
+    return bytes;
+}
+
+GfxSeriesSummary::Range GfxSeriesSummary::range(size_t begin, size_t end) const {
+    auto result = Range::empty();
+    end = std::min(end, samples_.size());
+    if (begin >= end) {
+        return result;
+    }
+
+    // The samples before the first and after the last whole block.
+    size_t headEnd = std::min(end, (begin + kBlockSize - 1) / kBlockSize * kBlockSize);
+    result.add(minMax(samples_.data() + begin, headEnd - begin));
+    size_t tailBegin = std::max(headEnd, end / kBlockSize * kBlockSize);
+    result.add(minMax(samples_.data() + tailBegin, end - tailBegin));
+
+    // Then up the pyramid: the entries not aligned on the next level are read at this one.
+    size_t low = headEnd / kBlockSize;
+    size_t high = tailBegin / kBlockSize;
+    for (size_t level = 0; low < high && level < levels_.size(); ++level) {
+        const auto& entries = levels_[level];
+        if (level + 1 == levels_.size()) {
+            for (; low < high; ++low) {
+                result.add(entries[low]);
+            }
+            break;
+        }
+        for (; low < high && low % kFanout != 0; ++low) {
+            result.add(entries[low]);
+        }
+        for (; low < high && high % kFanout != 0; --high) {
+            result.add(entries[high - 1]);
+        }
+        low /= kFanout;
+        high /= kFanout;
+    }
+    return result;
+}
+
+void GfxSeriesSummary::decimate(double firstSample, double samplesPerColumn, Range* columns, size_t columnCount) const {
+    const auto size = static_cast<double>(samples_.size());
+    for (size_t i = 0; i < columnCount; ++i) {
+        double columnBegin = std::floor(firstSample + static_cast<double>(i) * samplesPerColumn);
+        double columnEnd = std::floor(firstSample + static_cast<double>(i + 1) * samplesPerColumn);
+        columnEnd = std::min(std::max(columnEnd, columnBegin + 1), size);
+        columnBegin = std::max(columnBegin, 0.0);
+        columns[i] = columnBegin < columnEnd ? range(static_cast<size_t>(columnBegin), static_cast<size_t>(columnEnd))
+                                             : Range::empty();
+    }
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace winui_drover_island {
+
+// A data series, one value per sample, with a min/max pyramid over it: level zero holds the range
+// of each block of kBlockSize samples, each next level the range of kFanout entries of the level
+// below. The range of any span of samples is then read from a few entries per level, so
+// reducing a series to pixel columns costs O(columns * levels) whatever the number of samples.
+// Appending updates the pyramid incrementally. Samples must not be NaN.
+class GfxSeriesSummary {
+ public:
+    static constexpr size_t kBlockSize = 16;
+    static constexpr size_t kFanout = 4;
+
+    struct Range {
+        float min;
+        float max;
+
+        // The range of no sample: min is larger than max.
+        static Range empty();
+        bool isEmpty() const { return min > max; }
+        void add(const Range& other) {
+            min = other.min < min ? other.min : min;
+            max = other.max > max ? other.max : max;
+        }
+    };
+
+    // The range of the samples. Uses SSE2 where available.
+    static Range minMax(const float* samples, size_t count);
+
+    void append(const float* samples, size_t count);
+    void append(float sample) { append(&sample, 1); }
+    // Appending up to that many samples then doesn't allocate, clearing keeps the memory.
+    void reserve(size_t samples);
+    void clear();
+
+    size_t size() const { return samples_.size(); }
+    const std::vector<float>& samples() const { return samples_; }
+    // The memory used by the pyramid, on top of the samples.
+    size_t summaryBytes() const;
+
+    // The range of the samples [begin, end), empty when the span is.
+    Range range(size_t begin, size_t end) const;
+
+    // Column i gets the range of the samples [firstSample + i * samplesPerColumn,
+    // firstSample + (i + 1) * samplesPerColumn). Columns always cover at least the sample they
+    // start in, so zooming in past one sample per column doesn't leave holes; columns beyond the
+    // series are empty.
+    void decimate(double firstSample, double samplesPerColumn, Range* columns, size_t columnCount) const;
+
+ private:
+    std::vector<float> samples_;
+    std::vector<std::vector<Range>> levels_;
+};
+
+}  // namespace winui_drover_island
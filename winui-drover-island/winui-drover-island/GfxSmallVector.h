@@ -0,0 +1,85 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace winui_drover_island {
+
+// Vector of trivially copyable values that keeps up to N elements inline and only touches the
+// heap past that. Heap storage is kept across clear() so a reused instance stops allocating.
+template <typename T, size_t N>
+class GfxSmallVector {
+    static_assert(std::is_trivially_copyable<T>::value, "GfxSmallVector only holds trivially copyable values");
+
+ public:
+    GfxSmallVector() = default;
+
+    GfxSmallVector(GfxSmallVector const&) = delete;
+    GfxSmallVector& operator=(GfxSmallVector const&) = delete;
+
+    // Resizes without preserving the content, the values are expected to be overwritten.
+    void resizeForOverwrite(size_t size) {
+        if (size > N && heap_.size() < size) {
+            heap_.resize(size);
+        }
+        size_ = size;
+    }
+
+    void clear() { size_ = 0; }
+
+    void push_back(const T& value) {
+        if (size_ < N) {
+            inline_[size_++] = value;
+            return;
+        }
+        if (size_ == N) {
+            heap_.assign(inline_.begin(), inline_.end());
+        }
+        heap_.resize(size_);
+        heap_.push_back(value);
+        size_++;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T* data() { return size_ > N ? heap_.data() : inline_.data(); }
+    const T* data() const { return size_ > N ? heap_.data() : inline_.data(); }
+
+    T* begin() { return data(); }
+    T* end() { return data() + size_; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size_; }
+
+    T& operator[](size_t index) {
+        assert(index < size_);
+        return data()[index];
+    }
+    const T& operator[](size_t index) const {
+        assert(index < size_);
+        return data()[index];
+    }
+
+ private:
+    std::array<T, N> inline_{};
+    std::vector<T> heap_;
+    size_t size_ = 0;
+};
+
+}  // namespace winui_drover_island
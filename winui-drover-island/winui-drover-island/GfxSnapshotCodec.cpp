@@ -0,0 +1,208 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxSnapshotCodec.h"
+
+#include <cstring>
+
+namespace winui_drover_island {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x504e5347;  // "GSNP"
+constexpr uint32_t kVersion = 1;
+// Larger images are never captured, this bounds what a corrupted header can make us allocate.
+constexpr int32_t kMaxDimension = 16384;
+
+// The op codes follow the layout of the QOI format.
+constexpr uint8_t kOpIndex = 0x00;
+constexpr uint8_t kOpDiff = 0x40;
+constexpr uint8_t kOpLuma = 0x80;
+constexpr uint8_t kOpRun = 0xc0;
+constexpr uint8_t kOpColor = 0xfe;
+constexpr uint8_t kOpColorAlpha = 0xff;
+constexpr uint8_t kOpMask = 0xc0;
+constexpr int kMaxRun = 62;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+};
+
+struct Pixel {
+    uint8_t b, g, r, a;
+
+    bool operator==(const Pixel& other) const { return b == other.b && g == other.g && r == other.r && a == other.a; }
+    bool operator!=(const Pixel& other) const { return !(*this == other); }
+};
+static_assert(sizeof(Pixel) == 4, "Pixels map to the BGRA layout");
+
+inline size_t cacheIndex(const Pixel& p) {
+    return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) & 63;
+}
+
+}  // namespace
+
+void GfxSnapshotCodec::encode(const uint8_t* pixels, int32_t width, int32_t height, size_t stride, std::vector<uint8_t>& output) {
+    output.clear();
+    if (width <= 0 || height <= 0 || width > kMaxDimension || height > kMaxDimension) {
+        return;
+    }
+    // Worst case is one color op per pixel; the output is trimmed at the end.
+    output.resize(sizeof(Header) + static_cast<size_t>(width) * height * 5);
+    Header header{kMagic, kVersion, width, height};
+    std::memcpy(output.data(), &header, sizeof(header));
+    uint8_t* out = output.data() + sizeof(Header);
+
+    Pixel cache[64] = {};
+    Pixel previous{0, 0, 0, 255};
+    int run = 0;
+    for (int32_t y = 0; y < height; ++y) {
+        const auto* row = reinterpret_cast<const Pixel*>(pixels + stride * y);
+        for (int32_t x = 0; x < width; ++x) {
+            Pixel pixel;
+            std::memcpy(&pixel, row + x, sizeof(pixel));
+            if (pixel == previous) {
+                if (++run == kMaxRun) {
+                    *out++ = static_cast<uint8_t>(kOpRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0) {
+                *out++ = static_cast<uint8_t>(kOpRun | (run - 1));
+                run = 0;
+            }
+
+            auto index = cacheIndex(pixel);
+            if (cache[index] == pixel) {
+                *out++ = static_cast<uint8_t>(kOpIndex | index);
+            } else {
+                cache[index] = pixel;
+                if (pixel.a == previous.a) {
+                    int dr = static_cast<int8_t>(pixel.r - previous.r);
+                    int dg = static_cast<int8_t>(pixel.g - previous.g);
+                    int db = static_cast<int8_t>(pixel.b - previous.b);
+                    int drg = dr - dg;
+                    int dbg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        *out++ = static_cast<uint8_t>(kOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+                    } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7) {
+                        *out++ = static_cast<uint8_t>(kOpLuma | (dg + 32));
+                        *out++ = static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8));
+                    } else {
+                        *out++ = kOpColor;
+                        *out++ = pixel.r;
+                        *out++ = pixel.g;
+                        *out++ = pixel.b;
+                    }
+                } else {
+                    *out++ = kOpColorAlpha;
+                    *out++ = pixel.r;
+                    *out++ = pixel.g;
+                    *out++ = pixel.b;
+                    *out++ = pixel.a;
+                }
+            }
+            previous = pixel;
+        }
+    }
+    if (run > 0) {
+        *out++ = static_cast<uint8_t>(kOpRun | (run - 1));
+    }
+    output.resize(static_cast<size_t>(out - output.data()));
+}
+
+bool GfxSnapshotCodec::decode(const uint8_t* data, size_t size, GfxSnapshotImage& image) {
+    image = {};
+    Header header;
+    if (!data || size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion || header.width <= 0 || header.height <= 0 ||
+        header.width > kMaxDimension || header.height > kMaxDimension) {
+        return false;
+    }
+
+    size_t pixelCount = static_cast<size_t>(header.width) * header.height;
+    // Each op yields a run at most, so a truncated file is rejected before allocating its pixels.
+    if ((size - sizeof(header)) * kMaxRun < pixelCount) {
+        return false;
+    }
+    image.pixels.resize(pixelCount * sizeof(Pixel));
+    auto* out = reinterpret_cast<Pixel*>(image.pixels.data());
+    const uint8_t* in = data + sizeof(header);
+    const uint8_t* end = data + size;
+
+    Pixel cache[64] = {};
+    Pixel pixel{0, 0, 0, 255};
+    size_t written = 0;
+    while (written < pixelCount) {
+        if (in == end) {
+            image = {};
+            return false;
+        }
+        uint8_t op = *in++;
+        if (op == kOpColor || op == kOpColorAlpha) {
+            size_t length = op == kOpColor ? 3 : 4;
+            if (static_cast<size_t>(end - in) < length) {
+                image = {};
+                return false;
+            }
+            pixel.r = in[0];
+            pixel.g = in[1];
+            pixel.b = in[2];
+            if (op == kOpColorAlpha) {
+                pixel.a = in[3];
+            }
+            in += length;
+        } else if ((op & kOpMask) == kOpIndex) {
+            pixel = cache[op];
+        } else if ((op & kOpMask) == kOpDiff) {
+            pixel.r = static_cast<uint8_t>(pixel.r + ((op >> 4) & 3) - 2);
+            pixel.g = static_cast<uint8_t>(pixel.g + ((op >> 2) & 3) - 2);
+            pixel.b = static_cast<uint8_t>(pixel.b + (op & 3) - 2);
+        } else if ((op & kOpMask) == kOpLuma) {
+            if (in == end) {
+                image = {};
+                return false;
+            }
+            int dg = (op & 0x3f) - 32;
+            uint8_t second = *in++;
+            pixel.r = static_cast<uint8_t>(pixel.r + dg - 8 + (second >> 4));
+            pixel.g = static_cast<uint8_t>(pixel.g + dg);
+            pixel.b = static_cast<uint8_t>(pixel.b + dg - 8 + (second & 15));
+        } else {
+            size_t run = static_cast<size_t>(op & 0x3f) + 1;
+            if (run > pixelCount - written) {
+                image = {};
+                return false;
+            }
+            for (size_t i = 0; i < run; ++i) {
+                out[written++] = pixel;
+            }
+            continue;
+        }
+        cache[cacheIndex(pixel)] = pixel;
+        out[written++] = pixel;
+    }
+
+    image.width = header.width;
+    image.height = header.height;
+    return true;
+}
+
+}  // namespace winui_drover_island
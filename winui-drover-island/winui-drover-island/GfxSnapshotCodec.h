@@ -0,0 +1,40 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace winui_drover_island {
+
+struct GfxSnapshotImage {
+    int32_t width = 0;
+    int32_t height = 0;
+    // Premultiplied BGRA, rows are tightly packed.
+    std::vector<uint8_t> pixels;
+};
+
+// Lossless codec for the frames shown at startup and the tiles kept compressed in memory. It
+// favors speed over size: a single pass with a small cache of recent pixels, and runs for flat
+// areas, which UI content is mostly made of.
+class GfxSnapshotCodec {
+ public:
+    static void encode(const uint8_t* pixels, int32_t width, int32_t height, size_t stride, std::vector<uint8_t>& output);
+
+    // Fails on truncated or corrupted data, the image is left empty then.
+    static bool decode(const uint8_t* data, size_t size, GfxSnapshotImage& image);
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,80 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxSnapshotRenderer.h"
+#include "./GfxUtils.h"
+
+#include <cassert>
+#include <cstring>
+
+#include <robuffer.h>
+
+#include "winrt/Windows.Storage.Streams.h"
+
+namespace winui_drover_island {
+
+winrt::Microsoft::UI::Xaml::Media::Imaging::WriteableBitmap GfxSnapshotRenderer::load(const GfxSnapshotStore::Key& key) {
+    GfxSnapshotImage snapshot;
+    if (!GfxSnapshotStore::instance().load(key, snapshot)) {
+        return nullptr;
+    }
+    winrt::Microsoft::UI::Xaml::Media::Imaging::WriteableBitmap bitmap(snapshot.width, snapshot.height);
+    auto buffer = bitmap.PixelBuffer();
+    assert(buffer.Capacity() >= snapshot.pixels.size());
+    uint8_t* bytes = nullptr;
+    winrt::check_hresult(buffer.as<::Windows::Storage::Streams::IBufferByteAccess>()->Buffer(&bytes));
+    memcpy(bytes, snapshot.pixels.data(), snapshot.pixels.size());
+    bitmap.Invalidate();
+    return bitmap;
+}
+
+HRESULT GfxSnapshotRenderer::capture(GfxD2DDevice& device, const GfxSnapshotStore::Key& key, const D2D1_SIZE_F& sizeInDips,
+    const DrawFn& draw) {
+    const auto dpi = key.dpi;
+    auto size = D2D1::SizeU(static_cast<UINT32>(key.widthInPixels), static_cast<UINT32>(key.heightInPixels));
+    auto pixelFormat = D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED);
+
+    auto lease = device.leaseResourceCreationDeviceContext();
+    winrt::com_ptr<ID2D1DeviceContext> context;
+    context.copy_from(lease.context().get());
+
+    winrt::com_ptr<ID2D1Bitmap1> target;
+    ReturnIfFailed(context->CreateBitmap(size, nullptr, 0,
+        D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_TARGET, pixelFormat, dpi, dpi), target.put()));
+    context->SetTarget(target.get());
+    context->SetDpi(dpi, dpi);
+    context->SetTransform(D2D1::Matrix3x2F::Identity());
+    context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+    context->BeginDraw();
+    context->Clear();
+    draw(context, D2D_RECT_F{0, 0, sizeInDips.width, sizeInDips.height});
+    HRESULT hr = context->EndDraw();
+    context->SetTarget(nullptr);
+    ReturnIfFailed(hr);
+
+    winrt::com_ptr<ID2D1Bitmap1> readback;
+    ReturnIfFailed(context->CreateBitmap(size, nullptr, 0,
+        D2D1::BitmapProperties1(D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW, pixelFormat, dpi, dpi),
+        readback.put()));
+    ReturnIfFailed(readback->CopyFromBitmap(nullptr, target.get(), nullptr));
+
+    D2D1_MAPPED_RECT mapped = {};
+    ReturnIfFailed(readback->Map(D2D1_MAP_OPTIONS_READ, &mapped));
+    hr = GfxSnapshotStore::instance().save(key, mapped.bits, mapped.pitch);
+    readback->Unmap();
+    return hr;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,42 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <functional>
+
+#include "./GfxD2DDeviceManager.h"
+#include "./GfxSnapshotStore.h"
+#include "winrt/base.h"
+#include "winrt/Microsoft.UI.Xaml.Media.Imaging.h"
+
+namespace winui_drover_island {
+
+// Moves the frames of a control between GfxSnapshotStore and the screen: a stored snapshot
+// becomes a bitmap the control shows until its first frame, and the layers of the control are
+// drawn again at full resolution to be stored. Used on the UI thread only.
+class GfxSnapshotRenderer {
+ public:
+    using DrawFn = std::function<void(const winrt::com_ptr<ID2D1DeviceContext>&, const D2D_RECT_F&)>;
+
+    // Null when there is no snapshot of the key. Throws on failure.
+    static winrt::Microsoft::UI::Xaml::Media::Imaging::WriteableBitmap load(const GfxSnapshotStore::Key& key);
+
+    // The frame drawn by draw, in DIPs, at the size and DPI of the key. The surface may show a
+    // reduced resolution, and can't be read back anyway.
+    static HRESULT capture(GfxD2DDevice& device, const GfxSnapshotStore::Key& key, const D2D1_SIZE_F& sizeInDips, const DrawFn& draw);
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,188 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxSnapshotStore.h"
+#include "./GfxUtils.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include <winrt/Windows.Storage.h>
+
+namespace winui_drover_island {
+
+namespace {
+
+constexpr uint32_t kFileMagic = 0x4b4e5347;  // "GSNK"
+constexpr uint32_t kFileVersion = 1;
+// Anything larger isn't a snapshot we wrote.
+constexpr uint32_t kMaxFileSize = 256 * 1024 * 1024;
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t widthInPixels;
+    int32_t heightInPixels;
+    float dpi;
+    uint32_t payloadSize;
+};
+
+bool readAll(HANDLE file, void* data, DWORD size) {
+    DWORD read = 0;
+    return ReadFile(file, data, size, &read, nullptr) && read == size;
+}
+
+bool writeAll(HANDLE file, const void* data, DWORD size) {
+    DWORD written = 0;
+    return WriteFile(file, data, size, &written, nullptr) && written == size;
+}
+
+}  // namespace
+
+GfxSnapshotStore& GfxSnapshotStore::instance() {
+    static GfxSnapshotStore obj;
+    return obj;
+}
+
+const std::wstring& GfxSnapshotStore::directory() {
+    if (directoryResolved_) {
+        return directory_;
+    }
+    directoryResolved_ = true;
+    try {
+        // Packaged apps have a cache folder the system may clean up, which is what snapshots are.
+        directory_ = winrt::Windows::Storage::ApplicationData::Current().LocalCacheFolder().Path().c_str();
+    } catch (const winrt::hresult_error&) {
+        wchar_t tempPath[MAX_PATH + 1] = {};
+        if (GetTempPathW(_countof(tempPath), tempPath) == 0) {
+            Logger::warn("GetTempPathW has failed, snapshots are disabled");
+            return directory_;
+        }
+        directory_ = tempPath;
+        directory_ += L"winui-drover-island";
+        CreateDirectoryW(directory_.c_str(), nullptr);
+    }
+    directory_ += L"\\Snapshots";
+    if (!CreateDirectoryW(directory_.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS) {
+        Logger::warn("Failed to create the snapshot directory, snapshots are disabled");
+        directory_.clear();
+    }
+    return directory_;
+}
+
+std::wstring GfxSnapshotStore::pathFor(const std::wstring& name) {
+    const auto& folder = directory();
+    if (folder.empty() || name.empty()) {
+        return {};
+    }
+    // Names come from the controls, only keep what is valid in any file name.
+    std::wstring fileName = name;
+    std::replace_if(fileName.begin(), fileName.end(), [](wchar_t c) { return !iswalnum(c) && c != L'-' && c != L'_'; }, L'_');
+    return folder + L"\\" + fileName + L".snapshot";
+}
+
+bool GfxSnapshotStore::load(const Key& key, GfxSnapshotImage& image) {
+    image = {};
+    auto path = pathFor(key.name);
+    if (path.empty()) {
+        return false;
+    }
+    winrt::file_handle file{CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+    if (!file) {
+        return false;
+    }
+
+    FileHeader header;
+    if (!readAll(file.get(), &header, sizeof(header)) || header.magic != kFileMagic || header.version != kFileVersion) {
+        return false;
+    }
+    if (header.widthInPixels != key.widthInPixels || header.heightInPixels != key.heightInPixels || header.dpi != key.dpi) {
+        // Taken at another size or DPI, showing it would only make the first frame jump.
+        return false;
+    }
+    if (header.payloadSize == 0 || header.payloadSize > kMaxFileSize) {
+        return false;
+    }
+    std::vector<uint8_t> payload(header.payloadSize);
+    if (!readAll(file.get(), payload.data(), header.payloadSize)) {
+        return false;
+    }
+    return GfxSnapshotCodec::decode(payload.data(), payload.size(), image) && image.width == key.widthInPixels &&
+           image.height == key.heightInPixels;
+}
+
+HRESULT GfxSnapshotStore::save(const Key& key, const uint8_t* pixels, size_t stride) {
+    auto path = pathFor(key.name);
+    if (path.empty()) {
+        return E_FAIL;
+    }
+    GfxSnapshotCodec::encode(pixels, key.widthInPixels, key.heightInPixels, stride, encoded_);
+    if (encoded_.empty() || encoded_.size() > kMaxFileSize) {
+        return E_INVALIDARG;
+    }
+
+    // Written next to the previous snapshot and swapped in, so a crash never leaves half a file.
+    auto tempPath = path + L".tmp";
+    {
+        winrt::file_handle file{CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)};
+        if (!file) {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+        FileHeader header{kFileMagic, kFileVersion, key.widthInPixels, key.heightInPixels, key.dpi,
+            static_cast<uint32_t>(encoded_.size())};
+        if (!writeAll(file.get(), &header, sizeof(header)) ||
+            !writeAll(file.get(), encoded_.data(), static_cast<DWORD>(encoded_.size()))) {
+            HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+            file.close();
+            DeleteFileW(tempPath.c_str());
+            return hr;
+        }
+    }
+    if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        DeleteFileW(tempPath.c_str());
+        return hr;
+    }
+    return S_OK;
+}
+
+void GfxSnapshotStore::remove(const std::wstring& name) {
+    auto path = pathFor(name);
+    if (!path.empty()) {
+        DeleteFileW(path.c_str());
+    }
+}
+
+void GfxSnapshotStore::addSource(GfxSnapshotSource* source) {
+    assert(std::find(sources_.begin(), sources_.end(), source) == sources_.end());
+    sources_.push_back(source);
+}
+
+void GfxSnapshotStore::removeSource(GfxSnapshotSource* source) {
+    sources_.erase(std::remove(sources_.begin(), sources_.end(), source), sources_.end());
+}
+
+void GfxSnapshotStore::saveAll() {
+    // Saving runs user draw code, which may add or remove controls; iterate over a copy.
+    auto sources = sources_;
+    for (auto* source : sources) {
+        if (std::find(sources_.begin(), sources_.end(), source) != sources_.end()) {
+            source->saveSnapshot();
+        }
+    }
+}
+
+}  // namespace winui_drover_island
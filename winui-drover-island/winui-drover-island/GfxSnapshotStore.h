@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <Windows.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "./GfxSnapshotCodec.h"
+
+namespace winui_drover_island {
+
+class GfxSnapshotSource {
+ public:
+    virtual ~GfxSnapshotSource() = default;
+
+    // Captures the current frame into the store. Sources that have nothing on screen do nothing.
+    virtual void saveSnapshot() = 0;
+};
+
+// Keeps the last frame of the controls on disk, so the next launch can show it before the device
+// exists and the first real frame is drawn. There is one file per control name; the size and DPI
+// are part of the key, a snapshot taken at another size or DPI is never shown.
+// The store is used on the UI thread only.
+class GfxSnapshotStore {
+ public:
+    struct Key {
+        std::wstring name;
+        int32_t widthInPixels = 0;
+        int32_t heightInPixels = 0;
+        float dpi = 0;
+    };
+
+    static GfxSnapshotStore& instance();
+
+    bool load(const Key& key, GfxSnapshotImage& image);
+    // The pixels are premultiplied BGRA, of the size in the key.
+    HRESULT save(const Key& key, const uint8_t* pixels, size_t stride);
+    void remove(const std::wstring& name);
+
+    void addSource(GfxSnapshotSource* source);
+    void removeSource(GfxSnapshotSource* source);
+    // Called when the app suspends or its window closes.
+    void saveAll();
+
+ private:
+    GfxSnapshotStore() = default;
+
+    const std::wstring& directory();
+    std::wstring pathFor(const std::wstring& name);
+
+    std::vector<GfxSnapshotSource*> sources_;
+    // Reused by every save, snapshots are all of similar sizes.
+    std::vector<uint8_t> encoded_;
+    std::wstring directory_;
+    bool directoryResolved_ = false;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,209 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxStressScenario.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace winui_drover_island {
+
+namespace {
+
+// SplitMix64: the same sequence on every platform and standard library, unlike the distributions
+// of <random>.
+uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// In [0, 1).
+double nextUnit(uint64_t& state) {
+    return static_cast<double>(nextRandom(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// The whole text must parse, as a finite number.
+bool parseNumber(std::string_view text, double& value) {
+    std::string copy(text);
+    char* end = nullptr;
+    double parsed = std::strtod(copy.c_str(), &end);
+    if (copy.empty() || end != copy.c_str() + copy.size() || !std::isfinite(parsed)) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+}  // namespace
+
+bool GfxStressScenario::parseArgument(std::string_view argument, Options& options) {
+    constexpr std::string_view kPrefix = "--stress-";
+    auto separator = argument.find('=');
+    if (argument.substr(0, kPrefix.size()) != kPrefix || separator == std::string_view::npos) {
+        return false;
+    }
+    auto name = argument.substr(kPrefix.size(), separator - kPrefix.size());
+    double value = 0;
+    if (!parseNumber(argument.substr(separator + 1), value)) {
+        return false;
+    }
+    auto isCount = [&](double max) { return value >= 1 && value <= max && value == std::floor(value); };
+    bool isFraction = value >= 0 && value <= 1;
+    if (name == "controls" && isCount(100000)) {
+        options.controlCount = static_cast<uint32_t>(value);
+    } else if (name == "columns" && isCount(10000)) {
+        options.columns = static_cast<uint32_t>(value);
+    } else if (name == "min-rate" && value > 0) {
+        options.minInvalidationsPerSecond = value;
+    } else if (name == "max-rate" && value > 0) {
+        options.maxInvalidationsPerSecond = value;
+    } else if (name == "partial" && isFraction) {
+        options.partialInvalidationFraction = static_cast<float>(value);
+    } else if (name == "virtual" && isFraction) {
+        options.virtualSurfaceFraction = static_cast<float>(value);
+    } else if (name == "duration" && value > 0 && value <= 24 * 3600) {
+        options.duration = std::chrono::microseconds(static_cast<int64_t>(value * 1000000));
+    } else if (name == "seed" && value >= 0 && value < 9007199254740992.0 && value == std::floor(value)) {
+        // Exact as a double up to 2^53.
+        options.seed = static_cast<uint64_t>(value);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+GfxStressScenario::GfxStressScenario(const Options& options) : options_(options) {
+    options_.columns = std::max(options_.columns, 1u);
+    options_.minInvalidationsPerSecond = std::max(options_.minInvalidationsPerSecond, 0.001);
+    options_.maxInvalidationsPerSecond = std::max(options_.maxInvalidationsPerSecond, options_.minInvalidationsPerSecond);
+    createControls();
+}
+
+uint32_t GfxStressScenario::rowCount() const {
+    return (options_.controlCount + options_.columns - 1) / options_.columns;
+}
+
+void GfxStressScenario::createControls() {
+    uint64_t random = options_.seed;
+    controls_.resize(options_.controlCount);
+    for (size_t i = 0; i < controls_.size(); ++i) {
+        auto& control = controls_[i];
+        control.source = i + 1;
+        control.kind = nextUnit(random) < options_.droverIslandFraction ? ControlKind::kDroverIsland : ControlKind::kEllipse;
+        control.useVirtualSurface = nextUnit(random) < options_.virtualSurfaceFraction;
+        control.invalidationsPerSecond = options_.minInvalidationsPerSecond +
+            (options_.maxInvalidationsPerSecond - options_.minInvalidationsPerSecond) * nextUnit(random);
+    }
+    restart();
+}
+
+void GfxStressScenario::restart() {
+    schedules_.resize(controls_.size());
+    for (size_t i = 0; i < controls_.size(); ++i) {
+        auto& schedule = schedules_[i];
+        // Every control has a stream of its own, its invalidations don't depend on the count.
+        schedule.random = options_.seed ^ (controls_[i].source * 0x9e3779b97f4a7c15ull);
+        schedule.interval = std::chrono::microseconds(std::max<int64_t>(
+            static_cast<int64_t>(1000000.0 / controls_[i].invalidationsPerSecond), 1));
+        // Spread over the first interval, the controls don't all invalidate on the same frame.
+        schedule.next = std::chrono::microseconds(static_cast<int64_t>(schedule.interval.count() * nextUnit(schedule.random)));
+    }
+    due_.clear();
+}
+
+GfxStressScenario::Invalidation GfxStressScenario::nextInvalidation(size_t control) {
+    auto& schedule = schedules_[control];
+    Invalidation invalidation;
+    invalidation.time = schedule.next;
+    invalidation.control = control;
+    invalidation.partial = nextUnit(schedule.random) < options_.partialInvalidationFraction;
+    if (invalidation.partial) {
+        float width = options_.cellWidth * options_.partialInvalidationSize;
+        float height = options_.cellHeight * options_.partialInvalidationSize;
+        float left = static_cast<float>((options_.cellWidth - width) * nextUnit(schedule.random));
+        float top = static_cast<float>((options_.cellHeight - height) * nextUnit(schedule.random));
+        invalidation.rect[0] = left;
+        invalidation.rect[1] = top;
+        invalidation.rect[2] = left + width;
+        invalidation.rect[3] = top + height;
+    }
+    schedule.next += schedule.interval;
+    return invalidation;
+}
+
+const std::vector<GfxStressScenario::Invalidation>& GfxStressScenario::advance(std::chrono::microseconds time) {
+    due_.clear();
+    time = std::min(time, options_.duration);
+    for (size_t i = 0; i < schedules_.size(); ++i) {
+        while (schedules_[i].next <= time) {
+            due_.push_back(nextInvalidation(i));
+        }
+    }
+    std::stable_sort(due_.begin(), due_.end(), [](const Invalidation& a, const Invalidation& b) { return a.time < b.time; });
+    return due_;
+}
+
+GfxEventTrace GfxStressScenario::toTrace() const {
+    using EventKind = GfxEventTrace::EventKind;
+    GfxEventTrace trace;
+    for (const auto& control : controls_) {
+        GfxEventTrace::Event event;
+        event.source = control.source;
+        if (options_.dpi != kDefaultDpi) {
+            event.kind = EventKind::kDpiChange;
+            event.values[0] = options_.dpi;
+            trace.append(event);
+        }
+        event.kind = EventKind::kResize;
+        event.values[0] = options_.cellWidth;
+        event.values[1] = options_.cellHeight;
+        trace.append(event);
+    }
+
+    GfxStressScenario scenario(options_);
+    for (const auto& invalidation : scenario.advance(options_.duration)) {
+        GfxEventTrace::Event event;
+        event.time = invalidation.time;
+        event.source = controls_[invalidation.control].source;
+        event.kind = invalidation.partial ? EventKind::kInvalidateRect : EventKind::kInvalidate;
+        if (invalidation.partial) {
+            std::copy(std::begin(invalidation.rect), std::end(invalidation.rect), event.values);
+        }
+        trace.append(event);
+    }
+    return trace;
+}
+
+GfxStressScenario::HeadlessResult GfxStressScenario::runHeadless(const GfxEventReplayer::Options& replayOptions) const {
+    auto clock = std::make_shared<GfxManualFrameClock>();
+    GfxHeadlessCanvasGroup canvases(clock);
+    for (const auto& control : controls_) {
+        if (control.useVirtualSurface) {
+            canvases.setTilingThreshold(control.source, kVirtualTileSize);
+        }
+    }
+
+    HeadlessResult result;
+    result.frames = GfxEventReplayer::replay(toTrace(), canvases, *clock, replayOptions);
+    result.canvases = canvases.stats();
+    result.surfaces = canvases.surfaceCount();
+    result.surfaceBytes = canvases.surfaceBytes();
+    return result;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "./GfxEventReplayer.h"
+#include "./GfxEventTrace.h"
+#include "./GfxHeadlessCanvas.h"
+
+namespace winui_drover_island {
+
+// A dashboard of many controls in a grid, each invalidated at its own rate. The app drives real
+// controls with it, and the same scenario runs headless against GfxHeadlessCanvas, so the way the
+// pipeline scales with the number of controls can be measured on any machine. The controls and
+// their invalidations only depend on the options: two runs with the same seed are the same.
+class GfxStressScenario {
+ public:
+    struct Options {
+        uint32_t controlCount = 300;
+        uint32_t columns = 20;
+        // The size of a control in DIPs.
+        float cellWidth = 160.f;
+        float cellHeight = 120.f;
+        float dpi = kDefaultDpi;
+        // Of the controls, the ones using a virtual surface, and the ones showing a Drover Island
+        // rather than an ellipse.
+        float virtualSurfaceFraction = 0.5f;
+        float droverIslandFraction = 0.5f;
+        // Each control is invalidated at a rate picked in this range.
+        double minInvalidationsPerSecond = 1.0;
+        double maxInvalidationsPerSecond = 60.0;
+        // Of the invalidations, the ones redrawing a rect rather than the whole control, and the
+        // size of that rect relative to the control.
+        float partialInvalidationFraction = 0.75f;
+        float partialInvalidationSize = 0.25f;
+        std::chrono::microseconds duration = std::chrono::seconds(10);
+        uint64_t seed = 1;
+    };
+
+    enum class ControlKind { kEllipse, kDroverIsland };
+
+    struct Control {
+        // The source of the control's events in the trace, from 1.
+        uint64_t source = 0;
+        ControlKind kind = ControlKind::kEllipse;
+        bool useVirtualSurface = false;
+        double invalidationsPerSecond = 0;
+    };
+
+    struct Invalidation {
+        // Since the start of the scenario.
+        std::chrono::microseconds time{};
+        // Index of the control in controls().
+        size_t control = 0;
+        bool partial = false;
+        // Left, top, right and bottom in DIPs, in the control, when partial.
+        float rect[4] = {};
+    };
+
+    explicit GfxStressScenario(const Options& options);
+
+    // Sets the option of a command line argument: --stress-controls=N, --stress-columns=N,
+    // --stress-min-rate=R and --stress-max-rate=R in invalidations per second, --stress-partial=F
+    // and --stress-virtual=F as fractions, --stress-duration=S in seconds, --stress-seed=N.
+    // Returns false, leaving the options as they are, for other arguments and bad values.
+    static bool parseArgument(std::string_view argument, Options& options);
+
+    const Options& options() const { return options_; }
+    const std::vector<Control>& controls() const { return controls_; }
+    uint32_t rowCount() const;
+
+    // Returns the invalidations due since the previous call, up to time since the start, in
+    // order. Passing the duration of the options or more returns all that are left.
+    const std::vector<Invalidation>& advance(std::chrono::microseconds time);
+    void restart();
+
+    // The whole scenario as recorded events: a resize of every control at the start, then the
+    // invalidations. Control i is source i + 1.
+    GfxEventTrace toTrace() const;
+
+    struct HeadlessResult {
+        GfxEventReplayer::Result frames;
+        // Every canvas together.
+        GfxHeadlessCanvas::Stats canvases;
+        size_t surfaces = 0;
+        size_t surfaceBytes = 0;
+    };
+
+    // Replays toTrace() against one GfxHeadlessCanvas per control, all on the same clock: the
+    // frame times are those of a tick drawing every control invalidated since the previous one.
+    // Virtual surfaces aren't modeled: what a virtual surface allocates and draws is up to the
+    // compositor. They are only split in tiles of kVirtualTileSize, which changes nothing for
+    // cells smaller than a tile, like the default ones: these run as the other surfaces do.
+    static constexpr int32_t kVirtualTileSize = 256;
+    HeadlessResult runHeadless(const GfxEventReplayer::Options& replayOptions) const;
+    HeadlessResult runHeadless() const { return runHeadless(GfxEventReplayer::Options{}); }
+
+ private:
+    struct Schedule {
+        std::chrono::microseconds next{};
+        std::chrono::microseconds interval{};
+        uint64_t random = 0;
+    };
+
+    void createControls();
+    Invalidation nextInvalidation(size_t control);
+
+    Options options_;
+    std::vector<Control> controls_;
+    std::vector<Schedule> schedules_;
+    std::vector<Invalidation> due_;
+};
+
+}  // namespace winui_drover_island
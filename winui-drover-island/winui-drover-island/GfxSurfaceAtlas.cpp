@@ -0,0 +1,199 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "pch.h"
+
+#include "./GfxSurfaceAtlas.h"
+#include "./GfxUtils.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ddraw.h>
+
+namespace winrt {
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Microsoft::UI::Xaml::Media;
+}  // namespace winrt
+
+namespace winui_drover_island {
+
+GfxSurfaceAtlas::GfxSurfaceAtlas(int32_t sizeInPixels, float dpi)
+    : layout_(sizeInPixels, sizeInPixels),
+      surface_(winrt::Imaging::SurfaceImageSource(sizeInPixels, sizeInPixels, false)),
+      frameClock_(GfxVsyncFrameClock::shared()),
+      dpi_(dpi) {
+    // Atlases are shared by visible controls, so they are accounted for but never evicted.
+    budgetEntry_ = GfxMemoryBudget::instance().add(
+        GfxMemorySubsystem::kAtlases, static_cast<size_t>(sizeInPixels) * sizeInPixels * 4);
+}
+
+GfxSurfaceAtlas::~GfxSurfaceAtlas() {
+    assert(clients_.empty());
+    GfxMemoryBudget::instance().remove(budgetEntry_);
+    if (renderingPending_) {
+        frameClock_->cancelFrame(this);
+    }
+    auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(surface_);
+    LogIfFailed(sisNative->SetDevice(nullptr), "sisNative->SetDevice(nullptr)");
+}
+
+GfxSurfaceAtlas::SlotId GfxSurfaceAtlas::addClient(GfxSurfaceAtlasClient* client, int32_t widthInPixels, int32_t heightInPixels) {
+    assert(client);
+    auto slot = layout_.addSlot(widthInPixels, heightInPixels);
+    if (slot == GfxAtlasLayout::kInvalidSlot) {
+        return slot;
+    }
+    clients_.emplace_back(slot, client);
+    scheduleDraw();
+    return slot;
+}
+
+void GfxSurfaceAtlas::removeClient(SlotId slot) {
+    auto it = std::find_if(clients_.begin(), clients_.end(), [&](const auto& entry) { return entry.first == slot; });
+    assert(it != clients_.end());
+    if (it == clients_.end()) {
+        return;
+    }
+    clients_.erase(it);
+    layout_.removeSlot(slot);
+}
+
+void GfxSurfaceAtlas::invalidate(SlotId slot) {
+    layout_.markDirty(slot);
+    scheduleDraw();
+}
+
+void GfxSurfaceAtlas::scheduleDraw() {
+    if (renderingPending_ || !layout_.hasDirtySlots()) {
+        return;
+    }
+    frameClock_->requestFrame(this);
+    renderingPending_ = true;
+}
+
+void GfxSurfaceAtlas::onFrame(GfxFrameClock::Clock::time_point) {
+    renderingPending_ = false;
+
+    HRESULT hr = drawBatch();
+    if (FAILED(hr)) {
+        LogIfFailed(hr, "GfxSurfaceAtlas::drawBatch");
+        if (isDeviceLostHResult(hr) || hr == E_SURFACE_CONTENTS_LOST) {
+            handleDeviceLost();
+        } else {
+            // The batch took the dirty flags, give them back so the slots are drawn on the next tick.
+            for (auto slot : batch_.slots) {
+                layout_.markDirty(slot);
+            }
+            scheduleDraw();
+        }
+    }
+}
+
+HRESULT GfxSurfaceAtlas::drawBatch() {
+    if (!layout_.takeBatch(batch_)) {
+        return S_OK;
+    }
+
+    auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(surface_);
+    if (!device_) {
+        device_ = GfxD2DDeviceManager::instance().sharedDevice();
+        if (!device_) {
+            Logger::warn("Failed to get the shared device");
+            return E_FAIL;
+        }
+        ReturnIfFailed(sisNative->SetDevice(device_->d2dDevice().get()));
+    }
+
+    winrt::com_ptr<ID2D1DeviceContext> context;
+    POINT offset = {};
+    ReturnIfFailed(sisNative->BeginDraw(toRECT(batch_.updateRect), __uuidof(context), context.put_void(), &offset));
+
+    offset.x -= batch_.updateRect.left;
+    offset.y -= batch_.updateRect.top;
+
+    // Gaps between the slots are part of the update rect too, so clear everything once.
+    context->Clear();
+    context->SetDpi(dpi_, dpi_);
+    context->SetTextAntialiasMode(D2D1_TEXT_ANTIALIAS_MODE_GRAYSCALE);
+
+    for (auto slot : batch_.slots) {
+        auto client = std::find_if(clients_.begin(), clients_.end(), [&](const auto& entry) { return entry.first == slot; });
+        if (client == clients_.end()) {
+            continue;
+        }
+        auto rect = layout_.slotRect(slot);
+        float originX = pixelsToDips(offset.x + rect.left, dpi_);
+        float originY = pixelsToDips(offset.y + rect.top, dpi_);
+        D2D_RECT_F slotRect{0.f, 0.f, pixelsToDips(rect.width(), dpi_), pixelsToDips(rect.height(), dpi_)};
+
+        context->SetTransform(D2D1::Matrix3x2F::Translation(originX, originY));
+        context->PushAxisAlignedClip(slotRect, D2D1_ANTIALIAS_MODE_ALIASED);
+        client->second->drawAtlasSlot(context, slotRect);
+        context->PopAxisAlignedClip();
+    }
+
+    return sisNative->EndDraw();
+}
+
+void GfxSurfaceAtlas::handleDeviceLost() {
+    auto sisNative = objectAs<ISurfaceImageSourceNativeWithD2D>(surface_);
+    LogIfFailed(sisNative->SetDevice(nullptr), "sisNative->SetDevice(nullptr)");
+    device_.reset();
+    layout_.markAllDirty();
+
+    // Clients reset asynchronously and may give up their slot while doing so.
+    auto clients = clients_;
+    for (auto& entry : clients) {
+        entry.second->atlasDeviceLost();
+    }
+}
+
+GfxSurfaceAtlasManager& GfxSurfaceAtlasManager::instance() {
+    static GfxSurfaceAtlasManager obj;
+    return obj;
+}
+
+GfxSurfaceAtlasManager::Allocation GfxSurfaceAtlasManager::allocate(
+    GfxSurfaceAtlasClient* client, int32_t widthInPixels, int32_t heightInPixels, float dpi) {
+    if (widthInPixels > kMaxSlotSizeInPixels || heightInPixels > kMaxSlotSizeInPixels) {
+        return {};
+    }
+    for (auto& atlas : atlases_) {
+        if (atlas->dpi() != dpi) {
+            continue;
+        }
+        auto slot = atlas->addClient(client, widthInPixels, heightInPixels);
+        if (slot != GfxAtlasLayout::kInvalidSlot) {
+            return {atlas, slot};
+        }
+    }
+    auto atlas = std::make_shared<GfxSurfaceAtlas>(kAtlasSizeInPixels, dpi);
+    auto slot = atlas->addClient(client, widthInPixels, heightInPixels);
+    if (slot == GfxAtlasLayout::kInvalidSlot) {
+        return {};
+    }
+    atlases_.push_back(atlas);
+    return {atlas, slot};
+}
+
+void GfxSurfaceAtlasManager::release(const Allocation& allocation) {
+    if (!allocation) {
+        return;
+    }
+    allocation.atlas->removeClient(allocation.slot);
+    if (allocation.atlas->isEmpty()) {
+        atlases_.erase(std::remove(atlases_.begin(), atlases_.end(), allocation.atlas), atlases_.end());
+    }
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,112 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <d2d1_1.h>
+
+#include <memory>
+#include <vector>
+
+#include "./GfxAtlasLayout.h"
+#include "./GfxCompositionFrameClock.h"
+#include "./GfxD2DDeviceManager.h"
+#include "./GfxMemoryBudget.h"
+#include "Microsoft.UI.Xaml.Media.DXInterop.h"
+#include "winrt/Microsoft.UI.Xaml.Media.h"
+#include "winrt/Microsoft.UI.Xaml.Media.Imaging.h"
+
+namespace winui_drover_island {
+
+class GfxSurfaceAtlasClient {
+ public:
+    virtual ~GfxSurfaceAtlasClient() = default;
+
+    // Called between the atlas BeginDraw/EndDraw. The transform and clip are already set up so
+    // that (0, 0) is the top-left corner of the client's slot.
+    virtual void drawAtlasSlot(const winrt::com_ptr<ID2D1DeviceContext>&, const D2D_RECT_F& slotRect) = 0;
+    virtual void atlasDeviceLost() = 0;
+};
+
+// A SurfaceImageSource shared by many small controls. Each client owns a slot; all the slots
+// invalidated during a frame are drawn with a single BeginDraw/EndDraw on the next rendering tick.
+// Atlases are created and used on the UI thread only.
+class GfxSurfaceAtlas : private GfxFrameClockClient {
+ public:
+    using SlotId = GfxAtlasLayout::SlotId;
+    using SurfaceImageSource = winrt::Microsoft::UI::Xaml::Media::Imaging::SurfaceImageSource;
+
+    GfxSurfaceAtlas(int32_t sizeInPixels, float dpi);
+    ~GfxSurfaceAtlas();
+
+    GfxSurfaceAtlas(GfxSurfaceAtlas const&) = delete;
+    GfxSurfaceAtlas& operator=(GfxSurfaceAtlas const&) = delete;
+
+    float dpi() const { return dpi_; }
+    int32_t sizeInPixels() const { return layout_.width(); }
+    const SurfaceImageSource& surface() const { return surface_; }
+
+    SlotId addClient(GfxSurfaceAtlasClient* client, int32_t widthInPixels, int32_t heightInPixels);
+    void removeClient(SlotId slot);
+
+    PixelRect slotRect(SlotId slot) const { return layout_.slotRect(slot); }
+
+    void invalidate(SlotId slot);
+
+    bool isEmpty() const { return layout_.isEmpty(); }
+
+ private:
+    void scheduleDraw();
+    void onFrame(GfxFrameClock::Clock::time_point now) override;
+    HRESULT drawBatch();
+    void handleDeviceLost();
+
+    GfxAtlasLayout layout_;
+    GfxAtlasLayout::Batch batch_;
+    std::vector<std::pair<SlotId, GfxSurfaceAtlasClient*>> clients_;
+    SurfaceImageSource surface_{nullptr};
+    std::shared_ptr<GfxD2DDevice> device_;
+    // Atlases are shared between controls, they always draw on composition frames.
+    std::shared_ptr<GfxVsyncFrameClock> frameClock_;
+    GfxMemoryBudget::EntryId budgetEntry_ = GfxMemoryBudget::kInvalidEntry;
+    float dpi_ = 0;
+    bool renderingPending_ = false;
+};
+
+class GfxSurfaceAtlasManager {
+ public:
+    using SlotId = GfxAtlasLayout::SlotId;
+
+    // Controls larger than this, in either dimension, keep using their own surface.
+    static constexpr int32_t kMaxSlotSizeInPixels = 256;
+    static constexpr int32_t kAtlasSizeInPixels = 1024;
+
+    struct Allocation {
+        std::shared_ptr<GfxSurfaceAtlas> atlas;
+        SlotId slot = GfxAtlasLayout::kInvalidSlot;
+
+        explicit operator bool() const { return atlas && slot != GfxAtlasLayout::kInvalidSlot; }
+    };
+
+    static GfxSurfaceAtlasManager& instance();
+
+    Allocation allocate(GfxSurfaceAtlasClient* client, int32_t widthInPixels, int32_t heightInPixels, float dpi);
+    void release(const Allocation& allocation);
+
+ private:
+    GfxSurfaceAtlasManager() = default;
+
+    std::vector<std::shared_ptr<GfxSurfaceAtlas>> atlases_;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,37 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxTileLayout.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace winui_drover_island {
+
+GfxTileLayout::GfxTileLayout(int32_t width, int32_t height, int32_t maxTileSize)
+    : width_(width), height_(height), tileSize_(std::max(maxTileSize, 1)) {
+    assert(width_ >= 0 && height_ >= 0);
+    columns_ = (width_ + tileSize_ - 1) / tileSize_;
+    rows_ = (height_ + tileSize_ - 1) / tileSize_;
+}
+
+PixelRect GfxTileLayout::tileRect(size_t index) const {
+    assert(index < tileCount());
+    auto column = static_cast<int32_t>(index % static_cast<size_t>(columns_));
+    auto row = static_cast<int32_t>(index / static_cast<size_t>(columns_));
+    int32_t left = column * tileSize_;
+    int32_t top = row * tileSize_;
+    return PixelRect{left, top, std::min(left + tileSize_, width_), std::min(top + tileSize_, height_)};
+}
+
+}  // namespace winui_drover_island
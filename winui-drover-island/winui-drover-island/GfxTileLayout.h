@@ -0,0 +1,70 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "./GfxRect.h"
+
+namespace winui_drover_island {
+
+// Splits a surface that is too large for a single bitmap into a grid of tiles no larger than
+// maxTileSize. Tiles are laid out row by row; the last column and row may be smaller.
+class GfxTileLayout {
+ public:
+    GfxTileLayout() = default;
+    GfxTileLayout(int32_t width, int32_t height, int32_t maxTileSize);
+
+    static bool needsTiling(int32_t width, int32_t height, int32_t maxTileSize) {
+        return width > maxTileSize || height > maxTileSize;
+    }
+
+    int32_t width() const { return width_; }
+    int32_t height() const { return height_; }
+    int32_t tileSize() const { return tileSize_; }
+    int32_t columns() const { return columns_; }
+    int32_t rows() const { return rows_; }
+    size_t tileCount() const { return static_cast<size_t>(columns_) * static_cast<size_t>(rows_); }
+
+    PixelRect tileRect(size_t index) const;
+
+    // Calls fn(index, tileRect) for every tile intersecting rect, in index order.
+    template <typename CALLABLE>
+    void forEachTileIntersecting(const PixelRect& rect, CALLABLE&& fn) const {
+        auto clipped = rect.intersection(PixelRect{0, 0, width_, height_});
+        if (clipped.isEmpty()) {
+            return;
+        }
+        int32_t firstColumn = clipped.left / tileSize_;
+        int32_t lastColumn = (clipped.right - 1) / tileSize_;
+        int32_t firstRow = clipped.top / tileSize_;
+        int32_t lastRow = (clipped.bottom - 1) / tileSize_;
+        for (int32_t row = firstRow; row <= lastRow; ++row) {
+            for (int32_t column = firstColumn; column <= lastColumn; ++column) {
+                auto index = static_cast<size_t>(row) * static_cast<size_t>(columns_) + static_cast<size_t>(column);
+                fn(index, tileRect(index));
+            }
+        }
+    }
+
+ private:
+    int32_t width_ = 0;
+    int32_t height_ = 0;
+    int32_t tileSize_ = 1;
+    int32_t columns_ = 0;
+    int32_t rows_ = 0;
+};
+
+}  // namespace winui_drover_island
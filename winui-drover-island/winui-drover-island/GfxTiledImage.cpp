@@ -0,0 +1,205 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxTiledImage.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+
+namespace winui_drover_island {
+
+namespace {
+
+constexpr uint32_t kMagic = 0x4d495447;  // "GTIM"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kPageSize = 4096;
+
+struct Header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t tileSize;
+    int32_t columns;
+    int32_t rows;
+    uint32_t reserved;
+};
+
+size_t alignToPage(size_t size) {
+    return (size + kPageSize - 1) & ~(kPageSize - 1);
+}
+
+int32_t tileCount(int32_t pixels, int32_t tileSize) {
+    return static_cast<int32_t>((static_cast<int64_t>(pixels) + tileSize - 1) / tileSize);
+}
+
+}  // namespace
+
+bool GfxTiledImage::open(const std::filesystem::path& path) {
+    close();
+    if (!file_.open(path)) {
+        return false;
+    }
+    Header header;
+    if (file_.size() < sizeof(header)) {
+        close();
+        return false;
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (header.magic != kMagic || header.version != kVersion || header.width <= 0 || header.height <= 0 ||
+        header.tileSize <= 0 || header.tileSize > 4096 || header.columns != tileCount(header.width, header.tileSize) ||
+        header.rows != tileCount(header.height, header.tileSize)) {
+        close();
+        return false;
+    }
+
+    width_ = header.width;
+    height_ = header.height;
+    tileSize_ = header.tileSize;
+    columns_ = header.columns;
+    rows_ = header.rows;
+    firstTileOffset_ = alignToPage(sizeof(Header));
+    tileSpan_ = alignToPage(tileBytes());
+    // A truncated file would fault when its last tiles are touched, rather than fail here.
+    auto expectedSize = firstTileOffset_ + tileSpan_ * static_cast<size_t>(columns_) * static_cast<size_t>(rows_);
+    if (file_.size() < expectedSize) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void GfxTiledImage::close() {
+    file_.close();
+    width_ = height_ = tileSize_ = columns_ = rows_ = 0;
+    firstTileOffset_ = tileSpan_ = 0;
+}
+
+PixelRect GfxTiledImage::tileRect(const Tile& tile) const {
+    PixelRect rect{tile.column * tileSize_, tile.row * tileSize_, 0, 0};
+    rect.right = std::min(rect.left + tileSize_, width_);
+    rect.bottom = std::min(rect.top + tileSize_, height_);
+    return rect;
+}
+
+size_t GfxTiledImage::tileOffset(const Tile& tile) const {
+    assert(tile.column >= 0 && tile.column < columns_ && tile.row >= 0 && tile.row < rows_);
+    return firstTileOffset_ + tileSpan_ * (static_cast<size_t>(tile.row) * columns_ + tile.column);
+}
+
+const uint8_t* GfxTiledImage::tilePixels(const Tile& tile) const {
+    return file_.data() + tileOffset(tile);
+}
+
+template <typename Fn>
+void GfxTiledImage::forEachTileRange(const PixelRect& rect, Fn&& fn) const {
+    auto clipped = rect.intersection(PixelRect{0, 0, width_, height_});
+    if (clipped.isEmpty()) {
+        return;
+    }
+    int32_t firstColumn = clipped.left / tileSize_;
+    int32_t lastColumn = (clipped.right - 1) / tileSize_;
+    int32_t firstRow = clipped.top / tileSize_;
+    int32_t lastRow = (clipped.bottom - 1) / tileSize_;
+    for (int32_t row = firstRow; row <= lastRow; ++row) {
+        fn(row, firstColumn, lastColumn);
+    }
+}
+
+void GfxTiledImage::tilesIntersecting(const PixelRect& rect, std::vector<Tile>& tiles) const {
+    forEachTileRange(rect, [&](int32_t row, int32_t firstColumn, int32_t lastColumn) {
+        for (int32_t column = firstColumn; column <= lastColumn; ++column) {
+            tiles.push_back(Tile{column, row});
+        }
+    });
+}
+
+size_t GfxTiledImage::tileCountIntersecting(const PixelRect& rect) const {
+    size_t count = 0;
+    forEachTileRange(rect, [&](int32_t, int32_t firstColumn, int32_t lastColumn) {
+        count += static_cast<size_t>(lastColumn - firstColumn + 1);
+    });
+    return count;
+}
+
+void GfxTiledImage::prefetch(const PixelRect& rect) const {
+    // The tiles of a row are contiguous in the file, one hint per row.
+    forEachTileRange(rect, [&](int32_t row, int32_t firstColumn, int32_t lastColumn) {
+        auto offset = tileOffset(Tile{firstColumn, row});
+        file_.prefetch(offset, tileSpan_ * static_cast<size_t>(lastColumn - firstColumn + 1));
+    });
+}
+
+void GfxTiledImage::discard(const PixelRect& rect) const {
+    forEachTileRange(rect, [&](int32_t row, int32_t firstColumn, int32_t lastColumn) {
+        auto offset = tileOffset(Tile{firstColumn, row});
+        file_.discard(offset, tileSpan_ * static_cast<size_t>(lastColumn - firstColumn + 1));
+    });
+}
+
+PixelRect GfxTiledImage::readAheadRect(const PixelRect& previous, const PixelRect& current, int32_t distance) {
+    if (previous.isEmpty() || current.isEmpty() || distance <= 0) {
+        return {};
+    }
+    int32_t dx = current.left - previous.left;
+    int32_t dy = current.top - previous.top;
+    if (dx == 0 && dy == 0) {
+        return {};
+    }
+    // Includes the current rect: its pages are already loaded, prefetching them costs nothing.
+    PixelRect ahead = current;
+    if (dx > 0) {
+        ahead.right += distance;
+    } else if (dx < 0) {
+        ahead.left -= distance;
+    }
+    if (dy > 0) {
+        ahead.bottom += distance;
+    } else if (dy < 0) {
+        ahead.top -= distance;
+    }
+    return ahead;
+}
+
+bool GfxTiledImage::write(const std::filesystem::path& path, int32_t width, int32_t height, int32_t tileSize,
+    const TileWriter& writer) {
+    if (width <= 0 || height <= 0 || tileSize <= 0 || tileSize > 4096) {
+        return false;
+    }
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        return false;
+    }
+    Header header{kMagic, kVersion, width, height, tileSize, tileCount(width, tileSize), tileCount(height, tileSize), 0};
+    std::vector<uint8_t> page(alignToPage(sizeof(Header)));
+    std::memcpy(page.data(), &header, sizeof(header));
+    stream.write(reinterpret_cast<const char*>(page.data()), static_cast<std::streamsize>(page.size()));
+
+    size_t stride = static_cast<size_t>(tileSize) * 4;
+    std::vector<uint8_t> tile(alignToPage(stride * tileSize));
+    for (int32_t row = 0; row < header.rows; ++row) {
+        for (int32_t column = 0; column < header.columns; ++column) {
+            std::fill(tile.begin(), tile.end(), uint8_t{0});
+            PixelRect rect{column * tileSize, row * tileSize, 0, 0};
+            rect.right = std::min(rect.left + tileSize, width);
+            rect.bottom = std::min(rect.top + tileSize, height);
+            writer(rect, tile.data(), stride);
+            stream.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size()));
+        }
+    }
+    return static_cast<bool>(stream.flush());
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,94 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include "./GfxMappedFile.h"
+#include "./GfxRect.h"
+
+namespace winui_drover_island {
+
+// Raster image stored as a grid of square tiles, in a file that is memory-mapped rather than
+// read. Tiles are premultiplied BGRA, stored uncompressed and padded to the full tile size, so a
+// tile can be uploaded straight from the mapping. Only the tiles that are drawn are ever touched.
+//
+// File layout: a header, then the tiles row by row. Each tile starts on a page boundary, so
+// prefetching or dropping a tile never touches its neighbors.
+class GfxTiledImage {
+ public:
+    static constexpr int32_t kDefaultTileSize = 256;
+
+    struct Tile {
+        int32_t column = 0;
+        int32_t row = 0;
+    };
+
+    bool open(const std::filesystem::path& path);
+    void close();
+    bool isOpen() const { return file_.isOpen(); }
+
+    int32_t width() const { return width_; }
+    int32_t height() const { return height_; }
+    int32_t tileSize() const { return tileSize_; }
+    int32_t columns() const { return columns_; }
+    int32_t rows() const { return rows_; }
+    // Bytes between two rows of a tile.
+    size_t tileStride() const { return static_cast<size_t>(tileSize_) * 4; }
+    size_t tileBytes() const { return tileStride() * tileSize_; }
+
+    // The part of the image the tile covers, edge tiles are smaller than the tile size.
+    PixelRect tileRect(const Tile& tile) const;
+    const uint8_t* tilePixels(const Tile& tile) const;
+
+    // Appends the tiles intersecting the rect, in image pixels, row by row.
+    void tilesIntersecting(const PixelRect& rect, std::vector<Tile>& tiles) const;
+    // The number of tiles tilesIntersecting() appends, without listing them.
+    size_t tileCountIntersecting(const PixelRect& rect) const;
+
+    void prefetch(const PixelRect& rect) const;
+    void discard(const PixelRect& rect) const;
+
+    // The region worth prefetching once `current` is shown after `previous`: `current` extended
+    // by `distance` pixels in the direction it moved.
+    static PixelRect readAheadRect(const PixelRect& previous, const PixelRect& current, int32_t distance);
+
+    // Fills one tile: pixels points to a full tile, rows are tileStride() apart. Pixels outside
+    // of the tile rect are padding and are already cleared.
+    using TileWriter = std::function<void(const PixelRect& tileRect, uint8_t* pixels, size_t stride)>;
+
+    // Writes an image tile by tile, so images larger than the RAM can be converted.
+    static bool write(const std::filesystem::path& path, int32_t width, int32_t height, int32_t tileSize,
+        const TileWriter& writer);
+
+ private:
+    size_t tileOffset(const Tile& tile) const;
+    template <typename Fn>
+    void forEachTileRange(const PixelRect& rect, Fn&& fn) const;
+
+    GfxMappedFile file_;
+    int32_t width_ = 0;
+    int32_t height_ = 0;
+    int32_t tileSize_ = 0;
+    int32_t columns_ = 0;
+    int32_t rows_ = 0;
+    size_t firstTileOffset_ = 0;
+    size_t tileSpan_ = 0;
+};
+
+}  // namespace winui_drover_island
@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxUnits.h"
+
+#include <cmath>
+
+namespace winui_drover_island {
+
+int32_t dipsToPixels(float dips, float dpi, DpiRounding dpiRounding) {
+    float scaled = dips * dpi / kDefaultDpi;
+    switch (dpiRounding) {
+    case DpiRounding::kFloor: scaled = floorf(scaled); break;
+    case DpiRounding::kRound: scaled = roundf(scaled); break;
+    case DpiRounding::kCeiling: scaled = ceilf(scaled); break;
+    }
+
+    return static_cast<int32_t>(scaled);
+}
+
+int32_t sizeDipsToPixels(float dips, float dpi) {
+    int32_t result = dipsToPixels(dips, dpi, DpiRounding::kRound);
+
+    // Zero versus non-zero is pretty important for things like control sizes, so we want
+    // to avoid ever rounding non-zero input sizes down to zero during conversion to pixels.
+    // If the input value was small but positive, it's safer to round up to one instead.
+    if (result == 0 && dips > 0) {
+        return 1;
+    }
+
+    return result;
+}
+
+PixelRect toPixelRect(const DipRect& rect, float dpi) {
+    auto left = dipsToPixels(rect.x, dpi, DpiRounding::kRound);
+    auto top = dipsToPixels(rect.y, dpi, DpiRounding::kRound);
+    auto right = dipsToPixels(rect.x + rect.width, dpi, DpiRounding::kRound);
+    auto bottom = dipsToPixels(rect.y + rect.height, dpi, DpiRounding::kRound);
+
+    if (right == left && rect.width > 0)
+        right++;
+
+    if (bottom == top && rect.height > 0)
+        bottom++;
+
+    return PixelRect{left, top, right, bottom};
+}
+
+DipRect toDipRect(const PixelRect& rect, float dpi) {
+    return DipRect{pixelsToDips(rect.left, dpi), pixelsToDips(rect.top, dpi), pixelsToDips(rect.right - rect.left, dpi),
+        pixelsToDips(rect.bottom - rect.top, dpi)};
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "./GfxRect.h"
+
+namespace winui_drover_island {
+
+// Conversions between DIPs and surface pixels. No Windows dependencies, so the dirty region and
+// tiling code using them can be built and measured headless.
+
+enum class DpiRounding { kFloor, kRound, kCeiling };
+constexpr float kDefaultDpi = 96.0f;
+
+int32_t dipsToPixels(float dips, float dpi, DpiRounding dpiRounding);
+
+inline float pixelsToDips(int32_t pixels, float dpi) {
+    return pixels * kDefaultDpi / dpi;
+}
+
+int32_t sizeDipsToPixels(float dips, float dpi);
+
+// Same layout as winrt::Windows::Foundation::Rect.
+struct DipRect {
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+};
+
+// The edges are rounded to the nearest pixel; a rect that isn't empty covers one pixel at least.
+PixelRect toPixelRect(const DipRect& rect, float dpi);
+DipRect toDipRect(const PixelRect& rect, float dpi);
+
+}  // namespace winui_drover_island
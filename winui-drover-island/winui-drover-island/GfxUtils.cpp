@@ -26,57 +26,20 @@ void Logger::warn(const char* msg) {
     OutputDebugStringA(msg);
 }
 
-int32_t dipsToPixels(float dips, float dpi, DpiRounding dpiRounding) {
-    float scaled = dips * dpi / kDefaultDpi;
-    switch (dpiRounding) {
-    case DpiRounding::kFloor: scaled = floorf(scaled); break;
-    case DpiRounding::kRound: scaled = roundf(scaled); break;
-    case DpiRounding::kCeiling: scaled = ceilf(scaled); break;
+void GfxDebugOutputLogSink::write(const GfxLogRecord& record) {
+    char buffer[512];
+    if (format(record, buffer, sizeof(buffer)) > 0) {
+        OutputDebugStringA(buffer);
     }
-
-    return static_cast<int32_t>(scaled);
-}
-
-int32_t sizeDipsToPixels(float dips, float dpi) {
-    int32_t result = dipsToPixels(dips, dpi, DpiRounding::kRound);
-
-    // Zero versus non-zero is pretty important for things like control sizes, so we want
-    // to avoid ever rounding non-zero input sizes down to zero during conversion to pixels.
-    // If the input value was small but positive, it's safer to round up to one instead.
-    if (result == 0 && dips > 0) {
-        return 1;
-    }
-
-    return result;
 }
 
 winrt::Windows::Foundation::Rect toRect(RECT const& rect, float dpi) {
-    auto x = pixelsToDips(rect.left, dpi);
-    auto y = pixelsToDips(rect.top, dpi);
-    auto width = pixelsToDips(rect.right - rect.left, dpi);
-    auto height = pixelsToDips(rect.bottom - rect.top, dpi);
-
-    winrt::Windows::Foundation::Rect rc;
-    rc.X = x;
-    rc.Y = y;
-    rc.Width = width;
-    rc.Height = height;
-    return rc;
+    auto dipRect = toDipRect(toPixelRect(rect), dpi);
+    return winrt::Windows::Foundation::Rect{dipRect.x, dipRect.y, dipRect.width, dipRect.height};
 }
 
 RECT toRECT(const winrt::Windows::Foundation::Rect& rect, float dpi) {
-    auto left = dipsToPixels(rect.X, dpi, DpiRounding::kRound);
-    auto top = dipsToPixels(rect.Y, dpi, DpiRounding::kRound);
-    auto right = dipsToPixels(rect.X + rect.Width, dpi, DpiRounding::kRound);
-    auto bottom = dipsToPixels(rect.Y + rect.Height, dpi, DpiRounding::kRound);
-
-    if (right == left && rect.Width > 0)
-        right++;
-
-    if (bottom == top && rect.Height > 0)
-        bottom++;
-
-    return RECT{ left, top, right, bottom };
+    return toRECT(toPixelRect(DipRect{rect.X, rect.Y, rect.Width, rect.Height}, dpi));
 }
 
 bool isDeviceLostHResult(HRESULT hr) {
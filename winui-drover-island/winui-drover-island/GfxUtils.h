@@ -17,6 +17,10 @@
 #include <system_error>
 #include "winrt/Windows.Foundation.h"
 
+#include "./GfxLog.h"
+#include "./GfxRect.h"
+#include "./GfxUnits.h"
+
 namespace winui_drover_island {
 
 struct Logger {
@@ -24,21 +28,24 @@ struct Logger {
     static void warn(const char* msg);
 };
 
-enum class DpiRounding { kFloor, kRound, kCeiling };
-constexpr float kDefaultDpi = 96.0f;
-
-int32_t dipsToPixels(float dips, float dpi, DpiRounding dpiRounding);
-
-inline float pixelsToDips(int32_t pixels, float dpi) {
-    return pixels * kDefaultDpi / dpi;
-}
-
-int32_t sizeDipsToPixels(float dips, float dpi);
+// Sends the records of GfxLog to the debugger output.
+class GfxDebugOutputLogSink : public GfxLogSink {
+ public:
+    void write(const GfxLogRecord& record) override;
+};
 
 winrt::Windows::Foundation::Rect toRect(RECT const& rect, float dpi);
 
 RECT toRECT(const winrt::Windows::Foundation::Rect& rect, float dpi);
 
+inline RECT toRECT(const PixelRect& rect) {
+    return RECT{ rect.left, rect.top, rect.right, rect.bottom };
+}
+
+inline PixelRect toPixelRect(const RECT& rect) {
+    return PixelRect{ rect.left, rect.top, rect.right, rect.bottom };
+}
+
 #define ReturnIfFailed(v)   \
     {                       \
         HRESULT __hr = (v); \
@@ -93,17 +100,19 @@ HRESULT ComExceptionBoundary(CALLABLE&& fn) {
     }
 }
 
+// The log parameter must be a string literal: the message is only formatted later, on the
+// GfxLog drain thread, so these are cheap enough to be used in the render paths.
 template <typename CALLABLE>
-void ComExceptionBoundaryWithLog(CALLABLE&& fn, const char* log) {
+void ComExceptionBoundaryWithLog(CALLABLE&& fn, const char* log, uint64_t controlId = 0) {
     auto hResult = ComExceptionBoundary(std::move(fn));
     if (FAILED(hResult)) {
-        Logger::warn("[ComException][CanvasControl] " + std::string(log) + " function has thrown an exception " + std::to_string(hResult));
+        GfxLog::instance().log(GfxLogKind::kException, log, hResult, controlId);
     }
 }
 
-inline void LogIfFailed(HRESULT hResult, const char* log) {
+inline void LogIfFailed(HRESULT hResult, const char* log, uint64_t controlId = 0) {
     if (FAILED(hResult)) {
-        Logger::warn("[ComErrir][CanvasControl] " + std::string(log) + " function has failed " + std::to_string(hResult));
+        GfxLog::instance().log(GfxLogKind::kFailed, log, hResult, controlId);
     }
 }
 
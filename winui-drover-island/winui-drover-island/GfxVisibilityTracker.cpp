@@ -0,0 +1,78 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#include "./GfxVisibilityTracker.h"
+
+#include <algorithm>
+
+namespace winui_drover_island {
+
+bool GfxVisibilityTracker::onShown(Clock::time_point now) {
+    switch (state_) {
+    case State::kVisible:
+    case State::kRestoring: return false;
+    case State::kHidden: state_ = State::kVisible; return false;
+    case State::kReleased:
+        state_ = State::kRestoring;
+        shownSince_ = now;
+        return true;
+    }
+    return false;
+}
+
+void GfxVisibilityTracker::onHidden(Clock::time_point now) {
+    switch (state_) {
+    case State::kVisible:
+    case State::kRestoring:
+        // Hidden again before the content came back: the surface may have been re-created
+        // already, it gets its own grace period.
+        state_ = State::kHidden;
+        hiddenSince_ = now;
+        break;
+    case State::kHidden:
+    case State::kReleased: break;
+    }
+}
+
+GfxVisibilityTracker::Clock::duration GfxVisibilityTracker::remainingGrace(Clock::time_point now) const {
+    if (state_ != State::kHidden) {
+        return Clock::duration::max();
+    }
+    return std::max(Clock::duration::zero(), hiddenSince_ + gracePeriod_ - now);
+}
+
+bool GfxVisibilityTracker::shouldRelease(Clock::time_point now) const {
+    return state_ == State::kHidden && now - hiddenSince_ >= gracePeriod_;
+}
+
+void GfxVisibilityTracker::onReleased(size_t bytes) {
+    stats_.releaseCount++;
+    stats_.bytesReleased += bytes;
+    if (state_ == State::kHidden) {
+        state_ = State::kReleased;
+    }
+}
+
+void GfxVisibilityTracker::onPresented(Clock::time_point now) {
+    if (state_ != State::kRestoring) {
+        return;
+    }
+    state_ = State::kVisible;
+    auto latency = now - shownSince_;
+    stats_.restoreCount++;
+    stats_.lastRestoreLatency = latency;
+    stats_.maxRestoreLatency = std::max(stats_.maxRestoreLatency, latency);
+    stats_.totalRestoreLatency += latency;
+}
+
+}  // namespace winui_drover_island
@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2020 Adobe Systems Incorporated. All rights reserved.
+ *  This file is licensed to you under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License. You may obtain a copy
+ *  of the License at http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software distributed under
+ *  the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR REPRESENTATIONS
+ *  OF ANY KIND, either express or implied. See the License for the specific language
+ *  governing permissions and limitations under the License.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace winui_drover_island {
+
+// Tracks when a control stops being visible, decides when its surface can be released after a
+// grace period, and measures how long it takes to show content again once it is visible.
+// Time is passed in by the caller so the transitions can be driven by a test clock.
+class GfxVisibilityTracker {
+ public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class State {
+        kVisible,
+        // Hidden, but still holding its surface until the grace period is over.
+        kHidden,
+        // Hidden and the surface was released.
+        kReleased,
+        // Visible again, waiting for the first frame to be presented.
+        kRestoring,
+    };
+
+    struct Stats {
+        uint64_t releaseCount = 0;
+        uint64_t restoreCount = 0;
+        uint64_t bytesReleased = 0;
+        Clock::duration lastRestoreLatency{};
+        Clock::duration maxRestoreLatency{};
+        Clock::duration totalRestoreLatency{};
+    };
+
+    static constexpr Clock::duration kDefaultGracePeriod = std::chrono::seconds(2);
+
+    explicit GfxVisibilityTracker(Clock::duration gracePeriod = kDefaultGracePeriod) : gracePeriod_(gracePeriod) {}
+
+    void setGracePeriod(Clock::duration gracePeriod) { gracePeriod_ = gracePeriod; }
+    Clock::duration gracePeriod() const { return gracePeriod_; }
+
+    State state() const { return state_; }
+    bool isVisible() const { return state_ == State::kVisible || state_ == State::kRestoring; }
+
+    // Returns true if the surface was released while hidden and the control needs to redraw.
+    bool onShown(Clock::time_point now);
+    void onHidden(Clock::time_point now);
+
+    // Time left before the surface may be released, zero if it can be released now.
+    Clock::duration remainingGrace(Clock::time_point now) const;
+    bool shouldRelease(Clock::time_point now) const;
+
+    // The surface was released, either at the end of the grace period or by the memory budget.
+    void onReleased(size_t bytes);
+    // A frame was presented.
+    void onPresented(Clock::time_point now);
+
+    const Stats& stats() const { return stats_; }
+
+ private:
+    Clock::duration gracePeriod_;
+    Clock::time_point hiddenSince_{};
+    Clock::time_point shownSince_{};
+    State state_ = State::kVisible;
+    Stats stats_;
+};
+
+}  // namespace winui_drover_island
@@ -15,9 +15,20 @@
 #include "WinUIWindow.h"
 #include "DroverIsland.h"
 #include "EllipseShape.h"
+#include "GfxCompositionFrameClock.h"
+#include "GfxD2DDeviceManager.h"
+#include "GfxEventTrace.h"
+#include "GfxFrameClock.h"
+#include "GfxMemoryBudget.h"
+#include "GfxSnapshotStore.h"
 
+#include <shellapi.h>
 #include <winrt/Windows.UI.h>
 
+#include <cwchar>
+#include <filesystem>
+#include <string>
+
 using namespace winrt::Microsoft::UI::Xaml::Controls;
 using namespace winrt::Microsoft::UI::Xaml;
 using namespace winrt::Windows::Foundation;
@@ -25,6 +36,26 @@ using namespace winrt::Windows::Foundation;
 namespace winui_drover_island {
 
 namespace {
+// Identifies the window in the recorded events, the controls are numbered from 1.
+constexpr uint64_t kWindowEventSource = 0;
+
+// The stress mode invalidates on every composition frame or so, and reports once per second.
+constexpr std::chrono::milliseconds kStressTickInterval{ 16 };
+constexpr std::chrono::seconds kStressReportInterval{ 1 };
+// Between the controls of the stress grid, in DIPs.
+constexpr float kStressCellSpacing = 4;
+
+// What the parked controls may hold in surfaces, the least recently shown ones are released first.
+constexpr size_t kParkedControlsCapacity = 64 * 1024 * 1024;
+// A control that can't draw, like one of zero size, isn't waited for.
+constexpr std::chrono::seconds kSwitchLatencyTimeout{ 2 };
+
+const wchar_t* const kDescriptions[] = {
+	L"No control is currently rendering.",
+	L"This is a sample ellipse rendered using a sample class EllipseShape inheriting from CanvasControl. Resize the window to trigger redraws on the control.",
+	L"This is a the placeholder that is supposed to host a Drover Island. It is using the class DroverIsland inheriting from CanvasControl. Resize the window to trigger redraws on the control.",
+};
+
 Grid createGrid() {
 	// Setup the grid.
 	auto column1 = ColumnDefinition{};
@@ -54,12 +85,30 @@ Grid createGrid() {
 }
 }
 
-WinUIWindow::WinUIWindow() {	
+WinUIWindow::WinUIWindow() : mParkedControls(kParkedControlsCapacity) {
+	// The stress grid is set up from the command line, like --stress-controls=1000 --stress-max-rate=120.
+	int argumentCount = 0;
+	if (auto arguments = CommandLineToArgvW(GetCommandLineW(), &argumentCount)) {
+		for (int i = 1; i < argumentCount; ++i) {
+			GfxStressScenario::parseArgument(winrt::to_string(arguments[i]), mStressOptions);
+		}
+		LocalFree(arguments);
+	}
 }
 
 void WinUIWindow::create() {
 	// Add some content
 	mWindow = Window{};
+	// Nothing needs to be drawn while the window is minimized or fully occluded.
+	mVisibilityChangedRevoker = mWindow.VisibilityChanged(winrt::auto_revoke, [](const IInspectable&, const WindowVisibilityChangedEventArgs& args) {
+		GfxFrameClock::setOccluded(!args.Visible());
+	});
+	// Desktop apps are not always suspended before exiting, the snapshots are saved on close too.
+	mClosedRevoker = mWindow.Closed(winrt::auto_revoke, [](const IInspectable&, const WindowEventArgs&) {
+		GfxSnapshotStore::instance().saveAll();
+		// The shared clock outlives the window, it must not be left registered for Rendering.
+		GfxVsyncFrameClock::shared()->close();
+	});
 }
 
 void WinUIWindow::addContent() {
@@ -73,6 +122,40 @@ void WinUIWindow::addContent() {
 	mUncheckedRevoker = checkbox.Unchecked(winrt::auto_revoke, [this](const IInspectable&, const RoutedEventArgs&) { mUseVSIS = false; });
 	grid.Children().Append(checkbox);
 
+	auto recordCheckbox = CheckBox{};
+	recordCheckbox.Margin({ 20, 0, 0, 0 });
+	recordCheckbox.Content(winrt::box_value(L"Record Events"));
+	mRecordCheckedRevoker = recordCheckbox.Checked(winrt::auto_revoke, [this](const IInspectable&, const RoutedEventArgs&) { startRecording(); });
+	mRecordUncheckedRevoker = recordCheckbox.Unchecked(winrt::auto_revoke, [this](const IInspectable&, const RoutedEventArgs&) { stopRecording(); });
+	grid.Children().Append(recordCheckbox);
+	Grid::SetRow(recordCheckbox, 1);
+
+	auto hudCheckbox = CheckBox{};
+	hudCheckbox.Margin({ 20, 0, 0, 0 });
+	hudCheckbox.Content(winrt::box_value(L"Show Performance HUD"));
+	auto setShowHud = [this](bool show) {
+		mShowHud = show;
+		if (mCanvasControl) {
+			mCanvasControl->setHudVisible(show);
+		}
+	};
+	mHudCheckedRevoker = hudCheckbox.Checked(winrt::auto_revoke, [setShowHud](const IInspectable&, const RoutedEventArgs&) { setShowHud(true); });
+	mHudUncheckedRevoker = hudCheckbox.Unchecked(winrt::auto_revoke, [setShowHud](const IInspectable&, const RoutedEventArgs&) { setShowHud(false); });
+	grid.Children().Append(hudCheckbox);
+	Grid::SetRow(hudCheckbox, 2);
+
+	auto stressCheckbox = CheckBox{};
+	stressCheckbox.Margin({ 20, 0, 0, 0 });
+	stressCheckbox.VerticalAlignment(VerticalAlignment::Top);
+	wchar_t stressLabel[128];
+	swprintf_s(stressLabel, L"Stress Mode (%u controls, %g to %g invalidations/s)", mStressOptions.controlCount,
+		mStressOptions.minInvalidationsPerSecond, mStressOptions.maxInvalidationsPerSecond);
+	stressCheckbox.Content(winrt::box_value(stressLabel));
+	mStressCheckedRevoker = stressCheckbox.Checked(winrt::auto_revoke, [this](const IInspectable&, const RoutedEventArgs&) { startStressMode(); });
+	mStressUncheckedRevoker = stressCheckbox.Unchecked(winrt::auto_revoke, [this](const IInspectable&, const RoutedEventArgs&) { stopStressMode(); });
+	grid.Children().Append(stressCheckbox);
+	Grid::SetRow(stressCheckbox, 3);
+
 	auto title = TextBlock{};
 	title.Text(L"Playground for supporting Drover Islands in WinUI");
 	grid.Children().Append(title);
@@ -92,6 +175,7 @@ void WinUIWindow::addContent() {
 	mClickRevoker = button.Click(winrt::auto_revoke, [this](const IInspectable&, const RoutedEventArgs&) {
 		renderCanvasControl(pickNextControl());
 	});
+	mNextButton = button;
 
 	auto description = TextBlock{};
 	grid.Children().Append(description);
@@ -123,35 +207,254 @@ WinUIWindow::Type WinUIWindow::pickNextControl() {
 	}
 }
 
+uint32_t WinUIWindow::parkedControlKey(Type type, bool useVSIS) {
+	return static_cast<uint32_t>(type) * 2 + (useVSIS ? 1 : 0);
+}
+
 void WinUIWindow::renderCanvasControl(Type type) {
-	auto grid = mWindow.Content().as<Grid>();
+	GfxEventRecorder::instance().record(kWindowEventSource, GfxEventRecorder::EventKind::kPickControl, static_cast<float>(type));
+	mSwitchStart = std::chrono::steady_clock::now();
 
-	switch (type) {
-	case Type::None: {
+	// The control shown so far is parked rather than released, it can be picked again. The memory
+	// budget may have released the surfaces of the parked ones since they were parked: their
+	// costs are asked again before this one makes room.
+	if (mCanvasControl) {
+		mCanvasControl->setParked(true);
+		mParkedControls.updateCosts([](uint32_t, const auto& control) { return control->surfaceBytes(); });
+		mParkedControls.insert(parkedControlKey(mControlType, mCanvasControlUsesVSIS), mCanvasControl, mCanvasControl->surfaceBytes());
+	}
+
+	winrt::com_ptr<winrt::winui_drover_island::implementation::CanvasControl> control;
+	mSwitchReusedControl = type != Type::None && mParkedControls.take(parkedControlKey(type, mUseVSIS), control);
+	if (!mSwitchReusedControl) {
+		switch (type) {
+		case Type::None:
+			break;
+		case Type::Ellipse:
+			control.copy_from(winrt::make_self<winui_drover_island::EllipseShape>(mUseVSIS).get());
+			break;
+		case Type::DroverSample:
+			control.copy_from(winrt::make_self<winui_drover_island::DroverIsland>(mUseVSIS).get());
+			break;
+		}
+	}
+	if (control) {
+		control->setParked(false);
+		control->setHudVisible(mShowHud);
+		mCanvasContainer.Child(*control);
+	} else {
 		mCanvasContainer.Child(nullptr);
-		break;
 	}
-	case Type::Ellipse: {
-		auto ellipse = winrt::make_self<winui_drover_island::EllipseShape>(mUseVSIS);
-		mCanvasContainer.Child(*ellipse);
-		break;
+	mCanvasControl = std::move(control);
+	mCanvasControlUsesVSIS = mUseVSIS;
+
+	static_assert(_countof(kDescriptions) == static_cast<size_t>(Type::Last) + 1);
+	mDescription.Text(kDescriptions[static_cast<size_t>(type)]);
+
+	mControlType = type;
+	if (mCanvasControl) {
+		mSwitchRenderingRevoker = Media::CompositionTarget::Rendering(winrt::auto_revoke, [this](const IInspectable&, const IInspectable&) {
+			onSwitchRendering();
+		});
+	} else {
+		mSwitchRenderingRevoker.revoke();
 	}
-	case Type::DroverSample: {
-		auto droverIsland = winrt::make_self<winui_drover_island::DroverIsland>(mUseVSIS);
-		mCanvasContainer.Child(*droverIsland);
-		break;
+}
+
+void WinUIWindow::onSwitchRendering() {
+	auto latency = std::chrono::steady_clock::now() - mSwitchStart;
+	bool timedOut = latency > kSwitchLatencyTimeout;
+	if (mCanvasControl && !mCanvasControl->isContentReady() && !timedOut) {
+		return;
 	}
+	mSwitchRenderingRevoker.revoke();
+	if (!mCanvasControl || timedOut) {
+		return;
 	}
 
-	const wchar_t* descriptions[] = {
-		L"No control is currently rendering.",
-		L"This is a sample ellipse rendered using a sample class EllipseShape inheriting from CanvasControl. Resize the window to trigger redraws on the control.",
-		L"This is a the placeholder that is supposed to host a Drover Island. It is using the class DroverIsland inheriting from CanvasControl. Resize the window to trigger redraws on the control.",
-	};
-	static_assert(_countof(descriptions) == static_cast<size_t>(Type::Last) + 1);
-	mDescription.Text(descriptions[static_cast<size_t>(type)]);
+	auto& stats = mSwitchReusedControl ? mParkedControlLatency : mNewControlLatency;
+	stats.count++;
+	stats.total += latency;
+	auto milliseconds = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+	auto average = [&](const SwitchLatency& entry) { return entry.count ? milliseconds(entry.total) / entry.count : 0.0; };
 
-	mControlType = type;
+	wchar_t text[256];
+	swprintf_s(text, L"\nShown in %.1f ms, %ls. On average %.1f ms for a new control (%llu), %.1f ms for a parked one (%llu).",
+		milliseconds(latency), mSwitchReusedControl ? L"attached back from the parked controls" : L"as a new control",
+		average(mNewControlLatency), mNewControlLatency.count, average(mParkedControlLatency), mParkedControlLatency.count);
+	mDescription.Text(std::wstring(kDescriptions[static_cast<size_t>(mControlType)]) + text);
+}
+
+void WinUIWindow::startRecording() {
+	GfxEventRecorder::instance().start();
+	// The trace starts with a new control, so that it holds the whole life of the control.
+	mCanvasControl = nullptr;
+	mParkedControls.clear();
+	renderCanvasControl(mControlType);
+}
+
+void WinUIWindow::stopRecording() {
+	auto trace = GfxEventRecorder::instance().stop();
+	std::error_code error;
+	auto path = std::filesystem::temp_directory_path(error) / L"winui-drover-island.gevt";
+	if (error || !trace.save(path)) {
+		mDescription.Text(L"Failed to save the recorded events.");
+		return;
+	}
+	mDescription.Text(L"Recorded " + std::to_wstring(trace.events().size()) + L" events in " + path.wstring() +
+		L". Replay them with GfxEventReplayer to measure the frame times headless.");
+}
+
+void WinUIWindow::startStressMode() {
+	if (mStressScenario) {
+		return;
+	}
+	mCanvasContainer.Child(nullptr);
+	mCanvasControl = nullptr;
+	// Only the grid holds surfaces while it is measured.
+	mParkedControls.clear();
+	mSwitchRenderingRevoker.revoke();
+	mNextButton.IsEnabled(false);
+
+	mStressScenario = std::make_unique<GfxStressScenario>(mStressOptions);
+	const auto& options = mStressScenario->options();
+	const float pitchX = options.cellWidth + kStressCellSpacing;
+	const float pitchY = options.cellHeight + kStressCellSpacing;
+
+	// Most of the grid is out of view: scrolling shows and hides controls like a dashboard does.
+	auto canvas = Canvas{};
+	canvas.Width(options.columns * pitchX);
+	canvas.Height(mStressScenario->rowCount() * pitchY);
+	const auto& controls = mStressScenario->controls();
+	mStressControls.reserve(controls.size());
+	for (size_t i = 0; i < controls.size(); ++i) {
+		winrt::com_ptr<winrt::winui_drover_island::implementation::CanvasControl> control;
+		if (controls[i].kind == GfxStressScenario::ControlKind::kDroverIsland) {
+			control.copy_from(winrt::make_self<winui_drover_island::DroverIsland>(controls[i].useVirtualSurface).get());
+		} else {
+			control.copy_from(winrt::make_self<winui_drover_island::EllipseShape>(controls[i].useVirtualSurface).get());
+		}
+		control->Width(options.cellWidth);
+		control->Height(options.cellHeight);
+		canvas.Children().Append(*control);
+		Canvas::SetLeft(*control, (i % options.columns) * pitchX);
+		Canvas::SetTop(*control, (i / options.columns) * pitchY);
+		mStressControls.push_back(std::move(control));
+	}
+	auto scrollViewer = ScrollViewer{};
+	scrollViewer.HorizontalScrollBarVisibility(ScrollBarVisibility::Auto);
+	scrollViewer.Content(canvas);
+	mCanvasContainer.Child(scrollViewer);
+
+	auto queue = winrt::Microsoft::System::DispatcherQueue::GetForCurrentThread();
+	mStressTimer = queue.CreateTimer();
+	mStressTimer.Interval(kStressTickInterval);
+	mStressTimerRevoker = mStressTimer.Tick(winrt::auto_revoke, [this](const winrt::Microsoft::System::DispatcherQueueTimer&, const IInspectable&) { onStressTick(); });
+	mStressReportTimer = queue.CreateTimer();
+	mStressReportTimer.Interval(kStressReportInterval);
+	mStressReportTimerRevoker = mStressReportTimer.Tick(winrt::auto_revoke, [this](const winrt::Microsoft::System::DispatcherQueueTimer&, const IInspectable&) { reportStress(); });
+
+	mStressStart = std::chrono::steady_clock::now();
+	mStressReportStart = mStressStart;
+	mStressInvalidations = 0;
+	GfxVsyncFrameClock::shared()->resetTickStats();
+	mStressTimer.Start();
+	mStressReportTimer.Start();
+	mDescription.Text(L"Stress mode is starting...");
+}
+
+void WinUIWindow::stopStressMode() {
+	if (!mStressScenario) {
+		return;
+	}
+	mStressTimer.Stop();
+	mStressReportTimer.Stop();
+	mStressTimerRevoker.revoke();
+	mStressReportTimerRevoker.revoke();
+	mStressTimer = nullptr;
+	mStressReportTimer = nullptr;
+	mCanvasContainer.Child(nullptr);
+	mStressControls.clear();
+	mStressScenario.reset();
+	mNextButton.IsEnabled(true);
+	renderCanvasControl(mControlType);
+}
+
+void WinUIWindow::onStressTick() {
+	auto now = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - mStressStart);
+	for (const auto& invalidation : mStressScenario->advance(elapsed)) {
+		auto& control = mStressControls[invalidation.control];
+		if (invalidation.partial) {
+			control->invalidateRect(D2D1::RectF(invalidation.rect[0], invalidation.rect[1], invalidation.rect[2], invalidation.rect[3]));
+		} else {
+			control->invalidate();
+		}
+		mStressInvalidations++;
+	}
+	// The scenario loops until the stress mode is left.
+	if (elapsed >= mStressScenario->options().duration) {
+		mStressScenario->restart();
+		mStressStart = now;
+	}
+}
+
+void WinUIWindow::reportStress() {
+	auto now = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(now - mStressReportStart).count();
+	mStressReportStart = now;
+	if (seconds <= 0) {
+		return;
+	}
+
+	// Every control draws on the ticks of the shared clock, a tick is the frame of the whole grid.
+	const auto& clock = GfxVsyncFrameClock::shared();
+	auto ticks = clock->tickStats();
+	clock->resetTickStats();
+	auto milliseconds = [](auto duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+	double meanTick = ticks.ticks ? milliseconds(ticks.totalTime) / ticks.ticks : 0.0;
+
+	uint64_t fullFrames = 0;
+	uint64_t partialFrames = 0;
+	winrt::winui_drover_island::implementation::CanvasControl::FrameSkipStats frameSkip;
+	size_t virtualSurfaces = 0;
+	for (size_t i = 0; i < mStressControls.size(); ++i) {
+		const auto& damage = mStressControls[i]->damageStats();
+		fullFrames += damage.fullFrames;
+		partialFrames += damage.partialFrames;
+		const auto& skip = mStressControls[i]->frameSkipStats();
+		frameSkip.hashedFrames += skip.hashedFrames;
+		frameSkip.skippedFrames += skip.skippedFrames;
+		frameSkip.unhashedFrames += skip.unhashedFrames;
+		frameSkip.hashTime += skip.hashTime;
+		virtualSurfaces += mStressScenario->controls()[i].useVirtualSurface ? 1 : 0;
+	}
+
+	auto counters = GfxMemoryBudget::instance().counters();
+	auto megabytes = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+	const auto surfaces = static_cast<size_t>(GfxMemorySubsystem::kSurfaces);
+	const auto atlases = static_cast<size_t>(GfxMemorySubsystem::kAtlases);
+	// The controls hold the shared device already, this doesn't create another one.
+	GfxD2DContextPool::Stats pool;
+	if (auto device = GfxD2DDeviceManager::instance().sharedDevice()) {
+		pool = device->contextPoolStats();
+	}
+
+	wchar_t text[768];
+	swprintf_s(text,
+		L"Stress mode: %zu controls, %zu with a virtual surface, %.0f invalidations/s.\n"
+		L"Frames: %.0f/s drawing %.0f controls/s, %.2f ms mean, %.2f ms max. Since the start %llu full and %llu partial.\n"
+		L"Unchanged frames: %.1f%% skipped, %llu hashed in %.1f ms, %llu not hashed.\n"
+		L"Memory: %zu surfaces %.1f MB, atlases %.1f MB, %.1f MB of %.0f MB budget, %llu evictions.\n"
+		L"Context pool: %llu leases, %llu created, %llu contended, %zu idle.",
+		mStressControls.size(), virtualSurfaces, mStressInvalidations / seconds,
+		ticks.ticks / seconds, ticks.clientFrames / seconds, meanTick, milliseconds(ticks.maxTime), fullFrames, partialFrames,
+		frameSkip.skipRate() * 100.0, frameSkip.hashedFrames, milliseconds(frameSkip.hashTime), frameSkip.unhashedFrames,
+		counters.entries[surfaces], megabytes(counters.bytes[surfaces]), megabytes(counters.bytes[atlases]),
+		megabytes(counters.totalBytes), megabytes(counters.budgetInBytes), counters.evictionCount,
+		pool.leases, pool.createdContexts, pool.contendedLocks, pool.idleContexts);
+	mDescription.Text(text);
+	mStressInvalidations = 0;
 }
 
 void WinUIWindow::show() {
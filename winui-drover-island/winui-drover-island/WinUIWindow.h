@@ -14,6 +14,14 @@
 #include <winrt/Microsoft.UI.Xaml.h>
 #include <winrt/winui_drover_island.h>
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include "CanvasControl.h"
+#include "GfxLruCache.h"
+#include "GfxStressScenario.h"
+
 #pragma once
 
 namespace winui_drover_island {
@@ -36,15 +44,61 @@ private:
 
 	void renderCanvasControl(Type);
 	WinUIWindow::Type pickNextControl();
+	static uint32_t parkedControlKey(Type, bool useVSIS);
+	void onSwitchRendering();
+	void startRecording();
+	void stopRecording();
+	void startStressMode();
+	void stopStressMode();
+	void onStressTick();
+	void reportStress();
 
 	winrt::Microsoft::UI::Xaml::Window mWindow{ nullptr };
+	winrt::Microsoft::UI::Xaml::Window::VisibilityChanged_revoker mVisibilityChangedRevoker;
+	winrt::Microsoft::UI::Xaml::Window::Closed_revoker mClosedRevoker;
 	winrt::Microsoft::UI::Xaml::Controls::Button::Click_revoker mClickRevoker;
 	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Checked_revoker mCheckedRevoker;
 	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Unchecked_revoker mUncheckedRevoker;
+	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Checked_revoker mRecordCheckedRevoker;
+	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Unchecked_revoker mRecordUncheckedRevoker;
+	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Checked_revoker mHudCheckedRevoker;
+	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Unchecked_revoker mHudUncheckedRevoker;
+	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Checked_revoker mStressCheckedRevoker;
+	winrt::Microsoft::UI::Xaml::Controls::CheckBox::Unchecked_revoker mStressUncheckedRevoker;
 	Type mControlType = Type::None;
 	winrt::Microsoft::UI::Xaml::Controls::Border mCanvasContainer{ nullptr };
 	winrt::Microsoft::UI::Xaml::Controls::TextBlock mDescription{ nullptr };
+	winrt::Microsoft::UI::Xaml::Controls::Button mNextButton{ nullptr };
+	winrt::com_ptr<winrt::winui_drover_island::implementation::CanvasControl> mCanvasControl;
 	bool mUseVSIS = false;
+	bool mShowHud = false;
+
+	// The controls shown before, detached with their surfaces, by type and surface kind. Picking
+	// one again attaches it back without drawing it.
+	GfxLruCache<uint32_t, winrt::com_ptr<winrt::winui_drover_island::implementation::CanvasControl>> mParkedControls;
+	bool mCanvasControlUsesVSIS = false;
+	// From picking a control to the first composition frame showing its content.
+	struct SwitchLatency {
+		uint64_t count = 0;
+		std::chrono::steady_clock::duration total{};
+	};
+	SwitchLatency mNewControlLatency;
+	SwitchLatency mParkedControlLatency;
+	std::chrono::steady_clock::time_point mSwitchStart;
+	bool mSwitchReusedControl = false;
+	winrt::Microsoft::UI::Xaml::Media::CompositionTarget::Rendering_revoker mSwitchRenderingRevoker;
+
+	// Stress mode: a grid of controls invalidated as the scenario says, instead of a single control.
+	GfxStressScenario::Options mStressOptions;
+	std::unique_ptr<GfxStressScenario> mStressScenario;
+	std::vector<winrt::com_ptr<winrt::winui_drover_island::implementation::CanvasControl>> mStressControls;
+	std::chrono::steady_clock::time_point mStressStart;
+	std::chrono::steady_clock::time_point mStressReportStart;
+	uint64_t mStressInvalidations = 0;
+	winrt::Microsoft::System::DispatcherQueueTimer mStressTimer{ nullptr };
+	winrt::Microsoft::System::DispatcherQueueTimer::Tick_revoker mStressTimerRevoker;
+	winrt::Microsoft::System::DispatcherQueueTimer mStressReportTimer{ nullptr };
+	winrt::Microsoft::System::DispatcherQueueTimer::Tick_revoker mStressReportTimerRevoker;
 };
 
 }  // namespace winui_drover_island
\ No newline at end of file